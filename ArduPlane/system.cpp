@@ -509,6 +509,16 @@ void Plane::update_dynamic_notch()
         case HarmonicNotchDynamicMode::UpdateBLHeli: // BLHeli based tracking
             ins.update_harmonic_notch_freq_hz(MAX(ref_freq, AP_BLHeli::get_singleton()->get_average_motor_frequency_hz() * ref));
             break;
+#endif
+#if HAL_GYROFFT_ENABLED
+        case HarmonicNotchDynamicMode::UpdateFFT: // gyro FFT based tracking
+            if (ins.gyro_fft_healthy()) {
+                // set the harmonic notch filter frequency from the strongest vibration peak
+                ins.update_harmonic_notch_freq_hz(MAX(ref_freq, ins.get_gyro_fft_center_freq_hz() * ref));
+            } else {
+                ins.update_harmonic_notch_freq_hz(ref_freq);
+            }
+            break;
 #endif
         case HarmonicNotchDynamicMode::Fixed: // static
         default:
@@ -1,17 +1,25 @@
 #include "DataFlashFileReader.h"
 
 #include <fcntl.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <time.h>
+#include <algorithm>
 #include <cinttypes>
 
 #ifndef PRIu64
 #define PRIu64 "llu"
 #endif
 
+// distance in bytes between time checkpoints in the log index
+#define LOGREADER_INDEX_INTERVAL (64*1024U)
+#define LOGREADER_INDEX_VERSION 2
+
 // flogged from AP_Hal_Linux/system.cpp; we don't want to use stopped clock here
 uint64_t now() {
     struct timespec ts;
@@ -29,6 +37,18 @@ AP_LoggerFileReader::~AP_LoggerFileReader()
     const uint64_t delta = micros - start_micros;
     ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
     ::printf("Replay rates: %" PRIu64 " bytes/second  %" PRIu64 " messages/second\n", bytes_read*1000000/delta, message_count*1000000/delta);
+    if (map != nullptr) {
+        munmap((void *)map, map_size);
+    }
+    free(index.checkpoints);
+    free(index.offsets);
+    free(header_offsets);
+}
+
+void AP_LoggerFileReader::set_time_window(uint64_t start_us, uint64_t end_us)
+{
+    window_start_us = start_us;
+    window_end_us = end_us;
 }
 
 bool AP_LoggerFileReader::open_log(const char *logfile)
@@ -37,9 +57,305 @@ bool AP_LoggerFileReader::open_log(const char *logfile)
     if (fd == -1) {
         return false;
     }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        return true;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        ::printf("mmap of %s failed, reading instead\n", logfile);
+        return true;
+    }
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    map = (const uint8_t *)p;
+    map_size = st.st_size;
+    log_mtime = int64_t(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+
+    char *index_path = nullptr;
+    if (asprintf(&index_path, "%s.idx", logfile) == -1) {
+        index_path = nullptr;
+    }
+    if (index_path == nullptr || !load_index(index_path)) {
+        if (build_index() && index_path != nullptr) {
+            save_index(index_path);
+        }
+    }
+    free(index_path);
+
+    setup_window();
+
+    return true;
+}
+
+/*
+  return true if the message type named name carries information
+  needed to interpret the rest of the log, so must be delivered even
+  when it lies before the start of the time window
+ */
+bool AP_LoggerFileReader::is_header_type(const char name[4])
+{
+    static const char *header_names[] { "FMT", "FMTU", "UNIT", "MULT", "PARM" };
+    for (const char *h : header_names) {
+        if (strncmp(name, h, 4) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  return the multiplier to convert the leading timestamp field of
+  messages of format f to microseconds, or 0 if there is none
+ */
+uint16_t AP_LoggerFileReader::time_scale_for_format(const struct log_Format &f)
+{
+    const char sep = f.labels[6];
+    if (sep != ',' && sep != 0) {
+        return 0;
+    }
+    if (f.format[0] == 'Q' && strncmp(f.labels, "TimeUS", 6) == 0) {
+        return 1;
+    }
+    if (f.format[0] == 'I' && strncmp(f.labels, "TimeMS", 6) == 0) {
+        return 1000;
+    }
+    return 0;
+}
+
+bool AP_LoggerFileReader::message_time(const uint8_t *msg, uint64_t &time_us) const
+{
+    const uint16_t scale = time_scale[msg[2]];
+    if (scale == 0) {
+        return false;
+    }
+    if (scale == 1) {
+        memcpy(&time_us, &msg[3], sizeof(time_us));
+        return true;
+    }
+    uint32_t t;
+    memcpy(&t, &msg[3], sizeof(t));
+    time_us = uint64_t(t) * scale;
+    return true;
+}
+
+/*
+  return the length of the message at ofs in the mapped log, or 0 if
+  it is corrupt or truncated. length and scale hold the message
+  lengths and time scales of the formats seen so far
+ */
+size_t AP_LoggerFileReader::index_message(size_t ofs, uint8_t length[256], uint16_t scale[256])
+{
+    if (ofs + 3 > map_size) {
+        return 0;
+    }
+    const uint8_t *msg = &map[ofs];
+    if (msg[0] != HEAD_BYTE1 || msg[1] != HEAD_BYTE2) {
+        return 0;
+    }
+    const uint8_t type = msg[2];
+    if (type == LOG_FORMAT_MSG) {
+        if (ofs + sizeof(struct log_Format) > map_size) {
+            return 0;
+        }
+        struct log_Format f;
+        memcpy(&f, msg, sizeof(f));
+        length[f.type] = f.length;
+        scale[f.type] = time_scale_for_format(f);
+        memcpy(index.name[f.type], f.name, sizeof(index.name[f.type]));
+        memcpy(index.name[LOG_FORMAT_MSG], "FMT", 4);
+    }
+    const uint8_t len = (type == LOG_FORMAT_MSG) ? sizeof(struct log_Format) : length[type];
+    if (len < 3 || ofs + len > map_size) {
+        return 0;
+    }
+    return len;
+}
+
+// allocate the offset table for the per-type counts in the index
+void AP_LoggerFileReader::index_offsets_setup()
+{
+    index.num_offsets = 0;
+    for (uint16_t t=0; t<256; t++) {
+        index.first[t] = index.num_offsets;
+        index.num_offsets += index.count[t];
+    }
+    free(index.offsets);
+    index.offsets = (uint64_t *)malloc(index.num_offsets * sizeof(index.offsets[0]) + 1);
+}
+
+/*
+  walk the mapped log recording the offset of every message and a
+  timestamp checkpoint every LOGREADER_INDEX_INTERVAL bytes. The
+  first pass counts messages of each type, the second fills in their
+  offsets. Stops at the first corrupt or truncated message
+ */
+bool AP_LoggerFileReader::build_index()
+{
+    uint8_t length[256] {};
+    uint16_t scale[256] {};
+    uint64_t time_us = 0;
+    uint32_t max_checkpoints = 0;
+    size_t next_checkpoint = 0;
+    size_t ofs = 0;
+    size_t len;
+
+    memset(index.count, 0, sizeof(index.count));
+    index.num_checkpoints = 0;
+
+    while ((len = index_message(ofs, length, scale)) != 0) {
+        const uint8_t *msg = &map[ofs];
+        const uint8_t type = msg[2];
+
+        if (ofs >= next_checkpoint) {
+            if (index.num_checkpoints == max_checkpoints) {
+                max_checkpoints = max_checkpoints ? max_checkpoints * 2 : 64;
+                void *p = realloc(index.checkpoints, max_checkpoints * sizeof(index.checkpoints[0]));
+                if (p == nullptr) {
+                    return false;
+                }
+                index.checkpoints = (struct index_checkpoint *)p;
+            }
+            index.checkpoints[index.num_checkpoints++] = { ofs, time_us };
+            next_checkpoint = ofs + LOGREADER_INDEX_INTERVAL;
+        }
+
+        index.count[type]++;
+
+        if (scale[type] == 1) {
+            memcpy(&time_us, &msg[3], sizeof(time_us));
+        } else if (scale[type] != 0) {
+            uint32_t t;
+            memcpy(&t, &msg[3], sizeof(t));
+            time_us = uint64_t(t) * scale[type];
+        }
+
+        ofs += len;
+    }
+
+    index_offsets_setup();
+    if (index.offsets == nullptr) {
+        return false;
+    }
+    uint64_t fill[256];
+    memcpy(fill, index.first, sizeof(fill));
+    memset(length, 0, sizeof(length));
+    ofs = 0;
+    while ((len = index_message(ofs, length, scale)) != 0) {
+        index.offsets[fill[map[ofs+2]]++] = ofs;
+        ofs += len;
+    }
+
     return true;
 }
 
+// load a cached index, returning false if it is missing or stale
+bool AP_LoggerFileReader::load_index(const char *path)
+{
+    const int ifd = ::open(path, O_RDONLY|O_CLOEXEC);
+    if (ifd == -1) {
+        return false;
+    }
+    struct index_header hdr;
+    bool ok = ::read(ifd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+        memcmp(hdr.magic, "APLI", 4) == 0 &&
+        hdr.version == LOGREADER_INDEX_VERSION &&
+        hdr.log_size == map_size &&
+        hdr.log_mtime == log_mtime;
+    if (ok) {
+        const size_t cp_size = hdr.num_checkpoints * sizeof(index.checkpoints[0]);
+        index.checkpoints = (struct index_checkpoint *)malloc(cp_size + 1);
+        ok = index.checkpoints != nullptr &&
+            ::read(ifd, index.count, sizeof(index.count)) == sizeof(index.count) &&
+            ::read(ifd, index.name, sizeof(index.name)) == sizeof(index.name) &&
+            ::read(ifd, index.checkpoints, cp_size) == ssize_t(cp_size);
+        index.num_checkpoints = ok ? hdr.num_checkpoints : 0;
+    }
+    if (ok) {
+        index_offsets_setup();
+        const ssize_t ofs_size = index.num_offsets * sizeof(index.offsets[0]);
+        ok = index.offsets != nullptr &&
+            ::read(ifd, index.offsets, ofs_size) == ofs_size;
+    }
+    ::close(ifd);
+    return ok;
+}
+
+// cache the index next to the log; failure only costs a rebuild next time
+void AP_LoggerFileReader::save_index(const char *path) const
+{
+    const int ifd = ::open(path, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+    if (ifd == -1) {
+        return;
+    }
+    struct index_header hdr;
+    memcpy(hdr.magic, "APLI", 4);
+    hdr.version = LOGREADER_INDEX_VERSION;
+    hdr.log_size = map_size;
+    hdr.log_mtime = log_mtime;
+    hdr.num_checkpoints = index.num_checkpoints;
+    const size_t cp_size = index.num_checkpoints * sizeof(index.checkpoints[0]);
+    const ssize_t ofs_size = index.num_offsets * sizeof(index.offsets[0]);
+    const bool ok = ::write(ifd, &hdr, sizeof(hdr)) == sizeof(hdr) &&
+        ::write(ifd, index.count, sizeof(index.count)) == sizeof(index.count) &&
+        ::write(ifd, index.name, sizeof(index.name)) == sizeof(index.name) &&
+        ::write(ifd, index.checkpoints, cp_size) == ssize_t(cp_size) &&
+        ::write(ifd, index.offsets, ofs_size) == ofs_size;
+    ::close(ifd);
+    if (!ok) {
+        ::unlink(path);
+    }
+}
+
+/*
+  work out where we can jump to for the start of the time window: the
+  last checkpoint before the window start. The header messages before
+  that point, including parameter changes part way through the log,
+  are delivered from the index before jumping
+ */
+void AP_LoggerFileReader::setup_window()
+{
+    if (window_start_us == 0 || index.offsets == nullptr) {
+        return;
+    }
+    seek_offset = 0;
+    for (uint32_t i=0; i<index.num_checkpoints; i++) {
+        if (index.checkpoints[i].time_us >= window_start_us) {
+            break;
+        }
+        seek_offset = index.checkpoints[i].offset;
+    }
+    if (seek_offset == 0) {
+        return;
+    }
+
+    uint64_t count = 0;
+    for (uint16_t t=0; t<256; t++) {
+        if (index.count[t] != 0 && is_header_type(index.name[t])) {
+            count += index.count[t];
+        }
+    }
+    header_offsets = (uint64_t *)malloc(count * sizeof(header_offsets[0]) + 1);
+    if (header_offsets == nullptr) {
+        seek_offset = 0;
+        return;
+    }
+    num_header_offsets = 0;
+    for (uint16_t t=0; t<256; t++) {
+        if (index.count[t] == 0 || !is_header_type(index.name[t])) {
+            continue;
+        }
+        for (uint64_t i=0; i<index.count[t]; i++) {
+            const uint64_t ofs = index.offsets[index.first[t]+i];
+            if (ofs >= seek_offset) {
+                break;
+            }
+            header_offsets[num_header_offsets++] = ofs;
+        }
+    }
+    std::sort(&header_offsets[0], &header_offsets[num_header_offsets]);
+}
+
 ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
 {
     uint64_t ret = ::read(fd, buffer, count);
@@ -63,49 +379,145 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
 
 bool AP_LoggerFileReader::update(char type[5])
 {
-    uint8_t hdr[3];
-    if (read_input(hdr, 3) != 3) {
-        return false;
-    }
-    if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
-        printf("bad log header\n");
-        return false;
+    if (map == nullptr) {
+        return update_read(type);
     }
 
-    packet_counts[hdr[2]]++;
+    while (true) {
+        if (next_header < num_header_offsets) {
+            map_offset = header_offsets[next_header++];
+        } else if (seek_offset != 0) {
+            map_offset = seek_offset;
+            seek_offset = 0;
+        }
+        if (map_offset + 3 > map_size) {
+            return false;
+        }
+        const uint8_t *hdr = &map[map_offset];
+        if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+            printf("bad log header\n");
+            return false;
+        }
+
+        if (hdr[2] == LOG_FORMAT_MSG) {
+            if (map_offset + sizeof(struct log_Format) > map_size) {
+                return false;
+            }
+            struct log_Format f;
+            memcpy(&f, hdr, sizeof(f));
+            memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+            time_scale[f.type] = time_scale_for_format(f);
+            map_offset += sizeof(f);
+            bytes_read += sizeof(f);
+            packet_counts[LOG_FORMAT_MSG]++;
+            strncpy(type, "FMT", 3);
+            type[3] = 0;
 
-    if (hdr[2] == LOG_FORMAT_MSG) {
-        struct log_Format f;
-        memcpy(&f, hdr, 3);
-        if (read_input(&f.type, sizeof(f)-3) != sizeof(f)-3) {
+            message_count++;
+            return handle_log_format_msg(f);
+        }
+
+        const struct log_Format &f = formats[hdr[2]];
+        if (f.length == 0) {
+            // can't just throw these away as the format specifies the
+            // number of bytes in the message
+            ::printf("No format defined for type (%d)\n", hdr[2]);
+            exit(1);
+        }
+        if (map_offset + f.length > map_size) {
             return false;
         }
-        memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
-        strncpy(type, "FMT", 3);
-        type[3] = 0;
+        map_offset += f.length;
+        bytes_read += f.length;
+
+        uint64_t time_us;
+        if (message_time(hdr, time_us)) {
+            last_time_us = time_us;
+            if (window_end_us != 0 && time_us > window_end_us) {
+                return false;
+            }
+        }
+        if (!window_started) {
+            if (last_time_us >= window_start_us) {
+                window_started = true;
+            } else if (!is_header_type(f.name)) {
+                continue;
+            }
+        }
+
+        packet_counts[hdr[2]]++;
+        strncpy(type, f.name, 4);
+        type[4] = 0;
 
         message_count++;
-        return handle_log_format_msg(f);
+        return handle_msg(f, hdr);
     }
+}
 
-    const struct log_Format &f = formats[hdr[2]];
-    if (f.length == 0) {
-        // can't just throw these away as the format specifies the
-        // number of bytes in the message
-        ::printf("No format defined for type (%d)\n", hdr[2]);
-        exit(1);
-    }
+// read()-based fallback for when the log can't be mapped
+bool AP_LoggerFileReader::update_read(char type[5])
+{
+    while (true) {
+        uint8_t hdr[3];
+        if (read_input(hdr, 3) != 3) {
+            return false;
+        }
+        if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+            printf("bad log header\n");
+            return false;
+        }
 
-    uint8_t msg[f.length];
+        if (hdr[2] == LOG_FORMAT_MSG) {
+            struct log_Format f;
+            memcpy(&f, hdr, 3);
+            if (read_input(&f.type, sizeof(f)-3) != sizeof(f)-3) {
+                return false;
+            }
+            memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
+            time_scale[f.type] = time_scale_for_format(f);
+            packet_counts[LOG_FORMAT_MSG]++;
+            strncpy(type, "FMT", 3);
+            type[3] = 0;
 
-    memcpy(msg, hdr, 3);
-    if (read_input(&msg[3], f.length-3) != f.length-3) {
-        return false;
-    }
+            message_count++;
+            return handle_log_format_msg(f);
+        }
+
+        const struct log_Format &f = formats[hdr[2]];
+        if (f.length == 0) {
+            // can't just throw these away as the format specifies the
+            // number of bytes in the message
+            ::printf("No format defined for type (%d)\n", hdr[2]);
+            exit(1);
+        }
+
+        uint8_t msg[f.length];
 
-    strncpy(type, f.name, 4);
-    type[4] = 0;
+        memcpy(msg, hdr, 3);
+        if (read_input(&msg[3], f.length-3) != f.length-3) {
+            return false;
+        }
+
+        uint64_t time_us;
+        if (message_time(msg, time_us)) {
+            last_time_us = time_us;
+            if (window_end_us != 0 && time_us > window_end_us) {
+                return false;
+            }
+        }
+        if (!window_started) {
+            if (last_time_us >= window_start_us) {
+                window_started = true;
+            } else if (!is_header_type(f.name)) {
+                continue;
+            }
+        }
+
+        packet_counts[hdr[2]]++;
+        strncpy(type, f.name, 4);
+        type[4] = 0;
 
-    message_count++;
-    return handle_msg(f,msg);
+        message_count++;
+        return handle_msg(f,msg);
+    }
 }
@@ -14,8 +14,15 @@ public:
     bool open_log(const char *logfile);
     bool update(char type[5]);
 
+    // only deliver messages timestamped from start_us up to end_us
+    // (0 for no limit); messages before start_us other than formats
+    // and parameters are skipped using the log index. Must be called
+    // before open_log()
+    void set_time_window(uint64_t start_us, uint64_t end_us);
+
     virtual bool handle_log_format_msg(const struct log_Format &f) = 0;
-    virtual bool handle_msg(const struct log_Format &f, uint8_t *msg) = 0;
+    // msg points into the read-only log mapping and must not be modified
+    virtual bool handle_msg(const struct log_Format &f, const uint8_t *msg) = 0;
 
     void format_type(uint16_t type, char dest[5]);
     void get_packet_counts(uint64_t dest[]);
@@ -27,10 +34,74 @@ protected:
 
 private:
     ssize_t read_input(void *buf, size_t count);
+    bool update_read(char type[5]);
 
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
     uint64_t start_micros;
 
     uint64_t packet_counts[LOGREADER_MAX_FORMATS] = {};
+
+    // the whole log is mapped read-only; nullptr if mmap failed and we
+    // fall back to read()
+    const uint8_t *map = nullptr;
+    size_t map_size = 0;
+    size_t map_offset = 0;
+
+    // timestamp scaling to microseconds for each message type, 0 if
+    // the type has no leading TimeUS/TimeMS field
+    uint16_t time_scale[256] {};
+    bool message_time(const uint8_t *msg, uint64_t &time_us) const;
+    static uint16_t time_scale_for_format(const struct log_Format &f);
+    static bool is_header_type(const char name[4]);
+
+    uint64_t window_start_us = 0;
+    uint64_t window_end_us = 0;
+    bool window_started = false;
+    uint64_t last_time_us = 0;
+    // offset we jump to for the start of the window, 0 for none
+    size_t seek_offset = 0;
+    // offsets of the header messages the jump skips over, in log
+    // order; they are delivered before jumping
+    uint64_t *header_offsets = nullptr;
+    uint32_t num_header_offsets = 0;
+    uint32_t next_header = 0;
+
+    /*
+      offset index, built on the first pass over a log and cached in
+      <logfile>.idx. It holds the offset of every message, grouped by
+      type, and a checkpoint every LOGREADER_INDEX_INTERVAL bytes at
+      the next message boundary with the latest timestamp seen before
+      it
+     */
+    struct PACKED index_header {
+        char magic[4];
+        uint16_t version;
+        uint64_t log_size;
+        int64_t log_mtime;
+        uint32_t num_checkpoints;
+    };
+    struct PACKED index_checkpoint {
+        uint64_t offset;
+        uint64_t time_us;
+    };
+    struct {
+        uint64_t count[256];
+        char name[256][4];
+        uint32_t num_checkpoints;
+        struct index_checkpoint *checkpoints;
+        // offsets of messages of type t, in log order, are
+        // offsets[first[t]] to offsets[first[t]+count[t]-1]
+        uint64_t first[256];
+        uint64_t num_offsets;
+        uint64_t *offsets;
+    } index {};
+    int64_t log_mtime = 0;
+
+    size_t index_message(size_t ofs, uint8_t length[256], uint16_t scale[256]);
+    void index_offsets_setup();
+    bool build_index();
+    bool load_index(const char *path);
+    void save_index(const char *path) const;
+    void setup_window();
 };
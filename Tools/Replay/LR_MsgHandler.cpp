@@ -25,7 +25,7 @@ void LR_MsgHandler::wait_timestamp(uint32_t timestamp)
     wait_timestamp_usec(usecs);
 }
 
-void LR_MsgHandler::wait_timestamp_from_msg(uint8_t *msg)
+void LR_MsgHandler::wait_timestamp_from_msg(const uint8_t *msg)
 {
     uint64_t time_us;
     uint32_t time_ms;
@@ -48,14 +48,14 @@ void LR_MsgHandler::wait_timestamp_from_msg(uint8_t *msg)
  * subclasses to handle specific messages below here
 */
 
-void LR_MsgHandler_AHR2::process_message(uint8_t *msg)
+void LR_MsgHandler_AHR2::process_message(const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
     attitude_from_msg(msg, ahr2_attitude, "Roll", "Pitch", "Yaw");
 }
 
 
-void LR_MsgHandler_ARM::process_message(uint8_t *msg)
+void LR_MsgHandler_ARM::process_message(const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
     uint8_t ArmState = require_field_uint8_t(msg, "ArmState");
@@ -66,7 +66,7 @@ void LR_MsgHandler_ARM::process_message(uint8_t *msg)
 }
 
 
-void LR_MsgHandler_ARSP::process_message(uint8_t *msg)
+void LR_MsgHandler_ARSP::process_message(const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
 
@@ -75,19 +75,19 @@ void LR_MsgHandler_ARSP::process_message(uint8_t *msg)
 		    require_field_float(msg, "Temp"));
 }
 
-void LR_MsgHandler_NKF1::process_message(uint8_t *msg)
+void LR_MsgHandler_NKF1::process_message(const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
 }
 
 
-void LR_MsgHandler_ATT::process_message(uint8_t *msg)
+void LR_MsgHandler_ATT::process_message(const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
     attitude_from_msg(msg, attitude, "Roll", "Pitch", "Yaw");
 }
 
-void LR_MsgHandler_CHEK::process_message(uint8_t *msg)
+void LR_MsgHandler_CHEK::process_message(const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
     check_state.time_us = AP_HAL::micros64();
@@ -100,7 +100,7 @@ void LR_MsgHandler_CHEK::process_message(uint8_t *msg)
 }
 
 
-void LR_MsgHandler_BARO::process_message(uint8_t *msg)
+void LR_MsgHandler_BARO::process_message(const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
     uint32_t last_update_ms;
@@ -116,7 +116,7 @@ void LR_MsgHandler_BARO::process_message(uint8_t *msg)
 }
 
 
-void LR_MsgHandler_Event::process_message(uint8_t *msg)
+void LR_MsgHandler_Event::process_message(const uint8_t *msg)
 {
     uint8_t id = require_field_uint8_t(msg, "Id");
     if ((LogEvent)id == LogEvent::ARMED) {
@@ -131,12 +131,12 @@ void LR_MsgHandler_Event::process_message(uint8_t *msg)
 }
 
 
-void LR_MsgHandler_GPS2::process_message(uint8_t *msg)
+void LR_MsgHandler_GPS2::process_message(const uint8_t *msg)
 {
     update_from_msg_gps(1, msg);
 }
 
-void LR_MsgHandler_GPS_Base::update_from_msg_gps(uint8_t gps_offset, uint8_t *msg)
+void LR_MsgHandler_GPS_Base::update_from_msg_gps(uint8_t gps_offset, const uint8_t *msg)
 {
     uint64_t time_us;
     if (! field_value(msg, "TimeUS", time_us)) {
@@ -184,13 +184,13 @@ void LR_MsgHandler_GPS_Base::update_from_msg_gps(uint8_t gps_offset, uint8_t *ms
 
 
 
-void LR_MsgHandler_GPS::process_message(uint8_t *msg)
+void LR_MsgHandler_GPS::process_message(const uint8_t *msg)
 {
     update_from_msg_gps(0, msg);
 }
 
 
-void LR_MsgHandler_GPA_Base::update_from_msg_gpa(uint8_t gps_offset, uint8_t *msg)
+void LR_MsgHandler_GPA_Base::update_from_msg_gpa(uint8_t gps_offset, const uint8_t *msg)
 {
     uint64_t time_us;
     require_field(msg, "TimeUS", time_us);
@@ -213,32 +213,32 @@ void LR_MsgHandler_GPA_Base::update_from_msg_gpa(uint8_t gps_offset, uint8_t *ms
     gps.setHIL_Accuracy(gps_offset, vdop*0.01f, hacc*0.01f, vacc*0.01f, sacc*0.01f, have_vertical_velocity, sample_ms);
 }
 
-void LR_MsgHandler_GPA::process_message(uint8_t *msg)
+void LR_MsgHandler_GPA::process_message(const uint8_t *msg)
 {
     update_from_msg_gpa(0, msg);
 }
 
 
-void LR_MsgHandler_GPA2::process_message(uint8_t *msg)
+void LR_MsgHandler_GPA2::process_message(const uint8_t *msg)
 {
     update_from_msg_gpa(1, msg);
 }
 
 
 
-void LR_MsgHandler_IMU2::process_message(uint8_t *msg)
+void LR_MsgHandler_IMU2::process_message(const uint8_t *msg)
 {
   update_from_msg_imu(1, msg);
 }
 
 
-void LR_MsgHandler_IMU3::process_message(uint8_t *msg)
+void LR_MsgHandler_IMU3::process_message(const uint8_t *msg)
 {
   update_from_msg_imu(2, msg);
 }
 
 
-void LR_MsgHandler_IMU_Base::update_from_msg_imu(uint8_t imu_offset, uint8_t *msg)
+void LR_MsgHandler_IMU_Base::update_from_msg_imu(uint8_t imu_offset, const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
 
@@ -257,12 +257,12 @@ void LR_MsgHandler_IMU_Base::update_from_msg_imu(uint8_t imu_offset, uint8_t *ms
 }
 
 
-void LR_MsgHandler_IMU::process_message(uint8_t *msg)
+void LR_MsgHandler_IMU::process_message(const uint8_t *msg)
 {
     update_from_msg_imu(0, msg);
 }
 
-void LR_MsgHandler_IMT_Base::update_from_msg_imt(uint8_t imu_offset, uint8_t *msg)
+void LR_MsgHandler_IMT_Base::update_from_msg_imt(uint8_t imu_offset, const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
 
@@ -294,28 +294,28 @@ void LR_MsgHandler_IMT_Base::update_from_msg_imt(uint8_t imu_offset, uint8_t *ms
     }
 }
 
-void LR_MsgHandler_IMT::process_message(uint8_t *msg)
+void LR_MsgHandler_IMT::process_message(const uint8_t *msg)
 {
   update_from_msg_imt(0, msg);
 }
 
-void LR_MsgHandler_IMT2::process_message(uint8_t *msg)
+void LR_MsgHandler_IMT2::process_message(const uint8_t *msg)
 {
   update_from_msg_imt(1, msg);
 }
 
-void LR_MsgHandler_IMT3::process_message(uint8_t *msg)
+void LR_MsgHandler_IMT3::process_message(const uint8_t *msg)
 {
   update_from_msg_imt(2, msg);
 }
 
-void LR_MsgHandler_MAG2::process_message(uint8_t *msg)
+void LR_MsgHandler_MAG2::process_message(const uint8_t *msg)
 {
     update_from_msg_compass(1, msg);
 }
 
 
-void LR_MsgHandler_MAG_Base::update_from_msg_compass(uint8_t compass_offset, uint8_t *msg)
+void LR_MsgHandler_MAG_Base::update_from_msg_compass(uint8_t compass_offset, const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
 
@@ -336,7 +336,7 @@ void LR_MsgHandler_MAG_Base::update_from_msg_compass(uint8_t compass_offset, uin
 
 
 
-void LR_MsgHandler_MAG::process_message(uint8_t *msg)
+void LR_MsgHandler_MAG::process_message(const uint8_t *msg)
 {
     update_from_msg_compass(0, msg);
 }
@@ -344,7 +344,7 @@ void LR_MsgHandler_MAG::process_message(uint8_t *msg)
 #include <AP_AHRS/AP_AHRS.h>
 #include "VehicleType.h"
 
-void LR_MsgHandler_MSG::process_message(uint8_t *msg)
+void LR_MsgHandler_MSG::process_message(const uint8_t *msg)
 {
     const uint8_t msg_text_len = 64;
     char msg_text[msg_text_len];
@@ -370,7 +370,7 @@ void LR_MsgHandler_MSG::process_message(uint8_t *msg)
 }
 
 
-void LR_MsgHandler_NTUN_Copter::process_message(uint8_t *msg)
+void LR_MsgHandler_NTUN_Copter::process_message(const uint8_t *msg)
 {
     inavpos = Vector3f(require_field_float(msg, "PosX") * 0.01f,
 		       require_field_float(msg, "PosY") * 0.01f,
@@ -394,7 +394,7 @@ bool LR_MsgHandler_PARM::set_parameter(const char *name, const float value)
     return _set_parameter_callback(name, value);
 }
 
-void LR_MsgHandler_PARM::process_message(uint8_t *msg)
+void LR_MsgHandler_PARM::process_message(const uint8_t *msg)
 {
     const uint8_t parameter_name_len = AP_MAX_NAME_SIZE + 1; // null-term
     char parameter_name[parameter_name_len];
@@ -421,7 +421,7 @@ void LR_MsgHandler_PARM::process_message(uint8_t *msg)
     }
 }
 
-void LR_MsgHandler_PM::process_message(uint8_t *msg)
+void LR_MsgHandler_PM::process_message(const uint8_t *msg)
 {
     uint32_t new_logdrop;
     if (field_value(msg, "LogDrop", new_logdrop) &&
@@ -430,7 +430,7 @@ void LR_MsgHandler_PM::process_message(uint8_t *msg)
     }
 }
 
-void LR_MsgHandler_SIM::process_message(uint8_t *msg)
+void LR_MsgHandler_SIM::process_message(const uint8_t *msg)
 {
     wait_timestamp_from_msg(msg);
     attitude_from_msg(msg, sim_attitude, "Roll", "Pitch", "Yaw");
@@ -11,7 +11,7 @@ public:
     LR_MsgHandler(struct log_Format &f,
                   AP_Logger &_logger,
                   uint64_t &last_timestamp_usec);
-    virtual void process_message(uint8_t *msg) = 0;
+    virtual void process_message(const uint8_t *msg) = 0;
 
     // state for CHEK message
     struct CheckState {
@@ -25,7 +25,7 @@ protected:
     AP_Logger &logger;
     void wait_timestamp(uint32_t timestamp);
     void wait_timestamp_usec(uint64_t timestamp);
-    void wait_timestamp_from_msg(uint8_t *msg);
+    void wait_timestamp_from_msg(const uint8_t *msg);
 
     uint64_t &last_timestamp_usec;
 
@@ -41,7 +41,7 @@ public:
         : LR_MsgHandler(_f, _logger,_last_timestamp_usec),
           ahr2_attitude(_ahr2_attitude) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     Vector3f &ahr2_attitude;
@@ -55,7 +55,7 @@ public:
                    uint64_t &_last_timestamp_usec)
         : LR_MsgHandler(_f, _logger, _last_timestamp_usec) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 
@@ -66,7 +66,7 @@ public:
 		    uint64_t &_last_timestamp_usec, AP_Airspeed &_airspeed) :
 	LR_MsgHandler(_f, _logger, _last_timestamp_usec), airspeed(_airspeed) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     AP_Airspeed &airspeed;
@@ -79,7 +79,7 @@ public:
 		    uint64_t &_last_timestamp_usec) :
 	LR_MsgHandler(_f, _logger, _last_timestamp_usec) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 
@@ -90,7 +90,7 @@ public:
                    uint64_t &_last_timestamp_usec, Vector3f &_attitude)
         : LR_MsgHandler(_f, _logger, _last_timestamp_usec), attitude(_attitude)
         { };
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     Vector3f &attitude;
@@ -105,7 +105,7 @@ public:
         : LR_MsgHandler(_f, _logger, _last_timestamp_usec), 
           check_state(_check_state)
         { };
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     CheckState &check_state;
@@ -119,7 +119,7 @@ public:
         : LR_MsgHandler(_f, _logger, _last_timestamp_usec)
         { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 };
 
@@ -131,7 +131,7 @@ public:
                    uint64_t &_last_timestamp_usec)
         : LR_MsgHandler(_f, _logger, _last_timestamp_usec) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 
@@ -148,7 +148,7 @@ public:
           gps(_gps), ground_alt_cm(_ground_alt_cm) { };
 
 protected:
-    void update_from_msg_gps(uint8_t imu_offset, uint8_t *data);
+    void update_from_msg_gps(uint8_t imu_offset, const uint8_t *data);
 
 private:
     AP_GPS &gps;
@@ -165,7 +165,7 @@ public:
                               _gps, _ground_alt_cm),
         gps(_gps), ground_alt_cm(_ground_alt_cm) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     AP_GPS &gps;
@@ -185,7 +185,7 @@ public:
         : LR_MsgHandler_GPS_Base(_f, _logger, _last_timestamp_usec,
                                  _gps, _ground_alt_cm), gps(_gps),
         ground_alt_cm(_ground_alt_cm) { };
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 private:
     AP_GPS &gps;
     uint32_t &ground_alt_cm;
@@ -200,7 +200,7 @@ public:
         : LR_MsgHandler(_f, _logger, _last_timestamp_usec), gps(_gps) { };
 
 protected:
-    void update_from_msg_gpa(uint8_t imu_offset, uint8_t *data);
+    void update_from_msg_gpa(uint8_t imu_offset, const uint8_t *data);
 
 private:
     AP_GPS &gps;
@@ -215,7 +215,7 @@ public:
         : LR_MsgHandler_GPA_Base(_f, _logger,_last_timestamp_usec,
                               _gps), gps(_gps) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     AP_GPS &gps;
@@ -228,7 +228,7 @@ public:
                        uint64_t &_last_timestamp_usec, AP_GPS &_gps)
         : LR_MsgHandler_GPA_Base(_f, _logger, _last_timestamp_usec,
                                  _gps), gps(_gps) { };
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 private:
     AP_GPS &gps;
 };
@@ -248,7 +248,7 @@ public:
         accel_mask(_accel_mask),
         gyro_mask(_gyro_mask),
         ins(_ins) { };
-    void update_from_msg_imu(uint8_t imu_offset, uint8_t *msg);
+    void update_from_msg_imu(uint8_t imu_offset, const uint8_t *msg);
 
 private:
     uint8_t &accel_mask;
@@ -266,7 +266,7 @@ public:
         : LR_MsgHandler_IMU_Base(_f, _logger, _last_timestamp_usec,
                               _accel_mask, _gyro_mask, _ins) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 class LR_MsgHandler_IMU2 : public LR_MsgHandler_IMU_Base
@@ -279,7 +279,7 @@ public:
         : LR_MsgHandler_IMU_Base(_f, _logger, _last_timestamp_usec,
                               _accel_mask, _gyro_mask, _ins) {};
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 class LR_MsgHandler_IMU3 : public LR_MsgHandler_IMU_Base
@@ -292,7 +292,7 @@ public:
         : LR_MsgHandler_IMU_Base(_f, _logger, _last_timestamp_usec,
                               _accel_mask, _gyro_mask, _ins) {};
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 
@@ -309,7 +309,7 @@ public:
         gyro_mask(_gyro_mask),
         use_imt(_use_imt),
         ins(_ins) { };
-    void update_from_msg_imt(uint8_t imu_offset, uint8_t *msg);
+    void update_from_msg_imt(uint8_t imu_offset, const uint8_t *msg);
 
 private:
     uint8_t &accel_mask;
@@ -329,7 +329,7 @@ public:
         : LR_MsgHandler_IMT_Base(_f, _logger, _last_timestamp_usec,
                                  _accel_mask, _gyro_mask, _use_imt, _ins) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 class LR_MsgHandler_IMT2 : public LR_MsgHandler_IMT_Base
@@ -343,7 +343,7 @@ public:
         : LR_MsgHandler_IMT_Base(_f, _logger, _last_timestamp_usec,
                                  _accel_mask, _gyro_mask, _use_imt, _ins) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 class LR_MsgHandler_IMT3 : public LR_MsgHandler_IMT_Base
@@ -357,7 +357,7 @@ public:
         : LR_MsgHandler_IMT_Base(_f, _logger, _last_timestamp_usec,
                                  _accel_mask, _gyro_mask, _use_imt, _ins) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 
@@ -369,7 +369,7 @@ public:
 	: LR_MsgHandler(_f, _logger, _last_timestamp_usec), compass(_compass) { };
 
 protected:
-    void update_from_msg_compass(uint8_t compass_offset, uint8_t *msg);
+    void update_from_msg_compass(uint8_t compass_offset, const uint8_t *msg);
 
 private:
     Compass &compass;
@@ -382,7 +382,7 @@ public:
                    uint64_t &_last_timestamp_usec, Compass &_compass)
         : LR_MsgHandler_MAG_Base(_f, _logger, _last_timestamp_usec,_compass) {};
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 class LR_MsgHandler_MAG2 : public LR_MsgHandler_MAG_Base
@@ -392,7 +392,7 @@ public:
                     uint64_t &_last_timestamp_usec, Compass &_compass)
         : LR_MsgHandler_MAG_Base(_f, _logger, _last_timestamp_usec,_compass) {};
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 };
 
 
@@ -407,7 +407,7 @@ public:
         vehicle(_vehicle), ahrs(_ahrs) { }
 
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     VehicleType::vehicle_type &vehicle;
@@ -422,7 +422,7 @@ public:
 			   uint64_t &_last_timestamp_usec, Vector3f &_inavpos)
 	: LR_MsgHandler(_f, _logger, _last_timestamp_usec), inavpos(_inavpos) {};
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     Vector3f &inavpos;
@@ -439,7 +439,7 @@ public:
         _set_parameter_callback(set_parameter_callback)
         {};
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     bool set_parameter(const char *name, const float value);
@@ -453,7 +453,7 @@ public:
                      uint64_t &_last_timestamp_usec)
         : LR_MsgHandler(_f, _logger, _last_timestamp_usec) { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
 
@@ -469,7 +469,7 @@ public:
           sim_attitude(_sim_attitude)
         { };
 
-    void process_message(uint8_t *msg) override;
+    void process_message(const uint8_t *msg) override;
 
 private:
     Vector3f &sim_attitude;
@@ -112,7 +112,7 @@ void MsgHandler::parse_format_fields()
     free(labels);
 }
 
-bool MsgHandler::field_value(uint8_t *msg, const char *label, char *ret, uint8_t retlen)
+bool MsgHandler::field_value(const uint8_t *msg, const char *label, char *ret, uint8_t retlen)
 {
     struct format_field_info *info = find_field_info(label);
     if (info == NULL) {
@@ -133,7 +133,7 @@ bool MsgHandler::field_value(uint8_t *msg, const char *label, char *ret, uint8_t
 }
 
 
-bool MsgHandler::field_value(uint8_t *msg, const char *label, Vector3f &ret)
+bool MsgHandler::field_value(const uint8_t *msg, const char *label, Vector3f &ret)
 {
     const char *axes = "XYZ";
     uint8_t i;
@@ -196,7 +196,7 @@ MsgHandler::~MsgHandler()
     }
 }
 
-void MsgHandler::location_from_msg(uint8_t *msg,
+void MsgHandler::location_from_msg(const uint8_t *msg,
                                   Location &loc,
                                   const char *label_lat,
                                   const char *label_long,
@@ -207,7 +207,7 @@ void MsgHandler::location_from_msg(uint8_t *msg,
     loc.set_alt_cm(require_field_int32_t(msg, label_alt), Location::AltFrame::ABSOLUTE);
 }
 
-void MsgHandler::ground_vel_from_msg(uint8_t *msg,
+void MsgHandler::ground_vel_from_msg(const uint8_t *msg,
                                     Vector3f &vel,
                                     const char *label_speed,
                                     const char *label_course,
@@ -232,7 +232,7 @@ void MsgHandler::ground_vel_from_msg(uint8_t *msg,
     vel[2] = require_field_float(msg, label_vz);
 }
 
-void MsgHandler::attitude_from_msg(uint8_t *msg,
+void MsgHandler::attitude_from_msg(const uint8_t *msg,
 				   Vector3f &att,
 				   const char *label_roll,
 				   const char *label_pitch,
@@ -243,7 +243,7 @@ void MsgHandler::attitude_from_msg(uint8_t *msg,
     att[2] = require_field_uint16_t(msg, label_yaw) * 0.01f;
 }
 
-void MsgHandler::field_not_found(uint8_t *msg, const char *label)
+void MsgHandler::field_not_found(const uint8_t *msg, const char *label)
 {
     char all_labels[256];
     uint8_t type = msg[2];
@@ -253,38 +253,38 @@ void MsgHandler::field_not_found(uint8_t *msg, const char *label)
     abort();
 }
 
-void MsgHandler::require_field(uint8_t *msg, const char *label, char *buffer, uint8_t bufferlen)
+void MsgHandler::require_field(const uint8_t *msg, const char *label, char *buffer, uint8_t bufferlen)
 {
     if (! field_value(msg, label, buffer, bufferlen)) {
         field_not_found(msg,label);
     }
 }
 
-float MsgHandler::require_field_float(uint8_t *msg, const char *label)
+float MsgHandler::require_field_float(const uint8_t *msg, const char *label)
 {
     float ret;
     require_field(msg, label, ret);
     return ret;
 }
-uint8_t MsgHandler::require_field_uint8_t(uint8_t *msg, const char *label)
+uint8_t MsgHandler::require_field_uint8_t(const uint8_t *msg, const char *label)
 {
     uint8_t ret;
     require_field(msg, label, ret);
     return ret;
 }
-int32_t MsgHandler::require_field_int32_t(uint8_t *msg, const char *label)
+int32_t MsgHandler::require_field_int32_t(const uint8_t *msg, const char *label)
 {
     int32_t ret;
     require_field(msg, label, ret);
     return ret;
 }
-uint16_t MsgHandler::require_field_uint16_t(uint8_t *msg, const char *label)
+uint16_t MsgHandler::require_field_uint16_t(const uint8_t *msg, const char *label)
 {
     uint16_t ret;
     require_field(msg, label, ret);
     return ret;
 }
-int16_t MsgHandler::require_field_int16_t(uint8_t *msg, const char *label)
+int16_t MsgHandler::require_field_int16_t(const uint8_t *msg, const char *label)
 {
     int16_t ret;
     require_field(msg, label, ret);
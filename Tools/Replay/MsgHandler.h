@@ -20,25 +20,25 @@ public:
     // field_value - retrieve the value of a field from the supplied message
     // these return false if the field was not found
     template<typename R>
-    bool field_value(uint8_t *msg, const char *label, R &ret);
+    bool field_value(const uint8_t *msg, const char *label, R &ret);
 
-    bool field_value(uint8_t *msg, const char *label, Vector3f &ret);
-    bool field_value(uint8_t *msg, const char *label,
+    bool field_value(const uint8_t *msg, const char *label, Vector3f &ret);
+    bool field_value(const uint8_t *msg, const char *label,
 		     char *buffer, uint8_t bufferlen);
     
     template <typename R>
-    void require_field(uint8_t *msg, const char *label, R &ret)
+    void require_field(const uint8_t *msg, const char *label, R &ret)
         {   
             if (! field_value(msg, label, ret)) {
                 field_not_found(msg, label);
             }
         }
-    void require_field(uint8_t *msg, const char *label, char *buffer, uint8_t bufferlen);
-    float require_field_float(uint8_t *msg, const char *label);
-    uint8_t require_field_uint8_t(uint8_t *msg, const char *label);
-    int32_t require_field_int32_t(uint8_t *msg, const char *label);
-    uint16_t require_field_uint16_t(uint8_t *msg, const char *label);
-    int16_t require_field_int16_t(uint8_t *msg, const char *label);
+    void require_field(const uint8_t *msg, const char *label, char *buffer, uint8_t bufferlen);
+    float require_field_float(const uint8_t *msg, const char *label);
+    uint8_t require_field_uint8_t(const uint8_t *msg, const char *label);
+    int32_t require_field_int32_t(const uint8_t *msg, const char *label);
+    uint16_t require_field_uint16_t(const uint8_t *msg, const char *label);
+    int16_t require_field_int16_t(const uint8_t *msg, const char *label);
 
 private:
 
@@ -46,7 +46,7 @@ private:
                    uint8_t length);
 
     template<typename R>
-    void field_value_for_type_at_offset(uint8_t *msg, uint8_t type,
+    void field_value_for_type_at_offset(const uint8_t *msg, uint8_t type,
                                         uint8_t offset, R &ret);
 
     struct format_field_info { // parsed field information
@@ -71,25 +71,25 @@ protected:
     struct log_Format f; // the format we are a parser for
     ~MsgHandler();
 
-    void location_from_msg(uint8_t *msg, Location &loc, const char *label_lat,
+    void location_from_msg(const uint8_t *msg, Location &loc, const char *label_lat,
 			   const char *label_long, const char *label_alt);
 
-    void ground_vel_from_msg(uint8_t *msg,
+    void ground_vel_from_msg(const uint8_t *msg,
 			     Vector3f &vel,
 			     const char *label_speed,
 			     const char *label_course,
 			     const char *label_vz);
 
-    void attitude_from_msg(uint8_t *msg,
+    void attitude_from_msg(const uint8_t *msg,
 			   Vector3f &att,
 			   const char *label_roll,
 			   const char *label_pitch,
 			   const char *label_yaw);
-    [[noreturn]] void field_not_found(uint8_t *msg, const char *label);
+    [[noreturn]] void field_not_found(const uint8_t *msg, const char *label);
 };
 
 template<typename R>
-bool MsgHandler::field_value(uint8_t *msg, const char *label, R &ret)
+bool MsgHandler::field_value(const uint8_t *msg, const char *label, R &ret)
 {
     struct format_field_info *info = find_field_info(label);
     if (info == NULL) {
@@ -108,7 +108,7 @@ bool MsgHandler::field_value(uint8_t *msg, const char *label, R &ret)
 
 
 template<typename R>
-inline void MsgHandler::field_value_for_type_at_offset(uint8_t *msg,
+inline void MsgHandler::field_value_for_type_at_offset(const uint8_t *msg,
                                                       uint8_t type,
                                                       uint8_t offset,
                                                       R &ret)
@@ -117,34 +117,34 @@ inline void MsgHandler::field_value_for_type_at_offset(uint8_t *msg,
      * this switch statement somehow? */
     switch (type) {
     case 'B':
-        ret = (R)(((uint8_t*)&msg[offset])[0]);
+        ret = (R)(((const uint8_t*)&msg[offset])[0]);
         break;
     case 'c':
     case 'h':
-        ret = (R)(((int16_t*)&msg[offset])[0]);
+        ret = (R)(((const int16_t*)&msg[offset])[0]);
         break;
     case 'H':
-        ret = (R)(((uint16_t*)&msg[offset])[0]);
+        ret = (R)(((const uint16_t*)&msg[offset])[0]);
         break;
     case 'C':
-        ret = (R)(((uint16_t*)&msg[offset])[0]);
+        ret = (R)(((const uint16_t*)&msg[offset])[0]);
         break;
     case 'f':
-        ret = (R)(((float*)&msg[offset])[0]);
+        ret = (R)(((const float*)&msg[offset])[0]);
         break;
     case 'I':
     case 'E':
-        ret = (R)(((uint32_t*)&msg[offset])[0]);
+        ret = (R)(((const uint32_t*)&msg[offset])[0]);
         break;
     case 'L':
     case 'e':
-        ret = (R)(((int32_t*)&msg[offset])[0]);
+        ret = (R)(((const int32_t*)&msg[offset])[0]);
         break;
     case 'q':
-        ret = (R)(((int64_t*)&msg[offset])[0]);
+        ret = (R)(((const int64_t*)&msg[offset])[0]);
         break;
     case 'Q':
-        ret = (R)(((uint64_t*)&msg[offset])[0]);
+        ret = (R)(((const uint64_t*)&msg[offset])[0]);
         break;
     default:
         ::printf("Unhandled format type (%c)\n", type);
@@ -153,6 +153,8 @@ void Replay::usage(void)
     ::printf("\t--no-params        don't use parameters from the log\n");
     ::printf("\t--no-fpe           do not generate floating point exceptions\n");
     ::printf("\t--packet-counts    print packet counts at end of processing\n");
+    ::printf("\t--start-time TIME  start replay at log time TIME (seconds)\n");
+    ::printf("\t--end-time TIME    stop replay at log time TIME (seconds)\n");
 }
 
 
@@ -169,6 +171,8 @@ enum {
     OPT_PARAM_FILE,
     OPT_NO_FPE,
     OPT_PACKET_COUNTS,
+    OPT_START_TIME,
+    OPT_END_TIME,
 };
 
 void Replay::flush_logger(void) {
@@ -226,6 +230,8 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"no-params",       false,  0, OPT_NOPARAMS},
         {"no-fpe",          false,  0, OPT_NO_FPE},
         {"packet-counts",   false,  0, OPT_PACKET_COUNTS},
+        {"start-time",      true,   0, OPT_START_TIME},
+        {"end-time",        true,   0, OPT_END_TIME},
         {0, false, 0, 0}
     };
 
@@ -313,6 +319,14 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             packet_counts = true;
             break;
 
+        case OPT_START_TIME:
+            start_time_us = atof(gopt.optarg) * 1.0e6;
+            break;
+
+        case OPT_END_TIME:
+            end_time_us = atof(gopt.optarg) * 1.0e6;
+            break;
+
         case 'h':
         default:
             usage();
@@ -332,7 +346,7 @@ class IMUCounter : public AP_LoggerFileReader {
 public:
     IMUCounter() {}
     bool handle_log_format_msg(const struct log_Format &f) override;
-    bool handle_msg(const struct log_Format &f, uint8_t *msg) override;
+    bool handle_msg(const struct log_Format &f, const uint8_t *msg) override;
 
     uint64_t last_clock_timestamp = 0;
     float last_parm_value = 0;
@@ -356,7 +370,7 @@ bool IMUCounter::handle_log_format_msg(const struct log_Format &f) {
     return true;
 };
 
-bool IMUCounter::handle_msg(const struct log_Format &f, uint8_t *msg) {
+bool IMUCounter::handle_msg(const struct log_Format &f, const uint8_t *msg) {
     if (strncmp(f.name,"PARM",4) == 0) {
         // gather parameter values to check for SCHED_LOOP_RATE
         parm_handler->field_value(msg, "Name", last_parm_name, sizeof(last_parm_name));
@@ -527,6 +541,7 @@ void Replay::setup()
 
     hal.console->printf("Using an update rate of %u Hz\n", log_info.update_rate);
 
+    logreader.set_time_window(start_time_us, end_time_us);
     if (!logreader.open_log(filename)) {
         perror(filename);
         exit(1);
@@ -149,6 +149,9 @@ private:
     uint32_t output_counter = 0;
     uint64_t last_timestamp = 0;
     bool packet_counts = false;
+    // replay window in log time, 0 for unlimited
+    uint64_t start_time_us = 0;
+    uint64_t end_time_us = 0;
 
     struct {
         float max_roll_error;
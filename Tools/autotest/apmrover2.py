@@ -5,6 +5,7 @@ from __future__ import print_function
 
 import copy
 import os
+import re
 import shutil
 import sys
 import time
@@ -4761,6 +4762,65 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
         self.test_scripting_hello_world()
         self.test_scripting_simple_loop()
 
+    def test_scripting_heap_soak(self, duration=2*3600, max_fragmentation=60):
+        '''run a script that churns the heap for hours of sim time,
+        checking the heap doesn't fragment until allocations fail'''
+        self.start_subtest("Scripting heap soak")
+        ex = None
+        example_script = "heap_soak.lua"
+        heap_stats = []
+        errors = []
+        def my_message_hook(mav, m):
+            if m.get_type() != 'STATUSTEXT':
+                return
+            if "Panic" in m.text or "memory" in m.text or "Error" in m.text:
+                errors.append(m.text)
+            match = re.match(r"Lua: heap used:(\d+) hwm:(\d+) maxfree:(\d+) frag:(\d+)%", m.text)
+            if match is not None:
+                heap_stats.append([int(x) for x in match.groups()])
+        self.context_push()
+        self.install_message_hook(my_message_hook)
+        try:
+            self.set_parameter("SCR_ENABLE", 1)
+            self.set_parameter("SCR_HEAP_SIZE", 131072)
+            self.set_parameter("SCR_OPTIONS", 2) # send heap statistics
+            self.install_example_script(example_script)
+            self.reboot_sitl()
+            self.set_parameter("SIM_SPEEDUP", 100)
+            tstart = self.get_sim_time()
+            last_progress = tstart
+            while True:
+                now = self.get_sim_time_cached()
+                if now - tstart > duration:
+                    break
+                if len(errors):
+                    break
+                if now - last_progress > 600:
+                    last_progress = now
+                    if len(heap_stats):
+                        self.progress("Heap after %us: used=%u hwm=%u maxfree=%u frag=%u%%" %
+                                      ((now - tstart,) + tuple(heap_stats[-1])))
+                self.mav.recv_match(type='STATUSTEXT', blocking=True, timeout=1)
+        except Exception as e:
+            ex = e
+        self.remove_message_hook(my_message_hook)
+        self.context_pop()
+        self.remove_example_script(example_script)
+        self.reboot_sitl()
+
+        if ex is not None:
+            raise ex
+
+        if len(errors):
+            raise NotAchievedException("Scripting failed: %s" % errors[0])
+        if len(heap_stats) < duration / 2:
+            raise NotAchievedException("Expected heap statistics every second, got %u" % len(heap_stats))
+        # ignore the start up, while the live set fills
+        worst = max([frag for (used, hwm, maxfree, frag) in heap_stats[60:]])
+        self.progress("Worst fragmentation %u%%" % worst)
+        if worst > max_fragmentation:
+            raise NotAchievedException("Heap fragmentation %u%% > %u%%" % (worst, max_fragmentation))
+
     def test_mission_frame(self, frame, target_system=1, target_component=1):
         self.clear_mission(mavutil.mavlink.MAV_MISSION_TYPE_MISSION,
                            target_system=target_system,
@@ -5017,6 +5077,10 @@ Brakes have negligible effect (with=%0.2fm without=%0.2fm delta=%0.2fm)
              "Scripting test",
              self.test_scripting),
 
+            ("ScriptingHeapSoak",
+             "Scripting heap fragmentation over hours of sim time",
+             self.test_scripting_heap_soak),
+
             ("MissionFrames",
              "Upload/Download of items in different frames",
              self.test_mission_frames),
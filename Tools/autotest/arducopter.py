@@ -1915,6 +1915,74 @@ class AutoTestCopter(AutoTest):
         if ex is not None:
             raise ex
 
+    def fly_gyro_fft(self):
+        """Track injected vibration with the onboard gyro FFT"""
+        self.context_push()
+
+        ex = None
+        try:
+            self.set_rc_default()
+            self.set_parameter("INS_FFT_ENABLE", 1)
+            self.set_parameter("INS_FFT_MINHZ", 50)
+            self.set_parameter("INS_FFT_MAXHZ", 400)
+            self.set_parameter("INS_HNTCH_ENABLE", 1)
+            self.set_parameter("INS_HNTCH_FREQ", 80)
+            self.set_parameter("INS_HNTCH_REF", 1)
+            self.set_parameter("INS_HNTCH_MODE", 4)
+            self.set_parameter("LOG_DISARMED", 0)
+            self.set_parameter("SIM_GYR_RND", 20)
+            self.set_parameter("SIM_DRIFT_SPEED", 0)
+            self.set_parameter("SIM_DRIFT_TIME", 0)
+            self.reboot_sitl()
+
+            self.takeoff(10, mode="LOITER")
+
+            hover_time = 5
+            windows = []
+            for freq in (180, 250):
+                self.set_parameter("SIM_VIB_FREQ_X", freq)
+                self.set_parameter("SIM_VIB_FREQ_Y", freq)
+                self.progress("Hovering with %uHz vibration" % freq)
+                # let the smoothed peak settle
+                self.delay_sim_time(2)
+                tstart = self.get_sim_time()
+                self.delay_sim_time(hover_time)
+                windows.append((freq, tstart * 1.0e6, self.get_sim_time() * 1.0e6))
+
+            self.do_RTL()
+
+            dfreader = self.dfreader_for_current_onboard_log()
+            peaks = {}
+            dropped = 0
+            while True:
+                m = dfreader.recv_match(type="FTN")
+                if m is None:
+                    break
+                dropped = m.Drop
+                for (freq, since, until) in windows:
+                    if m.TimeUS >= since and m.TimeUS <= until:
+                        if not m.Ok:
+                            raise NotAchievedException("No FFT peak at %.1fs" % (m.TimeUS * 1.0e-6))
+                        peaks.setdefault(freq, []).append(m.PkAvg)
+            for (freq, since, until) in windows:
+                if freq not in peaks:
+                    raise NotAchievedException("No FTN messages with %uHz vibration" % freq)
+                worst = max(peaks[freq], key=lambda p: abs(p - freq))
+                if abs(worst - freq) > 5:
+                    raise NotAchievedException("FFT found %.1fHz with %uHz vibration" % (worst, freq))
+                self.progress("FFT tracked %uHz vibration to within %.1fHz" % (freq, abs(worst - freq)))
+            # SITL has CPU to spare, so the FFT thread should never hold
+            # the sample ring long enough for samples to be dropped
+            if dropped != 0:
+                raise NotAchievedException("FFT dropped %u gyro samples" % dropped)
+        except Exception as e:
+            ex = e
+
+        self.context_pop()
+
+        if ex is not None:
+            raise ex
+
     def fly_vision_position(self):
         """Disable GPS navigation, enable Vicon input."""
         # scribble down a location we can set origin to:
@@ -4479,6 +4547,10 @@ class AutoTestCopter(AutoTest):
              "Fly motor vibration test",
              self.fly_motor_vibration),
 
+            ("GyroFFT",
+             "Fly gyro FFT tracking test",
+             self.fly_gyro_fft),
+
             ("LogDownLoad",
              "Log download",
              lambda: self.log_download(
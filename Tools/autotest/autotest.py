@@ -26,6 +26,7 @@ import quadplane
 import balancebot
 
 import examples
+import lockstep
 from pysim import util
 from pymavlink import mavutil
 from pymavlink.generator import mavtemplate
@@ -409,6 +410,9 @@ def run_step(step):
     if step == 'run.examples':
         return examples.run_examples(debug=opts.debug, valgrind=False, gdb=False)
 
+    if step == 'lockstep.ArduCopter':
+        return lockstep.run_lockstep(binary)
+
     if step == 'build.Parameters':
         return build_parameters()
 
@@ -780,6 +784,13 @@ if __name__ == "__main__":
         'convertgpx',
     ]
 
+    # steps that are not run by default, only when named exactly.
+    # lockstep.ArduCopter only compares two short runs on the ground
+    # and has not yet been proven on the autotest server
+    optional_steps = [
+        'lockstep.ArduCopter',
+    ]
+
     skipsteps = opts.skip.split(',')
 
     # ensure we catch timeouts
@@ -809,6 +820,8 @@ if __name__ == "__main__":
         for a in args:
             matches = [step for step in steps
                        if fnmatch.fnmatch(step.lower(), a.lower())]
+            matches.extend([step for step in optional_steps
+                            if step.lower() == a.lower()])
             x = find_specific_test_to_run(a)
             if x is not None:
                 matches.append(x)
@@ -3533,6 +3533,103 @@ switch value'''
         if self.get_parameter("MIS_OPTIONS") != 1:
             raise NotAchievedException("Failed to set MIS_OPTIONS")
 
+    def param_upload_defaults(self):
+        '''return (name, value) pairs from the defaults files, in order'''
+        ret = []
+        for x in self.params:
+            for line in open(os.path.join(testdir, x)):
+                line = re.sub("#.*", "", line).strip()
+                if len(line) == 0:
+                    continue
+                a = line.replace(',', ' ').split()
+                if len(a) != 2:
+                    continue
+                ret.append((a[0], float(a[1])))
+        return ret
+
+    def param_value_name(self, m):
+        name = m.param_id
+        if not isinstance(name, str):
+            name = name.decode('ascii')
+        return name.rstrip('\x00')
+
+    def test_parameter_upload_acks(self):
+        '''upload a parameter file as one burst of PARAM_SETs and check
+        that every PARAM_SET gets its PARAM_VALUE'''
+        if self.params is None:
+            return
+        params = self.param_upload_defaults()
+        self.drain_mav()
+
+        self.start_subtest("Burst of PARAM_SETs from the defaults files")
+        pending = {}
+        acked = []
+        for (name, value) in params:
+            self.mav.mav.param_set_send(self.sysid_thismav(),
+                                        1,
+                                        name.encode('ascii'),
+                                        value,
+                                        mavutil.mavlink.MAV_PARAM_TYPE_REAL32)
+            pending[name] = value
+        tstart = self.get_sim_time()
+        while len(pending) > 0 and self.get_sim_time_cached() - tstart < 5:
+            m = self.mav.recv_match(type='PARAM_VALUE', blocking=True, timeout=1)
+            if m is None:
+                continue
+            name = self.param_value_name(m)
+            if name not in pending:
+                continue
+            if abs(m.param_value - pending[name]) > 0.0002 * max(1, abs(pending[name])):
+                raise NotAchievedException("%s acked with %f, expected %f" %
+                                           (name, m.param_value, pending[name]))
+            acked.append((name, pending[name]))
+            del pending[name]
+        # parameters belonging to disabled features don't exist, so
+        # are never acked. Check the others really were missed
+        for name in list(pending.keys()):
+            self.mav.mav.param_request_read_send(self.sysid_thismav(),
+                                                 1,
+                                                 name.encode('ascii'),
+                                                 -1)
+            m = self.mav.recv_match(type='PARAM_VALUE',
+                                    blocking=True,
+                                    timeout=2,
+                                    condition="PARAM_VALUE.param_id=='%s'" % name)
+            if m is None:
+                self.progress("%s does not exist" % name)
+                del pending[name]
+        if len(pending) > 0:
+            raise NotAchievedException("No PARAM_VALUE for %s" %
+                                       ",".join(sorted(pending.keys())))
+
+        self.start_subtest("A GCS retrying a PARAM_SET gets an ack for each")
+        if len(acked) == 0:
+            raise NotAchievedException("No parameters uploaded")
+        (name, value) = acked[0]
+        count = 50
+        acks = 0
+        self.drain_mav()
+        for i in range(count):
+            self.mav.mav.param_set_send(self.sysid_thismav(),
+                                        1,
+                                        name.encode('ascii'),
+                                        value,
+                                        mavutil.mavlink.MAV_PARAM_TYPE_REAL32)
+            # well inside the time a save batch is held for
+            tstart = self.get_sim_time_cached()
+            while self.get_sim_time_cached() - tstart < 0.05:
+                m = self.mav.recv_match(type='PARAM_VALUE', blocking=True, timeout=0.1)
+                if m is not None and self.param_value_name(m) == name:
+                    acks += 1
+        tstart = self.get_sim_time_cached()
+        while acks < count and self.get_sim_time_cached() - tstart < 2:
+            m = self.mav.recv_match(type='PARAM_VALUE', blocking=True, timeout=0.5)
+            if m is not None and self.param_value_name(m) == name:
+                acks += 1
+        if acks < count:
+            raise NotAchievedException("Got %u acks for %u PARAM_SETs of %s" %
+                                       (acks, count, name))
+
     def disabled_tests(self):
         return {}
 
@@ -3690,6 +3787,10 @@ switch value'''
             ("Parameters",
              "Test Parameter Set/Get",
              self.test_parameters),
+
+            ("ParameterUploadAcks",
+             "Test each PARAM_SET in an upload is acknowledged",
+             self.test_parameter_upload_acks),
         ]
 
     def post_tests_announcements(self):
@@ -0,0 +1,96 @@
+'''
+check that a SITL run in --lockstep mode is repeatable: run the same
+scenario twice and compare the dataflash logs
+'''
+from __future__ import print_function
+
+import glob
+import os
+import shutil
+import subprocess
+import tempfile
+import time
+
+from pysim import util
+from pymavlink import DFReader
+
+HOME = "40.071374969556928,-105.22978898137808,1583.702759,246"
+
+# messages compared between the two runs. GPS messages are left out
+# as their time of week comes from the wall clock at startup
+COMPARE_TYPES = ['IMU', 'ATT', 'BARO', 'MAG', 'RCOU', 'NKF1', 'XKF1']
+
+# simulated time compared, in seconds
+COMPARE_SECONDS = 60
+
+
+def run_once(binary, defaults_file, run_seconds):
+    '''run SITL in its own directory for run_seconds of wall clock time
+    and return the path to the log it wrote'''
+    rundir = tempfile.mkdtemp(prefix="lockstep-")
+    cmd = [binary,
+           '--lockstep',
+           '--wipe',
+           '--model', '+',
+           '--home', HOME,
+           '--defaults', defaults_file,
+           # nothing outside the process may take part, so the
+           # mavlink port talks to itself
+           '--uartA', 'loopback:']
+    print("Running: (%s) in %s" % (str(cmd), rundir))
+    sitl = subprocess.Popen(cmd, cwd=rundir, stdin=None, close_fds=True)
+    time.sleep(run_seconds)
+    if sitl.poll() is not None:
+        raise ValueError("SITL exited early (exit code=%d)" % sitl.returncode)
+    sitl.terminate()
+    sitl.wait()
+    logs = sorted(glob.glob(os.path.join(rundir, 'logs', '*.BIN')))
+    if len(logs) == 0:
+        raise ValueError("No log written in %s" % rundir)
+    return logs[-1]
+
+
+def read_log(logfile):
+    '''return the messages of COMPARE_TYPES in logfile in order, up to
+    COMPARE_SECONDS of simulated time'''
+    ret = []
+    mlog = DFReader.DFReader_binary(logfile)
+    while True:
+        m = mlog.recv_match(type=COMPARE_TYPES)
+        if m is None:
+            break
+        if m.TimeUS > COMPARE_SECONDS * 1.0e6:
+            break
+        ret.append(m.to_dict())
+    return ret
+
+
+def run_lockstep(binary, run_seconds=20):
+    '''run the same scenario twice and check that the logs match'''
+    tmpdir = tempfile.mkdtemp(prefix="lockstep-params-")
+    defaults_file = os.path.join(tmpdir, 'lockstep.parm')
+    shutil.copy(util.reltopdir('Tools/autotest/default_params/copter.parm'),
+                defaults_file)
+    with open(defaults_file, 'a') as f:
+        f.write("LOG_DISARMED 1\n")
+
+    log1 = run_once(binary, defaults_file, run_seconds)
+    log2 = run_once(binary, defaults_file, run_seconds)
+    msgs1 = read_log(log1)
+    msgs2 = read_log(log2)
+
+    # the runs were stopped on the wall clock, so one may have got
+    # further than the other
+    count = min(len(msgs1), len(msgs2))
+    if count == 0:
+        print("No messages to compare in %s and %s" % (log1, log2))
+        return False
+    for i in range(count):
+        if msgs1[i] != msgs2[i]:
+            print("Logs differ at message %u:" % i)
+            print("  %s: %s" % (log1, str(msgs1[i])))
+            print("  %s: %s" % (log2, str(msgs2[i])))
+            return False
+    print("Compared %u messages of %s, up to TimeUS=%u" %
+          (count, ','.join(COMPARE_TYPES), msgs1[count-1]['TimeUS']))
+    return True
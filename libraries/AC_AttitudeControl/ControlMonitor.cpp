@@ -41,13 +41,13 @@ void AC_AttitudeControl::control_monitor_update(void)
  */
 void AC_AttitudeControl::control_monitor_log(void)
 {
-    AP::logger().Write("CTRL", "TimeUS,RMSRollP,RMSRollD,RMSPitchP,RMSPitchD,RMSYaw", "Qfffff",
-                                           AP_HAL::micros64(),
-                                           (double)safe_sqrt(_control_monitor.rms_roll_P),
-                                           (double)safe_sqrt(_control_monitor.rms_roll_D),
-                                           (double)safe_sqrt(_control_monitor.rms_pitch_P),
-                                           (double)safe_sqrt(_control_monitor.rms_pitch_D),
-                                           (double)safe_sqrt(_control_monitor.rms_yaw));
+    AP_LOGGER_WRITE_PACKED("CTRL", "TimeUS,RMSRollP,RMSRollD,RMSPitchP,RMSPitchD,RMSYaw", nullptr, nullptr, "Qfffff",
+                           AP_HAL::micros64(),
+                           safe_sqrt(_control_monitor.rms_roll_P),
+                           safe_sqrt(_control_monitor.rms_roll_D),
+                           safe_sqrt(_control_monitor.rms_pitch_P),
+                           safe_sqrt(_control_monitor.rms_pitch_D),
+                           safe_sqrt(_control_monitor.rms_yaw));
 
 }
 
@@ -252,6 +252,10 @@ bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_polygons(const Lo
         }
     }
 
+    // bounding box of the path
+    const Vector2f path_min(MIN(start_NE.x, end_NE.x), MIN(start_NE.y, end_NE.y));
+    const Vector2f path_max(MAX(start_NE.x, end_NE.x), MAX(start_NE.y, end_NE.y));
+
     // iterate through exclusion polygons and calculate minimum margin
     for (uint8_t i = 0; i < num_exclusion_polygons; i++) {
         uint16_t num_points;
@@ -261,6 +265,21 @@ bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_polygons(const Lo
             continue;
         }
 
+        // skip polygons whose bounding box is too far from the path
+        // to lower the margin.  If the boxes don't touch the path is
+        // outside the polygon, so its margin is at least the gap
+        // between the boxes less the fence margin.  1cm of slack
+        // covers rounding in the distance calculation
+        Vector2f bounds_min, bounds_max;
+        if (margin_updated &&
+            fence->polyfence().get_exclusion_polygon_bounds(i, bounds_min, bounds_max)) {
+            const AC_PolyFence_grid::Bounds bounds {bounds_min, bounds_max};
+            const float gap_cm = bounds.gap(path_min, path_max) - 1.0f;
+            if (gap_cm > 0 && (gap_cm * 0.01f - fence_margin > margin)) {
+                continue;
+            }
+        }
+
         // if start is inside the polygon the margin's sign is reversed
         const float sign = Polygon_outside(start_NE, boundary, num_points) ? 1.0f : -1.0f;
 
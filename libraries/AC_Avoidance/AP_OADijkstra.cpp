@@ -617,6 +617,7 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
 
     // clear fence points visibility graph
     _fence_visgraph.clear();
+    _destination_visgraph_ok = false;
 
     // calculate distance from each point to all other points
     for (uint8_t i = 0; i < total_numpoints() - 1; i++) {
@@ -640,6 +641,12 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
         }
     }
 
+    // index items by node for update_visible_node_distances
+    if (!_fence_visgraph.build_adjacency(2 + total_numpoints())) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        return false;
+    }
+
     return true;
 }
 
@@ -693,33 +700,31 @@ void AP_OADijkstra::update_visible_node_distances(node_index curr_node_idx)
 
     // get current node for convenience
     const ShortPathNode &curr_node = _short_path_data[curr_node_idx];
+    const uint16_t curr_visgraph_node = AP_OAVisGraph::node_index(curr_node.id);
 
     // for each visibility graph
     const AP_OAVisGraph* visgraphs[] = {&_fence_visgraph, &_destination_visgraph};
     for (uint8_t v=0; v<ARRAY_SIZE(visgraphs); v++) {
 
-        // skip if empty
+        // for each item visible from current_node (i.e. with current node's id at either end of the vector)
         const AP_OAVisGraph &curr_visgraph = *visgraphs[v];
-        if (curr_visgraph.num_items() == 0) {
-            continue;
-        }
-
-        // search visibility graph for items visible from current_node
-        for (uint16_t i = 0; i < curr_visgraph.num_items(); i++) {
-            const AP_OAVisGraph::VisGraphItem &item = curr_visgraph[i];
-            // match if current node's id matches either of the id's in the graph (i.e. either end of the vector)
-            if ((curr_node.id == item.id1) || (curr_node.id == item.id2)) {
-                AP_OAVisGraph::OAItemID matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
-                // find item's id in node array
-                node_index item_node_idx;
-                if (find_node_from_id(matching_id, item_node_idx)) {
-                    // if current node's distance + distance to item is less than item's current distance, update item's distance
-                    const float dist_to_item_via_current_node = _short_path_data[curr_node_idx].distance_cm + item.distance_cm;
-                    if (dist_to_item_via_current_node < _short_path_data[item_node_idx].distance_cm) {
-                        // update item's distance and set "distance_from_idx" to current node's index
-                        _short_path_data[item_node_idx].distance_cm = dist_to_item_via_current_node;
-                        _short_path_data[item_node_idx].distance_from_idx = curr_node_idx;
-                    }
+        for (uint16_t i = 0; i < curr_visgraph.num_adjacent(curr_visgraph_node); i++) {
+            const AP_OAVisGraph::VisGraphItem &item = curr_visgraph.adjacent(curr_visgraph_node, i);
+            AP_OAVisGraph::OAItemID matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
+            // find item's id in node array
+            node_index item_node_idx;
+            if (find_node_from_id(matching_id, item_node_idx)) {
+                // visited nodes already have their shortest distance
+                if (_short_path_data[item_node_idx].visited) {
+                    continue;
+                }
+                // if current node's distance + distance to item is less than item's current distance, update item's distance
+                const float dist_to_item_via_current_node = _short_path_data[curr_node_idx].distance_cm + item.distance_cm;
+                if (dist_to_item_via_current_node < _short_path_data[item_node_idx].distance_cm) {
+                    // update item's distance and set "distance_from_idx" to current node's index
+                    _short_path_data[item_node_idx].distance_cm = dist_to_item_via_current_node;
+                    _short_path_data[item_node_idx].distance_from_idx = curr_node_idx;
+                    _short_path_heap.update(item_node_idx, dist_to_item_via_current_node);
                 }
             }
         }
@@ -758,29 +763,6 @@ bool AP_OADijkstra::find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_in
     return false;
 }
 
-// find index of node with lowest tentative distance (ignore visited nodes)
-// returns true if successful and node_idx argument is updated
-bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx) const
-{
-    node_index lowest_idx = 0;
-    float lowest_dist = FLT_MAX;
-
-    // scan through all nodes looking for closest
-    for (node_index i=0; i<_short_path_data_numpoints; i++) {
-        const ShortPathNode &node = _short_path_data[i];
-        if (!node.visited && (node.distance_cm < lowest_dist)) {
-            lowest_idx = i;
-            lowest_dist = node.distance_cm;
-        }
-    }
-
-    if (lowest_dist < FLT_MAX) {
-        node_idx = lowest_idx;
-        return true;
-    }
-    return false;
-}
-
 // calculate shortest path from origin to destination
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run: create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin, create_polygon_fence_visgraph
@@ -799,13 +781,20 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
         return false;
     }
-    if (!update_visgraph(_destination_visgraph, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, destination_NE)) {
-        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-        return false;
+
+    // the destination's visgraph only depends on the fence so is kept while the destination does not move
+    if (!_destination_visgraph_ok || (destination_NE != _destination_visgraph_pos)) {
+        _destination_visgraph_ok = update_visgraph(_destination_visgraph, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, destination_NE) &&
+                                   _destination_visgraph.build_adjacency(2 + total_numpoints());
+        if (!_destination_visgraph_ok) {
+            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+            return false;
+        }
+        _destination_visgraph_pos = destination_NE;
     }
 
     // expand _short_path_data if necessary
-    if (!_short_path_data.expand_to_hold(2 + total_numpoints())) {
+    if (!_short_path_data.expand_to_hold(2 + total_numpoints()) || !_short_path_heap.init(2 + total_numpoints())) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
         return false;
     }
@@ -829,6 +818,7 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
             _short_path_data[node_idx].distance_cm = _source_visgraph[i].distance_cm;
             _short_path_data[node_idx].distance_from_idx = current_node_idx;
+            _short_path_heap.update(node_idx, _source_visgraph[i].distance_cm);
         } else {
             err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
             return false;
@@ -838,7 +828,9 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
     _short_path_data[current_node_idx].visited = true;
 
     // move current_node_idx to node with lowest distance
-    while (find_closest_node_idx(current_node_idx)) {
+    while (!_short_path_heap.empty()) {
+        current_node_idx = _short_path_heap.pop();
+
         // update distances to all neighbours of current node
         update_visible_node_distances(current_node_idx);
 
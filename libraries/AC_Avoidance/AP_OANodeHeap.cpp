@@ -0,0 +1,112 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_OANodeHeap.h"
+
+AP_OANodeHeap::~AP_OANodeHeap()
+{
+    delete[] _heap;
+    delete[] _pos;
+    delete[] _distance;
+}
+
+// empty the heap and make room for nodes numbered 0 to num_nodes-1
+// returns false if out of memory
+bool AP_OANodeHeap::init(uint16_t num_nodes)
+{
+    _num_heap = 0;
+
+    if (_size < num_nodes) {
+        delete[] _heap;
+        delete[] _pos;
+        delete[] _distance;
+        _heap = new uint16_t[num_nodes];
+        _pos = new uint16_t[num_nodes];
+        _distance = new float[num_nodes];
+        if ((_heap == nullptr) || (_pos == nullptr) || (_distance == nullptr)) {
+            _size = 0;
+            return false;
+        }
+        _size = num_nodes;
+    }
+
+    for (uint16_t i = 0; i < _size; i++) {
+        _pos[i] = NOT_IN_HEAP;
+    }
+    return true;
+}
+
+// add a node or, if it is already in the heap, lower its distance
+void AP_OANodeHeap::update(uint16_t node, float distance)
+{
+    if (node >= _size) {
+        return;
+    }
+    _distance[node] = distance;
+    if (_pos[node] == NOT_IN_HEAP) {
+        set(_num_heap, node);
+        _num_heap++;
+    }
+    sift_up(_pos[node]);
+}
+
+// remove and return the node with the lowest distance
+uint16_t AP_OANodeHeap::pop()
+{
+    const uint16_t node = _heap[0];
+    _pos[node] = NOT_IN_HEAP;
+    _num_heap--;
+    if (_num_heap > 0) {
+        set(0, _heap[_num_heap]);
+        sift_down(0);
+    }
+    return node;
+}
+
+// move the node at pos towards the top of the heap until its parent comes before it
+void AP_OANodeHeap::sift_up(uint16_t pos)
+{
+    const uint16_t node = _heap[pos];
+    while (pos > 0) {
+        const uint16_t parent = (pos - 1) / 2;
+        if (!before(node, _heap[parent])) {
+            break;
+        }
+        set(pos, _heap[parent]);
+        pos = parent;
+    }
+    set(pos, node);
+}
+
+// move the node at pos towards the bottom of the heap until it comes before its children
+void AP_OANodeHeap::sift_down(uint16_t pos)
+{
+    const uint16_t node = _heap[pos];
+    while (true) {
+        uint16_t child = 2 * pos + 1;
+        if (child >= _num_heap) {
+            break;
+        }
+        if ((child + 1 < _num_heap) && before(_heap[child + 1], _heap[child])) {
+            child++;
+        }
+        if (!before(_heap[child], node)) {
+            break;
+        }
+        set(pos, _heap[child]);
+        pos = child;
+    }
+    set(pos, node);
+}
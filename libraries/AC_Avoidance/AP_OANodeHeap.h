@@ -0,0 +1,52 @@
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+
+/*
+ * Binary min-heap of node numbers keyed on distance, used by Dijkstra's
+ * algorithm to find the closest unvisited node. Nodes with equal
+ * distances come out lowest node number first so nodes are visited in
+ * the same order as a linear search for the lowest distance
+ */
+class AP_OANodeHeap {
+public:
+    AP_OANodeHeap() {}
+    ~AP_OANodeHeap();
+
+    /* Do not allow copies */
+    AP_OANodeHeap(const AP_OANodeHeap &other) = delete;
+    AP_OANodeHeap &operator=(const AP_OANodeHeap&) = delete;
+
+    // empty the heap and make room for nodes numbered 0 to num_nodes-1
+    // returns false if out of memory
+    bool init(uint16_t num_nodes);
+
+    // true if there are no nodes in the heap
+    bool empty() const { return _num_heap == 0; }
+
+    // add a node or, if it is already in the heap, lower its distance
+    void update(uint16_t node, float distance);
+
+    // remove and return the node with the lowest distance
+    // Note: heap must not be empty
+    uint16_t pop();
+
+private:
+
+    // true if heap entry a should be popped before heap entry b
+    bool before(uint16_t a, uint16_t b) const {
+        return (_distance[a] < _distance[b]) || ((_distance[a] == _distance[b]) && (a < b));
+    }
+
+    void sift_up(uint16_t pos);
+    void sift_down(uint16_t pos);
+    void set(uint16_t pos, uint16_t node) { _heap[pos] = node; _pos[node] = pos; }
+
+    static const uint16_t NOT_IN_HEAP = UINT16_MAX;
+
+    uint16_t *_heap = nullptr;      // node numbers in heap order
+    uint16_t *_pos = nullptr;       // each node's position in _heap or NOT_IN_HEAP
+    float *_distance = nullptr;     // each node's distance
+    uint16_t _num_heap = 0;         // number of nodes in heap
+    uint16_t _size = 0;             // number of nodes the arrays can hold
+};
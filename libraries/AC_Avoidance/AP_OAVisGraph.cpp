@@ -21,6 +21,12 @@ AP_OAVisGraph::AP_OAVisGraph() :
 {
 }
 
+AP_OAVisGraph::~AP_OAVisGraph()
+{
+    delete[] _adj_start;
+    delete[] _adj_items;
+}
+
 // add item to visiblity graph, returns true on success, false if graph is full
 bool AP_OAVisGraph::add_item(const OAItemID &id1, const OAItemID &id2, float distance_cm)
 {
@@ -39,3 +45,86 @@ bool AP_OAVisGraph::add_item(const OAItemID &id1, const OAItemID &id2, float dis
     _num_items++;
     return true;
 }
+
+// node number of an item: the source is 0, the destination 1 and
+// intermediate points follow from 2
+uint16_t AP_OAVisGraph::node_index(const OAItemID &id)
+{
+    switch (id.id_type) {
+    case OATYPE_SOURCE:
+        return 0;
+    case OATYPE_DESTINATION:
+        return 1;
+    case OATYPE_INTERMEDIATE_POINT:
+        break;
+    }
+    return id.id_num + 2;
+}
+
+// build the list of items touching each of the first num_nodes nodes
+// returns false if out of memory
+bool AP_OAVisGraph::build_adjacency(uint16_t num_nodes)
+{
+    _adj_num_nodes = 0;
+
+    // ensure there is space in the arrays
+    if (_adj_start_size < num_nodes + 1) {
+        delete[] _adj_start;
+        _adj_start = new uint16_t[num_nodes + 1];
+        if (_adj_start == nullptr) {
+            _adj_start_size = 0;
+            return false;
+        }
+        _adj_start_size = num_nodes + 1;
+    }
+    const uint32_t num_entries = 2 * (uint32_t)_num_items;
+    if (_adj_items_size < num_entries) {
+        delete[] _adj_items;
+        _adj_items = new uint16_t[num_entries];
+        if (_adj_items == nullptr) {
+            _adj_items_size = 0;
+            return false;
+        }
+        _adj_items_size = num_entries;
+    }
+
+    // count items touching each node
+    memset(_adj_start, 0, (num_nodes + 1) * sizeof(_adj_start[0]));
+    for (uint16_t i = 0; i < _num_items; i++) {
+        const uint16_t n1 = node_index(_items[i].id1);
+        const uint16_t n2 = node_index(_items[i].id2);
+        if (n1 < num_nodes) {
+            _adj_start[n1 + 1]++;
+        }
+        if (n2 < num_nodes) {
+            _adj_start[n2 + 1]++;
+        }
+    }
+
+    // convert counts to start offsets
+    for (uint16_t n = 0; n < num_nodes; n++) {
+        _adj_start[n + 1] += _adj_start[n];
+    }
+
+    // fill in item indices in the order the items were added, using
+    // _adj_start[n] as the insert position for node n
+    for (uint16_t i = 0; i < _num_items; i++) {
+        const uint16_t n1 = node_index(_items[i].id1);
+        const uint16_t n2 = node_index(_items[i].id2);
+        if (n1 < num_nodes) {
+            _adj_items[_adj_start[n1]++] = i;
+        }
+        if (n2 < num_nodes) {
+            _adj_items[_adj_start[n2]++] = i;
+        }
+    }
+
+    // each insert position is now the start of the next node's items
+    for (uint16_t n = num_nodes; n > 0; n--) {
+        _adj_start[n] = _adj_start[n - 1];
+    }
+    _adj_start[0] = 0;
+
+    _adj_num_nodes = num_nodes;
+    return true;
+}
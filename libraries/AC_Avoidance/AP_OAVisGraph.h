@@ -10,6 +10,7 @@
 class AP_OAVisGraph {
 public:
     AP_OAVisGraph();
+    ~AP_OAVisGraph();
 
     /* Do not allow copies */
     AP_OAVisGraph(const AP_OAVisGraph &other) = delete;
@@ -40,7 +41,7 @@ public:
     };
 
     // clear all elements from graph
-    void clear() { _num_items = 0; }
+    void clear() { _num_items = 0; _adj_num_nodes = 0; }
 
     // get number of items in visibility graph table
     uint16_t num_items() const { return _num_items; }
@@ -52,8 +53,36 @@ public:
     // Note: no protection against out-of-bounds accesses so use with num_items()
     const VisGraphItem& operator[](uint16_t i) const { return _items[i]; }
 
+    // node number of an item: the source is 0, the destination 1 and
+    // intermediate points follow from 2
+    static uint16_t node_index(const OAItemID &id);
+
+    // build the list of items touching each of the first num_nodes
+    // nodes, stored compressed (one array of item indices for all
+    // nodes). Must be called again after items are added
+    // returns false if out of memory
+    bool build_adjacency(uint16_t num_nodes);
+
+    // number of items touching a node, 0 if build_adjacency has not
+    // been called since the graph was cleared
+    uint16_t num_adjacent(uint16_t node) const {
+        return (node < _adj_num_nodes) ? (_adj_start[node+1] - _adj_start[node]) : 0;
+    }
+
+    // i'th item touching a node, 0 indexed
+    // Note: no protection against out-of-bounds accesses so use with num_adjacent()
+    const VisGraphItem& adjacent(uint16_t node, uint16_t i) const { return _items[_adj_items[_adj_start[node] + i]]; }
+
 private:
 
     AP_ExpandingArray<VisGraphItem> _items;
     uint16_t _num_items;
+
+    // adjacency lists: items touching node n are
+    // _adj_items[_adj_start[n]] to _adj_items[_adj_start[n+1]-1]
+    uint16_t *_adj_start = nullptr;
+    uint16_t *_adj_items = nullptr;
+    uint16_t _adj_num_nodes = 0;
+    uint16_t _adj_start_size = 0;
+    uint32_t _adj_items_size = 0;
 };
@@ -0,0 +1,231 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AC_Avoidance/AP_OAVisGraph.h>
+#include <AC_Avoidance/AP_OANodeHeap.h>
+
+/*
+  shortest path search over the visibility graph of synthetic fences:
+  a square grid of octagonal exclusion zones with the vehicle at one
+  corner and the destination at the other. The graph is built the
+  same way as AP_OADijkstra::create_fence_visgraph() and the search is
+  run both as it was originally written (linear search for the closest
+  node and for each node's neighbours) and as it is now (node heap and
+  visgraph adjacency lists)
+ */
+
+#define POINTS_PER_ZONE 8
+#define ZONE_RADIUS_CM  1000.0f
+#define ZONE_SPACING_CM 3000.0f
+#define MARGIN_CM       200.0f
+
+struct SyntheticFence {
+    uint16_t num_zones;
+    Vector2f zone_pts[32][POINTS_PER_ZONE];     // exclusion polygons
+    Vector2f points[32*POINTS_PER_ZONE];        // fence points with margin
+    uint16_t num_points;
+    Vector2f source;
+    Vector2f destination;
+    AP_OAVisGraph fence_visgraph;
+    AP_OAVisGraph source_visgraph;
+    AP_OAVisGraph destination_visgraph;
+
+    bool intersects(const Vector2f &start, const Vector2f &end) const {
+        for (uint16_t z = 0; z < num_zones; z++) {
+            Vector2f intersection;
+            if (Polygon_intersects(zone_pts[z], POINTS_PER_ZONE, start, end, intersection)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void build_fence_visgraph() {
+        fence_visgraph.clear();
+        for (uint8_t i = 0; i < num_points - 1; i++) {
+            for (uint8_t j = i + 1; j < num_points; j++) {
+                if (!intersects(points[i], points[j])) {
+                    fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i},
+                                            {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, j},
+                                            (points[i] - points[j]).length());
+                }
+            }
+        }
+        fence_visgraph.build_adjacency(2 + num_points);
+    }
+
+    void build_visgraph(AP_OAVisGraph &visgraph, AP_OAVisGraph::OAType type, const Vector2f &pos, bool add_destination) {
+        visgraph.clear();
+        for (uint8_t i = 0; i < num_points; i++) {
+            if (!intersects(pos, points[i])) {
+                visgraph.add_item({type, 0}, {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, (pos - points[i]).length());
+            }
+        }
+        if (add_destination && !intersects(pos, destination)) {
+            visgraph.add_item({type, 0}, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, (pos - destination).length());
+        }
+        visgraph.build_adjacency(2 + num_points);
+    }
+
+    void init(uint16_t zones_per_side) {
+        num_zones = 0;
+        num_points = 0;
+        for (uint16_t x = 0; x < zones_per_side; x++) {
+            for (uint16_t y = 0; y < zones_per_side; y++) {
+                const Vector2f centre((x + 1) * ZONE_SPACING_CM, (y + 1) * ZONE_SPACING_CM);
+                for (uint8_t p = 0; p < POINTS_PER_ZONE; p++) {
+                    const float angle = M_2PI * p / POINTS_PER_ZONE;
+                    const Vector2f offset(cosf(angle), sinf(angle));
+                    zone_pts[num_zones][p] = centre + offset * ZONE_RADIUS_CM;
+                    points[num_points++] = centre + offset * ((ZONE_RADIUS_CM + MARGIN_CM) / cosf(M_PI / POINTS_PER_ZONE));
+                }
+                num_zones++;
+            }
+        }
+        source.zero();
+        destination = Vector2f(zones_per_side + 1, zones_per_side + 1) * ZONE_SPACING_CM;
+        build_fence_visgraph();
+        build_visgraph(source_visgraph, AP_OAVisGraph::OATYPE_SOURCE, source, true);
+        build_visgraph(destination_visgraph, AP_OAVisGraph::OATYPE_DESTINATION, destination, false);
+    }
+};
+
+static SyntheticFence fence;
+
+struct Node {
+    AP_OAVisGraph::OAItemID id;
+    bool visited;
+    uint16_t distance_from_idx;
+    float distance_cm;
+};
+static Node nodes[2 + 32*POINTS_PER_ZONE];
+static uint16_t num_nodes;
+
+static void init_nodes()
+{
+    num_nodes = 2 + fence.num_points;
+    nodes[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, true, 0, 0};
+    nodes[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, UINT16_MAX, FLT_MAX};
+    for (uint8_t i = 0; i < fence.num_points; i++) {
+        nodes[2 + i] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, UINT16_MAX, FLT_MAX};
+    }
+    for (uint16_t i = 0; i < fence.source_visgraph.num_items(); i++) {
+        const uint16_t n = AP_OAVisGraph::node_index(fence.source_visgraph[i].id2);
+        nodes[n].distance_cm = fence.source_visgraph[i].distance_cm;
+        nodes[n].distance_from_idx = 0;
+    }
+}
+
+// search as originally written
+static float shortest_path_linear()
+{
+    init_nodes();
+    const AP_OAVisGraph* visgraphs[] = {&fence.fence_visgraph, &fence.destination_visgraph};
+    while (true) {
+        uint16_t curr = 0;
+        float lowest_dist = FLT_MAX;
+        for (uint16_t i = 0; i < num_nodes; i++) {
+            if (!nodes[i].visited && (nodes[i].distance_cm < lowest_dist)) {
+                curr = i;
+                lowest_dist = nodes[i].distance_cm;
+            }
+        }
+        if (lowest_dist >= FLT_MAX) {
+            break;
+        }
+        for (const AP_OAVisGraph *visgraph : visgraphs) {
+            for (uint16_t i = 0; i < visgraph->num_items(); i++) {
+                const AP_OAVisGraph::VisGraphItem &item = (*visgraph)[i];
+                if ((nodes[curr].id == item.id1) || (nodes[curr].id == item.id2)) {
+                    const uint16_t n = AP_OAVisGraph::node_index((nodes[curr].id == item.id1) ? item.id2 : item.id1);
+                    const float dist = nodes[curr].distance_cm + item.distance_cm;
+                    if (dist < nodes[n].distance_cm) {
+                        nodes[n].distance_cm = dist;
+                        nodes[n].distance_from_idx = curr;
+                    }
+                }
+            }
+        }
+        nodes[curr].visited = true;
+    }
+    return nodes[1].distance_cm;
+}
+
+// search using node heap and adjacency lists
+static AP_OANodeHeap heap;
+
+static float shortest_path_heap()
+{
+    init_nodes();
+    heap.init(num_nodes);
+    for (uint16_t i = 1; i < num_nodes; i++) {
+        if (nodes[i].distance_cm < FLT_MAX) {
+            heap.update(i, nodes[i].distance_cm);
+        }
+    }
+    const AP_OAVisGraph* visgraphs[] = {&fence.fence_visgraph, &fence.destination_visgraph};
+    while (!heap.empty()) {
+        const uint16_t curr = heap.pop();
+        for (const AP_OAVisGraph *visgraph : visgraphs) {
+            for (uint16_t i = 0; i < visgraph->num_adjacent(curr); i++) {
+                const AP_OAVisGraph::VisGraphItem &item = visgraph->adjacent(curr, i);
+                const uint16_t n = AP_OAVisGraph::node_index((nodes[curr].id == item.id1) ? item.id2 : item.id1);
+                if (nodes[n].visited) {
+                    continue;
+                }
+                const float dist = nodes[curr].distance_cm + item.distance_cm;
+                if (dist < nodes[n].distance_cm) {
+                    nodes[n].distance_cm = dist;
+                    nodes[n].distance_from_idx = curr;
+                    heap.update(n, dist);
+                }
+            }
+        }
+        nodes[curr].visited = true;
+    }
+    return nodes[1].distance_cm;
+}
+
+static void BM_DijkstraFenceVisgraph(benchmark::State& state)
+{
+    fence.init(state.range(0));
+
+    while (state.KeepRunning()) {
+        fence.build_fence_visgraph();
+        gbenchmark_escape(&fence);
+    }
+    state.counters["points"] = fence.num_points;
+}
+
+static void BM_DijkstraSearchLinear(benchmark::State& state)
+{
+    fence.init(state.range(0));
+
+    while (state.KeepRunning()) {
+        float dist = shortest_path_linear();
+        gbenchmark_escape(&dist);
+    }
+    state.counters["points"] = fence.num_points;
+}
+
+static void BM_DijkstraSearchHeap(benchmark::State& state)
+{
+    fence.init(state.range(0));
+    if (shortest_path_heap() != shortest_path_linear()) {
+        state.SkipWithError("paths differ");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        float dist = shortest_path_heap();
+        gbenchmark_escape(&dist);
+    }
+    state.counters["points"] = fence.num_points;
+}
+
+// 3x3 to 5x5 zones, 72 to 200 fence points
+BENCHMARK(BM_DijkstraFenceVisgraph)->DenseRange(3, 5);
+BENCHMARK(BM_DijkstraSearchLinear)->DenseRange(3, 5);
+BENCHMARK(BM_DijkstraSearchHeap)->DenseRange(3, 5);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,213 @@
+#include "AC_PolyFence_grid.h"
+
+// number of grid cells allocated per polygon
+#define AC_POLYFENCE_GRID_CELLS_PER_POLYGON 2
+
+// lower bound on the distance between this box and anything within
+// the box other_min..other_max
+float AC_PolyFence_grid::Bounds::gap(const Vector2f &other_min, const Vector2f &other_max) const
+{
+    const float dx = MAX(other_min.x - max.x, min.x - other_max.x);
+    const float dy = MAX(other_min.y - max.y, min.y - other_max.y);
+    return norm(MAX(dx, 0.0f), MAX(dy, 0.0f));
+}
+
+bool AC_PolyFence_grid::init(uint8_t max_polygons)
+{
+    clear();
+    if (max_polygons == 0) {
+        return true;
+    }
+    _polygons = new Polygon[max_polygons];
+    if (_polygons == nullptr) {
+        return false;
+    }
+    _max_polygons = max_polygons;
+    return true;
+}
+
+void AC_PolyFence_grid::add(const Vector2f *points, uint8_t count)
+{
+    if (_num_polygons >= _max_polygons || count == 0) {
+        return;
+    }
+    Polygon &polygon = _polygons[_num_polygons];
+    polygon.points = points;
+    polygon.count = count;
+    polygon.bounds.min = points[0];
+    polygon.bounds.max = points[0];
+    for (uint8_t i=1; i<count; i++) {
+        polygon.bounds.min.x = MIN(polygon.bounds.min.x, points[i].x);
+        polygon.bounds.min.y = MIN(polygon.bounds.min.y, points[i].y);
+        polygon.bounds.max.x = MAX(polygon.bounds.max.x, points[i].x);
+        polygon.bounds.max.y = MAX(polygon.bounds.max.y, points[i].y);
+    }
+
+    if (_num_polygons == 0) {
+        _extent = polygon.bounds;
+    } else {
+        _extent.min.x = MIN(_extent.min.x, polygon.bounds.min.x);
+        _extent.min.y = MIN(_extent.min.y, polygon.bounds.min.y);
+        _extent.max.x = MAX(_extent.max.x, polygon.bounds.max.x);
+        _extent.max.y = MAX(_extent.max.y, polygon.bounds.max.y);
+    }
+    _num_polygons++;
+}
+
+uint8_t AC_PolyFence_grid::cell_x(float x) const
+{
+    // rounding can't make this non-monotonic in x, so a position
+    // inside a polygon's bounds is always within the cells covered
+    // by those bounds
+    const float f = (x - _extent.min.x) * _cell_scale.x;
+    if (f <= 0) {
+        return 0;
+    }
+    if (f >= _cells_x - 1) {
+        return _cells_x - 1;
+    }
+    return uint8_t(f);
+}
+
+uint8_t AC_PolyFence_grid::cell_y(float y) const
+{
+    const float f = (y - _extent.min.y) * _cell_scale.y;
+    if (f <= 0) {
+        return 0;
+    }
+    if (f >= _cells_y - 1) {
+        return _cells_y - 1;
+    }
+    return uint8_t(f);
+}
+
+bool AC_PolyFence_grid::build()
+{
+    delete[] _cell_start;
+    _cell_start = nullptr;
+    delete[] _cell_polygons;
+    _cell_polygons = nullptr;
+
+    if (_num_polygons < 2) {
+        // bounds checks are as good as a grid
+        return true;
+    }
+
+    // roughly square cells, about AC_POLYFENCE_GRID_CELLS_PER_POLYGON
+    // of them per polygon
+    const uint16_t target_cells = uint16_t(_num_polygons) * AC_POLYFENCE_GRID_CELLS_PER_POLYGON;
+    const float width = MAX(_extent.max.x - _extent.min.x, 1.0f);
+    const float height = MAX(_extent.max.y - _extent.min.y, 1.0f);
+    const float nx = constrain_float(roundf(sqrtf(target_cells * width / height)), 1, 255);
+    _cells_x = uint8_t(nx);
+    _cells_y = uint8_t(constrain_float(ceilf(target_cells / nx), 1, 255));
+    _cell_scale.x = _cells_x / width;
+    _cell_scale.y = _cells_y / height;
+    const uint16_t num_cells = uint16_t(_cells_x) * _cells_y;
+
+    _cell_start = new uint16_t[num_cells+1];
+    if (_cell_start == nullptr) {
+        return false;
+    }
+    memset(_cell_start, 0, sizeof(_cell_start[0]) * (num_cells+1));
+
+    // count the polygons overlapping each cell
+    uint32_t total = 0;
+    for (uint8_t i=0; i<_num_polygons; i++) {
+        const Bounds &b = _polygons[i].bounds;
+        const uint8_t x0 = cell_x(b.min.x), x1 = cell_x(b.max.x);
+        const uint8_t y0 = cell_y(b.min.y), y1 = cell_y(b.max.y);
+        for (uint8_t y=y0; y<=y1; y++) {
+            for (uint8_t x=x0; x<=x1; x++) {
+                _cell_start[y*_cells_x + x]++;
+            }
+        }
+        total += (x1 + 1 - x0) * (y1 + 1 - y0);
+    }
+    if (total > UINT16_MAX) {
+        // too many large polygons for a grid to help
+        delete[] _cell_start;
+        _cell_start = nullptr;
+        return false;
+    }
+
+    _cell_polygons = new uint8_t[total];
+    if (_cell_polygons == nullptr) {
+        delete[] _cell_start;
+        _cell_start = nullptr;
+        return false;
+    }
+
+    // make _cell_start[c] the end of cell c, then fill each cell
+    // backwards from its end, which leaves _cell_start[c] at the
+    // start of the cell and the cell's polygons in index order
+    for (uint16_t c=1; c<num_cells; c++) {
+        _cell_start[c] += _cell_start[c-1];
+    }
+    _cell_start[num_cells] = total;
+    for (int16_t i=_num_polygons-1; i>=0; i--) {
+        const Bounds &b = _polygons[i].bounds;
+        const uint8_t x0 = cell_x(b.min.x), x1 = cell_x(b.max.x);
+        const uint8_t y0 = cell_y(b.min.y), y1 = cell_y(b.max.y);
+        for (uint8_t y=y0; y<=y1; y++) {
+            for (uint8_t x=x0; x<=x1; x++) {
+                _cell_polygons[--_cell_start[y*_cells_x + x]] = i;
+            }
+        }
+    }
+
+    return true;
+}
+
+void AC_PolyFence_grid::clear()
+{
+    delete[] _cell_start;
+    _cell_start = nullptr;
+    delete[] _cell_polygons;
+    _cell_polygons = nullptr;
+    delete[] _polygons;
+    _polygons = nullptr;
+    _max_polygons = 0;
+    _num_polygons = 0;
+}
+
+bool AC_PolyFence_grid::polygon_contains(const Polygon &polygon, const Vector2f &pos) const
+{
+    return polygon.bounds.contains(pos) &&
+           !Polygon_outside(pos, polygon.points, polygon.count);
+}
+
+bool AC_PolyFence_grid::inside_any(const Vector2f &pos) const
+{
+    if (_cell_start == nullptr) {
+        for (uint8_t i=0; i<_num_polygons; i++) {
+            if (polygon_contains(_polygons[i], pos)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (!_extent.contains(pos)) {
+        return false;
+    }
+    const uint16_t c = cell_y(pos.y) * _cells_x + cell_x(pos.x);
+    for (uint16_t i=_cell_start[c]; i<_cell_start[c+1]; i++) {
+        if (polygon_contains(_polygons[_cell_polygons[i]], pos)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AC_PolyFence_grid::outside_any(const Vector2f &pos) const
+{
+    // the point must be inside every polygon, so there is nothing
+    // for the grid to skip
+    for (uint8_t i=0; i<_num_polygons; i++) {
+        if (!polygon_contains(_polygons[i], pos)) {
+            return true;
+        }
+    }
+    return false;
+}
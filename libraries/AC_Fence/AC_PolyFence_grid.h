@@ -0,0 +1,93 @@
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+  AC_PolyFence_grid - bounding boxes and a uniform grid over a set of
+  fence polygons, so that point queries only test the polygons whose
+  bounding box covers the point.
+
+  Polygons are added once after a fence load and the grid is then
+  built; the points are not copied, so must outlive the grid.  If the
+  grid cannot be allocated queries fall back to testing the bounding
+  box of every polygon, which still gives the same answers.
+ */
+class AC_PolyFence_grid {
+public:
+    AC_PolyFence_grid() {}
+    ~AC_PolyFence_grid() { clear(); }
+
+    AC_PolyFence_grid(const AC_PolyFence_grid &other) = delete;
+    AC_PolyFence_grid &operator=(const AC_PolyFence_grid&) = delete;
+
+    // axis-aligned bounding box of a polygon
+    class Bounds {
+    public:
+        Vector2f min;
+        Vector2f max;
+
+        // true if pos is inside or on the edge of the box
+        bool contains(const Vector2f &pos) const {
+            return pos.x >= min.x && pos.x <= max.x &&
+                   pos.y >= min.y && pos.y <= max.y;
+        }
+
+        // lower bound on the distance between the box and anything
+        // within the box other_min..other_max; zero if they overlap
+        float gap(const Vector2f &other_min, const Vector2f &other_max) const;
+    };
+
+    // allocate space for up to max_polygons polygons; returns false
+    // on allocation failure
+    bool init(uint8_t max_polygons) WARN_IF_UNUSED;
+
+    // add a polygon of count points.  The polygon's index is the
+    // number of polygons added before it
+    void add(const Vector2f *points, uint8_t count);
+
+    // build the grid over the polygons added so far.  Returns false
+    // if the grid could not be allocated; queries still work
+    bool build();
+
+    // free all memory and forget all polygons
+    void clear();
+
+    uint8_t count() const { return _num_polygons; }
+    const Bounds &bounds(uint8_t index) const { return _polygons[index].bounds; }
+
+    // returns true if pos is inside any of the polygons
+    bool inside_any(const Vector2f &pos) const WARN_IF_UNUSED;
+
+    // returns true if pos is outside any of the polygons
+    bool outside_any(const Vector2f &pos) const WARN_IF_UNUSED;
+
+private:
+
+    class Polygon {
+    public:
+        const Vector2f *points;
+        Bounds bounds;
+        uint8_t count;
+    };
+    Polygon *_polygons = nullptr;
+    uint8_t _max_polygons = 0;
+    uint8_t _num_polygons = 0;
+
+    // bounds of all polygons
+    Bounds _extent;
+
+    // the grid.  The polygons whose bounding box overlaps cell c are
+    // _cell_polygons[_cell_start[c]] to _cell_polygons[_cell_start[c+1]-1]
+    uint16_t *_cell_start = nullptr;
+    uint8_t *_cell_polygons = nullptr;
+    uint8_t _cells_x;
+    uint8_t _cells_y;
+    Vector2f _cell_scale;  // cells per unit distance
+
+    // cell column/row of a position, clamped to the grid
+    uint8_t cell_x(float x) const;
+    uint8_t cell_y(float y) const;
+
+    bool polygon_contains(const Polygon &polygon, const Vector2f &pos) const;
+};
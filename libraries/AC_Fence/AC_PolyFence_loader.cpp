@@ -211,19 +211,14 @@ bool AC_PolyFence_loader::breached(const Vector2f& pos_cm) const
     }
 
     // check we are inside each inclusion zone:
-    for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
-        const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
-        if (Polygon_outside(pos_cm, boundary.points, boundary.count)) {
-            return true;
-        }
+    if (_inclusion_grid.outside_any(pos_cm)) {
+        return true;
     }
 
-    // check we are outside each exclusion zone:
-    for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
-        const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
-        if (!Polygon_outside(pos_cm, boundary.points, boundary.count)) {
-            return true;
-        }
+    // check we are outside each exclusion zone; the grid only tests
+    // the zones whose bounding box contains pos_cm:
+    if (_exclusion_grid.inside_any(pos_cm)) {
+        return true;
     }
 
     // check circular excludes
@@ -548,10 +543,12 @@ void AC_PolyFence_loader::unload()
     delete[] _loaded_inclusion_boundary;
     _loaded_inclusion_boundary = nullptr;
     _num_loaded_inclusion_boundaries = 0;
+    _inclusion_grid.clear();
 
     delete[] _loaded_exclusion_boundary;
     _loaded_exclusion_boundary = nullptr;
     _num_loaded_exclusion_boundaries = 0;
+    _exclusion_grid.clear();
 
     delete[] _loaded_circle_inclusion_boundary;
     _loaded_circle_inclusion_boundary = nullptr;
@@ -652,7 +649,8 @@ bool AC_PolyFence_loader::load_from_eeprom()
         Debug("Fence: Allocating %u bytes for inc. fences",
               (unsigned)(count * sizeof(InclusionBoundary)));
         _loaded_inclusion_boundary = new InclusionBoundary[count];
-        if (_loaded_inclusion_boundary == nullptr) {
+        if (_loaded_inclusion_boundary == nullptr ||
+            !_inclusion_grid.init(count)) {
             unload();
             get_loaded_fence_semaphore().give();
             return false;
@@ -664,7 +662,8 @@ bool AC_PolyFence_loader::load_from_eeprom()
         Debug("Fence: Allocating %u bytes for exc. fences",
               (unsigned)(count * sizeof(ExclusionBoundary)));
         _loaded_exclusion_boundary = new ExclusionBoundary[count];
-        if (_loaded_exclusion_boundary == nullptr) {
+        if (_loaded_exclusion_boundary == nullptr ||
+            !_exclusion_grid.init(count)) {
             unload();
             get_loaded_fence_semaphore().give();
             return false;
@@ -729,6 +728,7 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 storage_valid = false;
                 break;
             }
+            _inclusion_grid.add(boundary.points, boundary.count);
             _num_loaded_inclusion_boundaries++;
             break;
         }
@@ -747,6 +747,7 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 storage_valid = false;
                 break;
             }
+            _exclusion_grid.add(boundary.points, boundary.count);
             _num_loaded_exclusion_boundaries++;
             break;
         }
@@ -807,6 +808,12 @@ bool AC_PolyFence_loader::load_from_eeprom()
         return false;
     }
 
+    // a failure to allocate the grid only slows down breach checks,
+    // so is not fatal
+    if (!_exclusion_grid.build()) {
+        Debug("Fence: exclusion grid not built");
+    }
+
     _load_time_ms = AP_HAL::millis();
 
     get_loaded_fence_semaphore().give();
@@ -827,6 +834,18 @@ Vector2f* AC_PolyFence_loader::get_exclusion_polygon(uint16_t index, uint16_t &n
     return boundary.points;
 }
 
+/// returns the bounding box of the specified exclusion polygon, offsets in cm from EKF origin in NE frame
+bool AC_PolyFence_loader::get_exclusion_polygon_bounds(uint16_t index, Vector2f &min_cm, Vector2f &max_cm) const
+{
+    if (index >= _exclusion_grid.count()) {
+        return false;
+    }
+    const AC_PolyFence_grid::Bounds &bounds = _exclusion_grid.bounds(index);
+    min_cm = bounds.min;
+    max_cm = bounds.max;
+    return true;
+}
+
 /// returns pointer to array of inclusion polygon points and num_points is filled in with the number of points in the polygon
 /// points are offsets in cm from EKF origin in NE frame
 Vector2f* AC_PolyFence_loader::get_inclusion_polygon(uint16_t index, uint16_t &num_points) const
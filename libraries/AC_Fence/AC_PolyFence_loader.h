@@ -5,6 +5,8 @@
 #include <AP_Math/AP_Math.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 
+#include "AC_PolyFence_grid.h"
+
 #define AC_POLYFENCE_FENCE_POINT_PROTOCOL_SUPPORT 1
 
 enum class AC_PolyFenceType {
@@ -59,6 +61,10 @@ public:
     /// points are offsets in cm from EKF origin in NE frame
     Vector2f* get_exclusion_polygon(uint16_t index, uint16_t &num_points) const;
 
+    /// fills in the bounding box of the specified exclusion polygon, offsets in cm from EKF origin in NE frame
+    /// returns false if the polygon does not exist
+    bool get_exclusion_polygon_bounds(uint16_t index, Vector2f &min_cm, Vector2f &max_cm) const WARN_IF_UNUSED;
+
     /// return system time of last update to the exclusion polygon points
     uint32_t get_exclusion_polygon_update_ms() const {
         return _load_time_ms;
@@ -264,6 +270,11 @@ private:
     ExclusionBoundary *_loaded_exclusion_boundary;
     uint8_t _num_loaded_exclusion_boundaries;
 
+    // bounding boxes of the loaded polygons, with a grid over the
+    // exclusion polygons for breach checks
+    AC_PolyFence_grid _inclusion_grid;
+    AC_PolyFence_grid _exclusion_grid;
+
     // _loaded_offsets_from_origin - stores x/y offset-from-origin
     // coordinate pairs.  Various items store their locations in this
     // allocation - the polygon boundaries and the return point, for
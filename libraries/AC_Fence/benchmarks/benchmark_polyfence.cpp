@@ -0,0 +1,198 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AC_Fence/AC_PolyFence_grid.h>
+
+/*
+  fence checks against randomly generated sets of exclusion polygons,
+  as for a survey area with many no-fly zones: irregular polygons of
+  4 to 12 points scattered over a 5km square.  Breach checks and
+  BendyRuler style path margins are run both as they were originally
+  written (every polygon tested) and using AC_PolyFence_grid
+ */
+
+#define AREA_CM          500000.0f
+#define MAX_ZONES        200
+#define MAX_ZONE_POINTS  12
+#define NUM_QUERIES      256
+#define PROBE_LENGTH_CM  1500.0f
+#define FENCE_MARGIN     2.0f
+
+static uint32_t rand_state;
+
+static float rand_float(float min, float max)
+{
+    rand_state = rand_state * 1664525U + 1013904223U;
+    return min + (max - min) * ((rand_state >> 8) * (1.0f / (1U<<24)));
+}
+
+struct RandomFence {
+    uint8_t num_zones;
+    Vector2f points[MAX_ZONES][MAX_ZONE_POINTS];
+    uint8_t num_points[MAX_ZONES];
+    Vector2f query[NUM_QUERIES];
+    Vector2f probe_end[NUM_QUERIES];
+    AC_PolyFence_grid grid;
+
+    void init(uint8_t zones) {
+        rand_state = 1;
+        num_zones = zones;
+        for (uint8_t z=0; z<num_zones; z++) {
+            // a star-shaped polygon with random radius at each vertex
+            const Vector2f centre(rand_float(0, AREA_CM), rand_float(0, AREA_CM));
+            const float radius = rand_float(2000, 15000);
+            num_points[z] = 4 + uint8_t(rand_float(0, MAX_ZONE_POINTS - 4 + 0.99f));
+            for (uint8_t p=0; p<num_points[z]; p++) {
+                const float angle = M_2PI * p / num_points[z];
+                points[z][p] = centre + Vector2f(cosf(angle), sinf(angle)) * radius * rand_float(0.5f, 1.0f);
+            }
+        }
+        for (uint16_t q=0; q<NUM_QUERIES; q++) {
+            query[q] = Vector2f(rand_float(0, AREA_CM), rand_float(0, AREA_CM));
+            const float bearing = rand_float(0, M_2PI);
+            probe_end[q] = query[q] + Vector2f(cosf(bearing), sinf(bearing)) * PROBE_LENGTH_CM;
+        }
+        build_grid();
+    }
+
+    void build_grid() {
+        if (!grid.init(num_zones)) {
+            return;
+        }
+        for (uint8_t z=0; z<num_zones; z++) {
+            grid.add(points[z], num_points[z]);
+        }
+        grid.build();
+    }
+};
+
+static RandomFence fence;
+
+// breach check as originally written
+static bool breached_all(const Vector2f &pos)
+{
+    for (uint8_t z=0; z<fence.num_zones; z++) {
+        if (!Polygon_outside(pos, fence.points[z], fence.num_points[z])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// path margin as originally calculated by BendyRuler
+static float margin_all(const Vector2f &start, const Vector2f &end)
+{
+    float margin = FLT_MAX;
+    for (uint8_t z=0; z<fence.num_zones; z++) {
+        const float sign = Polygon_outside(start, fence.points[z], fence.num_points[z]) ? 1.0f : -1.0f;
+        const float margin_new = (sign * Polygon_closest_distance_line(fence.points[z], fence.num_points[z], start, end) * 0.01f) - FENCE_MARGIN;
+        margin = MIN(margin, margin_new);
+    }
+    return margin;
+}
+
+// path margin skipping polygons whose bounds are too far away
+static float margin_bounds(const Vector2f &start, const Vector2f &end)
+{
+    const Vector2f path_min(MIN(start.x, end.x), MIN(start.y, end.y));
+    const Vector2f path_max(MAX(start.x, end.x), MAX(start.y, end.y));
+    float margin = FLT_MAX;
+    for (uint8_t z=0; z<fence.num_zones; z++) {
+        const float gap_cm = fence.grid.bounds(z).gap(path_min, path_max) - 1.0f;
+        if (gap_cm > 0 && (gap_cm * 0.01f - FENCE_MARGIN > margin)) {
+            continue;
+        }
+        const float sign = Polygon_outside(start, fence.points[z], fence.num_points[z]) ? 1.0f : -1.0f;
+        const float margin_new = (sign * Polygon_closest_distance_line(fence.points[z], fence.num_points[z], start, end) * 0.01f) - FENCE_MARGIN;
+        margin = MIN(margin, margin_new);
+    }
+    return margin;
+}
+
+static bool results_match()
+{
+    for (uint16_t q=0; q<NUM_QUERIES; q++) {
+        if (breached_all(fence.query[q]) != fence.grid.inside_any(fence.query[q])) {
+            return false;
+        }
+        if (margin_all(fence.query[q], fence.probe_end[q]) != margin_bounds(fence.query[q], fence.probe_end[q])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void BM_PolyFenceGridBuild(benchmark::State& state)
+{
+    fence.init(state.range(0));
+
+    while (state.KeepRunning()) {
+        fence.build_grid();
+        gbenchmark_escape(&fence.grid);
+    }
+}
+
+static void BM_PolyFenceBreachAll(benchmark::State& state)
+{
+    fence.init(state.range(0));
+
+    uint16_t q = 0;
+    while (state.KeepRunning()) {
+        bool breached = breached_all(fence.query[q]);
+        gbenchmark_escape(&breached);
+        q = (q + 1) % NUM_QUERIES;
+    }
+}
+
+static void BM_PolyFenceBreachGrid(benchmark::State& state)
+{
+    fence.init(state.range(0));
+    if (!results_match()) {
+        state.SkipWithError("results differ");
+        return;
+    }
+
+    uint16_t q = 0;
+    while (state.KeepRunning()) {
+        bool breached = fence.grid.inside_any(fence.query[q]);
+        gbenchmark_escape(&breached);
+        q = (q + 1) % NUM_QUERIES;
+    }
+}
+
+static void BM_PolyFenceMarginAll(benchmark::State& state)
+{
+    fence.init(state.range(0));
+
+    uint16_t q = 0;
+    while (state.KeepRunning()) {
+        float margin = margin_all(fence.query[q], fence.probe_end[q]);
+        gbenchmark_escape(&margin);
+        q = (q + 1) % NUM_QUERIES;
+    }
+}
+
+static void BM_PolyFenceMarginBounds(benchmark::State& state)
+{
+    fence.init(state.range(0));
+    if (!results_match()) {
+        state.SkipWithError("results differ");
+        return;
+    }
+
+    uint16_t q = 0;
+    while (state.KeepRunning()) {
+        float margin = margin_bounds(fence.query[q], fence.probe_end[q]);
+        gbenchmark_escape(&margin);
+        q = (q + 1) % NUM_QUERIES;
+    }
+}
+
+// 10 to 200 exclusion zones
+BENCHMARK(BM_PolyFenceGridBuild)->Arg(10)->Arg(50)->Arg(MAX_ZONES);
+BENCHMARK(BM_PolyFenceBreachAll)->Arg(10)->Arg(50)->Arg(MAX_ZONES);
+BENCHMARK(BM_PolyFenceBreachGrid)->Arg(10)->Arg(50)->Arg(MAX_ZONES);
+BENCHMARK(BM_PolyFenceMarginAll)->Arg(10)->Arg(50)->Arg(MAX_ZONES);
+BENCHMARK(BM_PolyFenceMarginBounds)->Arg(10)->Arg(50)->Arg(MAX_ZONES);
+
+BENCHMARK_MAIN()
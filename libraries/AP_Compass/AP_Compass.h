@@ -353,6 +353,13 @@ private:
     bool _start_calibration_mask(uint8_t mask, bool retry=false, bool autosave=false, float delay_sec=0.0f, bool autoreboot=false);
     bool _auto_reboot() { return _compass_cal_autoreboot; }
 
+#if COMPASS_CAL_ENABLED
+    // the calibrators' fits run on their own thread
+    bool _start_calibration_thread();
+    void _update_calibration_thread();
+    bool _cal_thread_started;
+#endif
+
     // see if we already have probed a i2c driver by bus number and address
     bool _have_i2c_driver(uint8_t bus_num, uint8_t address) const;
 
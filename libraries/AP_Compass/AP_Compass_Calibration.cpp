@@ -20,9 +20,7 @@ void Compass::cal_update()
     bool running = false;
 
     for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
-        bool failure;
-        _calibrator[i].update(failure);
-        if (failure) {
+        if (_calibrator[i].check_for_failure()) {
             AP_Notify::events.compass_cal_failed = 1;
         }
 
@@ -49,6 +47,41 @@ void Compass::cal_update()
     }
 }
 
+/*
+  the fits are run on a low priority thread so they only use spare
+  CPU, rather than holding up the main loop
+ */
+bool Compass::_start_calibration_thread()
+{
+    if (_cal_thread_started) {
+        return true;
+    }
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&Compass::_update_calibration_thread, void),
+                                      "compasscal",
+                                      4096, AP_HAL::Scheduler::PRIORITY_IO, -1)) {
+        return false;
+    }
+    _cal_thread_started = true;
+    return true;
+}
+
+void Compass::_update_calibration_thread()
+{
+    while (true) {
+        bool busy = false;
+        if (!hal.util->get_soft_armed()) {
+            for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
+                if (_calibrator[i].update()) {
+                    busy = true;
+                }
+            }
+        }
+        // each update() does a slice of a fit, so come back soon while
+        // fitting and let other threads run in between
+        hal.scheduler->delay(busy ? 1 : 20);
+    }
+}
+
 bool Compass::_start_calibration(uint8_t i, bool retry, float delay)
 {
     if (!healthy(i)) {
@@ -80,6 +113,10 @@ bool Compass::_start_calibration(uint8_t i, bool retry, float delay)
             _calibrator[i].set_orientation(r, _state[i].external, _rotate_auto>=2);
         }
     }
+    if (!_start_calibration_thread()) {
+        gcs().send_text(MAV_SEVERITY_ERROR, "Compass cal thread failed to start");
+        return false;
+    }
     _cal_saved[i] = false;
     _calibrator[i].start(retry, delay, get_offsets_max(), i);
 
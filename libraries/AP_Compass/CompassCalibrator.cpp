@@ -55,6 +55,12 @@
  *
  * The fitting algorithm used is Levenberg-Marquardt. See also:
  * http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm
+ *
+ * Samples arrive through new_sample() from the compass drivers, and the
+ * fits are run by update() on the compass calibration thread. Each call
+ * to update() accumulates the sums for a fit step over at most
+ * COMPASS_CAL_FIT_CHUNK samples, so the semaphore shared with the
+ * drivers and the GCS interface is only held briefly.
  */
 
 #include "CompassCalibrator.h"
@@ -75,16 +81,18 @@ extern const AP_HAL::HAL& hal;
 
 CompassCalibrator::CompassCalibrator()
 {
-    stop();
+    set_status(Status::NOT_STARTED);
 }
 
 void CompassCalibrator::stop()
 {
+    WITH_SEMAPHORE(_sem);
     set_status(Status::NOT_STARTED);
 }
 
 void CompassCalibrator::set_orientation(enum Rotation orientation, bool is_external, bool fix_orientation)
 {
+    WITH_SEMAPHORE(_sem);
     _check_orientation = true;
     _orientation = orientation;
     _orig_orientation = orientation;
@@ -94,6 +102,7 @@ void CompassCalibrator::set_orientation(enum Rotation orientation, bool is_exter
 
 void CompassCalibrator::start(bool retry, float delay, uint16_t offset_max, uint8_t compass_idx)
 {
+    WITH_SEMAPHORE(_sem);
     if (running()) {
         return;
     }
@@ -169,19 +178,43 @@ void CompassCalibrator::update_completion_mask()
 
 bool CompassCalibrator::check_for_timeout()
 {
+    // if the calibration thread has the semaphore it is fitting, and
+    // not waiting for samples
+    if (!_sem.take_nonblocking()) {
+        return false;
+    }
+    bool timed_out = false;
     uint32_t tnow = AP_HAL::millis();
     if (running() && tnow - _last_sample_ms > 1000) {
         _retry = false;
         set_status(Status::FAILED);
-        return true;
+        timed_out = true;
     }
-    return false;
+    _sem.give();
+    return timed_out;
+}
+
+bool CompassCalibrator::check_for_failure()
+{
+    if (!_sem.take_nonblocking()) {
+        return false;
+    }
+    const bool failed = _failed;
+    _failed = false;
+    _sem.give();
+    return failed;
 }
 
 void CompassCalibrator::new_sample(const Vector3f& sample)
 {
     _last_sample_ms = AP_HAL::millis();
 
+    // don't hold up the driver while the calibration thread is
+    // fitting, the sample buffer is full then
+    if (!_sem.take_nonblocking()) {
+        return;
+    }
+
     if (_status == Status::WAITING_TO_START) {
         set_status(Status::RUNNING_STEP_ONE);
     }
@@ -190,33 +223,39 @@ void CompassCalibrator::new_sample(const Vector3f& sample)
         update_completion_mask(sample);
         _sample_buffer[_samples_collected].set(sample);
         _sample_buffer[_samples_collected].att.set_from_ahrs();
+        index_insert(_samples_collected);
         _samples_collected++;
     }
+
+    _sem.give();
 }
 
-void CompassCalibrator::update(bool &failure)
+bool CompassCalibrator::update()
 {
-    failure = false;
+    WITH_SEMAPHORE(_sem);
 
     // collect the minimum number of samples
     if (!fitting()) {
-        return;
+        return false;
     }
 
     if (_status == Status::RUNNING_STEP_ONE) {
         if (_fit_step >= 10) {
             if (is_equal(_fitness, _initial_fitness) || isnan(_fitness)) {  // if true, means that fitness is diverging instead of converging
                 set_status(Status::FAILED);
-                failure = true;
+                _failed = true;
             } else {
                 set_status(Status::RUNNING_STEP_TWO);
             }
         } else {
-            if (_fit_step == 0) {
+            if (_fit_step == 0 &&
+                _fit_state->phase == FitState::Phase::ACCUMULATE &&
+                _fit_state->sample == 0) {
                 calc_initial_offset();
             }
-            run_sphere_fit();
-            _fit_step++;
+            if (run_sphere_fit()) {
+                _fit_step++;
+            }
         }
     } else if (_status == Status::RUNNING_STEP_TWO) {
         if (_fit_step >= 35) {
@@ -224,16 +263,19 @@ void CompassCalibrator::update(bool &failure)
                 set_status(Status::SUCCESS);
             } else {
                 set_status(Status::FAILED);
-                failure = true;
+                _failed = true;
             }
         } else if (_fit_step < 15) {
-            run_sphere_fit();
-            _fit_step++;
+            if (run_sphere_fit()) {
+                _fit_step++;
+            }
         } else {
-            run_ellipsoid_fit();
-            _fit_step++;
+            if (run_ellipsoid_fit()) {
+                _fit_step++;
+            }
         }
     }
+    return true;
 }
 
 /////////////////////////////////////////////////////////////
@@ -261,6 +303,10 @@ void CompassCalibrator::initialize_fit()
     _sphere_lambda = 1.0f;
     _ellipsoid_lambda = 1.0f;
     _fit_step = 0;
+    if (_fit_state != nullptr) {
+        _fit_state->phase = FitState::Phase::ACCUMULATE;
+        _fit_state->sample = 0;
+    }
 }
 
 void CompassCalibrator::reset_state()
@@ -274,9 +320,36 @@ void CompassCalibrator::reset_state()
     _params.scale_factor = 0;
 
     memset(_completion_mask, 0, sizeof(_completion_mask));
+    if (_sample_index != nullptr) {
+        memset(_sample_index->head, 0, sizeof(_sample_index->head));
+    }
     initialize_fit();
 }
 
+bool CompassCalibrator::allocate_buffers()
+{
+    if (_sample_buffer == nullptr) {
+        _sample_buffer = (CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassSample));
+    }
+    if (_sample_index == nullptr) {
+        _sample_index = (SampleIndex*)calloc(1, sizeof(SampleIndex));
+    }
+    if (_fit_state == nullptr) {
+        _fit_state = (FitState*)calloc(1, sizeof(FitState));
+    }
+    return _sample_buffer != nullptr && _sample_index != nullptr && _fit_state != nullptr;
+}
+
+void CompassCalibrator::free_buffers()
+{
+    free(_sample_buffer);
+    _sample_buffer = nullptr;
+    free(_sample_index);
+    _sample_index = nullptr;
+    free(_fit_state);
+    _fit_state = nullptr;
+}
+
 bool CompassCalibrator::set_status(CompassCalibrator::Status status)
 {
     if (status != Status::NOT_STARTED && _status == status) {
@@ -287,10 +360,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
         case Status::NOT_STARTED:
             reset_state();
             _status = Status::NOT_STARTED;
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_buffers();
             return true;
 
         case Status::WAITING_TO_START:
@@ -309,10 +379,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 return false;
             }
 
-            if (_sample_buffer == nullptr) {
-                _sample_buffer = (CompassSample*)calloc(COMPASS_CAL_NUM_SAMPLES, sizeof(CompassSample));
-            }
-            if (_sample_buffer != nullptr) {
+            if (allocate_buffers()) {
                 initialize_fit();
                 _status = Status::RUNNING_STEP_ONE;
                 return true;
@@ -333,10 +400,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 return false;
             }
 
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_buffers();
 
             _status = Status::SUCCESS;
             return true;
@@ -360,10 +424,7 @@ bool CompassCalibrator::set_status(CompassCalibrator::Status status)
                 return true;
             }
 
-            if (_sample_buffer != nullptr) {
-                free(_sample_buffer);
-                _sample_buffer = nullptr;
-            }
+            free_buffers();
 
             _status = status;
             return true;
@@ -393,7 +454,7 @@ bool CompassCalibrator::fit_acceptable()
 
 void CompassCalibrator::thin_samples()
 {
-    if (_sample_buffer == nullptr) {
+    if (_sample_buffer == nullptr || _sample_index == nullptr) {
         return;
     }
 
@@ -406,11 +467,18 @@ void CompassCalibrator::thin_samples()
         _sample_buffer[i] = _sample_buffer[j];
         _sample_buffer[j] = temp;
     }
+    index_rebuild(_sample_index->cell_size);
 
     // remove any samples that are close together
     for (uint16_t i=0; i < _samples_collected; i++) {
         if (!accept_sample(_sample_buffer[i], i)) {
-            _sample_buffer[i] = _sample_buffer[_samples_collected-1];
+            const uint16_t last = _samples_collected-1;
+            index_remove(i);
+            if (i != last) {
+                index_remove(last);
+                _sample_buffer[i] = _sample_buffer[last];
+                index_insert(i);
+            }
             _samples_collected--;
             _samples_thinned++;
         }
@@ -441,17 +509,61 @@ bool CompassCalibrator::accept_sample(const Vector3f& sample, uint16_t skip_inde
     static const float a = (4.0f * M_PI / (3.0f * faces)) + M_PI / 3.0f;
     static const float theta = 0.5f * acosf(cosf(a) / (1.0f - cosf(a)));
 
-    if (_sample_buffer == nullptr) {
+    if (_sample_buffer == nullptr || _sample_index == nullptr) {
         return false;
     }
 
     float min_distance = _params.radius * 2*sinf(theta/2);
 
-    for (uint16_t i = 0; i<_samples_collected; i++) {
-        if (i != skip_index) {
-            float distance = (sample - _sample_buffer[i].get()).length();
-            if (distance < min_distance) {
-                return false;
+    if (!(min_distance >= 1.0f)) {
+        // a diverged fit, check every sample rather than use cells
+        // that are too small to index
+        for (uint16_t i = 0; i<_samples_collected; i++) {
+            if (i != skip_index) {
+                float distance = (sample - _sample_buffer[i].get()).length();
+                if (distance < min_distance) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // the cell size follows the radius, which changes as the fit runs
+    const float cell_size = 2.5f * min_distance;
+    if (!is_equal(cell_size, _sample_index->cell_size)) {
+        index_rebuild(cell_size);
+    }
+
+    // the cube of side 2*min_distance around the sample spans at most
+    // two cells on each axis
+    const int32_t x0 = floorf((sample.x - min_distance) / cell_size);
+    const int32_t y0 = floorf((sample.y - min_distance) / cell_size);
+    const int32_t z0 = floorf((sample.z - min_distance) / cell_size);
+
+    uint8_t searched[8];
+    uint8_t num_searched = 0;
+    for (uint8_t c = 0; c < 8; c++) {
+        const uint8_t bucket = index_bucket(x0 + (c & 1), y0 + ((c >> 1) & 1), z0 + ((c >> 2) & 1));
+        bool seen = false;
+        for (uint8_t k = 0; k < num_searched; k++) {
+            if (searched[k] == bucket) {
+                seen = true;
+                break;
+            }
+        }
+        if (seen) {
+            continue;
+        }
+        searched[num_searched++] = bucket;
+
+        for (uint16_t j = _sample_index->head[bucket]; j != 0; j = _sample_index->next[j-1]) {
+            const uint16_t i = j - 1;
+            if (i != skip_index) {
+                float distance = (sample - _sample_buffer[i].get()).length();
+                if (distance < min_distance) {
+                    return false;
+                }
             }
         }
     }
@@ -463,6 +575,54 @@ bool CompassCalibrator::accept_sample(const CompassSample& sample, uint16_t skip
     return accept_sample(sample.get(), skip_index);
 }
 
+uint8_t CompassCalibrator::index_bucket(int32_t x, int32_t y, int32_t z) const
+{
+    // spread neighbouring cells over the buckets
+    const uint32_t h = (uint32_t(x) * 73856093U) ^ (uint32_t(y) * 19349663U) ^ (uint32_t(z) * 83492791U);
+    return h % COMPASS_CAL_INDEX_BUCKETS;
+}
+
+uint8_t CompassCalibrator::index_bucket(const Vector3f &sample) const
+{
+    const float cell_size = _sample_index->cell_size;
+    return index_bucket(floorf(sample.x / cell_size), floorf(sample.y / cell_size), floorf(sample.z / cell_size));
+}
+
+void CompassCalibrator::index_insert(uint16_t i)
+{
+    if (!(_sample_index->cell_size >= 1.0f)) {
+        // not indexing, see accept_sample()
+        return;
+    }
+    const uint8_t bucket = index_bucket(_sample_buffer[i].get());
+    _sample_index->next[i] = _sample_index->head[bucket];
+    _sample_index->head[bucket] = i + 1;
+}
+
+void CompassCalibrator::index_remove(uint16_t i)
+{
+    if (!(_sample_index->cell_size >= 1.0f)) {
+        return;
+    }
+    uint16_t *link = &_sample_index->head[index_bucket(_sample_buffer[i].get())];
+    while (*link != 0) {
+        if (*link == i + 1) {
+            *link = _sample_index->next[i];
+            return;
+        }
+        link = &_sample_index->next[*link - 1];
+    }
+}
+
+void CompassCalibrator::index_rebuild(float cell_size)
+{
+    _sample_index->cell_size = cell_size;
+    memset(_sample_index->head, 0, sizeof(_sample_index->head));
+    for (uint16_t i = 0; i < _samples_collected; i++) {
+        index_insert(i);
+    }
+}
+
 float CompassCalibrator::calc_residual(const Vector3f& sample, const param_t& params) const
 {
     Matrix3f softiron(
@@ -524,93 +684,6 @@ void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t&
     ret[3] = -1.0f * (((offdiag.y * A) + (offdiag.z * B) + (diag.z    * C))/length);
 }
 
-// run sphere fit to calculate diagonals and offdiagonals
-void CompassCalibrator::run_sphere_fit()
-{
-    if (_sample_buffer == nullptr) {
-        return;
-    }
-
-    const float lma_damping = 10.0f;
-
-    // take backup of fitness and parameters so we can determine later if this fit has improved the calibration
-    float fitness = _fitness;
-    float fit1, fit2;
-    param_t fit1_params, fit2_params;
-    fit1_params = fit2_params = _params;
-
-    float JTJ[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_SPHERE_PARAMS*COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_SPHERE_PARAMS] = { };
-
-    // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
-
-        float sphere_jacob[COMPASS_CAL_NUM_SPHERE_PARAMS];
-
-        calc_sphere_jacob(sample, fit1_params, sphere_jacob);
-
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
-                JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
-            }
-            // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
-        }
-    }
-
-    //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
-    // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
-    for (uint8_t i = 0; i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+i] += _sphere_lambda/lma_damping;
-    }
-
-    if (!inverse(JTJ, JTJ, 4)) {
-        return;
-    }
-
-    if (!inverse(JTJ2, JTJ2, 4)) {
-        return;
-    }
-
-    // extract radius, offset, diagonals and offdiagonal parameters
-    for (uint8_t row=0; row < COMPASS_CAL_NUM_SPHERE_PARAMS; row++) {
-        for (uint8_t col=0; col < COMPASS_CAL_NUM_SPHERE_PARAMS; col++) {
-            fit1_params.get_sphere_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-            fit2_params.get_sphere_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_SPHERE_PARAMS+col];
-        }
-    }
-
-    // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
-
-    // decide which of the two sets of parameters is best and store in fit1_params
-    if (fit1 > _fitness && fit2 > _fitness) {
-        // if neither set of parameters provided better results, increase lambda
-        _sphere_lambda *= lma_damping;
-    } else if (fit2 < _fitness && fit2 < fit1) {
-        // if fit2 was better we will use it. decrease lambda
-        _sphere_lambda /= lma_damping;
-        fit1_params = fit2_params;
-        fitness = fit2;
-    } else if (fit1 < _fitness) {
-        fitness = fit1;
-    }
-    //--------------------Levenberg-Marquardt-part-ends-here--------------------------------//
-
-    // store new parameters and update fitness
-    if (!isnan(fitness) && fitness < _fitness) {
-        _fitness = fitness;
-        _params = fit1_params;
-        update_completion_mask();
-    }
-}
-
 void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const
 {
     const Vector3f &offset = params.offset;
@@ -641,90 +714,136 @@ void CompassCalibrator::calc_ellipsoid_jacob(const Vector3f& sample, const param
     ret[8] = -1.0f * (((sample.z + offset.z) * B) + ((sample.y + offset.y) * C))/length;
 }
 
-void CompassCalibrator::run_ellipsoid_fit()
+/*
+  run a step of the sphere or ellipsoid fit. The sums over the samples
+  are accumulated COMPASS_CAL_FIT_CHUNK samples at a time, for JTJ and
+  JTFI first, then for the fitness of the two candidate sets of
+  parameters. Returns true once the step is complete
+ */
+bool CompassCalibrator::run_fit(bool ellipsoid)
 {
-    if (_sample_buffer == nullptr) {
-        return;
+    if (_sample_buffer == nullptr || _fit_state == nullptr) {
+        return true;
     }
 
     const float lma_damping = 10.0f;
+    const uint8_t num_params = ellipsoid ? COMPASS_CAL_NUM_ELLIPSOID_PARAMS : COMPASS_CAL_NUM_SPHERE_PARAMS;
+    FitState &fit = *_fit_state;
+    const uint16_t end = MIN(fit.sample + COMPASS_CAL_FIT_CHUNK, _samples_collected);
+
+    if (fit.phase == FitState::Phase::ACCUMULATE) {
+        if (fit.sample == 0) {
+            memset(fit.JTJ, 0, sizeof(fit.JTJ));
+            memset(fit.JTFI, 0, sizeof(fit.JTFI));
+            fit.fit1_params = fit.fit2_params = _params;
+        }
 
-    // take backup of fitness and parameters so we can determine later if this fit has improved the calibration
-    float fitness = _fitness;
-    float fit1, fit2;
-    param_t fit1_params, fit2_params;
-    fit1_params = fit2_params = _params;
-
-    float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
-    float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS] = { };
+        // Gauss Newton Part common for all kind of extensions including LM
+        for (uint16_t k = fit.sample; k < end; k++) {
+            Vector3f sample = _sample_buffer[k].get();
 
-    // Gauss Newton Part common for all kind of extensions including LM
-    for (uint16_t k = 0; k<_samples_collected; k++) {
-        Vector3f sample = _sample_buffer[k].get();
+            float jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+            if (ellipsoid) {
+                calc_ellipsoid_jacob(sample, fit.fit1_params, jacob);
+            } else {
+                calc_sphere_jacob(sample, fit.fit1_params, jacob);
+            }
+            const float residual = calc_residual(sample, fit.fit1_params);
+
+            for (uint8_t i = 0; i < num_params; i++) {
+                // compute the upper triangle of JTJ, it is symmetric
+                for (uint8_t j = i; j < num_params; j++) {
+                    fit.JTJ[i*num_params+j] += jacob[i] * jacob[j];
+                }
+                // compute JTFI
+                fit.JTFI[i] += jacob[i] * residual;
+            }
+        }
+        fit.sample = end;
+        if (fit.sample < _samples_collected) {
+            return false;
+        }
 
-        float ellipsoid_jacob[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
+        // refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
+        float *JTJ = fit.JTJ;
+        float JTJ2[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        const float lambda = ellipsoid ? _ellipsoid_lambda : _sphere_lambda;
+        for (uint8_t i = 0; i < num_params; i++) {
+            for (uint8_t j = 0; j < i; j++) {
+                JTJ[i*num_params+j] = JTJ[j*num_params+i];
+            }
+        }
+        memcpy(JTJ2, JTJ, sizeof(float)*num_params*num_params);   // a backup JTJ for LM
+        for (uint8_t i = 0; i < num_params; i++) {
+            JTJ[i*num_params+i] += lambda;
+            JTJ2[i*num_params+i] += lambda/lma_damping;
+        }
 
-        calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
+        fit.sample = 0;
+        if (!inverse(JTJ, JTJ, num_params) || !inverse(JTJ2, JTJ2, num_params)) {
+            return true;
+        }
 
-        for (uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for (uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
+        // extract radius, offset, diagonals and offdiagonal parameters
+        float *fit1 = ellipsoid ? fit.fit1_params.get_ellipsoid_params() : fit.fit1_params.get_sphere_params();
+        float *fit2 = ellipsoid ? fit.fit2_params.get_ellipsoid_params() : fit.fit2_params.get_sphere_params();
+        for (uint8_t row=0; row < num_params; row++) {
+            for (uint8_t col=0; col < num_params; col++) {
+                fit1[row] -= fit.JTFI[col] * JTJ[row*num_params+col];
+                fit2[row] -= fit.JTFI[col] * JTJ2[row*num_params+col];
             }
-            // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
         }
-    }
 
-    //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
-    //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
-    for (uint8_t i = 0; i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-        JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda;
-        JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i] += _ellipsoid_lambda/lma_damping;
+        fit.phase = FitState::Phase::EVALUATE;
+        fit.fit1 = 0;
+        fit.fit2 = 0;
+        return false;
     }
 
-    if (!inverse(JTJ, JTJ, 9)) {
-        return;
+    // calculate fitness of two possible sets of parameters
+    for (uint16_t k = fit.sample; k < end; k++) {
+        Vector3f sample = _sample_buffer[k].get();
+        fit.fit1 += sq(calc_residual(sample, fit.fit1_params));
+        fit.fit2 += sq(calc_residual(sample, fit.fit2_params));
     }
-
-    if (!inverse(JTJ2, JTJ2, 9)) {
-        return;
+    fit.sample = end;
+    if (fit.sample < _samples_collected) {
+        return false;
     }
+    fit.phase = FitState::Phase::ACCUMULATE;
+    fit.sample = 0;
 
-    // extract radius, offset, diagonals and offdiagonal parameters
-    for (uint8_t row=0; row < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; row++) {
-        for (uint8_t col=0; col < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; col++) {
-            fit1_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
-            fit2_params.get_ellipsoid_params()[row] -= JTFI[col] * JTJ2[row*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+col];
-        }
+    float fitness = _fitness;
+    float fit1 = 1.0e30f;
+    float fit2 = 1.0e30f;
+    if (_samples_collected != 0) {
+        fit1 = fit.fit1 / _samples_collected;
+        fit2 = fit.fit2 / _samples_collected;
     }
 
-    // calculate fitness of two possible sets of parameters
-    fit1 = calc_mean_squared_residuals(fit1_params);
-    fit2 = calc_mean_squared_residuals(fit2_params);
-
     // decide which of the two sets of parameters is best and store in fit1_params
+    float &lambda = ellipsoid ? _ellipsoid_lambda : _sphere_lambda;
     if (fit1 > _fitness && fit2 > _fitness) {
         // if neither set of parameters provided better results, increase lambda
-        _ellipsoid_lambda *= lma_damping;
+        lambda *= lma_damping;
     } else if (fit2 < _fitness && fit2 < fit1) {
         // if fit2 was better we will use it. decrease lambda
-        _ellipsoid_lambda /= lma_damping;
-        fit1_params = fit2_params;
+        lambda /= lma_damping;
+        fit.fit1_params = fit.fit2_params;
         fitness = fit2;
     } else if (fit1 < _fitness) {
         fitness = fit1;
     }
-    //--------------------Levenberg-part-ends-here--------------------------------//
+    //--------------------Levenberg-Marquardt-part-ends-here--------------------------------//
 
     // store new parameters and update fitness
-    if (fitness < _fitness) {
+    if (!isnan(fitness) && fitness < _fitness) {
         _fitness = fitness;
-        _params = fit1_params;
+        _params = fit.fit1_params;
         update_completion_mask();
     }
+    return true;
 }
 
 
@@ -926,8 +1045,8 @@ bool CompassCalibrator::calculate_orientation(void)
     // re-run the fit to get the diagonals and off-diagonals for the
     // new orientation
     initialize_fit();
-    run_sphere_fit();
-    run_ellipsoid_fit();
+    while (!run_sphere_fit()) {}
+    while (!run_ellipsoid_fit()) {}
 
     return fit_acceptable();
 }
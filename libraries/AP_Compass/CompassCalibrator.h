@@ -1,10 +1,13 @@
 #pragma once
 
+#include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 
 #define COMPASS_CAL_NUM_SPHERE_PARAMS       4
 #define COMPASS_CAL_NUM_ELLIPSOID_PARAMS    9
 #define COMPASS_CAL_NUM_SAMPLES             300     // number of samples required before fitting begins
+#define COMPASS_CAL_FIT_CHUNK               50      // samples processed per call to update() while fitting
+#define COMPASS_CAL_INDEX_BUCKETS           128     // hash buckets in the sample index
 
 #define COMPASS_MIN_SCALE_FACTOR 0.85
 #define COMPASS_MAX_SCALE_FACTOR 1.3
@@ -23,12 +26,17 @@ public:
     void start(bool retry, float delay, uint16_t offset_max, uint8_t compass_idx);
     void stop();
 
-    // update the state machine and calculate offsets, diagonals and offdiagonals
-    void update(bool &failure);
+    // update the state machine and calculate offsets, diagonals and
+    // offdiagonals. Called from the calibration thread, and does a
+    // slice of the fit each call. Returns true if there is more to do
+    bool update();
     void new_sample(const Vector3f &sample);
 
     bool check_for_timeout();
 
+    // returns true once for each failed attempt since the last call
+    bool check_for_failure();
+
     // running is true if actively calculating offsets, diagonals or offdiagonals
     bool running() const;
 
@@ -112,6 +120,27 @@ private:
     // set status including any required initialisation
     bool set_status(Status status);
 
+    // allocate and free the sample buffer, index and fit state
+    bool allocate_buffers();
+    void free_buffers();
+
+    // spatial hash of the sample buffer, so that accept_sample() only
+    // compares a sample against those in the cells around it. Cells
+    // are cubes larger than twice the acceptance distance, so any
+    // sample that is too close lies in one of the eight cells covering
+    // the cube around the new sample. Chains hold sample index + 1 so
+    // zero is the end of a chain
+    struct SampleIndex {
+        float cell_size;
+        uint16_t head[COMPASS_CAL_INDEX_BUCKETS];
+        uint16_t next[COMPASS_CAL_NUM_SAMPLES];
+    };
+    uint8_t index_bucket(int32_t x, int32_t y, int32_t z) const;
+    uint8_t index_bucket(const Vector3f &sample) const;
+    void index_insert(uint16_t i);
+    void index_remove(uint16_t i);
+    void index_rebuild(float cell_size);
+
     // returns true if sample should be added to buffer
     bool accept_sample(const Vector3f &sample, uint16_t skip_index = UINT16_MAX);
     bool accept_sample(const CompassSample &sample, uint16_t skip_index = UINT16_MAX);
@@ -142,12 +171,35 @@ private:
     void calc_initial_offset();
 
     // run sphere fit to calculate diagonals and offdiagonals
+    // returns true when a step of the fit is complete
     void calc_sphere_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_sphere_fit();
+    bool run_sphere_fit() { return run_fit(false); }
 
     // run ellipsoid fit to calculate diagonals and offdiagonals
+    // returns true when a step of the fit is complete
     void calc_ellipsoid_jacob(const Vector3f& sample, const param_t& params, float* ret) const;
-    void run_ellipsoid_fit();
+    bool run_ellipsoid_fit() { return run_fit(true); }
+
+    // run one Levenberg-Marquardt step of the sphere or ellipsoid fit,
+    // COMPASS_CAL_FIT_CHUNK samples at a time
+    bool run_fit(bool ellipsoid);
+
+    // a fit step in progress. The sums over the samples for JTJ and
+    // JTFI, then for the fitness of the two candidate parameter sets,
+    // are accumulated over several calls
+    struct FitState {
+        enum class Phase : uint8_t {
+            ACCUMULATE,
+            EVALUATE,
+        } phase;
+        uint16_t sample;    // next sample to add to the sums
+        float JTJ[COMPASS_CAL_NUM_ELLIPSOID_PARAMS*COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        float JTFI[COMPASS_CAL_NUM_ELLIPSOID_PARAMS];
+        param_t fit1_params;
+        param_t fit2_params;
+        float fit1;         // sums of squared residuals
+        float fit2;
+    };
 
     // update the completion mask based on a single sample
     void update_completion_mask(const Vector3f& sample);
@@ -177,6 +229,8 @@ private:
     uint8_t _attempt;                       // number of attempts have been made to calibrate
     completion_mask_t _completion_mask;     // bitmask of directions in which we have samples
     CompassSample *_sample_buffer;          // buffer of sensor values
+    SampleIndex *_sample_index;             // spatial hash of _sample_buffer
+    FitState *_fit_state;                   // fit step in progress
     uint16_t _samples_collected;            // number of samples in buffer
     uint16_t _samples_thinned;              // number of samples removed by the thin_samples() call (called before step 2 begins)
 
@@ -195,4 +249,9 @@ private:
     bool _check_orientation;                // true if orientation should be automatically checked
     bool _fix_orientation;                  // true if orientation should be fixed if necessary
     float _orientation_confidence;          // measure of confidence in automatic orientation detection
+
+    // samples arrive from the compass drivers' threads, the fit runs on
+    // the calibration thread and the GCS interface is on the main thread
+    HAL_Semaphore _sem;
+    bool _failed;                           // an attempt failed since the last check_for_failure()
 };
@@ -0,0 +1,86 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_AHRS/AP_AHRS.h>
+#include <AP_Compass/CompassCalibrator.h>
+#include <AP_GPS/AP_GPS.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// the calibrator takes the attitude of each sample from the AHRS, and
+// the expected field strength from the GPS position if there is one
+static AP_AHRS_DCM ahrs;
+static AP_GPS gps;
+static GCS_Dummy _gcs;
+
+// static, so zeroed before construction as it is inside Compass
+static CompassCalibrator cal;
+
+static uint32_t noise_state = 12345;
+
+// deterministic noise in [-0.5, 0.5)
+static float noise()
+{
+    noise_state = noise_state * 1664525U + 1013904223U;
+    return ((noise_state >> 8) & 0xFFFF) / 65536.0f - 0.5f;
+}
+
+/*
+  feed the calibrator a fixed stream of samples of a 400mGauss field
+  seen by a tumbling vehicle through a soft iron matrix and an offset,
+  running the fit as far as it will go after each sample
+ */
+TEST(CompassCalibrator, FixedStream)
+{
+    const Vector3f field(230, -60, 320);
+    const Matrix3f soft_iron(Vector3f(1.05f, 0.02f, -0.03f),
+                             Vector3f(0.02f, 0.97f, 0.01f),
+                             Vector3f(-0.03f, 0.01f, 1.02f));
+    const Vector3f offset(-120, 85, 40);
+
+    cal.start(false, 0, 1000, 0);
+
+    for (uint32_t i=0; i<200000; i++) {
+        const float t = i * 0.01f;
+        Matrix3f rot;
+        rot.from_euler(t*1.3f, t*0.7f, t*2.1f);
+        Vector3f sample = soft_iron * (rot.transposed() * field) + offset;
+        sample += Vector3f(noise(), noise(), noise());
+        cal.new_sample(sample);
+        for (uint16_t n=0; n<5000 && cal.update(); n++) {
+        }
+        if (cal.get_status() == CompassCalibrator::Status::SUCCESS ||
+            cal.get_status() == CompassCalibrator::Status::FAILED) {
+            break;
+        }
+    }
+    ASSERT_EQ(CompassCalibrator::Status::SUCCESS, cal.get_status());
+
+    Vector3f offsets, diagonals, offdiagonals;
+    float scale_factor;
+    cal.get_calibration(offsets, diagonals, offdiagonals, scale_factor);
+
+    // the offsets cancel the applied offset
+    EXPECT_NEAR(-offset.x, offsets.x, 0.5f);
+    EXPECT_NEAR(-offset.y, offsets.y, 0.5f);
+    EXPECT_NEAR(-offset.z, offsets.z, 0.5f);
+
+    // results of the calibrator before samples were indexed and the
+    // fit was split into slices, for the same stream
+    EXPECT_FLOAT_EQ(120.033447f, offsets.x);
+    EXPECT_FLOAT_EQ(-85.0329132f, offsets.y);
+    EXPECT_FLOAT_EQ(-39.9972115f, offsets.z);
+    EXPECT_FLOAT_EQ(0.969406843f, diagonals.x);
+    EXPECT_FLOAT_EQ(1.04830587f, diagonals.y);
+    EXPECT_FLOAT_EQ(0.99748075f, diagonals.z);
+    EXPECT_FLOAT_EQ(-0.0203223173f, offdiagonals.x);
+    EXPECT_FLOAT_EQ(0.0285897646f, offdiagonals.y);
+    EXPECT_FLOAT_EQ(-0.0108089847f, offdiagonals.z);
+    EXPECT_FLOAT_EQ(0.278308213f, cal.get_fitness());
+
+    // no GPS, so no scale factor
+    EXPECT_FLOAT_EQ(0, scale_factor);
+}
+
+AP_GTEST_MAIN()
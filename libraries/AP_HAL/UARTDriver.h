@@ -48,6 +48,18 @@ public:
     // read from a locked port. If port is locked and key is not correct then 0 is returned
     virtual int16_t read_locked(uint32_t key) { return -1; }
     
+    /*
+      bulk reads. read_ptr() returns a pointer to the contiguous run of
+      received bytes at the front of the receive buffer and sets n to
+      its length. It returns nullptr if there is no data, or if the
+      driver does not support bulk reads, in which case use read().
+      The bytes stay in the buffer until read_advance() is called with
+      the number used. The pointer is not valid after read_advance()
+      or after anything that may reallocate the buffer, such as begin()
+     */
+    virtual const uint8_t *read_ptr(uint32_t &n) { n = 0; return nullptr; }
+    virtual bool read_advance(uint32_t n) { return false; }
+
     // control optional features
     virtual bool set_options(uint8_t options) { return options==0; }
     virtual uint8_t get_options(void) const { return 0; }
@@ -555,6 +555,35 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+const uint8_t *UARTDriver::read_ptr(uint32_t &n)
+{
+    n = 0;
+    if (lock_read_key != 0 || _uart_owner_thd != chThdGetSelfX()){
+        return nullptr;
+    }
+    if (!_initialised) {
+        return nullptr;
+    }
+    return _readbuf.readptr(n);
+}
+
+bool UARTDriver::read_advance(uint32_t n)
+{
+    if (lock_read_key != 0 || _uart_owner_thd != chThdGetSelfX()){
+        return false;
+    }
+    if (!_initialised) {
+        return false;
+    }
+    if (!_readbuf.advance(n)) {
+        return false;
+    }
+    if (!_rts_is_active) {
+        update_rts_line();
+    }
+    return true;
+}
+
 int16_t UARTDriver::read_locked(uint32_t key)
 {
     if (lock_read_key != 0 && key != lock_read_key) {
@@ -44,6 +44,8 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    const uint8_t *read_ptr(uint32_t &n) override;
+    bool read_advance(uint32_t n) override;
     int16_t read_locked(uint32_t key) override;
     void _timer_tick(void) override;
 
@@ -291,6 +291,23 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+const uint8_t *UARTDriver::read_ptr(uint32_t &n)
+{
+    n = 0;
+    if (!_initialised) {
+        return nullptr;
+    }
+    return _readbuf.readptr(n);
+}
+
+bool UARTDriver::read_advance(uint32_t n)
+{
+    if (!_initialised) {
+        return false;
+    }
+    return _readbuf.advance(n);
+}
+
 /* Linux implementations of Print virtual methods */
 size_t UARTDriver::write(uint8_t c)
 {
@@ -30,6 +30,8 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    const uint8_t *read_ptr(uint32_t &n) override;
+    bool read_advance(uint32_t n) override;
 
     /* Linux implementations of Print virtual methods */
     size_t write(uint8_t c) override;
@@ -68,7 +68,10 @@ void SITL_State::_sitl_setup(const char *home_str)
 #endif
 
 #ifndef HIL_MODE
-    _setup_fdm();
+    if (!_scheduler->lockstep()) {
+        // no external RC input in lockstep mode
+        _setup_fdm();
+    }
 #endif
     fprintf(stdout, "Starting SITL input\n");
 
@@ -204,10 +207,16 @@ void SITL_State::_fdm_input_step(void)
 
 void SITL_State::wait_clock(uint64_t wait_time_usec)
 {
+    Scheduler *scheduler = Scheduler::from(hal.scheduler);
     while (AP_HAL::micros64() < wait_time_usec) {
         if (hal.scheduler->in_main_thread() ||
-            Scheduler::from(hal.scheduler)->semaphore_wait_hack_required()) {
+            scheduler->semaphore_wait_hack_required()) {
             _fdm_input_step();
+            if (scheduler->lockstep()) {
+                scheduler->lockstep_run_threads();
+            }
+        } else if (scheduler->lockstep()) {
+            scheduler->lockstep_wait(wait_time_usec);
         } else {
             usleep(1000);
         }
@@ -470,7 +479,9 @@ void SITL_State::_fdm_input_local(void)
     struct sitl_input input;
 
     // check for direct RC input
-    _check_rc_input();
+    if (!_scheduler->lockstep()) {
+        _check_rc_input();
+    }
 
     // construct servos structure for FDM
     _simulator_servos(input);
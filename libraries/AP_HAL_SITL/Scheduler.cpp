@@ -4,6 +4,7 @@
 #include "Scheduler.h"
 #include "UARTDriver.h"
 #include <sys/time.h>
+#include <errno.h>
 #include <fenv.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
 #if defined (__clang__)
@@ -35,6 +36,11 @@ bool Scheduler::_in_semaphore_take_wait = false;
 Scheduler::thread_attr *Scheduler::threads;
 HAL_Semaphore Scheduler::_thread_sem;
 
+bool Scheduler::_lockstep;
+pthread_mutex_t Scheduler::_lockstep_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t Scheduler::_lockstep_cond = PTHREAD_COND_INITIALIZER;
+thread_local Scheduler::thread_attr *Scheduler::_current_thread;
+
 Scheduler::Scheduler(SITL_State *sitlState) :
     _sitlState(sitlState),
     _stopped_clock_usec(0)
@@ -256,8 +262,22 @@ void Scheduler::stop_clock(uint64_t time_usec)
 void *Scheduler::thread_create_trampoline(void *ctx)
 {
     struct thread_attr *a = (struct thread_attr *)ctx;
+    _current_thread = a;
+    if (_lockstep) {
+        // don't start until the main thread hands over
+        from(hal.scheduler)->lockstep_wait(0);
+    }
     a->f[0]();
-    
+
+    if (_lockstep) {
+        // hand back to the main thread, which frees the thread
+        pthread_mutex_lock(&_lockstep_mutex);
+        a->lockstep_state = LockstepState::EXITED;
+        pthread_cond_broadcast(&_lockstep_cond);
+        pthread_mutex_unlock(&_lockstep_mutex);
+        return nullptr;
+    }
+
     WITH_SEMAPHORE(_thread_sem);
     if (threads == a) {
         threads = a->next;
@@ -290,7 +310,6 @@ bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name, uint32_
     // safety margin
     stack_size += 2300;
     
-    pthread_t thread {};
     const uint32_t alloc_stack = MAX(size_t(PTHREAD_STACK_MIN),stack_size);
 
     struct thread_attr *a = new struct thread_attr;
@@ -314,6 +333,8 @@ bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name, uint32_
     a->stack_size = stack_size;
     a->f[0] = proc;
     a->name = name;
+    a->lockstep_wake_usec = 0;
+    a->lockstep_state = LockstepState::STARTING;
     
     pthread_attr_init(&a->attr);
 #if !defined(__CYGWIN__) && !defined(__CYGWIN64__)
@@ -321,11 +342,14 @@ bool Scheduler::thread_create(AP_HAL::MemberProc proc, const char *name, uint32_
         AP_HAL::panic("Failed to set stack of size %u for thread %s", alloc_stack, name);
     }
 #endif
-    if (pthread_create(&thread, &a->attr, thread_create_trampoline, a) != 0) {
+    if (pthread_create(&a->thread, &a->attr, thread_create_trampoline, a) != 0) {
         goto failed;
     }
+    // the main thread walks the list without _thread_sem in lockstep mode
+    pthread_mutex_lock(&_lockstep_mutex);
     a->next = threads;
     threads = a;
+    pthread_mutex_unlock(&_lockstep_mutex);
     return true;
 
 failed:
@@ -354,3 +378,94 @@ void Scheduler::check_thread_stacks(void)
         }
     }
 }
+
+/*
+  wait for the main thread to hand over once the clock reaches
+  wait_usec. Called in place of sleeping by threads other than the
+  main thread when in lockstep mode
+ */
+void Scheduler::lockstep_wait(uint64_t wait_usec)
+{
+    struct thread_attr *a = _current_thread;
+    if (a == nullptr) {
+        // not created by thread_create(), so nothing will hand over
+        usleep(1000);
+        return;
+    }
+    pthread_mutex_lock(&_lockstep_mutex);
+    a->lockstep_wake_usec = wait_usec;
+    a->lockstep_state = LockstepState::WAITING;
+    pthread_cond_broadcast(&_lockstep_cond);
+    while (a->lockstep_state != LockstepState::RUNNING) {
+        pthread_cond_wait(&_lockstep_cond, &_lockstep_mutex);
+    }
+    pthread_mutex_unlock(&_lockstep_mutex);
+}
+
+/*
+  hand over to each thread that is due to wake in turn, in list order,
+  waiting for each to wait again or exit before moving on. Only one
+  thread runs at a time, so the result does not depend on the host's
+  scheduling
+ */
+void Scheduler::lockstep_run_threads()
+{
+    const uint64_t now = AP_HAL::micros64();
+
+    pthread_mutex_lock(&_lockstep_mutex);
+    // threads created while we wait are added at the head of the
+    // list, so are first run on the next step
+    for (struct thread_attr *a=threads; a; a=a->next) {
+        while (a->lockstep_state == LockstepState::STARTING) {
+            pthread_cond_wait(&_lockstep_cond, &_lockstep_mutex);
+        }
+        if (a->lockstep_state != LockstepState::WAITING ||
+            a->lockstep_wake_usec > now) {
+            continue;
+        }
+        a->lockstep_state = LockstepState::RUNNING;
+        pthread_cond_broadcast(&_lockstep_cond);
+        // a thread that spins without a delay never hands back, and
+        // would otherwise hang the simulation with no indication why
+        uint32_t running_s = 0;
+        while (a->lockstep_state == LockstepState::RUNNING) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_sec += 1;
+            if (pthread_cond_timedwait(&_lockstep_cond, &_lockstep_mutex, &ts) != ETIMEDOUT) {
+                continue;
+            }
+            running_s++;
+            if (running_s >= SITL_LOCKSTEP_TIMEOUT_S) {
+                AP_HAL::panic("lockstep: thread %s ran for %us without a delay", a->name, (unsigned)running_s);
+            }
+            if (running_s % SITL_LOCKSTEP_WARN_S == 0) {
+                ::fprintf(stderr, "lockstep: thread %s has run for %us without a delay\n", a->name, (unsigned)running_s);
+            }
+        }
+    }
+    lockstep_remove_exited();
+    pthread_mutex_unlock(&_lockstep_mutex);
+}
+
+/*
+  free threads that have exited in lockstep mode. Called with
+  _lockstep_mutex held
+ */
+void Scheduler::lockstep_remove_exited(void)
+{
+    struct thread_attr **p = &threads;
+    while (*p) {
+        struct thread_attr *a = *p;
+        if (a->lockstep_state != LockstepState::EXITED) {
+            p = &a->next;
+            continue;
+        }
+        *p = a->next;
+        // it may still be unwinding on its stack
+        pthread_join(a->thread, nullptr);
+        free(a->stack);
+        free(a->f);
+        delete a;
+    }
+}
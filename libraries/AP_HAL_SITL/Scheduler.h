@@ -8,6 +8,12 @@
 
 #define SITL_SCHEDULER_MAX_TIMER_PROCS 8
 
+// in lockstep mode, warn every SITL_LOCKSTEP_WARN_S seconds of wall
+// clock time about a thread that runs without waiting, and panic once
+// it has run for SITL_LOCKSTEP_TIMEOUT_S
+#define SITL_LOCKSTEP_WARN_S 5
+#define SITL_LOCKSTEP_TIMEOUT_S 60
+
 /* Scheduler implementation: */
 class HALSITL::Scheduler : public AP_HAL::Scheduler {
 public:
@@ -67,6 +73,24 @@ public:
     // a couple of helper functions to cope with SITL's time stepping
     bool semaphore_wait_hack_required();
 
+    /*
+      lockstep mode: threads created with thread_create() only run
+      when the main thread hands over to them after a simulation
+      step, one at a time and in a fixed order, so that a run is
+      repeatable and never waits on the wall clock
+     */
+    void set_lockstep(bool enable) { _lockstep = enable; }
+    bool lockstep() const { return _lockstep; }
+
+    // wait, in a thread other than the main thread, until the
+    // simulated clock reaches wait_usec and the main thread hands over
+    void lockstep_wait(uint64_t wait_usec);
+
+    // run each waiting thread that is due in turn, returning when all
+    // of them are waiting again. Called by the main thread after each
+    // simulation step
+    void lockstep_run_threads();
+
 private:
     SITL_State *_sitlState;
     uint8_t _nested_atomic_ctr;
@@ -90,6 +114,7 @@ private:
 
     static void *thread_create_trampoline(void *ctx);
     static void check_thread_stacks(void);
+    static void lockstep_remove_exited(void);
     
     bool _initialized;
     uint64_t _stopped_clock_usec;
@@ -97,16 +122,32 @@ private:
     pthread_t _main_ctx;
 
     static HAL_Semaphore _thread_sem;
+
+    enum class LockstepState : uint8_t {
+        STARTING,   // created but not yet waiting for the first hand over
+        WAITING,    // waiting in lockstep_wait()
+        RUNNING,    // handed over to by the main thread
+        EXITED,     // thread function returned, to be freed by the main thread
+    };
+
     struct thread_attr {
         struct thread_attr *next;
+        pthread_t thread;
         AP_HAL::MemberProc *f;
         pthread_attr_t attr;
         uint32_t stack_size;
         void *stack;
         const uint8_t *stack_min;
         const char *name;
+        uint64_t lockstep_wake_usec;
+        LockstepState lockstep_state;
     };
     static struct thread_attr *threads;
+
+    static bool _lockstep;
+    static pthread_mutex_t _lockstep_mutex;
+    static pthread_cond_t _lockstep_cond;
+    static thread_local struct thread_attr *_current_thread;
     static const uint8_t stackfill = 0xEB;
 };
 #endif  // CONFIG_HAL_BOARD
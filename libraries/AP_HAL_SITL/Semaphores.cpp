@@ -36,7 +36,17 @@ bool Semaphore::give()
 bool Semaphore::take(uint32_t timeout_ms)
 {
     if (timeout_ms == HAL_SEMAPHORE_BLOCK_FOREVER) {
-        return pthread_mutex_lock(&_lock) == 0;
+        if (!Scheduler::from(hal.scheduler)->lockstep()) {
+            return pthread_mutex_lock(&_lock) == 0;
+        }
+        // in lockstep mode the holder may only run again once the
+        // clock moves on, so we must not block
+        while (!take_nonblocking()) {
+            Scheduler::from(hal.scheduler)->set_in_semaphore_take_wait(true);
+            hal.scheduler->delay_microseconds(200);
+            Scheduler::from(hal.scheduler)->set_in_semaphore_take_wait(false);
+        }
+        return true;
     }
     if (take_nonblocking()) {
         return true;
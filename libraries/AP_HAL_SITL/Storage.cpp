@@ -87,6 +87,7 @@ void Storage::read_block(void *dst, uint16_t loc, size_t n)
     }
     _storage_open();
     memcpy(dst, &_buffer[loc], n);
+    _read_count++;
 }
 
 void Storage::write_block(uint16_t loc, const void *src, size_t n)
@@ -31,6 +31,9 @@ public:
     void _timer_tick(void) override;
     bool healthy(void) override;
 
+    // number of read_block() calls, used by tests to check access patterns
+    uint32_t get_read_count(void) const { return _read_count; }
+
 private:
     volatile bool _initialised;
     void _storage_create(void);
@@ -50,6 +53,7 @@ private:
     bool _flash_failed;
     uint32_t _last_re_init_ms;
     uint32_t _last_empty_ms;
+    uint32_t _read_count;
 
 #if STORAGE_USE_FLASH
     AP_FlashStorage _flash{_buffer,
@@ -25,6 +25,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <stdarg.h>
+#include <ctype.h>
 #include <AP_Math/AP_Math.h>
 
 #include <errno.h>
@@ -46,6 +47,7 @@ extern const AP_HAL::HAL& hal;
 using namespace HALSITL;
 
 bool UARTDriver::_console;
+UARTDriver *UARTDriver::_ports[8];
 
 /* UARTDriver method implementations */
 
@@ -81,6 +83,8 @@ void UARTDriver::begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace)
              mcast:239.255.145.50:14550
              uart:/dev/ttyUSB0:57600
              sim:ParticleSensor_SDS021:
+             loopback:        // writes are read back on this port
+             loopback:D       // writes are read on uartD
          */
         char *saveptr = nullptr;
         char *s = strdup(path);
@@ -110,6 +114,21 @@ void UARTDriver::begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace)
                 _fd = _sitlState->sim_fd(args1, args2);
                 _fd_write = _sitlState->sim_fd_write(args1);
             }
+        } else if (strcmp(devtype, "loopback") == 0) {
+            // in-process connection, with no file descriptor
+            if (!_connected) {
+                _loopback_peer = this;
+                if (args1 != nullptr) {
+                    const uint8_t peer = toupper(args1[0]) - 'A';
+                    if (peer >= ARRAY_SIZE(_ports) || _ports[peer] == nullptr) {
+                        AP_HAL::panic("Invalid loopback port: %s", path);
+                    }
+                    _loopback_peer = _ports[peer];
+                }
+                ::printf("Loopback connection on port %u to port %u\n",
+                         _portNumber, _loopback_peer->_portNumber);
+                _connected = true;
+            }
         } else if (strcmp(devtype, "udpclient") == 0) {
             // udp client connection
             const char *ip = args1;
@@ -174,6 +193,20 @@ int16_t UARTDriver::read(void)
     return c;
 }
 
+const uint8_t *UARTDriver::read_ptr(uint32_t &n)
+{
+    n = 0;
+    if (available() <= 0) {
+        return nullptr;
+    }
+    return _readbuffer.readptr(n);
+}
+
+bool UARTDriver::read_advance(uint32_t n)
+{
+    return _readbuffer.advance(n);
+}
+
 void UARTDriver::flush(void)
 {
 }
@@ -642,6 +675,11 @@ void UARTDriver::_timer_tick(void)
         last_tick_us = now;
     }
 
+    if (_loopback_peer != nullptr) {
+        _loopback_tick(max_bytes);
+        return;
+    }
+
     if (_packetise) {
         uint16_t n = _writebuffer.available();
         n = MIN(n, max_bytes);
@@ -746,6 +784,30 @@ void UARTDriver::_timer_tick(void)
     }
 }
 
+/*
+  move bytes written to a loopback port into the read buffer of its peer
+ */
+void UARTDriver::_loopback_tick(uint32_t max_bytes)
+{
+    ByteBuffer &rx = _loopback_peer->_readbuffer;
+    uint32_t n = MIN(MIN(_writebuffer.available(), rx.space()), max_bytes);
+    if (n == 0) {
+        return;
+    }
+    while (n > 0) {
+        uint32_t navail;
+        const uint8_t *readptr = _writebuffer.readptr(navail);
+        if (readptr == nullptr || navail == 0) {
+            break;
+        }
+        navail = MIN(navail, n);
+        rx.write(readptr, navail);
+        _writebuffer.advance(navail);
+        n -= navail;
+    }
+    _loopback_peer->_receive_timestamp = AP_HAL::micros64();
+}
+
 /*
   return timestamp estimate in microseconds for when the start of
   a nbytes packet arrived on the uart. This should be treated as a
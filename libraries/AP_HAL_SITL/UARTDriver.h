@@ -20,6 +20,10 @@ public:
         _fd = -1;
         _mc_fd = -1;
         _listen_fd = -1;
+
+        if (portNumber < ARRAY_SIZE(_ports)) {
+            _ports[portNumber] = this;
+        }
     }
 
     /* Implementations of UARTDriver virtual methods */
@@ -46,6 +50,8 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    const uint8_t *read_ptr(uint32_t &n) override;
+    bool read_advance(uint32_t n) override;
 
     /* Implementations of Print virtual methods */
     size_t write(uint8_t c) override;
@@ -125,6 +131,13 @@ private:
     // _fd.  This is to support simulated serial devices, which use a
     // pipe for read and a pipe for write
     int _fd_write = -1;
+
+    // all ports by port number, for finding a loopback peer
+    static UARTDriver *_ports[8];
+
+    // for a loopback device, the port whose read buffer our writes go to
+    UARTDriver *_loopback_peer = nullptr;
+    void _loopback_tick(uint32_t max_bytes);
 };
 
 #endif
@@ -0,0 +1,67 @@
+/*
+  physics for a swarm of SITL vehicles in one process, stepped on a
+  pool of threads. Start it with a model for the HAL, for example
+
+    SWARM_COUNT=50 SWARM_MODEL=quad build/sitl/examples/SwarmPhysics -M quad
+
+  then start firmware instance N with "-M gazebo -I N". The vehicle
+  type, count, number of threads and base port are taken from the
+  SWARM_MODEL, SWARM_COUNT, SWARM_THREADS and SWARM_BASE_PORT
+  environment variables
+ */
+
+#include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL.h>
+#include <SITL/SITL.h>
+#include <SITL/SIM_Swarm.h>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static SITL::SITL sitl;
+static SITL::Swarm swarm;
+
+static uint32_t last_report_ms;
+static uint64_t last_steps;
+
+static long env_long(const char *name, long default_value)
+{
+    const char *s = getenv(name);
+    return s ? strtol(s, nullptr, 0) : default_value;
+}
+
+void setup(void)
+{
+    const char *model = getenv("SWARM_MODEL");
+    if (model == nullptr) {
+        model = "quad";
+    }
+    const uint16_t count = constrain_int32(env_long("SWARM_COUNT", 10), 1, 1000);
+    const uint8_t threads = constrain_int32(env_long("SWARM_THREADS", sysconf(_SC_NPROCESSORS_ONLN)), 1, 255);
+    const uint16_t base_port = env_long("SWARM_BASE_PORT", 9002);
+
+    if (!swarm.init(model, count, base_port) || !swarm.start(threads)) {
+        AP_HAL::panic("Failed to start swarm");
+    }
+    last_report_ms = AP_HAL::millis();
+}
+
+void loop(void)
+{
+    hal.scheduler->delay(1000);
+
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint64_t steps = swarm.total_steps();
+    hal.console->printf("%u vehicles, %.0f steps/s\n",
+                        (unsigned)swarm.count(),
+                        (steps - last_steps) * 1000.0 / (now_ms - last_report_ms));
+    last_steps = steps;
+    last_report_ms = now_ms;
+}
+
+AP_HAL_MAIN();
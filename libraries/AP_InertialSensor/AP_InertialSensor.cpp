@@ -457,6 +457,12 @@ const AP_Param::GroupInfo AP_InertialSensor::var_info[] = {
     // @Path: ../Filter/HarmonicNotchFilter.cpp
     AP_SUBGROUPINFO(_harmonic_notch_filter, "HNTCH_",  41, AP_InertialSensor, HarmonicNotchFilterParams),
 
+#if HAL_GYROFFT_ENABLED
+    // @Group: FFT_
+    // @Path: ../AP_InertialSensor/GyroFFT.cpp
+    AP_SUBGROUPINFO(gyrofft, "FFT_",  42, AP_InertialSensor, AP_InertialSensor::GyroFFT),
+#endif
+
     /*
       NOTE: parameter indexes have gaps above. When adding new
       parameters check for conflicts carefully
@@ -660,6 +666,11 @@ AP_InertialSensor::init(uint16_t sample_rate)
     // initialise IMU batch logging
     batchsampler.init();
 
+#if HAL_GYROFFT_ENABLED
+    // start in-flight gyro spectral analysis
+    gyrofft.init();
+#endif
+
     // the center frequency of the harmonic notch is always taken from the calculated value so that it can be updated
     // dynamically, the calculated value is always some multiple of the configured center frequency, so start with the
     // configured value
@@ -876,6 +887,9 @@ AP_InertialSensor::detect_backends(void)
 void AP_InertialSensor::periodic()
 {
     batchsampler.periodic();
+#if HAL_GYROFFT_ENABLED
+    gyrofft.periodic();
+#endif
 }
 
 
@@ -27,6 +27,11 @@
 #include <Filter/NotchFilter.h>
 #include <Filter/HarmonicNotchFilter.h>
 
+#ifndef HAL_GYROFFT_ENABLED
+// in-flight gyro spectral analysis needs spare CPU on a separate thread
+#define HAL_GYROFFT_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
 class AP_InertialSensor_Backend;
 class AuxiliaryBus;
 class AP_AHRS;
@@ -246,6 +251,14 @@ public:
     // return true if harmonic notch enabled
     bool gyro_harmonic_notch_enabled(void) const { return _harmonic_notch_filter.enabled(); }
 
+#if HAL_GYROFFT_ENABLED
+    // return true if the gyro FFT has recently found a vibration peak
+    bool gyro_fft_healthy(void) const { return gyrofft.healthy(); }
+
+    // frequency of the vibration peak found by the gyro FFT
+    float get_gyro_fft_center_freq_hz(void) const { return gyrofft.center_freq_hz(); }
+#endif
+
     /*
       HIL set functions. The minimum for HIL is set_accel() and
       set_gyro(). The others are option for higher fidelity log
@@ -375,6 +388,97 @@ public:
     };
     BatchSampler batchsampler{*this};
 
+#if HAL_GYROFFT_ENABLED
+    /*
+      in-flight spectral analysis of the first gyro. Decimated roll
+      and pitch rates are collected from the same raw sample path as
+      the BatchSampler, and a low priority thread windows them, runs
+      an FFT and finds the strongest vibration peak, which the
+      harmonic notch can then track
+     */
+    class GyroFFT {
+    public:
+        GyroFFT(const AP_InertialSensor &imu) :
+            _imu(imu) {
+            AP_Param::setup_object_defaults(this, var_info);
+        };
+
+        void init();
+        void sample(uint8_t instance, const Vector3f &sample);
+
+        // a function called by the main thread at the main loop rate:
+        void periodic();
+
+        // true if a peak has been found recently
+        bool healthy() const;
+        // smoothed frequency of the strongest peak
+        float center_freq_hz() const { return _center_freq_hz; }
+
+        // class level parameters
+        static const struct AP_Param::GroupInfo var_info[];
+
+        // Parameters
+        AP_Int8 _enable;
+        AP_Int16 _window_size;
+        AP_Int16 _min_hz;
+        AP_Int16 _max_hz;
+        AP_Float _snr_threshold_db;
+        // end Parameters
+
+    private:
+        void run();
+        bool copy_window();
+        void fft();
+        void find_peak();
+
+        bool _initialised;
+
+        // samples are averaged in groups of _decimation before analysis
+        uint16_t _decimation;
+        float _sample_rate_hz;
+        uint16_t _window;
+        Vector2f _accum;
+        uint16_t _accum_count;
+
+        // ring of the last _window decimated roll and pitch samples,
+        // protected by _sem
+        HAL_Semaphore _sem;
+        float *_ring_x;
+        float *_ring_y;
+        uint16_t _ring_head;
+        uint16_t _ring_count;
+
+        // decimated samples waiting for the FFT thread to release the
+        // ring. Only used by the thread calling sample(). If the FFT
+        // thread holds the ring for longer than it takes for
+        // _pending to fill, further samples are dropped and counted
+        Vector2f _pending[8];
+        uint8_t _num_pending;
+        uint32_t _pending_dropped;
+
+        // FFT working space, Hann window and twiddle factors, used only
+        // by the FFT thread
+        float *_re;
+        float *_im;
+        float *_hann;
+        float *_cos;
+        float *_sin;
+
+        // results, written by the FFT thread
+        LowPassFilterFloat _freq_filter;
+        float _center_freq_hz;
+        float _peak_freq_hz;
+        float _peak_snr_db;
+        uint32_t _last_peak_ms;
+        uint32_t _last_analysis_ms;
+
+        uint32_t _last_log_ms;
+
+        const AP_InertialSensor &_imu;
+    };
+    GyroFFT gyrofft{*this};
+#endif
+
 private:
     // load backend drivers
     bool _add_backend(AP_InertialSensor_Backend *backend);
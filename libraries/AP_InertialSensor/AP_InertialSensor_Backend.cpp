@@ -251,6 +251,10 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
         _imu._new_gyro_data[instance] = true;
     }
 
+#if HAL_GYROFFT_ENABLED
+    _imu.gyrofft.sample(instance, gyro);
+#endif
+
     if (!_imu.batchsampler.doing_post_filter_logging()) {
         log_gyro_raw(instance, sample_us, gyro);
     }
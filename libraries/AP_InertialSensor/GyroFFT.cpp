@@ -0,0 +1,360 @@
+#include "AP_InertialSensor.h"
+
+#if HAL_GYROFFT_ENABLED
+
+#include <GCS_MAVLink/GCS.h>
+#include <AP_Logger/AP_Logger.h>
+
+// window sizes are powers of two in this range
+#define GYROFFT_MIN_WINDOW          32
+#define GYROFFT_MAX_WINDOW          1024
+// a peak is no longer used if there has not been another this long
+#define GYROFFT_PEAK_TIMEOUT_MS     1000
+// cutoff of the filter smoothing the peak frequency
+#define GYROFFT_FREQ_FILT_HZ        2.0f
+// interval between FFT log messages
+#define GYROFFT_LOG_INTERVAL_MS     100
+
+// Class level parameters
+const AP_Param::GroupInfo AP_InertialSensor::GyroFFT::var_info[] = {
+    // @Param: ENABLE
+    // @DisplayName: Gyro FFT enable
+    // @Description: Enable in-flight spectral analysis of the first gyro. The frequency of the strongest vibration can be tracked by the harmonic notch by setting INS_HNTCH_MODE to 4.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO_FLAGS("ENABLE", 1, AP_InertialSensor::GyroFFT, _enable, 0, AP_PARAM_FLAG_ENABLE),
+
+    // @Param: WINDOW
+    // @DisplayName: FFT window size
+    // @Description: Number of samples in each FFT, rounded down to a power of two. Larger windows give finer frequency resolution but respond more slowly and need more memory and CPU.
+    // @Range: 32 1024
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("WINDOW", 2, AP_InertialSensor::GyroFFT, _window_size, 256),
+
+    // @Param: MINHZ
+    // @DisplayName: Minimum frequency
+    // @Description: Lowest frequency searched for a vibration peak
+    // @Range: 20 400
+    // @Units: Hz
+    // @User: Advanced
+    AP_GROUPINFO("MINHZ", 3, AP_InertialSensor::GyroFFT, _min_hz, 50),
+
+    // @Param: MAXHZ
+    // @DisplayName: Maximum frequency
+    // @Description: Highest frequency searched for a vibration peak. The gyro samples are decimated to a little over twice this frequency before analysis.
+    // @Range: 50 1000
+    // @Units: Hz
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("MAXHZ", 4, AP_InertialSensor::GyroFFT, _max_hz, 400),
+
+    // @Param: SNR
+    // @DisplayName: Minimum peak signal to noise ratio
+    // @Description: A peak is only used if its power is at least this much above the average power of the frequencies searched
+    // @Range: 3 30
+    // @Units: dB
+    // @User: Advanced
+    AP_GROUPINFO("SNR", 5, AP_InertialSensor::GyroFFT, _snr_threshold_db, 10),
+
+    AP_GROUPEND
+};
+
+extern const AP_HAL::HAL& hal;
+
+void AP_InertialSensor::GyroFFT::init()
+{
+    if (!_enable || _initialised) {
+        return;
+    }
+    const float raw_rate_hz = _imu._gyro_raw_sample_rates[0];
+    if (_imu._gyro_count == 0 || !is_positive(raw_rate_hz)) {
+        return;
+    }
+
+    // decimate to a little over twice the highest frequency searched
+    _decimation = MAX(1, uint16_t(raw_rate_hz / (2.5f * MAX(_max_hz.get(), 1))));
+    _sample_rate_hz = raw_rate_hz / _decimation;
+
+    _window = GYROFFT_MIN_WINDOW;
+    while (_window * 2 <= MIN(_window_size.get(), GYROFFT_MAX_WINDOW)) {
+        _window *= 2;
+    }
+
+    // ring (2 arrays), FFT working space (2), window (1) and half
+    // window of cosines and sines (1)
+    const uint32_t total_allocation = 6 * _window * sizeof(float);
+    float *mem = (float *)calloc(6 * _window, sizeof(float));
+    if (mem == nullptr) {
+        gcs().send_text(MAV_SEVERITY_WARNING, "Failed to allocate %u bytes for gyro FFT", (unsigned int)total_allocation);
+        return;
+    }
+    _ring_x = &mem[0];
+    _ring_y = &mem[_window];
+    _re = &mem[2 * _window];
+    _im = &mem[3 * _window];
+    _hann = &mem[4 * _window];
+    _cos = &mem[5 * _window];
+    _sin = &mem[5 * _window + _window / 2];
+
+    for (uint16_t i = 0; i < _window; i++) {
+        _hann[i] = 0.5f - 0.5f * cosf(M_2PI * i / _window);
+    }
+    for (uint16_t i = 0; i < _window / 2; i++) {
+        _cos[i] = cosf(M_2PI * i / _window);
+        _sin[i] = sinf(M_2PI * i / _window);
+    }
+    _freq_filter.set_cutoff_frequency(GYROFFT_FREQ_FILT_HZ);
+
+    // run at low priority so it only uses spare CPU
+    if (!hal.scheduler->thread_create(FUNCTOR_BIND_MEMBER(&AP_InertialSensor::GyroFFT::run, void),
+                                      "FFT",
+                                      4096, AP_HAL::Scheduler::PRIORITY_IO, -1)) {
+        free(mem);
+        _ring_x = nullptr;
+        gcs().send_text(MAV_SEVERITY_WARNING, "Failed to start gyro FFT thread");
+        return;
+    }
+
+    gcs().send_text(MAV_SEVERITY_INFO, "Gyro FFT: %u samples at %uHz, %.1fHz resolution",
+                    (unsigned)_window, (unsigned)_sample_rate_hz, (double)(_sample_rate_hz / _window));
+    _initialised = true;
+}
+
+/*
+  called from the backends for every raw gyro sample
+ */
+void AP_InertialSensor::GyroFFT::sample(uint8_t instance, const Vector3f &sample)
+{
+    if (!_initialised || instance != 0) {
+        return;
+    }
+
+    // vibration shows in roll and pitch; yaw is usually much quieter
+    _accum.x += sample.x;
+    _accum.y += sample.y;
+    _accum_count++;
+    if (_accum_count < _decimation) {
+        return;
+    }
+    const Vector2f average = _accum / _accum_count;
+    _accum.zero();
+    _accum_count = 0;
+
+    // never wait on the FFT thread here. While it is copying the ring
+    // samples are held back, and added the next time the ring is
+    // free. If it holds the ring for longer than _pending covers the
+    // sample is lost, which the FTN message records
+    if (_num_pending < ARRAY_SIZE(_pending)) {
+        _pending[_num_pending++] = average;
+    } else {
+        _pending_dropped++;
+    }
+    if (!_sem.take_nonblocking()) {
+        return;
+    }
+    for (uint8_t i = 0; i < _num_pending; i++) {
+        _ring_x[_ring_head] = _pending[i].x;
+        _ring_y[_ring_head] = _pending[i].y;
+        _ring_head = (_ring_head + 1) & (_window - 1);
+    }
+    _ring_count = MIN(_ring_count + _num_pending, _window);
+    _num_pending = 0;
+    _sem.give();
+}
+
+/*
+  the FFT thread. A window is analysed each time a quarter of a
+  window of new samples has arrived
+ */
+void AP_InertialSensor::GyroFFT::run()
+{
+    const uint32_t interval_ms = MAX(1U, uint32_t(250 * _window / _sample_rate_hz));
+    while (true) {
+        hal.scheduler->delay(interval_ms);
+        if (!copy_window()) {
+            continue;
+        }
+        fft();
+        find_peak();
+    }
+}
+
+/*
+  copy the latest window of samples, oldest first, applying the Hann
+  window. Roll goes in the real part and pitch in the imaginary part,
+  so that one complex FFT analyses both
+ */
+bool AP_InertialSensor::GyroFFT::copy_window()
+{
+    {
+        // hold the ring only for the copy
+        WITH_SEMAPHORE(_sem);
+        if (_ring_count < _window) {
+            return false;
+        }
+        const uint16_t older = _window - _ring_head;
+        memcpy(&_re[0], &_ring_x[_ring_head], older * sizeof(float));
+        memcpy(&_re[older], &_ring_x[0], _ring_head * sizeof(float));
+        memcpy(&_im[0], &_ring_y[_ring_head], older * sizeof(float));
+        memcpy(&_im[older], &_ring_y[0], _ring_head * sizeof(float));
+    }
+    for (uint16_t i = 0; i < _window; i++) {
+        _re[i] *= _hann[i];
+        _im[i] *= _hann[i];
+    }
+    return true;
+}
+
+/*
+  in-place iterative radix-2 complex FFT of _re and _im
+ */
+void AP_InertialSensor::GyroFFT::fft()
+{
+    const uint16_t n = _window;
+
+    // bit reversed reordering
+    for (uint16_t i = 1, j = 0; i < n; i++) {
+        uint16_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float t = _re[i];
+            _re[i] = _re[j];
+            _re[j] = t;
+            t = _im[i];
+            _im[i] = _im[j];
+            _im[j] = t;
+        }
+    }
+
+    for (uint16_t len = 2; len <= n; len <<= 1) {
+        const uint16_t half = len >> 1;
+        const uint16_t step = n / len;
+        for (uint16_t i = 0; i < n; i += len) {
+            for (uint16_t k = 0; k < half; k++) {
+                const float wr = _cos[k * step];
+                const float wi = -_sin[k * step];
+                const uint16_t a = i + k;
+                const uint16_t b = a + half;
+                const float vr = _re[b] * wr - _im[b] * wi;
+                const float vi = _re[b] * wi + _im[b] * wr;
+                _re[b] = _re[a] - vr;
+                _im[b] = _im[a] - vi;
+                _re[a] += vr;
+                _im[a] += vi;
+            }
+        }
+    }
+}
+
+/*
+  find the strongest peak between the minimum and maximum frequencies
+  in the combined roll and pitch power spectrum
+ */
+void AP_InertialSensor::GyroFFT::find_peak()
+{
+    const uint16_t n = _window;
+    const float bin_hz = _sample_rate_hz / n;
+
+    // with Z = FFT(x + iy), |X[k]|^2 + |Y[k]|^2 = (|Z[k]|^2 + |Z[n-k]|^2) / 2.
+    // Leave room for a bin on each side of the peak, and skip the
+    // bins the mean gyro rate leaks into
+    const uint16_t k_min = constrain_int16(int16_t(ceilf(_min_hz / bin_hz)), 2, n / 2 - 6);
+    const uint16_t k_max = constrain_int16(int16_t(_max_hz / bin_hz), k_min + 4, n / 2 - 2);
+    for (uint16_t k = k_min - 1; k <= k_max + 1; k++) {
+        const uint16_t m = n - k;
+        _re[k] = 0.5f * (sq(_re[k]) + sq(_im[k]) + sq(_re[m]) + sq(_im[m]));
+    }
+
+    uint16_t peak = k_min;
+    float total = 0;
+    for (uint16_t k = k_min; k <= k_max; k++) {
+        total += _re[k];
+        if (_re[k] > _re[peak]) {
+            peak = k;
+        }
+    }
+
+    const uint32_t now_ms = AP_HAL::millis();
+    const float dt = (now_ms - _last_analysis_ms) * 0.001f;
+    _last_analysis_ms = now_ms;
+
+    // compare against the mean of the rest of the band, leaving out
+    // the bins the peak spreads into
+    const float peak_power = _re[peak];
+    float other_power = total - peak_power;
+    uint16_t num_other = k_max - k_min;
+    if (peak > k_min) {
+        other_power -= _re[peak-1];
+        num_other--;
+    }
+    if (peak < k_max) {
+        other_power -= _re[peak+1];
+        num_other--;
+    }
+    if (!is_positive(peak_power) || !is_positive(other_power)) {
+        return;
+    }
+    const float snr_db = 10 * log10f(peak_power * num_other / other_power);
+    _peak_snr_db = snr_db;
+    if (snr_db < _snr_threshold_db) {
+        return;
+    }
+
+    // the log of a Hann windowed peak is close to a parabola, which
+    // gives its position to a small fraction of a bin
+    const float l0 = logf(MAX(_re[peak-1], FLT_MIN));
+    const float l1 = logf(peak_power);
+    const float l2 = logf(MAX(_re[peak+1], FLT_MIN));
+    const float denom = l0 - 2 * l1 + l2;
+    float delta = 0;
+    if (is_negative(denom)) {
+        delta = constrain_float(0.5f * (l0 - l2) / denom, -0.5f, 0.5f);
+    }
+    const float freq_hz = (peak + delta) * bin_hz;
+    _peak_freq_hz = freq_hz;
+
+    if (now_ms - _last_peak_ms > GYROFFT_PEAK_TIMEOUT_MS) {
+        _freq_filter.reset(freq_hz);
+    }
+    _center_freq_hz = _freq_filter.apply(freq_hz, dt);
+    _last_peak_ms = now_ms;
+}
+
+bool AP_InertialSensor::GyroFFT::healthy() const
+{
+    return _initialised && AP_HAL::millis() - _last_peak_ms < GYROFFT_PEAK_TIMEOUT_MS;
+}
+
+void AP_InertialSensor::GyroFFT::periodic()
+{
+    if (!_initialised) {
+        return;
+    }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - _last_log_ms < GYROFFT_LOG_INTERVAL_MS) {
+        return;
+    }
+    _last_log_ms = now_ms;
+
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger == nullptr) {
+        return;
+    }
+    struct log_GYRO_FFT pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_GYRO_FFT_MSG),
+        time_us     : AP_HAL::micros64(),
+        center_freq : _center_freq_hz,
+        peak_freq   : _peak_freq_hz,
+        snr         : _peak_snr_db,
+        healthy     : healthy(),
+        dropped     : _pending_dropped
+    };
+    logger->WriteBlock(&pkt, sizeof(pkt));
+}
+
+#endif // HAL_GYROFFT_ENABLED
@@ -92,6 +92,16 @@ const AP_Param::GroupInfo AP_Logger::var_info[] = {
     // @User: Standard
     // @Units: s
     AP_GROUPINFO("_FILE_TIMEOUT",  6, AP_Logger, _params.file_timeout,     HAL_LOGGING_FILE_TIMEOUT),
+
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+    // @Param: _FILE_ASYNC
+    // @DisplayName: Asynchronous log file writes
+    // @Description: When enabled the File backend submits log writes asynchronously (io_uring, or POSIX AIO on older kernels) from two page-aligned buffers, so a slow storage device does not stall the logging thread. Direct IO bypasses the page cache and is used only if the filesystem supports it.
+    // @Values: 0:Disabled,1:Enabled,2:Enabled with direct IO
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("_FILE_ASYNC",  7, AP_Logger, _params.file_async,     0),
+#endif
     
     AP_GROUPEND
 };
@@ -782,12 +792,42 @@ void AP_Logger::WriteCritical(const char *name, const char *labels, const char *
 }
 
 void AP_Logger::WriteV(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, va_list arg_list, bool is_critical)
+{
+    WriteV(get_write_handle(name, labels, units, mults, fmt), arg_list, is_critical);
+}
+
+AP_Logger::WriteHandle AP_Logger::get_write_handle(const char *name, const char *labels, const char *units, const char *mults, const char *fmt)
 {
     struct log_write_fmt *f = msg_fmt_for_name(name, labels, units, mults, fmt);
     if (f == nullptr) {
         // unable to map name to a messagetype; could be out of
         // msgtypes, could be out of slots, ...
         AP::internalerror().error(AP_InternalError::error_t::logger_mapfailure);
+    }
+    return f;
+}
+
+void AP_Logger::Write(WriteHandle handle, ...)
+{
+    va_list arg_list;
+
+    va_start(arg_list, handle);
+    WriteV(handle, arg_list);
+    va_end(arg_list);
+}
+
+void AP_Logger::WriteCritical(WriteHandle handle, ...)
+{
+    va_list arg_list;
+
+    va_start(arg_list, handle);
+    WriteV(handle, arg_list, true);
+    va_end(arg_list);
+}
+
+void AP_Logger::WriteV(WriteHandle f, va_list arg_list, bool is_critical)
+{
+    if (f == nullptr) {
         return;
     }
 
@@ -800,12 +840,40 @@ void AP_Logger::WriteV(const char *name, const char *labels, const char *units,
         }
         va_list arg_copy;
         va_copy(arg_copy, arg_list);
-        backends[i]->Write(f->msg_type, arg_copy, is_critical);
+        backends[i]->Write(f->msg_type, f->msg_len, f->fmt, arg_copy, is_critical);
         va_end(arg_copy);
     }
 }
 
 
+void AP_Logger::WritePacket(WriteHandle f, uint8_t *pkt, uint8_t len, bool is_critical)
+{
+    if (f == nullptr) {
+        return;
+    }
+    if (f->msg_len != len) {
+        // the handle was created for a different format
+        AP::internalerror().error(AP_InternalError::error_t::logger_mapfailure);
+        return;
+    }
+    pkt[0] = HEAD_BYTE1;
+    pkt[1] = HEAD_BYTE2;
+    pkt[2] = f->msg_type;
+
+    for (uint8_t i=0; i<_next_backend; i++) {
+        if (!(f->sent_mask & (1U<<i))) {
+            if (!backends[i]->Write_Emit_FMT(f->msg_type)) {
+                continue;
+            }
+            f->sent_mask |= (1U<<i);
+        }
+        if (backends[i]->bufferspace_available() < len) {
+            continue;
+        }
+        backends[i]->WritePrioritisedBlock(pkt, len, is_critical);
+    }
+}
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 void AP_Logger::assert_same_fmt_for_name(const AP_Logger::log_write_fmt *f,
                                                const char *name,
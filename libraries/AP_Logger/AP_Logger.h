@@ -23,6 +23,11 @@
 #include <stdint.h>
 
 #include "LoggerMessageWriter.h"
+#include "LogPacker.h"
+
+#ifndef HAL_LOGGER_FILE_ASYNC_ENABLED
+#define HAL_LOGGER_FILE_ASYNC_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
 
 class AP_Logger_Backend;
 class AP_AHRS;
@@ -181,6 +186,7 @@ class AC_PosControl;
 class AP_Logger
 {
     friend class AP_Logger_Backend; // for _num_types
+    friend class AP_Logger_Benchmark; // benchmarks/benchmark_logger_write.cpp
 
 public:
     FUNCTOR_TYPEDEF(vehicle_startup_message_Writer, void);
@@ -292,6 +298,53 @@ public:
     void WriteCritical(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, ...);
     void WriteV(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, va_list arg_list, bool is_critical=false);
 
+    // this structure looks much like struct LogStructure in
+    // LogStructure.h, however we need to remember a pointer value for
+    // efficiency of finding message types
+    struct log_write_fmt {
+        struct log_write_fmt *next;
+        uint8_t msg_type;
+        uint8_t msg_len;
+        uint8_t sent_mask; // bitmask of backends sent to
+        const char *name;
+        const char *fmt;
+        const char *labels;
+        const char *units;
+        const char *mults;
+    };
+
+    /*
+      prepared format handles. get_write_handle() maps a name to its
+      message type once; passing the handle to Write() then skips the
+      lookup by name on every call. Handles remain valid for the
+      lifetime of the logger. Returns nullptr on failure.
+     */
+    typedef struct log_write_fmt *WriteHandle;
+    WriteHandle get_write_handle(const char *name, const char *labels, const char *fmt) {
+        return get_write_handle(name, labels, nullptr, nullptr, fmt);
+    }
+    WriteHandle get_write_handle(const char *name, const char *labels, const char *units, const char *mults, const char *fmt);
+    void Write(WriteHandle handle, ...);
+    void WriteCritical(WriteHandle handle, ...);
+    void WriteV(WriteHandle handle, va_list arg_list, bool is_critical=false);
+
+    // write a message whose fields were packed at compile time; see
+    // LogPacker.h and AP_LOGGER_WRITE_PACKED
+    template <typename... Ts>
+    void WritePacked(WriteHandle handle, const Ts&... args) {
+        uint8_t pkt[LogPacker::check<LogPacker::types<Ts...>>::msg_len];
+        LogPacker::pack(&pkt[3], args...);
+        WritePacket(handle, pkt, sizeof(pkt), false);
+    }
+    template <typename... Ts>
+    void WriteCriticalPacked(WriteHandle handle, const Ts&... args) {
+        uint8_t pkt[LogPacker::check<LogPacker::types<Ts...>>::msg_len];
+        LogPacker::pack(&pkt[3], args...);
+        WritePacket(handle, pkt, sizeof(pkt), true);
+    }
+    // fill in the header of a packed message and write it out
+    void WritePacket(WriteHandle handle, uint8_t *pkt, uint8_t len, bool is_critical);
+
     // This structure provides information on the internal member data of a PID for logging purposes
     struct PID_Info {
         float target;
@@ -339,6 +392,9 @@ public:
         AP_Int8 log_replay;
         AP_Int8 mav_bufsize; // in kilobytes
         AP_Int16 file_timeout; // in seconds
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+        AP_Int8 file_async;
+#endif
     } _params;
 
     const struct LogStructure *structure(uint16_t num) const;
@@ -403,20 +459,7 @@ private:
      * labels and values in a single function call.
      */
 
-    // this structure looks much like struct LogStructure in
-    // LogStructure.h, however we need to remember a pointer value for
-    // efficiency of finding message types
-    struct log_write_fmt {
-        struct log_write_fmt *next;
-        uint8_t msg_type;
-        uint8_t msg_len;
-        uint8_t sent_mask; // bitmask of backends sent to
-        const char *name;
-        const char *fmt;
-        const char *labels;
-        const char *units;
-        const char *mults;
-    } *log_write_fmts;
+    struct log_write_fmt *log_write_fmts;
 
     // return (possibly allocating) a log_write_fmt for a name
     struct log_write_fmt *msg_fmt_for_name(const char *name, const char *labels, const char *units, const char *mults, const char *fmt);
@@ -0,0 +1,467 @@
+/*
+   AP_Logger asynchronous file writer for Linux
+ */
+
+#include "AP_Logger_AsyncWriter.h"
+
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+#ifndef HAVE_IO_URING
+#define HAVE_IO_URING 0
+#endif
+
+extern const AP_HAL::HAL& hal;
+
+// O_DIRECT needs buffers, lengths and offsets aligned to the logical
+// block size; a page covers every device we care about
+#define ASYNC_ALIGN 4096U
+
+AP_Logger_AsyncWriter::~AP_Logger_AsyncWriter()
+{
+    if (_fd != -1) {
+        wait_idle();
+    }
+    ring_teardown();
+    for (uint8_t i=0; i<ARRAY_SIZE(_buf); i++) {
+        free(_buf[i].data);
+    }
+}
+
+bool AP_Logger_AsyncWriter::init()
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(_buf); i++) {
+        if (_buf[i].data != nullptr) {
+            continue;
+        }
+        void *p = nullptr;
+        if (posix_memalign(&p, ASYNC_ALIGN, HAL_LOGGER_FILE_ASYNC_BUFSIZE) != 0) {
+            return false;
+        }
+        memset(p, 0, HAL_LOGGER_FILE_ASYNC_BUFSIZE);
+        _buf[i].data = (uint8_t *)p;
+    }
+    if (!ring_setup()) {
+        hal.console->printf("AP_Logger: io_uring unavailable, using POSIX AIO\n");
+    }
+    return true;
+}
+
+void AP_Logger_AsyncWriter::begin(int fd, bool direct)
+{
+    _fd = fd;
+    _direct = direct;
+    _cur = 0;
+    _stalled = false;
+    _failed = false;
+    _gave_up = false;
+    for (uint8_t i=0; i<ARRAY_SIZE(_buf); i++) {
+        _buf[i].fill = 0;
+        _buf[i].offset = 0;
+        _buf[i].retries = 0;
+        _buf[i].state = BufState::IDLE;
+    }
+    _buf[_cur].state = BufState::FILLING;
+    _prealloc_end = 0;
+    preallocate(HAL_LOGGER_FILE_PREALLOCATE);
+}
+
+bool AP_Logger_AsyncWriter::busy() const
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(_buf); i++) {
+        if (_buf[i].state == BufState::INFLIGHT ||
+            _buf[i].state == BufState::PENDING ||
+            _buf[i].fill != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  reserve file space ahead of the writes so the filesystem does not
+  have to allocate blocks (and update metadata) on every write
+ */
+void AP_Logger_AsyncWriter::preallocate(uint64_t end)
+{
+    if (end <= _prealloc_end) {
+        return;
+    }
+    if (fallocate(_fd, FALLOC_FL_KEEP_SIZE, _prealloc_end, end - _prealloc_end) == 0) {
+        _prealloc_end = end;
+    } else {
+        // not supported by this filesystem; don't try again
+        _prealloc_end = UINT64_MAX;
+    }
+}
+
+uint32_t AP_Logger_AsyncWriter::write(const uint8_t *data, uint32_t len)
+{
+    uint32_t accepted = 0;
+    while (accepted < len) {
+        struct buffer &b = _buf[_cur];
+        if (b.fill == HAL_LOGGER_FILE_ASYNC_BUFSIZE) {
+            if (other().state != BufState::IDLE) {
+                // both buffers busy; leave the rest in the caller's buffer
+                if (!_stalled) {
+                    _stalled = true;
+                    _stats.stalls++;
+                }
+                break;
+            }
+            _stalled = false;
+            submit(_cur, b.fill);
+            struct buffer &n = other();
+            n.offset = b.offset + b.fill;
+            n.fill = 0;
+            n.state = BufState::FILLING;
+            _cur ^= 1;
+            if (n.offset + HAL_LOGGER_FILE_PREALLOCATE/2 > _prealloc_end) {
+                preallocate(n.offset + HAL_LOGGER_FILE_PREALLOCATE);
+            }
+            continue;
+        }
+        const uint32_t n = MIN(len - accepted, HAL_LOGGER_FILE_ASYNC_BUFSIZE - b.fill);
+        memcpy(&b.data[b.fill], &data[accepted], n);
+        b.fill += n;
+        accepted += n;
+    }
+    return accepted;
+}
+
+void AP_Logger_AsyncWriter::flush_partial()
+{
+    struct buffer &b = _buf[_cur];
+    if (b.fill == 0 || other().state != BufState::IDLE) {
+        return;
+    }
+    // pad to the block size; the padding is overwritten when the
+    // buffer is next written, or trimmed by finish()
+    const uint32_t len = _direct ? ((b.fill + ASYNC_ALIGN - 1) & ~(ASYNC_ALIGN - 1)) : b.fill;
+    if (len > b.fill) {
+        memset(&b.data[b.fill], 0, len - b.fill);
+    }
+    submit(_cur, len);
+    // carry on filling a copy of the partial data at the same offset;
+    // it is only submitted once this write has completed
+    struct buffer &n = other();
+    memcpy(n.data, b.data, b.fill);
+    n.fill = b.fill;
+    n.offset = b.offset;
+    n.state = BufState::FILLING;
+    _cur ^= 1;
+}
+
+void AP_Logger_AsyncWriter::submit(uint8_t idx, uint32_t len)
+{
+    struct buffer &b = _buf[idx];
+    b.write_len = len;
+    b.submit_us = AP_HAL::micros();
+    b.iov.iov_base = b.data;
+    b.iov.iov_len = len;
+    b.state = BufState::INFLIGHT;
+    const bool ok = using_io_uring() ? ring_submit(b, idx) : aio_submit(b);
+    if (!ok) {
+        b.state = BufState::PENDING;
+        _stats.errors++;
+        _failed = true;
+    }
+}
+
+void AP_Logger_AsyncWriter::complete(uint8_t idx, int32_t res)
+{
+    struct buffer &b = _buf[idx];
+    if (b.state != BufState::INFLIGHT) {
+        return;
+    }
+    if (res != (int32_t)b.write_len) {
+        // failed or short write; try the whole buffer again
+        b.state = BufState::PENDING;
+        _stats.errors++;
+        _failed = true;
+        return;
+    }
+    const uint32_t latency = AP_HAL::micros() - b.submit_us;
+    _stats.writes++;
+    _stats.latency_sum_us += latency;
+    _stats.latency_max_us = MAX(_stats.latency_max_us, latency);
+    b.fill = 0;
+    b.retries = 0;
+    b.state = BufState::IDLE;
+}
+
+bool AP_Logger_AsyncWriter::update()
+{
+    if (using_io_uring()) {
+        ring_reap(false);
+    } else {
+        aio_reap(false);
+    }
+    for (uint8_t i=0; i<ARRAY_SIZE(_buf); i++) {
+        if (_buf[i].state == BufState::PENDING) {
+            if (_buf[i].retries >= HAL_LOGGER_FILE_ASYNC_MAX_RETRIES) {
+                _gave_up = true;
+                continue;
+            }
+            _buf[i].retries++;
+            submit(i, _buf[i].write_len);
+        }
+    }
+    const bool ret = !_failed;
+    _failed = false;
+    return ret;
+}
+
+void AP_Logger_AsyncWriter::wait_idle()
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(_buf); i++) {
+        while (_buf[i].state == BufState::INFLIGHT) {
+            if (using_io_uring()) {
+                ring_reap(true);
+            } else {
+                aio_reap(true);
+            }
+        }
+    }
+}
+
+void AP_Logger_AsyncWriter::sync()
+{
+    update();
+    wait_idle();
+    flush_partial();
+    wait_idle();
+}
+
+bool AP_Logger_AsyncWriter::finish()
+{
+    if (_fd == -1) {
+        return true;
+    }
+    wait_idle();
+
+    bool ret = true;
+    uint64_t end = 0;
+    // a failed buffer is always older than the filling one
+    for (uint8_t i=0; i<ARRAY_SIZE(_buf); i++) {
+        struct buffer &b = (i == 0) ? other() : _buf[_cur];
+        if (b.state == BufState::IDLE || b.fill == 0) {
+            continue;
+        }
+        if (_direct) {
+            // the tail is not block sized; finish it with buffered IO
+            fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) & ~O_DIRECT);
+            _direct = false;
+        }
+        if (pwrite(_fd, b.data, b.fill, b.offset) != (ssize_t)b.fill) {
+            _stats.errors++;
+            ret = false;
+        }
+        end = MAX(end, b.offset + b.fill);
+        b.fill = 0;
+        b.state = BufState::IDLE;
+    }
+    if (end != 0 && ftruncate(_fd, end) != 0) {
+        ret = false;
+    }
+    _fd = -1;
+    return ret;
+}
+
+void AP_Logger_AsyncWriter::get_stats(struct stats &s)
+{
+    s = _stats;
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+/*
+  POSIX AIO submission; used where io_uring is not available
+ */
+bool AP_Logger_AsyncWriter::aio_submit(struct buffer &b)
+{
+    memset(&b.cb, 0, sizeof(b.cb));
+    b.cb.aio_fildes = _fd;
+    b.cb.aio_buf = b.data;
+    b.cb.aio_nbytes = b.write_len;
+    b.cb.aio_offset = b.offset;
+    b.cb.aio_sigevent.sigev_notify = SIGEV_NONE;
+    return aio_write(&b.cb) == 0;
+}
+
+void AP_Logger_AsyncWriter::aio_reap(bool wait)
+{
+    for (uint8_t i=0; i<ARRAY_SIZE(_buf); i++) {
+        struct buffer &b = _buf[i];
+        if (b.state != BufState::INFLIGHT) {
+            continue;
+        }
+        if (wait) {
+            const struct aiocb *list[1] = { &b.cb };
+            aio_suspend(list, 1, nullptr);
+        }
+        const int err = aio_error(&b.cb);
+        if (err == EINPROGRESS) {
+            continue;
+        }
+        const ssize_t res = aio_return(&b.cb);
+        complete(i, err == 0 ? res : -err);
+    }
+}
+
+#if HAVE_IO_URING
+/*
+  io_uring setup using the raw system calls, so we don't depend on
+  liburing being installed on the board
+ */
+bool AP_Logger_AsyncWriter::ring_setup()
+{
+    if (_ring_fd != -1) {
+        return true;
+    }
+    struct io_uring_params p {};
+    const int fd = syscall(__NR_io_uring_setup, 4, &p);
+    if (fd < 0) {
+        return false;
+    }
+
+    _sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    _cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        _sq_ring_size = _cq_ring_size = MAX(_sq_ring_size, _cq_ring_size);
+    }
+    _sq_ptr = mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (_sq_ptr == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    if (single_mmap) {
+        _cq_ptr = _sq_ptr;
+    } else {
+        _cq_ptr = mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (_cq_ptr == MAP_FAILED) {
+            munmap(_sq_ptr, _sq_ring_size);
+            close(fd);
+            return false;
+        }
+    }
+    _sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        if (!single_mmap) {
+            munmap(_cq_ptr, _cq_ring_size);
+        }
+        munmap(_sq_ptr, _sq_ring_size);
+        close(fd);
+        return false;
+    }
+
+    uint8_t *sq = (uint8_t *)_sq_ptr;
+    _sq.head = (uint32_t *)(sq + p.sq_off.head);
+    _sq.tail = (uint32_t *)(sq + p.sq_off.tail);
+    _sq.mask = (uint32_t *)(sq + p.sq_off.ring_mask);
+    _sq.array = (uint32_t *)(sq + p.sq_off.array);
+    _sq.sqes = (struct io_uring_sqe *)sqes;
+
+    uint8_t *cq = (uint8_t *)_cq_ptr;
+    _cq.head = (uint32_t *)(cq + p.cq_off.head);
+    _cq.tail = (uint32_t *)(cq + p.cq_off.tail);
+    _cq.mask = (uint32_t *)(cq + p.cq_off.ring_mask);
+    _cq.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    _ring_fd = fd;
+    return true;
+}
+
+void AP_Logger_AsyncWriter::ring_teardown()
+{
+    if (_ring_fd == -1) {
+        return;
+    }
+    munmap(_sq.sqes, _sqes_size);
+    if (_cq_ptr != _sq_ptr) {
+        munmap(_cq_ptr, _cq_ring_size);
+    }
+    munmap(_sq_ptr, _sq_ring_size);
+    close(_ring_fd);
+    _ring_fd = -1;
+}
+
+bool AP_Logger_AsyncWriter::ring_submit(struct buffer &b, uint8_t idx)
+{
+    const uint32_t tail = *_sq.tail;
+    const uint32_t index = tail & *_sq.mask;
+    struct io_uring_sqe *sqe = &_sq.sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    // WRITEV rather than WRITE keeps us working on 5.1+ kernels
+    sqe->opcode = IORING_OP_WRITEV;
+    sqe->fd = _fd;
+    sqe->addr = (uint64_t)(uintptr_t)&b.iov;
+    sqe->len = 1;
+    sqe->off = b.offset;
+    sqe->user_data = idx;
+    _sq.array[index] = index;
+    __atomic_store_n(_sq.tail, tail + 1, __ATOMIC_RELEASE);
+
+    // if the kernel doesn't take the entry now it stays queued and
+    // goes with the next ring_enter()
+    ring_enter(false);
+    return true;
+}
+
+void AP_Logger_AsyncWriter::ring_enter(bool wait)
+{
+    const uint32_t to_submit = *_sq.tail - __atomic_load_n(_sq.head, __ATOMIC_ACQUIRE);
+    if (to_submit == 0 && !wait) {
+        return;
+    }
+    syscall(__NR_io_uring_enter, _ring_fd, to_submit, wait ? 1 : 0,
+            wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+}
+
+void AP_Logger_AsyncWriter::ring_reap(bool wait)
+{
+    ring_enter(wait);
+    uint32_t head = *_cq.head;
+    const uint32_t tail = __atomic_load_n(_cq.tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const struct io_uring_cqe &cqe = _cq.cqes[head & *_cq.mask];
+        if (cqe.user_data < ARRAY_SIZE(_buf)) {
+            complete(cqe.user_data, cqe.res);
+        }
+        head++;
+    }
+    __atomic_store_n(_cq.head, head, __ATOMIC_RELEASE);
+}
+
+#else // HAVE_IO_URING
+
+bool AP_Logger_AsyncWriter::ring_setup() { return false; }
+void AP_Logger_AsyncWriter::ring_teardown() {}
+bool AP_Logger_AsyncWriter::ring_submit(struct buffer &b, uint8_t idx) { return false; }
+void AP_Logger_AsyncWriter::ring_enter(bool wait) {}
+void AP_Logger_AsyncWriter::ring_reap(bool wait) {}
+
+#endif // HAVE_IO_URING
+
+#endif // HAL_LOGGER_FILE_ASYNC_ENABLED
@@ -0,0 +1,159 @@
+/*
+   AP_Logger asynchronous file writer for Linux
+
+   Double-buffered writer used by AP_Logger_File. The IO thread copies
+   log data into the filling buffer while the other buffer is being
+   written by the kernel, so a slow SD card no longer blocks the IO
+   thread inside write()/fsync(). Writes are submitted with io_uring
+   where the kernel supports it, falling back to POSIX AIO otherwise.
+   Buffers are page aligned so the file may be opened with O_DIRECT,
+   and file space is preallocated ahead of the write offset.
+
+   All methods must be called with the owning backend's
+   write_fd_semaphore held.
+ */
+#pragma once
+
+#include "AP_Logger.h"
+
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+
+#include <aio.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#ifndef HAL_LOGGER_FILE_ASYNC_BUFSIZE
+#define HAL_LOGGER_FILE_ASYNC_BUFSIZE (64*1024U)
+#endif
+
+#ifndef HAL_LOGGER_FILE_PREALLOCATE
+#define HAL_LOGGER_FILE_PREALLOCATE (16*1024*1024U)
+#endif
+
+// number of times a failed write is resubmitted before giving up
+#ifndef HAL_LOGGER_FILE_ASYNC_MAX_RETRIES
+#define HAL_LOGGER_FILE_ASYNC_MAX_RETRIES 10
+#endif
+
+class AP_Logger_AsyncWriter
+{
+public:
+    ~AP_Logger_AsyncWriter();
+
+    // allocate buffers and set up the submission method. Returns
+    // false if asynchronous writes are not possible
+    bool init();
+
+    // start writing at offset 0 of fd. direct must be true if fd was
+    // opened with O_DIRECT
+    void begin(int fd, bool direct);
+
+    // copy up to len bytes into the filling buffer, submitting it
+    // when full. Returns the number of bytes accepted, which is less
+    // than len while both buffers are busy
+    uint32_t write(const uint8_t *data, uint32_t len);
+
+    // submit the partially filled buffer so it reaches the disk; the
+    // data stays buffered and is rewritten once the buffer fills
+    void flush_partial();
+
+    // reap completed writes and resubmit failed ones. Returns false
+    // if a write has failed since the last call
+    bool update();
+
+    // true once a write has failed HAL_LOGGER_FILE_ASYNC_MAX_RETRIES
+    // times in a row; nothing more is submitted until begin()
+    bool gave_up() const { return _gave_up; }
+
+    // write out all buffered data, including a partial buffer, and
+    // wait for it to complete
+    void sync();
+
+    // wait for all writes, write out any remaining data and trim
+    // padding from the file. The fd is left open
+    bool finish();
+
+    // true if data is buffered or being written
+    bool busy() const;
+
+    // true if io_uring is used rather than POSIX AIO
+    bool using_io_uring() const { return _ring_fd != -1; }
+
+    struct stats {
+        uint32_t writes;         // completed writes
+        uint32_t latency_sum_us; // sum of submission to completion times
+        uint32_t latency_max_us;
+        uint32_t stalls;         // times write() found both buffers busy
+        uint32_t errors;
+    };
+    // return stats gathered since the last call, and reset them
+    void get_stats(struct stats &s);
+
+private:
+    enum class BufState : uint8_t {
+        FILLING,
+        INFLIGHT,
+        PENDING,  // write failed, to be resubmitted
+        IDLE,
+    };
+
+    struct buffer {
+        uint8_t *data;
+        uint32_t fill;        // bytes of log data
+        uint32_t write_len;   // bytes submitted, padded for O_DIRECT
+        uint64_t offset;      // file offset of data[0]
+        uint32_t submit_us;
+        uint8_t retries;      // resubmissions since the last good write
+        BufState state;
+        struct iovec iov;
+        struct aiocb cb;
+    } _buf[2];
+
+    uint8_t _cur;             // buffer being filled
+    int _fd = -1;
+    bool _direct;
+    bool _stalled;
+    bool _failed;
+    bool _gave_up;
+    uint64_t _prealloc_end;
+    struct stats _stats;
+
+    // io_uring state; _ring_fd is -1 when POSIX AIO is used
+    int _ring_fd = -1;
+    struct {
+        uint32_t *head;
+        uint32_t *tail;
+        uint32_t *mask;
+        uint32_t *array;
+        struct io_uring_sqe *sqes;
+    } _sq;
+    struct {
+        uint32_t *head;
+        uint32_t *tail;
+        uint32_t *mask;
+        struct io_uring_cqe *cqes;
+    } _cq;
+    void *_sq_ptr;
+    void *_cq_ptr;
+    uint32_t _sq_ring_size;
+    uint32_t _cq_ring_size;
+    uint32_t _sqes_size;
+
+    bool ring_setup();
+    void ring_teardown();
+    bool ring_submit(struct buffer &b, uint8_t idx);
+    void ring_enter(bool wait);
+    void ring_reap(bool wait);
+
+    bool aio_submit(struct buffer &b);
+    void aio_reap(bool wait);
+
+    void submit(uint8_t idx, uint32_t len);
+    void complete(uint8_t idx, int32_t res);
+    void wait_idle();
+    void preallocate(uint64_t end);
+
+    struct buffer &other() { return _buf[_cur ^ 1]; }
+};
+
+#endif // HAL_LOGGER_FILE_ASYNC_ENABLED
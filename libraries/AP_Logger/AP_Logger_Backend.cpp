@@ -175,32 +175,39 @@ bool AP_Logger_Backend::Write_Emit_FMT(uint8_t msg_type)
 
 bool AP_Logger_Backend::Write(const uint8_t msg_type, va_list arg_list, bool is_critical)
 {
-    // stack-allocate a buffer so we can WriteBlock(); this could be
-    // 255 bytes!  If we were willing to lose the WriteBlock
-    // abstraction we could do WriteBytes() here instead?
-    const char *fmt  = nullptr;
-    uint8_t msg_len;
-    AP_Logger::log_write_fmt *f;
-    for (f = _front.log_write_fmts; f; f=f->next) {
-        if (f->msg_type == msg_type) {
-            fmt = f->fmt;
-            msg_len = f->msg_len;
-            break;
-        }
-    }
-    if (fmt == nullptr) {
+    const AP_Logger::log_write_fmt *f = _front.log_write_fmt_for_msg_type(msg_type);
+    if (f == nullptr) {
         AP::internalerror().error(AP_InternalError::error_t::logger_logwrite_missingfmt);
         return false;
     }
+    return Write(msg_type, f->msg_len, f->fmt, arg_list, is_critical);
+}
+
+bool AP_Logger_Backend::Write(const uint8_t msg_type, const uint8_t msg_len, const char *fmt, va_list arg_list, bool is_critical)
+{
+    // stack-allocate a buffer so we can WriteBlock(); this could be
+    // 255 bytes!  If we were willing to lose the WriteBlock
+    // abstraction we could do WriteBytes() here instead?
     if (bufferspace_available() < msg_len) {
         return false;
     }
     uint8_t buffer[msg_len];
+    buffer[0] = HEAD_BYTE1;
+    buffer[1] = HEAD_BYTE2;
+    buffer[2] = msg_type;
+    Write_pack(&buffer[3], fmt, arg_list);
+
+    return WritePrioritisedBlock(buffer, msg_len, is_critical);
+}
+
+/*
+  pack the fields described by fmt from arg_list into buffer
+ */
+void AP_Logger_Backend::Write_pack(uint8_t *buffer, const char *fmt, va_list arg_list)
+{
     uint8_t offset = 0;
-    buffer[offset++] = HEAD_BYTE1;
-    buffer[offset++] = HEAD_BYTE2;
-    buffer[offset++] = msg_type;
-    for (uint8_t i=0; i<strlen(fmt); i++) {
+    const uint8_t fmt_len = strlen(fmt);
+    for (uint8_t i=0; i<fmt_len; i++) {
         uint8_t charlen = 0;
         switch(fmt[i]) {
         case 'b': {
@@ -292,8 +299,6 @@ bool AP_Logger_Backend::Write(const uint8_t msg_type, va_list arg_list, bool is_
             offset += charlen;
         }
     }
-
-    return WritePrioritisedBlock(buffer, msg_len, is_critical);
 }
 
 bool AP_Logger_Backend::StartNewLogOK() const
@@ -2,6 +2,8 @@
 
 #include "AP_Logger.h"
 
+#include <atomic>
+
 class LoggerMessageWriter_DFLogStart;
 
 class AP_Logger_Backend
@@ -113,6 +115,13 @@ public:
     // write a log message out to the log of msg_type type, with
     // values contained in arg_list:
     bool Write(uint8_t msg_type, va_list arg_list, bool is_critical=false);
+    // as above, but with the format already looked up by the
+    // frontend; avoids walking the format list per message
+    bool Write(uint8_t msg_type, uint8_t msg_len, const char *fmt, va_list arg_list, bool is_critical=false);
+
+    // pack the fields described by fmt from arg_list into buffer
+    // (which starts after the message header)
+    static void Write_pack(uint8_t *buffer, const char *fmt, va_list arg_list);
 
     // these methods are used when reporting system status over mavlink
     virtual bool logging_enabled() const = 0;
@@ -147,7 +156,9 @@ protected:
     LoggerMessageWriter_DFLogStart *_startup_messagewriter;
     bool _writing_startup_messages;
 
-    uint32_t _dropped;
+    // incremented by every thread writing to the log, some of them
+    // without holding the backend's semaphore
+    std::atomic<uint32_t> _dropped;
 
     // must be called when a new log is being started:
     virtual void start_new_log_reset_variables();
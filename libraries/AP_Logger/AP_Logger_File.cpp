@@ -52,6 +52,12 @@ AP_Logger_File::AP_Logger_File(AP_Logger &front,
     _perf_overruns(hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, "DF_overruns"))
 {
     df_stats_clear();
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    for (uint8_t i=0; i<HAL_LOGGER_FILE_STAGING_MAX_THREADS; i++) {
+        _staging[i] = nullptr;
+    }
+    _staging_count = 0;
+#endif
 }
 
 
@@ -100,6 +106,19 @@ void AP_Logger_File::Init()
 
     hal.console->printf("AP_Logger_File: buffer size=%u\n", (unsigned)bufsize);
 
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+    if (_front._params.file_async != 0 && _async == nullptr) {
+        _async = new AP_Logger_AsyncWriter();
+        if (_async != nullptr && !_async->init()) {
+            delete _async;
+            _async = nullptr;
+        }
+        if (_async == nullptr) {
+            hal.console->printf("AP_Logger: asynchronous writes unavailable\n");
+        }
+    }
+#endif
+
     _initialised = true;
     hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&AP_Logger_File::_io_timer, void));
 }
@@ -484,10 +503,32 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
         return false;
     }
 
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    if (!is_critical && !_writing_startup_messages) {
+        // critical blocks (including FMT messages) go straight into
+        // _writebuf so they always precede staged data which uses them
+        ByteBuffer *ring = staging_ring();
+        if (ring != nullptr) {
+            if (!stage_block(*ring, pBuffer, size)) {
+                hal.util->perf_count(_perf_overruns);
+                _dropped++;
+                return false;
+            }
+            return true;
+        }
+    }
+#endif
+
     if (!semaphore.take(1)) {
         return false;
     }
-        
+
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    if (is_critical) {
+        staging_flush_thread(size);
+    }
+#endif
+
     uint32_t space = _writebuf.space();
 
     if (_writing_startup_messages &&
@@ -783,6 +824,13 @@ void AP_Logger_File::stop_logging(void)
     if (_write_fd != -1) {
         int fd = _write_fd;
         _write_fd = -1;
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+        if (_async != nullptr) {
+            // wait for outstanding writes and write out the tail
+            EXPECT_DELAY_MS(3000);
+            _async->finish();
+        }
+#endif
         AP::FS().close(fd);
     }
     if (have_sem) {
@@ -854,7 +902,19 @@ uint16_t AP_Logger_File::start_new_log(void)
 #endif
 
     EXPECT_DELAY_MS(3000);
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+    bool direct = false;
+    if (_async != nullptr && _front._params.file_async == 2) {
+        // not all filesystems support direct IO
+        _write_fd = AP::FS().open(_write_filename, O_WRONLY|O_CREAT|O_TRUNC|O_DIRECT);
+        direct = (_write_fd != -1);
+    }
+    if (_write_fd == -1) {
+        _write_fd = AP::FS().open(_write_filename, O_WRONLY|O_CREAT|O_TRUNC);
+    }
+#else
     _write_fd = AP::FS().open(_write_filename, O_WRONLY|O_CREAT|O_TRUNC);
+#endif
     _cached_oldest_log = 0;
 
     if (_write_fd == -1) {
@@ -871,6 +931,17 @@ uint16_t AP_Logger_File::start_new_log(void)
     _last_write_ms = AP_HAL::millis();
     _write_offset = 0;
     _writebuf.clear();
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+    if (_async != nullptr) {
+        _async->begin(_write_fd, direct);
+    }
+#endif
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    {
+        WITH_SEMAPHORE(semaphore);
+        staging_discard();
+    }
+#endif
     write_fd_semaphore.give();
 
     // now update lastlog.txt with the new log number
@@ -906,6 +977,12 @@ void AP_Logger_File::flush(void)
 #if APM_BUILD_TYPE(APM_BUILD_Replay) || APM_BUILD_TYPE(APM_BUILD_UNKNOWN)
 {
     uint32_t tnow = AP_HAL::millis();
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    {
+        WITH_SEMAPHORE(semaphore);
+        staging_drain();
+    }
+#endif
     while (_write_fd != -1 && _initialised && !_open_error && _writebuf.available()) {
         // convince the IO timer that it really is OK to write out
         // less than _writebuf_chunk bytes:
@@ -916,6 +993,11 @@ void AP_Logger_File::flush(void)
     }
     if (write_fd_semaphore.take(1)) {
         if (_write_fd != -1) {
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+            if (_async != nullptr) {
+                _async->sync();
+            }
+#endif
             ::fsync(_write_fd);
         }
         write_fd_semaphore.give();
@@ -938,6 +1020,20 @@ void AP_Logger_File::_io_timer(void)
         return;
     }
 
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    if (semaphore.take(1)) {
+        staging_drain();
+        semaphore.give();
+    }
+#endif
+
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+    if (_async != nullptr) {
+        _io_timer_async(tnow);
+        return;
+    }
+#endif
+
     uint32_t nbytes = _writebuf.available();
     if (nbytes == 0) {
         return;
@@ -948,17 +1044,8 @@ void AP_Logger_File::_io_timer(void)
         // least once per 2 seconds if data is available
         return;
     }
-    if (tnow - _free_space_last_check_time > _free_space_check_interval) {
-        _free_space_last_check_time = tnow;
-        last_io_operation = "disk_space_avail";
-        if (disk_space_avail() < _free_space_min_avail && disk_space() > 0) {
-            hal.console->printf("Out of space for logging\n");
-            stop_logging();
-            _open_error = true; // prevent logging starting again
-            last_io_operation = "";
-            return;
-        }
-        last_io_operation = "";
+    if (!check_free_space(tnow)) {
+        return;
     }
 
     hal.util->perf_begin(_perf_write);
@@ -989,7 +1076,9 @@ void AP_Logger_File::_io_timer(void)
         write_fd_semaphore.give();
         return;
     }
+    const uint32_t write_start_us = AP_HAL::micros();
     ssize_t nwritten = AP::FS().write(_write_fd, head, nbytes);
+    df_stats_gather_write(AP_HAL::micros() - write_start_us);
     last_io_operation = "";
     if (nwritten <= 0) {
         if ((tnow - _last_write_ms)/1000U > unsigned(_front._params.file_timeout)) {
@@ -1039,6 +1128,247 @@ void AP_Logger_File::_io_timer(void)
     hal.util->perf_end(_perf_write);
 }
 
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+/*
+  return the staging ring for the calling thread. Each thread claims a
+  ring the first time it writes a non-critical block; threads beyond
+  HAL_LOGGER_FILE_STAGING_MAX_THREADS use the locked path instead
+ */
+ByteBuffer *AP_Logger_File::staging_ring(bool claim)
+{
+    static thread_local struct {
+        const AP_Logger_File *owner;
+        ByteBuffer *ring;
+    } slot;
+
+    if (slot.owner == this) {
+        return slot.ring;
+    }
+    if (!claim) {
+        return nullptr;
+    }
+    slot.owner = this;
+    slot.ring = nullptr;
+
+    uint8_t idx = _staging_count;
+    do {
+        if (idx >= HAL_LOGGER_FILE_STAGING_MAX_THREADS) {
+            return nullptr;
+        }
+    } while (!_staging_count.compare_exchange_weak(idx, idx+1));
+
+    ByteBuffer *ring = new ByteBuffer(HAL_LOGGER_FILE_STAGING_SIZE);
+    if (ring == nullptr) {
+        return nullptr;
+    }
+    if (ring->get_size() == 0) {
+        delete ring;
+        return nullptr;
+    }
+    _staging[idx] = ring;
+    slot.ring = ring;
+    return ring;
+}
+
+/*
+  write a block into a staging ring, prefixed with its length. The
+  block is published with a single commit so the IO thread never sees
+  a partial block
+ */
+bool AP_Logger_File::stage_block(ByteBuffer &ring, const void *pBuffer, uint16_t size)
+{
+    const uint32_t len = sizeof(size) + size;
+    if (ring.space() < len) {
+        return false;
+    }
+    ByteBuffer::IoVec vec[2];
+    const uint8_t n_vec = ring.reserve(vec, len);
+    uint8_t v = 0;
+    uint32_t ofs = 0;
+    auto put = [&](const uint8_t *data, uint32_t n) {
+        while (n > 0 && v < n_vec) {
+            const uint32_t c = MIN(n, vec[v].len - ofs);
+            memcpy(&vec[v].data[ofs], data, c);
+            data += c;
+            n -= c;
+            ofs += c;
+            if (ofs == vec[v].len) {
+                v++;
+                ofs = 0;
+            }
+        }
+    };
+    put((const uint8_t *)&size, sizeof(size));
+    put((const uint8_t *)pBuffer, size);
+    return ring.commit(len);
+}
+
+/*
+  move complete blocks from the staging rings into _writebuf. Blocks
+  stay staged while _writebuf is short of space, keeping the reserve
+  for critical messages
+ */
+void AP_Logger_File::staging_drain()
+{
+    const uint8_t count = MIN(_staging_count.load(), HAL_LOGGER_FILE_STAGING_MAX_THREADS);
+    for (uint8_t i=0; i<count; i++) {
+        ByteBuffer *ring = _staging[i];
+        if (ring == nullptr) {
+            continue;
+        }
+        if (!staging_drain_ring(*ring, critical_message_reserved_space())) {
+            return;
+        }
+    }
+}
+
+bool AP_Logger_File::staging_drain_ring(ByteBuffer &ring, uint32_t reserve)
+{
+    uint16_t size;
+    while (ring.peekbytes((uint8_t *)&size, sizeof(size)) == sizeof(size) &&
+           ring.available() >= sizeof(size) + size) {
+        if (_writebuf.space() < size + reserve) {
+            return false;
+        }
+        ring.advance(sizeof(size));
+        ByteBuffer::IoVec vec[2];
+        const uint8_t n_vec = ring.peekiovec(vec, size);
+        for (uint8_t v=0; v<n_vec; v++) {
+            _writebuf.write(vec[v].data, vec[v].len);
+        }
+        ring.advance(size);
+        df_stats_gather(size);
+    }
+    return true;
+}
+
+/*
+  a thread's staged blocks must reach the log before its next critical
+  block, otherwise the IO thread could write them after it. Blocks
+  which do not fit ahead of the critical block are dropped
+ */
+void AP_Logger_File::staging_flush_thread(uint16_t size)
+{
+    ByteBuffer *ring = staging_ring(false);
+    if (ring == nullptr) {
+        return;
+    }
+    if (staging_drain_ring(*ring, size)) {
+        return;
+    }
+    uint16_t staged_size;
+    while (ring->peekbytes((uint8_t *)&staged_size, sizeof(staged_size)) == sizeof(staged_size) &&
+           ring->available() >= sizeof(staged_size) + staged_size) {
+        ring->advance(sizeof(staged_size) + staged_size);
+        _dropped++;
+    }
+}
+
+void AP_Logger_File::staging_discard()
+{
+    const uint8_t count = MIN(_staging_count.load(), HAL_LOGGER_FILE_STAGING_MAX_THREADS);
+    for (uint8_t i=0; i<count; i++) {
+        ByteBuffer *ring = _staging[i];
+        if (ring != nullptr) {
+            ring->advance(ring->available());
+        }
+    }
+}
+#endif // HAL_LOGGER_FILE_STAGING_ENABLED
+
+bool AP_Logger_File::check_free_space(uint32_t tnow)
+{
+    if (tnow - _free_space_last_check_time > _free_space_check_interval) {
+        _free_space_last_check_time = tnow;
+        last_io_operation = "disk_space_avail";
+        if (disk_space_avail() < _free_space_min_avail && disk_space() > 0) {
+            hal.console->printf("Out of space for logging\n");
+            stop_logging();
+            _open_error = true; // prevent logging starting again
+            last_io_operation = "";
+            return false;
+        }
+        last_io_operation = "";
+    }
+    return true;
+}
+
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+/*
+  IO thread handling when writes are asynchronous. Data is copied
+  from _writebuf into the writer's buffers as fast as they are
+  written; the thread only blocks if the writer needs to preallocate
+  file space
+ */
+void AP_Logger_File::_io_timer_async(uint32_t tnow)
+{
+    if (!check_free_space(tnow)) {
+        return;
+    }
+    if (!write_fd_semaphore.take(1)) {
+        return;
+    }
+    if (_write_fd == -1) {
+        write_fd_semaphore.give();
+        return;
+    }
+
+    hal.util->perf_begin(_perf_write);
+    last_io_operation = "write";
+
+    if (!_async->update()) {
+        hal.util->perf_count(_perf_errors);
+        _last_write_failed = true;
+    } else {
+        _last_write_failed = false;
+        _last_write_ms = tnow;
+    }
+
+    uint32_t size;
+    const uint8_t *head;
+    while ((head = _writebuf.readptr(size)) != nullptr) {
+        const uint32_t n = _async->write(head, size);
+        _writebuf.advance(n);
+        _write_offset += n;
+        if (n < size) {
+            break;
+        }
+    }
+
+    // get data to the disk at least once per 2 seconds
+    if (tnow - _last_write_time > 2000UL) {
+        _last_write_time = tnow;
+        _async->flush_partial();
+    }
+
+    AP_Logger_AsyncWriter::stats s;
+    _async->get_stats(s);
+    stats.writes += s.writes;
+    stats.write_lat_sum += s.latency_sum_us;
+    stats.write_lat_max = MAX(stats.write_lat_max, s.latency_max_us);
+    stats.write_stalls += s.stalls;
+
+    if (_async->gave_up() ||
+        (_last_write_failed &&
+         (tnow - _last_write_ms)/1000U > unsigned(_front._params.file_timeout))) {
+        // as for synchronous writes, give up on the file if we can't
+        // write for LOG_FILE_TIMEOUT seconds, or if the same write
+        // keeps failing
+        hal.util->perf_count(_perf_errors);
+        last_io_operation = "close";
+        _async->finish();
+        AP::FS().close(_write_fd);
+        _write_fd = -1;
+        _initialised = false;
+        printf("Failed to write to File\n");
+    }
+
+    last_io_operation = "";
+    write_fd_semaphore.give();
+    hal.util->perf_end(_perf_write);
+}
+#endif // HAL_LOGGER_FILE_ASYNC_ENABLED
+
 // this sensor is enabled if we should be logging at the moment
 bool AP_Logger_File::logging_enabled() const
 {
@@ -1098,6 +1428,9 @@ void AP_Logger_File::Write_AP_Logger_Stats_File(const struct df_stats &_stats)
         buf_space_min   : _stats.buf_space_min,
         buf_space_max   : _stats.buf_space_max,
         buf_space_avg   : (_stats.blocks) ? (_stats.buf_space_sigma / _stats.blocks) : 0,
+        write_lat_avg   : (_stats.writes) ? (_stats.write_lat_sum / _stats.writes) : 0,
+        write_lat_max   : _stats.write_lat_max,
+        write_stalls    : _stats.write_stalls,
 
     };
     WriteBlock(&pkt, sizeof(pkt));
@@ -1116,6 +1449,14 @@ void AP_Logger_File::df_stats_gather(const uint16_t bytes_written) {
     stats.blocks++;
 }
 
+void AP_Logger_File::df_stats_gather_write(const uint32_t latency_us) {
+    stats.writes++;
+    stats.write_lat_sum += latency_us;
+    if (latency_us > stats.write_lat_max) {
+        stats.write_lat_max = latency_us;
+    }
+}
+
 void AP_Logger_File::df_stats_clear() {
     memset(&stats, '\0', sizeof(stats));
     stats.buf_space_min = -1;
@@ -12,6 +12,29 @@
 
 #include <AP_HAL/utility/RingBuffer.h>
 #include "AP_Logger_Backend.h"
+#include "AP_Logger_AsyncWriter.h"
+
+/*
+  per-thread staging rings. Non-critical blocks are written by each
+  producer thread into its own single-producer/single-consumer ring
+  without taking the write buffer semaphore; the IO thread moves
+  complete blocks from the rings into the write buffer
+ */
+#ifndef HAL_LOGGER_FILE_STAGING_ENABLED
+#define HAL_LOGGER_FILE_STAGING_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+#include <atomic>
+
+#ifndef HAL_LOGGER_FILE_STAGING_MAX_THREADS
+#define HAL_LOGGER_FILE_STAGING_MAX_THREADS 8
+#endif
+
+#ifndef HAL_LOGGER_FILE_STAGING_SIZE
+#define HAL_LOGGER_FILE_STAGING_SIZE 8192
+#endif
+#endif
 
 class AP_Logger_File : public AP_Logger_Backend
 {
@@ -125,6 +148,15 @@ private:
 
     void _io_timer(void);
 
+    // check for enough free space, stopping logging if there isn't
+    bool check_free_space(uint32_t tnow);
+
+#if HAL_LOGGER_FILE_ASYNC_ENABLED
+    // asynchronous writer, nullptr unless LOG_FILE_ASYNC is set
+    AP_Logger_AsyncWriter *_async;
+    void _io_timer_async(uint32_t tnow);
+#endif
+
     uint32_t critical_message_reserved_space() const {
         // possibly make this a proportional to buffer size?
         uint32_t ret = 1024;
@@ -169,17 +201,52 @@ private:
 
     const char *last_io_operation = "";
 
+#if HAL_LOGGER_FILE_STAGING_ENABLED
+    // staging rings, one per producer thread. Slots are claimed
+    // with _staging_count and published by storing the ring pointer
+    std::atomic<ByteBuffer *> _staging[HAL_LOGGER_FILE_STAGING_MAX_THREADS];
+    std::atomic<uint8_t> _staging_count;
+
+    // return the calling thread's staging ring, claiming one if
+    // needed and claim is true. Returns nullptr if no ring is available
+    ByteBuffer *staging_ring(bool claim=true);
+
+    // write a block to a staging ring; false if it did not fit
+    bool stage_block(ByteBuffer &ring, const void *pBuffer, uint16_t size);
+
+    // move complete blocks from the staging rings into _writebuf;
+    // caller must hold semaphore
+    void staging_drain();
+
+    // move complete blocks from one ring into _writebuf, leaving
+    // reserve bytes free; false if blocks were left in the ring.
+    // Caller must hold semaphore
+    bool staging_drain_ring(ByteBuffer &ring, uint32_t reserve);
+
+    // move the calling thread's staged blocks into _writebuf ahead of
+    // a critical block of the given size; caller must hold semaphore
+    void staging_flush_thread(uint16_t size);
+
+    // discard all staged blocks; caller must hold semaphore
+    void staging_discard();
+#endif
+
     struct df_stats {
         uint16_t blocks;
         uint32_t bytes;
         uint32_t buf_space_min;
         uint32_t buf_space_max;
         uint32_t buf_space_sigma;
+        uint16_t writes;
+        uint32_t write_lat_sum;  // microseconds
+        uint32_t write_lat_max;  // microseconds
+        uint16_t write_stalls;
     };
     struct df_stats stats;
 
     void Write_AP_Logger_Stats_File(const struct df_stats &_stats);
     void df_stats_gather(uint16_t bytes_written);
+    void df_stats_gather_write(uint32_t latency_us);
     void df_stats_log();
     void df_stats_clear();
 
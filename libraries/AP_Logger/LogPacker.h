@@ -0,0 +1,132 @@
+/*
+  compile-time packing of ad-hoc log messages
+
+  The varargs AP_Logger::Write() interprets its format string for
+  every message. The helpers here check the format string against
+  the C++ types of the arguments at compile time and compute the
+  packet length from those types, so that writing a message becomes
+  a fixed sequence of stores into a fixed-size packet.
+
+  Usage:
+    AP_LOGGER_WRITE_PACKED("TEST", "TimeUS,A,B", "s--", "F--", "Qfh",
+                           AP_HAL::micros64(), float_val, int16_val);
+
+  Argument types must match the format exactly (e.g. pass a float for
+  'f' and an int16_t for 'h'); string and array fields ('n', 'N', 'Z',
+  'a') are not supported, use AP_Logger::Write() for those.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+namespace LogPacker {
+
+// true if a C++ argument of type T may be logged with format character c
+template <typename T>
+constexpr bool field_matches(const char c)
+{
+    return std::is_floating_point<T>::value ?
+        ((sizeof(T) == 4 && c == 'f') ||
+         (sizeof(T) == 8 && c == 'd')) :
+        !std::is_integral<T>::value ? false :
+        std::is_signed<T>::value ?
+        ((sizeof(T) == 1 && c == 'b') ||
+         (sizeof(T) == 2 && (c == 'h' || c == 'c')) ||
+         (sizeof(T) == 4 && (c == 'i' || c == 'L' || c == 'e')) ||
+         (sizeof(T) == 8 && c == 'q')) :
+        ((sizeof(T) == 1 && (c == 'B' || c == 'M')) ||
+         (sizeof(T) == 2 && (c == 'H' || c == 'C')) ||
+         (sizeof(T) == 4 && (c == 'I' || c == 'E')) ||
+         (sizeof(T) == 8 && c == 'Q'));
+}
+
+// number of characters in s; 0 for nullptr
+constexpr uint8_t length(const char *s)
+{
+    return (s == nullptr || s[0] == 0) ? 0 : 1 + length(s+1);
+}
+
+// number of commas in s
+constexpr uint8_t num_commas(const char *s)
+{
+    return (s[0] == 0) ? 0 : ((s[0] == ',') ? 1 : 0) + num_commas(s+1);
+}
+
+// number of comma-separated labels in s
+constexpr uint8_t num_labels(const char *s)
+{
+    return (s == nullptr || s[0] == 0) ? 0 : 1 + num_commas(s);
+}
+
+template <typename... Ts> struct types {};
+
+// declared only; used in decltype() to name the decayed argument types
+template <typename... Ts>
+types<Ts...> arg_types(Ts... args);
+
+template <typename... Ts> struct fields;
+
+template <>
+struct fields<> {
+    static constexpr uint8_t size = 0;
+    static constexpr uint8_t count = 0;
+    static constexpr bool match(const char *fmt) { return fmt[0] == 0; }
+};
+
+template <typename T, typename... Rest>
+struct fields<T, Rest...> {
+    static constexpr uint8_t size = sizeof(T) + fields<Rest...>::size;
+    static constexpr uint8_t count = 1 + fields<Rest...>::count;
+    static constexpr bool match(const char *fmt) {
+        return fmt[0] != 0 &&
+            field_matches<T>(fmt[0]) &&
+            fields<Rest...>::match(fmt+1);
+    }
+};
+
+template <typename Types> struct check;
+
+template <typename... Ts>
+struct check<types<Ts...>> {
+    // total packet length including the three byte header
+    static constexpr uint8_t msg_len = 3 + fields<Ts...>::size;
+
+    // true if fmt, labels, units and multipliers all describe the
+    // argument list
+    static constexpr bool valid(const char *labels, const char *units, const char *mults, const char *fmt) {
+        return fields<Ts...>::match(fmt) &&
+            fields<Ts...>::count <= 16 &&
+            num_labels(labels) == fields<Ts...>::count &&
+            (units == nullptr || length(units) == fields<Ts...>::count) &&
+            (mults == nullptr || length(mults) == fields<Ts...>::count);
+    }
+};
+
+// copy arguments into a packet in order, without padding
+static inline void pack(uint8_t *) {}
+
+template <typename T, typename... Rest>
+static inline void pack(uint8_t *buf, const T &value, const Rest&... rest)
+{
+    memcpy(buf, &value, sizeof(T));
+    pack(buf + sizeof(T), rest...);
+}
+
+} // namespace LogPacker
+
+/*
+  write an ad-hoc message through a per-call-site format handle. The
+  format is checked against the argument types at compile time
+ */
+#define AP_LOGGER_WRITE_PACKED(name, labels, units, mults, fmt, ...)   \
+    do {                                                                \
+        static_assert(LogPacker::check<decltype(LogPacker::arg_types(__VA_ARGS__))>::valid(labels, units, mults, fmt), \
+                      "log format does not match arguments for " name); \
+        static AP_Logger::WriteHandle _log_handle;                      \
+        if (_log_handle == nullptr) {                                   \
+            _log_handle = AP::logger().get_write_handle(name, labels, units, mults, fmt); \
+        }                                                               \
+        AP::logger().WritePacked(_log_handle, __VA_ARGS__);             \
+    } while (0)
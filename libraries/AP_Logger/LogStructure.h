@@ -183,6 +183,9 @@ struct PACKED log_DSF {
     uint32_t buf_space_min;
     uint32_t buf_space_max;
     uint32_t buf_space_avg;
+    uint32_t write_lat_avg;
+    uint32_t write_lat_max;
+    uint16_t write_stalls;
 };
 
 struct PACKED log_Event {
@@ -278,6 +281,16 @@ struct PACKED log_ISBD {
 };
 static_assert(sizeof(log_ISBD) < 256, "log_ISBD is over-size");
 
+struct PACKED log_GYRO_FFT {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    float center_freq;
+    float peak_freq;
+    float snr;
+    uint8_t healthy;
+    uint32_t dropped;
+};
+
 struct PACKED log_Vibe {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -370,6 +383,43 @@ struct PACKED log_MAV {
     uint16_t packet_rx_drop_count;
 };
 
+struct PACKED log_MAVLink_route {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t sysid;
+    uint8_t compid;
+    uint8_t mavtype;
+    uint8_t channel_mask;
+    uint32_t packets;
+    uint32_t bytes;
+};
+
+struct PACKED log_Scripting {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    char name[16];
+    uint32_t runs;
+    uint32_t run_time;
+    uint32_t max_time;
+    uint32_t alloc_bytes;
+    uint32_t gc_time;
+    int32_t total_mem;
+};
+
+struct PACKED log_Scripting_Heap {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t size;
+    uint32_t used;
+    uint32_t high_water;
+    uint32_t largest_free;
+    uint8_t fragmentation;
+    uint32_t alloc_rate;
+    uint32_t fail_count;
+    uint32_t pool_bytes;
+    uint32_t pool_free;
+};
+
 struct PACKED log_RSSI {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -857,6 +907,19 @@ struct PACKED log_TERRAIN {
     uint16_t loaded;
 };
 
+/*
+  terrain cache statistics
+ */
+struct PACKED log_TERRAIN_CACHE {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t cache_size;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t map_loads;
+    uint32_t prefetched;
+};
+
 /*
   UBlox logging
  */
@@ -1452,6 +1515,8 @@ struct PACKED log_Arm_Disarm {
       "XKV2","Qffffffffffff","TimeUS,V12,V13,V14,V15,V16,V17,V18,V19,V20,V21,V22,V23", "s------------", "F------------" }, \
     { LOG_TERRAIN_MSG, sizeof(log_TERRAIN), \
       "TERR","QBLLHffHH","TimeUS,Status,Lat,Lng,Spacing,TerrH,CHeight,Pending,Loaded", "s-DU-mm--", "F-GG-00--" }, \
+    { LOG_TERRAIN_CACHE_MSG, sizeof(log_TERRAIN_CACHE), \
+      "TERC","QBIIII","TimeUS,Size,Hit,Miss,MapLd,Pref", "s-----", "F-----" }, \
     { LOG_GPS_UBX1_MSG, sizeof(log_Ubx1), \
       "UBX1", "QBHBBHI",  "TimeUS,Instance,noisePerMS,jamInd,aPower,agcCnt,config", "s------", "F------"  }, \
     { LOG_GPS_UBX2_MSG, sizeof(log_Ubx2), \
@@ -1528,10 +1593,12 @@ struct PACKED log_Arm_Disarm {
       "ISBH",ISBH_FMT,ISBH_LABELS,ISBH_UNITS,ISBH_MULTS },  \
     { LOG_ISBD_MSG, sizeof(log_ISBD), \
       "ISBD",ISBD_FMT,ISBD_LABELS, ISBD_UNITS, ISBD_MULTS }, \
+    { LOG_GYRO_FFT_MSG, sizeof(log_GYRO_FFT), \
+      "FTN", "QfffBI", "TimeUS,PkAvg,PkRaw,SNR,Ok,Drop", "szz---", "F00---" }, \
     { LOG_ORGN_MSG, sizeof(log_ORGN), \
       "ORGN","QBLLe","TimeUS,Type,Lat,Lng,Alt", "s-DUm", "F-GGB" },   \
     { LOG_DF_FILE_STATS, sizeof(log_DSF), \
-      "DSF", "QIHIIII", "TimeUS,Dp,Blk,Bytes,FMn,FMx,FAv", "s--b---", "F--0---" }, \
+      "DSF", "QIHIIIIIIH", "TimeUS,Dp,Blk,Bytes,FMn,FMx,FAv,WLAv,WLMx,WStl", "s--b---ss-", "F--0---FF-" }, \
     { LOG_RPM_MSG, sizeof(log_RPM), \
       "RPM",  "Qff", "TimeUS,rpm1,rpm2", "sqq", "F00" }, \
     { LOG_GIMBAL1_MSG, sizeof(log_Gimbal1), \
@@ -1546,6 +1613,12 @@ struct PACKED log_Arm_Disarm {
       "RALY", "QBBLLh", "TimeUS,Tot,Seq,Lat,Lng,Alt", "s--DUm", "F--GGB" },  \
     { LOG_MAV_MSG, sizeof(log_MAV),   \
       "MAV", "QBHHH",   "TimeUS,chan,txp,rxp,rxdp", "s#---", "F-000" },   \
+    { LOG_MAVLINK_ROUTE_MSG, sizeof(log_MAVLink_route), \
+      "MAVR", "QBBBBII", "TimeUS,SysId,CompId,Type,ChMask,Pkts,Bytes", "s-----b", "F-----0" }, \
+    { LOG_SCRIPTING_MSG, sizeof(log_Scripting), \
+      "SCR", "QNIIIIIi", "TimeUS,Name,Runs,Time,MaxTime,Alloc,GC,Mem", "s--ssbsb", "F--FF0F0" }, \
+    { LOG_SCRIPTING_HEAP_MSG, sizeof(log_Scripting_Heap), \
+      "SCRH", "QIIIIBIIII", "TimeUS,Size,Used,HWM,MaxFree,Frag,Rate,Fails,Pool,PoolFree", "sbbbb%--bb", "F0000-0-00" }, \
     { LOG_VISUALODOM_MSG, sizeof(log_VisualOdom), \
       "VISO", "Qffffffff", "TimeUS,dt,AngDX,AngDY,AngDZ,PosDX,PosDY,PosDZ,conf", "ssrrrmmm-", "FF000000-" }, \
     { LOG_OPTFLOW_MSG, sizeof(log_Optflow), \
@@ -1595,6 +1668,11 @@ enum LogMessages : uint8_t {
     LOG_XKFD_MSG,
     LOG_XKV1_MSG,
     LOG_XKV2_MSG,
+    LOG_SCRIPTING_MSG,
+    LOG_SCRIPTING_HEAP_MSG,
+    LOG_TERRAIN_CACHE_MSG,
+    LOG_MAVLINK_ROUTE_MSG,
+    LOG_GYRO_FFT_MSG,
 
     LOG_FORMAT_MSG = 128, // this must remain #128
 
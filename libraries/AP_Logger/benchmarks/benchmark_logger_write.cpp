@@ -0,0 +1,168 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/AP_Logger_Backend.h>
+#include <AP_Logger/LoggerMessageWriter.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  compare packing a typical 10-field message through the varargs
+  format interpreter with the compile-time packed path, on its own
+  and through AP_Logger::Write()
+ */
+
+#define BENCH_FMT "QffffffIhB"
+#define BENCH_LABELS "TimeUS,A,B,C,D,E,F,G,H,I"
+
+static_assert(LogPacker::check<LogPacker::types<uint64_t, float, float, float, float, float, float, uint32_t, int16_t, uint8_t>>::valid(BENCH_LABELS, nullptr, nullptr, BENCH_FMT),
+              "benchmark format does not match");
+
+static void pack_varargs(uint8_t *buffer, const char *fmt, ...)
+{
+    va_list arg_list;
+    va_start(arg_list, fmt);
+    buffer[0] = HEAD_BYTE1;
+    buffer[1] = HEAD_BYTE2;
+    buffer[2] = 200;
+    AP_Logger_Backend::Write_pack(&buffer[3], fmt, arg_list);
+    va_end(arg_list);
+}
+
+static void BM_LoggerPackVarargs(benchmark::State& state)
+{
+    uint8_t buffer[3+8+6*4+4+2+1];
+    uint64_t time_us = 1234567;
+    float v = 1.0f;
+
+    while (state.KeepRunning()) {
+        pack_varargs(buffer, BENCH_FMT,
+                     time_us, (double)v, (double)(v+1), (double)(v+2),
+                     (double)(v+3), (double)(v+4), (double)(v+5),
+                     (uint32_t)time_us, (int16_t)-3, (uint8_t)7);
+        gbenchmark_escape(buffer);
+        time_us++;
+    }
+}
+
+static void BM_LoggerPackCompileTime(benchmark::State& state)
+{
+    uint8_t buffer[LogPacker::check<LogPacker::types<uint64_t, float, float, float, float, float, float, uint32_t, int16_t, uint8_t>>::msg_len];
+    uint64_t time_us = 1234567;
+    float v = 1.0f;
+
+    while (state.KeepRunning()) {
+        buffer[0] = HEAD_BYTE1;
+        buffer[1] = HEAD_BYTE2;
+        buffer[2] = 200;
+        LogPacker::pack(&buffer[3],
+                        time_us, v, v+1, v+2, v+3, v+4, v+5,
+                        (uint32_t)time_us, (int16_t)-3, (uint8_t)7);
+        gbenchmark_escape(buffer);
+        time_us++;
+    }
+}
+
+static const struct LogStructure log_structure[] = {
+    LOG_COMMON_STRUCTURES
+};
+
+/*
+  a backend that accepts every message and keeps only the last one,
+  so the Write benchmarks time the front end and the backend's packing
+  without any storage. It adds itself to the logger
+ */
+class AP_Logger_Benchmark : public AP_Logger_Backend {
+public:
+    AP_Logger_Benchmark(AP_Logger &front) :
+        AP_Logger_Backend(front, new StartupWriter()) {
+        _initialised = true;
+        front._structures = log_structure;
+        front._num_types = ARRAY_SIZE(log_structure);
+        front.backends[front._next_backend++] = this;
+        front.EnableWrites(true);
+        front.set_force_log_disarmed(true);
+    }
+
+    bool CardInserted(void) const override { return true; }
+    void EraseAll() override {}
+    bool NeedPrep() override { return false; }
+    void Prep() override {}
+    uint16_t find_last_log() override { return 0; }
+    void get_log_boundaries(uint16_t log_num, uint32_t & start_page, uint32_t & end_page) override {}
+    void get_log_info(uint16_t log_num, uint32_t &size, uint32_t &time_utc) override {}
+    int16_t get_log_data(uint16_t log_num, uint16_t page, uint32_t offset, uint16_t len, uint8_t *data) override { return 0; }
+    uint16_t get_num_logs() override { return 0; }
+    bool logging_started(void) const override { return true; }
+    uint32_t bufferspace_available() override { return sizeof(last); }
+    uint16_t start_new_log(void) override { return 0; }
+    void stop_logging(void) override {}
+    bool logging_enabled() const override { return true; }
+    bool logging_failed() const override { return false; }
+
+    uint8_t last[256];
+
+protected:
+    bool WritesOK() const override { return true; }
+    bool _WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) override {
+        memcpy(last, pBuffer, MIN(size, sizeof(last)));
+        return true;
+    }
+
+private:
+    // there are no startup messages to write
+    class StartupWriter : public LoggerMessageWriter_DFLogStart {
+    public:
+        bool finished() override { return true; }
+    };
+};
+
+static AP_Int32 log_bitmask;
+static AP_Logger logger{log_bitmask};
+static AP_Logger_Benchmark *backend;
+
+static void setup_logger(void)
+{
+    if (backend == nullptr) {
+        log_bitmask = (uint32_t)-1;
+        backend = new AP_Logger_Benchmark(logger);
+    }
+}
+
+static void BM_LoggerWriteVarargs(benchmark::State& state)
+{
+    setup_logger();
+    uint64_t time_us = 1234567;
+    float v = 1.0f;
+
+    while (state.KeepRunning()) {
+        AP::logger().Write("BNCV", BENCH_LABELS, BENCH_FMT,
+                           time_us, (double)v, (double)(v+1), (double)(v+2),
+                           (double)(v+3), (double)(v+4), (double)(v+5),
+                           (uint32_t)time_us, (int16_t)-3, (uint8_t)7);
+        gbenchmark_escape(backend->last);
+        time_us++;
+    }
+}
+
+static void BM_LoggerWritePacked(benchmark::State& state)
+{
+    setup_logger();
+    uint64_t time_us = 1234567;
+    float v = 1.0f;
+
+    while (state.KeepRunning()) {
+        AP_LOGGER_WRITE_PACKED("BNCP", BENCH_LABELS, nullptr, nullptr, BENCH_FMT,
+                               time_us, v, v+1, v+2, v+3, v+4, v+5,
+                               (uint32_t)time_us, (int16_t)-3, (uint8_t)7);
+        gbenchmark_escape(backend->last);
+        time_us++;
+    }
+}
+
+BENCHMARK(BM_LoggerPackVarargs);
+BENCHMARK(BM_LoggerPackCompileTime);
+BENCHMARK(BM_LoggerWriteVarargs);
+BENCHMARK(BM_LoggerWritePacked);
+
+BENCHMARK_MAIN()
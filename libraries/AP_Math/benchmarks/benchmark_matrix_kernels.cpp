@@ -0,0 +1,167 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrix_kernels.h>
+#include <AP_Math/matrixN.h>
+
+/*
+  a symmetric positive definite NxN matrix: diagonally dominant with
+  small off diagonal elements
+ */
+template <uint8_t N>
+static void make_spd(float (&A)[N][N])
+{
+    for (uint8_t i = 0; i < N; i++) {
+        for (uint8_t j = 0; j < N; j++) {
+            A[i][j] = (i == j) ? N : 1.0f / (1 + i + j);
+        }
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixKernelMul(benchmark::State& state)
+{
+    float A[N][N], B[N][N], C[N][N];
+    make_spd(A);
+    make_spd(B);
+
+    while (state.KeepRunning()) {
+        gbenchmark_escape(A);
+        mat_mul(A, B, C);
+        gbenchmark_escape(C);
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixNaiveMul(benchmark::State& state)
+{
+    float A[N*N], B[N*N];
+    make_spd(*(float (*)[N][N])A);
+    make_spd(*(float (*)[N][N])B);
+
+    while (state.KeepRunning()) {
+        gbenchmark_escape(A);
+        float *C = mat_mul(A, B, N);
+        gbenchmark_escape(C);
+        delete[] C;
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixKernelSyrk(benchmark::State& state)
+{
+    float A[N][N], C[N][N];
+    make_spd(A);
+    make_spd(C);
+
+    while (state.KeepRunning()) {
+        gbenchmark_escape(A);
+        mat_syrk(C, A, -1.0e-6f);
+        gbenchmark_escape(C);
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixKernelCholeskySolve(benchmark::State& state)
+{
+    float A[N][N], L[N][N], b[N], x[N];
+    make_spd(A);
+    for (uint8_t i = 0; i < N; i++) {
+        b[i] = i;
+    }
+
+    while (state.KeepRunning()) {
+        memcpy(L, A, sizeof(L));
+        gbenchmark_escape(L);
+        if (mat_cholesky(L)) {
+            mat_cholesky_solve(L, b, x);
+        }
+        gbenchmark_escape(x);
+    }
+}
+
+template <uint8_t N>
+static void BM_MatrixKernelLDLTSolve(benchmark::State& state)
+{
+    float A[N][N], LD[N][N], b[N], x[N];
+    make_spd(A);
+    for (uint8_t i = 0; i < N; i++) {
+        b[i] = i;
+    }
+
+    while (state.KeepRunning()) {
+        memcpy(LD, A, sizeof(LD));
+        gbenchmark_escape(LD);
+        if (mat_ldlt(LD)) {
+            mat_ldlt_solve(LD, b, x);
+        }
+        gbenchmark_escape(x);
+    }
+}
+
+// the general inverse, as used by the compass calibrator, for comparison
+template <uint8_t N>
+static void BM_MatrixInverseSolve(benchmark::State& state)
+{
+    float A[N*N], inv[N*N], b[N], x[N];
+    make_spd(*(float (*)[N][N])A);
+    for (uint8_t i = 0; i < N; i++) {
+        b[i] = i;
+    }
+
+    while (state.KeepRunning()) {
+        gbenchmark_escape(A);
+        if (inverse(A, inv, N)) {
+            mat_mul_vec(*(float (*)[N][N])inv, b, x);
+        }
+        gbenchmark_escape(x);
+    }
+}
+
+static void BM_MatrixNSymRank1Update(benchmark::State& state)
+{
+    const float d[4] {1, 2, 3, 4};
+    MatrixN<float,4> P{d};
+    const float x[4] {0.1f, 0.2f, 0.3f, 0.4f};
+    const VectorN<float,4> v{x};
+
+    while (state.KeepRunning()) {
+        P.sym_rank1_update(v, -1.0e-6f);
+        gbenchmark_escape(&P);
+    }
+}
+
+static void BM_MatrixNOuterSubtract(benchmark::State& state)
+{
+    const float d[4] {1, 2, 3, 4};
+    MatrixN<float,4> P{d};
+    MatrixN<float,4> tmp;
+    const float x[4] {0.1f, 0.2f, 0.3f, 0.4f};
+    const VectorN<float,4> v{x};
+
+    while (state.KeepRunning()) {
+        tmp.mult(v, v * 1.0e-6f);
+        P -= tmp;
+        P.force_symmetry();
+        gbenchmark_escape(&P);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_MatrixKernelMul, 4);
+BENCHMARK_TEMPLATE(BM_MatrixNaiveMul, 4);
+BENCHMARK_TEMPLATE(BM_MatrixKernelMul, 9);
+BENCHMARK_TEMPLATE(BM_MatrixNaiveMul, 9);
+BENCHMARK_TEMPLATE(BM_MatrixKernelMul, 24);
+BENCHMARK_TEMPLATE(BM_MatrixNaiveMul, 24);
+BENCHMARK_TEMPLATE(BM_MatrixKernelSyrk, 9);
+BENCHMARK_TEMPLATE(BM_MatrixKernelSyrk, 24);
+BENCHMARK_TEMPLATE(BM_MatrixKernelCholeskySolve, 9);
+BENCHMARK_TEMPLATE(BM_MatrixKernelLDLTSolve, 9);
+BENCHMARK_TEMPLATE(BM_MatrixInverseSolve, 9);
+BENCHMARK_TEMPLATE(BM_MatrixKernelCholeskySolve, 24);
+BENCHMARK_TEMPLATE(BM_MatrixKernelLDLTSolve, 24);
+BENCHMARK_TEMPLATE(BM_MatrixInverseSolve, 24);
+BENCHMARK(BM_MatrixNSymRank1Update);
+BENCHMARK(BM_MatrixNOuterSubtract);
+
+BENCHMARK_MAIN()
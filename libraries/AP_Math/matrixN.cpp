@@ -5,17 +5,21 @@
 #pragma GCC optimize("O2")
 
 #include "matrixN.h"
+#include "matrix_kernels.h"
 
 
 // multiply two vectors to give a matrix, in-place
 template <typename T, uint8_t N>
 void MatrixN<T,N>::mult(const VectorN<T,N> &A, const VectorN<T,N> &B)
 {
-    for (uint8_t i = 0; i < N; i++) {
-        for (uint8_t j = 0; j < N; j++) {
-            v[i][j] = A[i] * B[j];
-        }
-    }
+    mat_outer(A._v, B._v, v);
+}
+
+// add alpha * x * x' to the matrix, keeping it exactly symmetric
+template <typename T, uint8_t N>
+void MatrixN<T,N>::sym_rank1_update(const VectorN<T,N> &x, T alpha)
+{
+    mat_syr(v, x._v, alpha);
 }
 
 // subtract B from the matrix
@@ -55,6 +59,7 @@ void MatrixN<T,N>::force_symmetry(void)
 }
 
 template void MatrixN<float,4>::mult(const VectorN<float,4> &A, const VectorN<float,4> &B);
+template void MatrixN<float,4>::sym_rank1_update(const VectorN<float,4> &x, float alpha);
 template MatrixN<float,4> &MatrixN<float,4>::operator -=(const MatrixN<float,4> &B);
 template MatrixN<float,4> &MatrixN<float,4>::operator +=(const MatrixN<float,4> &B);
 template void MatrixN<float,4>::force_symmetry(void);
@@ -34,6 +34,9 @@ public:
     // multiply two vectors to give a matrix, in-place
     void mult(const VectorN<T,N> &A, const VectorN<T,N> &B);
 
+    // add alpha * x * x' to the matrix, keeping it exactly symmetric
+    void sym_rank1_update(const VectorN<T,N> &x, T alpha);
+
     // subtract B from the matrix
     MatrixN<T,N> &operator -=(const MatrixN<T,N> &B);
 
@@ -44,5 +47,5 @@ public:
     void force_symmetry(void);
 
 private:
-    T v[N][N];
+    alignas(16) T v[N][N];
 };
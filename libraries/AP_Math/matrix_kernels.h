@@ -0,0 +1,260 @@
+/*
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  linear algebra kernels for matrices whose size is known at compile
+  time. They work on plain row major arrays, T m[R][C], so they can be
+  used on the storage of MatrixN and VectorN or on a local array
+  without copying, and nothing is allocated.
+
+  The innermost loop of each kernel walks a row, so it is unit stride,
+  and where its length is a template parameter it is unrolled with
+  MatUnroll. At -Os the compiler won't unroll loops itself, and for
+  the small matrices used in flight code the loop overhead is a large
+  part of the cost.
+
+  Decompositions work in place and return false if the matrix isn't
+  positive definite (Cholesky) or is singular (LDLT), leaving the
+  matrix partly decomposed.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <cmath>
+
+/*
+  call f(0) .. f(N-1) with the loop unrolled at compile time
+ */
+template <uint8_t N>
+struct MatUnroll {
+    template <typename F>
+    __attribute__((always_inline)) static void run(F &f) {
+        MatUnroll<N-1>::run(f);
+        f(N-1);
+    }
+};
+
+template <>
+struct MatUnroll<0> {
+    template <typename F>
+    __attribute__((always_inline)) static void run(F &) {}
+};
+
+/*
+  C = A * B, where A is NxM and B is MxP. C must not be A or B
+ */
+template <typename T, uint8_t N, uint8_t M, uint8_t P>
+void mat_mul(const T (&A)[N][M], const T (&B)[M][P], T (&C)[N][P])
+{
+    for (uint8_t i = 0; i < N; i++) {
+        T *c = C[i];
+        const T a0 = A[i][0];
+        auto first = [&](uint8_t j) { c[j] = a0 * B[0][j]; };
+        MatUnroll<P>::run(first);
+        for (uint8_t k = 1; k < M; k++) {
+            const T a = A[i][k];
+            const T *b = B[k];
+            auto axpy = [&](uint8_t j) { c[j] += a * b[j]; };
+            MatUnroll<P>::run(axpy);
+        }
+    }
+}
+
+/*
+  y = A * x, where A is NxM. y must not be x
+ */
+template <typename T, uint8_t N, uint8_t M>
+void mat_mul_vec(const T (&A)[N][M], const T (&x)[M], T (&y)[N])
+{
+    for (uint8_t i = 0; i < N; i++) {
+        const T *a = A[i];
+        T sum = 0;
+        auto dot = [&](uint8_t k) { sum += a[k] * x[k]; };
+        MatUnroll<M>::run(dot);
+        y[i] = sum;
+    }
+}
+
+/*
+  C = a * b', the outer product of two vectors
+ */
+template <typename T, uint8_t N, uint8_t M>
+void mat_outer(const T (&a)[N], const T (&b)[M], T (&C)[N][M])
+{
+    for (uint8_t i = 0; i < N; i++) {
+        T *c = C[i];
+        const T ai = a[i];
+        auto mul = [&](uint8_t j) { c[j] = ai * b[j]; };
+        MatUnroll<M>::run(mul);
+    }
+}
+
+/*
+  C += alpha * A * A', where A is NxK and C is symmetric. The lower
+  triangle is calculated and copied to the upper, so C stays exactly
+  symmetric
+ */
+template <typename T, uint8_t N, uint8_t K>
+void mat_syrk(T (&C)[N][N], const T (&A)[N][K], T alpha)
+{
+    for (uint8_t i = 0; i < N; i++) {
+        const T *ai = A[i];
+        for (uint8_t j = 0; j <= i; j++) {
+            const T *aj = A[j];
+            T sum = 0;
+            auto dot = [&](uint8_t k) { sum += ai[k] * aj[k]; };
+            MatUnroll<K>::run(dot);
+            C[i][j] += alpha * sum;
+            C[j][i] = C[i][j];
+        }
+    }
+}
+
+/*
+  C += alpha * x * x', the rank one case of mat_syrk()
+ */
+template <typename T, uint8_t N>
+void mat_syr(T (&C)[N][N], const T (&x)[N], T alpha)
+{
+    for (uint8_t i = 0; i < N; i++) {
+        const T axi = alpha * x[i];
+        for (uint8_t j = 0; j <= i; j++) {
+            C[i][j] += axi * x[j];
+            C[j][i] = C[i][j];
+        }
+    }
+}
+
+/*
+  Cholesky decomposition A = L * L'. Only the lower triangle of A is
+  read, and it is replaced by L. The upper triangle is left alone
+ */
+template <typename T, uint8_t N>
+bool mat_cholesky(T (&A)[N][N])
+{
+    for (uint8_t j = 0; j < N; j++) {
+        T *aj = A[j];
+        T d = aj[j];
+        for (uint8_t k = 0; k < j; k++) {
+            d -= aj[k] * aj[k];
+        }
+        if (!(d > 0) || std::isinf(d)) {
+            return false;
+        }
+        d = std::sqrt(d);
+        aj[j] = d;
+        const T inv_d = 1 / d;
+        for (uint8_t i = j+1; i < N; i++) {
+            T *ai = A[i];
+            T s = ai[j];
+            for (uint8_t k = 0; k < j; k++) {
+                s -= ai[k] * aj[k];
+            }
+            ai[j] = s * inv_d;
+        }
+    }
+    return true;
+}
+
+/*
+  solve L * L' * x = b given the output of mat_cholesky(). x may be b
+ */
+template <typename T, uint8_t N>
+void mat_cholesky_solve(const T (&L)[N][N], const T (&b)[N], T (&x)[N])
+{
+    // L * y = b
+    for (uint8_t i = 0; i < N; i++) {
+        const T *li = L[i];
+        T s = b[i];
+        for (uint8_t k = 0; k < i; k++) {
+            s -= li[k] * x[k];
+        }
+        x[i] = s / li[i];
+    }
+    // L' * x = y
+    for (int16_t i = N-1; i >= 0; i--) {
+        T s = x[i];
+        for (uint8_t k = i+1; k < N; k++) {
+            s -= L[k][i] * x[k];
+        }
+        x[i] = s / L[i][i];
+    }
+}
+
+/*
+  LDL' decomposition A = L * D * L', where L is unit lower triangular
+  and D diagonal. This needs no square roots, and works for symmetric
+  matrices that are not positive definite as long as no pivot is zero.
+  Only the lower triangle of A is read. It is replaced by L below the
+  diagonal and D on it
+ */
+template <typename T, uint8_t N>
+bool mat_ldlt(T (&A)[N][N])
+{
+    // L[j][k] * D[k] for the row being worked on
+    T v[N];
+    for (uint8_t j = 0; j < N; j++) {
+        T *aj = A[j];
+        T d = aj[j];
+        for (uint8_t k = 0; k < j; k++) {
+            v[k] = aj[k] * A[k][k];
+            d -= aj[k] * v[k];
+        }
+        // zero or nan
+        if (!(std::fabs(d) > 0) || std::isinf(d)) {
+            return false;
+        }
+        aj[j] = d;
+        const T inv_d = 1 / d;
+        for (uint8_t i = j+1; i < N; i++) {
+            T *ai = A[i];
+            T s = ai[j];
+            for (uint8_t k = 0; k < j; k++) {
+                s -= ai[k] * v[k];
+            }
+            ai[j] = s * inv_d;
+        }
+    }
+    return true;
+}
+
+/*
+  solve L * D * L' * x = b given the output of mat_ldlt(). x may be b
+ */
+template <typename T, uint8_t N>
+void mat_ldlt_solve(const T (&LD)[N][N], const T (&b)[N], T (&x)[N])
+{
+    // L * y = b
+    for (uint8_t i = 0; i < N; i++) {
+        const T *li = LD[i];
+        T s = b[i];
+        for (uint8_t k = 0; k < i; k++) {
+            s -= li[k] * x[k];
+        }
+        x[i] = s;
+    }
+    // D * z = y
+    for (uint8_t i = 0; i < N; i++) {
+        x[i] /= LD[i][i];
+    }
+    // L' * x = z
+    for (int16_t i = N-1; i >= 0; i--) {
+        T s = x[i];
+        for (uint8_t k = i+1; k < N; k++) {
+            s -= LD[k][i] * x[k];
+        }
+        x[i] = s;
+    }
+}
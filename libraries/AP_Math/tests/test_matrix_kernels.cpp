@@ -0,0 +1,125 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/matrix_kernels.h>
+
+// a symmetric positive definite 4x4 matrix and a vector to solve for
+static const float spd[4][4] = {
+    { 4.0f,  1.0f, -0.5f,  0.2f},
+    { 1.0f,  3.0f,  0.3f, -0.1f},
+    {-0.5f,  0.3f,  2.0f,  0.4f},
+    { 0.2f, -0.1f,  0.4f,  1.5f},
+};
+static const float rhs[4] = {1.0f, -2.0f, 0.5f, 3.0f};
+
+static void naive_mul_vec(const float (&A)[4][4], const float (&x)[4], float (&y)[4])
+{
+    for (uint8_t i = 0; i < 4; i++) {
+        y[i] = 0;
+        for (uint8_t k = 0; k < 4; k++) {
+            y[i] += A[i][k] * x[k];
+        }
+    }
+}
+
+TEST(MatrixKernelsTest, Mul)
+{
+    const float A[2][3] = {{1, 2, 3}, {4, 5, 6}};
+    const float B[3][2] = {{7, 8}, {9, 10}, {11, 12}};
+    float C[2][2];
+    mat_mul(A, B, C);
+    EXPECT_FLOAT_EQ(58, C[0][0]);
+    EXPECT_FLOAT_EQ(64, C[0][1]);
+    EXPECT_FLOAT_EQ(139, C[1][0]);
+    EXPECT_FLOAT_EQ(154, C[1][1]);
+
+    const float x[3] = {1, -1, 2};
+    float y[2];
+    mat_mul_vec(A, x, y);
+    EXPECT_FLOAT_EQ(5, y[0]);
+    EXPECT_FLOAT_EQ(11, y[1]);
+}
+
+TEST(MatrixKernelsTest, SymmetricRankUpdate)
+{
+    const float A[3][2] = {{1, 2}, {3, 4}, {5, 6}};
+    float C[3][3] = {};
+    mat_syrk(C, A, 2.0f);
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            EXPECT_FLOAT_EQ(2 * (A[i][0] * A[j][0] + A[i][1] * A[j][1]), C[i][j]);
+        }
+    }
+
+    // rank one update matches the outer product
+    const float x[3] = {1, -2, 3};
+    float outer[3][3];
+    mat_outer(x, x, outer);
+    float D[3][3] = {};
+    mat_syr(D, x, -0.5f);
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            EXPECT_FLOAT_EQ(-0.5f * outer[i][j], D[i][j]);
+        }
+    }
+}
+
+TEST(MatrixKernelsTest, Cholesky)
+{
+    float L[4][4];
+    memcpy(L, spd, sizeof(L));
+    EXPECT_TRUE(mat_cholesky(L));
+
+    // L * L' gives back the original matrix
+    for (uint8_t i = 0; i < 4; i++) {
+        for (uint8_t j = 0; j <= i; j++) {
+            float sum = 0;
+            for (uint8_t k = 0; k <= j; k++) {
+                sum += L[i][k] * L[j][k];
+            }
+            EXPECT_NEAR(spd[i][j], sum, 1.0e-6);
+        }
+    }
+
+    float x[4];
+    mat_cholesky_solve(L, rhs, x);
+    float b[4];
+    naive_mul_vec(spd, x, b);
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_NEAR(rhs[i], b[i], 1.0e-5);
+    }
+
+    // not positive definite
+    float M[2][2] = {{1, 2}, {2, 1}};
+    EXPECT_FALSE(mat_cholesky(M));
+}
+
+TEST(MatrixKernelsTest, LDLT)
+{
+    float LD[4][4];
+    memcpy(LD, spd, sizeof(LD));
+    EXPECT_TRUE(mat_ldlt(LD));
+
+    float x[4];
+    mat_ldlt_solve(LD, rhs, x);
+    float b[4];
+    naive_mul_vec(spd, x, b);
+    for (uint8_t i = 0; i < 4; i++) {
+        EXPECT_NEAR(rhs[i], b[i], 1.0e-5);
+    }
+
+    // symmetric but indefinite is fine as long as no pivot is zero
+    float M[2][2] = {{1, 2}, {2, 1}};
+    const float m_rhs[2] = {3, 3};
+    EXPECT_TRUE(mat_ldlt(M));
+    float y[2];
+    mat_ldlt_solve(M, m_rhs, y);
+    EXPECT_NEAR(1.0f, y[0], 1.0e-6);
+    EXPECT_NEAR(1.0f, y[1], 1.0e-6);
+
+    // singular
+    float S[2][2] = {{1, 2}, {2, 4}};
+    EXPECT_FALSE(mat_ldlt(S));
+}
+
+AP_GTEST_MAIN()
@@ -17,6 +17,7 @@
 #include <cmath>
 #include <string.h>
 #include "matrixN.h"
+#include "matrix_kernels.h"
 
 #ifndef MATH_CHECK_INDEXES
 # define MATH_CHECK_INDEXES 0
@@ -33,6 +34,8 @@ class MatrixN;
 template <typename T, uint8_t N>
 class VectorN
 {
+    friend class MatrixN<T,N>;
+
 public:
     // trivial ctor
     inline VectorN<T,N>() {
@@ -161,12 +164,7 @@ public:
     // multiplication of a matrix by a vector, in-place
     // C = A * B
     void mult(const MatrixN<T,N> &A, const VectorN<T,N> &B) {
-        for (uint8_t i = 0; i < N; i++) {
-            _v[i] = 0;
-            for (uint8_t k = 0; k < N; k++) {
-                _v[i] += A.v[i][k] * B[k];
-            }
-        }
+        mat_mul_vec(A.v, B._v, _v);
     }
 
 private:
@@ -351,8 +351,11 @@ bool AP_Mission::is_nav_cmd(const Mission_Command& cmd)
 ///     accounts for do_jump commands but never increments the jump's num_times_run (advance_current_nav_cmd is responsible for this)
 bool AP_Mission::get_next_nav_cmd(uint16_t start_index, Mission_Command& cmd)
 {
-    // search until the end of the mission command list
-    for (uint16_t cmd_index = start_index; cmd_index < (unsigned)_cmd_total; cmd_index++) {
+    // search until the end of the mission command list, skipping
+    // commands which can't lead to a navigation command
+    for (uint16_t cmd_index = next_nav_candidate(start_index);
+         cmd_index < (unsigned)_cmd_total;
+         cmd_index = next_nav_candidate(cmd_index+1)) {
         // get next command
         if (!get_next_cmd(cmd_index, cmd, false)) {
             // no more commands so return failure
@@ -519,6 +522,22 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
         return false;
     }
 
+#if AP_MISSION_CACHE_ENABLED
+    if (cache_update()) {
+        cmd = _cache[index];
+        return true;
+    }
+#endif
+
+    decode_cmd_from_storage(index, cmd);
+
+    // return success
+    return true;
+}
+
+/// decode_cmd_from_storage - read and unpack the command at index from storage
+void AP_Mission::decode_cmd_from_storage(uint16_t index, Mission_Command& cmd) const
+{
     // Find out proper location in memory by using the start_byte position + the index
     // we can load a command, we don't process it yet
     // read WP position
@@ -565,11 +584,117 @@ bool AP_Mission::read_cmd_from_storage(uint16_t index, Mission_Command& cmd) con
 
     // set command's index to it's position in eeprom
     cmd.index = index;
+}
+
+#if AP_MISSION_CACHE_ENABLED
+/// cache_update - decode any commands up to _cmd_total not yet in the cache
+///     returns false if there is no cache
+bool AP_Mission::cache_update() const
+{
+    WITH_SEMAPHORE(_rsem);
+
+    if (_cache == nullptr) {
+        if (_cache_alloc_failed) {
+            return false;
+        }
+        const uint16_t max_commands = num_commands_max();
+        _cache = new Mission_Command[max_commands];
+        _cache_next_nav = new uint16_t[max_commands];
+        _cache_next_landing = new uint16_t[max_commands];
+        if (_cache == nullptr || _cache_next_nav == nullptr || _cache_next_landing == nullptr) {
+            delete[] _cache;
+            _cache = nullptr;
+            delete[] _cache_next_nav;
+            _cache_next_nav = nullptr;
+            delete[] _cache_next_landing;
+            _cache_next_landing = nullptr;
+            _cache_alloc_failed = true;
+            return false;
+        }
+        // command 0 is home, which is never read from storage
+        _cache_count = 1;
+        _cache_index_valid = false;
+    }
+
+    if ((unsigned)_cmd_total > num_commands_max()) {
+        return false;
+    }
+
+    // the mission may have been cleared or truncated
+    const uint16_t total = MAX(_cmd_total, 1);
+    if (_cache_count > total) {
+        _cache_count = total;
+        _cache_index_valid = false;
+    }
+
+    while (_cache_count < total) {
+        decode_cmd_from_storage(_cache_count, _cache[_cache_count]);
+        _cache_count++;
+        _cache_index_valid = false;
+    }
 
-    // return success
     return true;
 }
 
+/// cache_index_update - rebuild _cache_next_nav and _cache_next_landing if the cache has changed
+///     returns false if there is no cache
+bool AP_Mission::cache_index_update() const
+{
+    WITH_SEMAPHORE(_rsem);
+
+    if (!cache_update()) {
+        return false;
+    }
+    if (_cache_index_valid) {
+        return true;
+    }
+
+    uint16_t next_nav = AP_MISSION_CMD_INDEX_NONE;
+    uint16_t next_landing = AP_MISSION_CMD_INDEX_NONE;
+    for (uint16_t i = _cache_count; i-- > 0; ) {
+        const Mission_Command &cmd = _cache[i];
+        // command 0 is home, a waypoint
+        if (i == 0 || is_nav_cmd(cmd) || cmd.id == MAV_CMD_DO_JUMP) {
+            next_nav = i;
+        }
+        if (i != 0 && (cmd.id == MAV_CMD_DO_LAND_START || cmd.id == MAV_CMD_DO_GO_AROUND)) {
+            next_landing = i;
+        }
+        _cache_next_nav[i] = next_nav;
+        _cache_next_landing[i] = next_landing;
+    }
+    _cache_index_valid = true;
+
+    return true;
+}
+#endif // AP_MISSION_CACHE_ENABLED
+
+/// next_nav_candidate - returns the first index at or after index holding a
+///     command which get_next_cmd() may resolve to a "navigation" command
+uint16_t AP_Mission::next_nav_candidate(uint16_t index) const
+{
+#if AP_MISSION_CACHE_ENABLED
+    WITH_SEMAPHORE(_rsem);
+    if (index < (unsigned)_cmd_total && cache_index_update()) {
+        return _cache_next_nav[index];
+    }
+#endif
+    return index;
+}
+
+/// next_landing_candidate - returns the first index at or after index holding
+///     a DO_LAND_START or DO_GO_AROUND command
+uint16_t AP_Mission::next_landing_candidate(uint16_t index) const
+{
+#if AP_MISSION_CACHE_ENABLED
+    WITH_SEMAPHORE(_rsem);
+    if (index < (unsigned)_cmd_total && cache_index_update()) {
+        return _cache_next_landing[index];
+    }
+#endif
+    return index;
+}
+
 bool AP_Mission::stored_in_location(uint16_t id)
 {
     switch (id) {
@@ -641,6 +766,14 @@ bool AP_Mission::write_cmd_to_storage(uint16_t index, const Mission_Command& cmd
         _storage.write_block(pos_in_storage+5, packed.bytes, 10);
     }
 
+#if AP_MISSION_CACHE_ENABLED
+    // keep the cached copy the same as storage
+    if (index != 0 && index < _cache_count) {
+        decode_cmd_from_storage(index, _cache[index]);
+        _cache_index_valid = false;
+    }
+#endif
+
     // remember when the mission last changed
     _last_change_time_ms = AP_HAL::millis();
 
@@ -1785,7 +1918,7 @@ uint16_t AP_Mission::get_landing_sequence_start()
     float min_distance = -1;
 
     // Go through mission looking for nearest landing start command
-    for (uint16_t i = 1; i < num_commands(); i++) {
+    for (uint16_t i = next_landing_candidate(1); i < num_commands(); i = next_landing_candidate(i+1)) {
         Mission_Command tmp;
         if (!read_cmd_from_storage(i, tmp)) {
             continue;
@@ -1834,7 +1967,7 @@ bool AP_Mission::jump_to_abort_landing_sequence(void)
     if (AP::ahrs().get_position(current_loc)) {
         float min_distance = FLT_MAX;
 
-        for (uint16_t i = 1; i < num_commands(); i++) {
+        for (uint16_t i = next_landing_candidate(1); i < num_commands(); i = next_landing_candidate(i+1)) {
             Mission_Command tmp;
             if (!read_cmd_from_storage(i, tmp)) {
                 continue;
@@ -39,6 +39,11 @@
 #define AP_MISSION_OPTIONS_DEFAULT          0       // Do not clear the mission when rebooting
 #define AP_MISSION_MASK_MISSION_CLEAR       (1<<0)  // If set then Clear the mission on boot
 
+// keep a decoded copy of the mission in RAM on boards with memory to spare
+#ifndef AP_MISSION_CACHE_ENABLED
+#define AP_MISSION_CACHE_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
 /// @class    AP_Mission
 /// @brief    Object managing Mission
 class AP_Mission {
@@ -284,6 +289,14 @@ public:
         _prev_nav_cmd_index(AP_MISSION_CMD_INDEX_NONE),
         _prev_nav_cmd_wp_index(AP_MISSION_CMD_INDEX_NONE),
         _last_change_time_ms(0)
+#if AP_MISSION_CACHE_ENABLED
+        ,_cache(nullptr),
+        _cache_count(0),
+        _cache_alloc_failed(false),
+        _cache_next_nav(nullptr),
+        _cache_next_landing(nullptr),
+        _cache_index_valid(false)
+#endif
     {
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         if (_singleton != nullptr) {
@@ -490,6 +503,18 @@ private:
 
     static bool stored_in_location(uint16_t id);
 
+    /// decode_cmd_from_storage - read and unpack the command at index from storage
+    void decode_cmd_from_storage(uint16_t index, Mission_Command& cmd) const;
+
+    /// next_nav_candidate - returns the first index at or after index holding a
+    ///     command which get_next_cmd() may resolve to a "navigation" command
+    ///     (a navigation command or a do-jump), or index if not known
+    uint16_t next_nav_candidate(uint16_t index) const;
+
+    /// next_landing_candidate - returns the first index at or after index holding
+    ///     a DO_LAND_START or DO_GO_AROUND command, or index if not known
+    uint16_t next_landing_candidate(uint16_t index) const;
+
     struct Mission_Flags {
         mission_state state;
         uint8_t nav_cmd_loaded  : 1; // true if a "navigation" command has been loaded into _nav_cmd
@@ -581,6 +606,30 @@ private:
     // const functions
     static HAL_Semaphore_Recursive _rsem;
 
+#if AP_MISSION_CACHE_ENABLED
+    // decoded copy of the commands in storage.  Commands 1 to
+    // _cache_count-1 are always the same as in storage; commands
+    // written to storage below _cache_count are decoded again, and
+    // the rest are decoded when next needed.  All protected by _rsem
+    mutable Mission_Command *_cache;
+    mutable uint16_t _cache_count;
+    mutable bool _cache_alloc_failed;
+
+    // for each cached command, the index returned by
+    // next_nav_candidate() and next_landing_candidate()
+    mutable uint16_t *_cache_next_nav;
+    mutable uint16_t *_cache_next_landing;
+    mutable bool _cache_index_valid;
+
+    // decode any commands up to _cmd_total not yet in the cache;
+    // returns false if there is no cache
+    bool cache_update() const;
+
+    // rebuild _cache_next_nav and _cache_next_landing if the cache
+    // has changed; returns false if there is no cache
+    bool cache_index_update() const;
+#endif
+
     // mission items common to all vehicles:
     bool start_command_do_gripper(const AP_Mission::Mission_Command& cmd);
     bool start_command_do_servorelayevents(const AP_Mission::Mission_Command& cmd);
@@ -16,10 +16,13 @@
  */
 #include "AP_NavEKF_core_common.h"
 
-NavEKF_core_common::Matrix24 NavEKF_core_common::KH;
-NavEKF_core_common::Matrix24 NavEKF_core_common::KHP;
-NavEKF_core_common::Matrix24 NavEKF_core_common::nextP;
-NavEKF_core_common::Vector28 NavEKF_core_common::Kfusion;
+#include <stdio.h>
+#include <GCS_MAVLink/GCS.h>
+
+EKF_SCRATCH NavEKF_core_common::Matrix24 NavEKF_core_common::KH;
+EKF_SCRATCH NavEKF_core_common::Matrix24 NavEKF_core_common::KHP;
+EKF_SCRATCH NavEKF_core_common::Matrix24 NavEKF_core_common::nextP;
+EKF_SCRATCH NavEKF_core_common::Vector28 NavEKF_core_common::Kfusion;
 
 /*
   fill common scratch variables, for detecting re-use of variables between loops in SITL
@@ -37,3 +40,39 @@ void NavEKF_core_common::fill_scratch_variables(void)
     fill_nanf(&Kfusion[0], sizeof(Kfusion)/sizeof(float));
 #endif
 }
+
+/*
+  send a text message to the GCS, or hold it for flush_text() if the
+  core may be running on a worker thread
+ */
+void NavEKF_core_common::send_text(MAV_SEVERITY severity, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+    if (text_deferred) {
+        // these are one-off state change messages, so a few slots is
+        // plenty. Any more in a single update are dropped
+        if (text_count < ARRAY_SIZE(text_held)) {
+            text_held[text_count].severity = severity;
+            vsnprintf(text_held[text_count].text, sizeof(text_held[0].text), fmt, ap);
+            text_count++;
+        }
+        va_end(ap);
+        return;
+    }
+#endif
+    gcs().send_textv(severity, fmt, ap);
+    va_end(ap);
+}
+
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+void NavEKF_core_common::flush_text(void)
+{
+    text_deferred = false;
+    for (uint8_t i=0; i<text_count; i++) {
+        gcs().send_text(text_held[i].severity, "%s", text_held[i].text);
+    }
+    text_count = 0;
+}
+#endif
@@ -19,6 +19,16 @@
 #include <stdint.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Math/vectorN.h>
+#include <GCS_MAVLink/GCS_MAVLink.h>
+#include "AP_NavEKF_core_workers.h"
+
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+// cores may be updated on separate threads, so each thread needs its
+// own scratch space
+#define EKF_SCRATCH thread_local
+#else
+#define EKF_SCRATCH
+#endif
 
 /*
   this declares a common parent class for AP_NavEKF2 and
@@ -41,12 +51,36 @@ public:
     typedef ftype Matrix24[24][24];
 #endif
 
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+    // hold messages from send_text() until flush_text() is called.
+    // The frontend does this around a parallel update, so only the
+    // main thread talks to the GCS
+    void defer_text(void) { text_deferred = true; }
+
+    // send any held messages and stop holding them
+    void flush_text(void);
+#endif
+
 protected:
-    static Matrix24 KH;                   // intermediate result used for covariance updates
-    static Matrix24 KHP;                  // intermediate result used for covariance updates
-    static Matrix24 nextP;                // Predicted covariance matrix before addition of process noise to diagonals
-    static Vector28 Kfusion;              // intermediate fusion vector
+    static EKF_SCRATCH Matrix24 KH;       // intermediate result used for covariance updates
+    static EKF_SCRATCH Matrix24 KHP;      // intermediate result used for covariance updates
+    static EKF_SCRATCH Matrix24 nextP;    // Predicted covariance matrix before addition of process noise to diagonals
+    static EKF_SCRATCH Vector28 Kfusion;  // intermediate fusion vector
 
     // fill all the common scratch variables with NaN on SITL
     void fill_scratch_variables(void);
+
+    // send a text message to the GCS, cores use this instead of
+    // gcs().send_text()
+    void send_text(MAV_SEVERITY severity, const char *fmt, ...) FMT_PRINTF(3, 4);
+
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+private:
+    bool text_deferred;
+    uint8_t text_count;
+    struct {
+        MAV_SEVERITY severity;
+        char text[MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1];
+    } text_held[4];
+#endif
 };
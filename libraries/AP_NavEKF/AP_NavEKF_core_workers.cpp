@@ -0,0 +1,182 @@
+/*
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_NavEKF_core_workers.h"
+
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+
+#include <sched.h>
+
+// number of polls of the generation/pending counters before blocking;
+// a lane update takes a few hundred microseconds, so a short spin
+// avoids a futex round trip on most frames
+#define NAVEKF_WORKER_SPIN_COUNT 2000
+
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+NavEKF_core_workers::~NavEKF_core_workers()
+{
+    stop_threads();
+}
+
+bool NavEKF_core_workers::init(uint8_t num_lanes)
+{
+    _num_lanes = num_lanes < max_lanes ? num_lanes : max_lanes;
+
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return false;
+    }
+    const int ncpus = CPU_COUNT(&allowed);
+    if (ncpus < 2 || _num_lanes < 2) {
+        return false;
+    }
+
+    // give the workers the scheduling class of the calling (main)
+    // thread so they are not starved by it
+    int policy;
+    struct sched_param param;
+    pthread_getschedparam(pthread_self(), &policy, &param);
+
+    for (uint8_t lane=1; lane<_num_lanes; lane++) {
+        // pin lane n to the n'th allowed CPU, leaving the main thread
+        // where it is
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        int n = lane % ncpus;
+        for (int cpu=0; cpu<CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed) && n-- == 0) {
+                CPU_SET(cpu, &cpus);
+                break;
+            }
+        }
+
+        _args[lane] = { this, lane };
+
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, policy);
+        pthread_attr_setschedparam(&attr, &param);
+        int ret = pthread_create(&_threads[_num_threads], &attr, thread_main, &_args[lane]);
+        if (ret != 0) {
+            // no permission for the scheduling class; run at the
+            // default priority
+            pthread_attr_destroy(&attr);
+            pthread_attr_init(&attr);
+            pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+            ret = pthread_create(&_threads[_num_threads], &attr, thread_main, &_args[lane]);
+        }
+        pthread_attr_destroy(&attr);
+        if (ret != 0) {
+            stop_threads();
+            return false;
+        }
+        _num_threads++;
+    }
+    return true;
+}
+
+void NavEKF_core_workers::stop_threads()
+{
+    pthread_mutex_lock(&_mtx);
+    _stop = true;
+    pthread_cond_broadcast(&_start_cond);
+    pthread_mutex_unlock(&_mtx);
+    for (uint8_t i=0; i<_num_threads; i++) {
+        pthread_join(_threads[i], nullptr);
+    }
+    _num_threads = 0;
+    _stop = false;
+}
+
+void *NavEKF_core_workers::thread_main(void *arg)
+{
+    const struct lane_arg *a = (const struct lane_arg *)arg;
+    a->workers->worker(a->lane);
+    return nullptr;
+}
+
+void NavEKF_core_workers::worker(uint8_t lane)
+{
+    uint32_t seen = 0;
+    while (true) {
+        uint32_t gen = _generation.load(std::memory_order_acquire);
+        for (uint16_t i=0; gen == seen && i<NAVEKF_WORKER_SPIN_COUNT; i++) {
+            cpu_relax();
+            gen = _generation.load(std::memory_order_acquire);
+        }
+        if (gen == seen) {
+            pthread_mutex_lock(&_mtx);
+            while ((gen = _generation.load(std::memory_order_acquire)) == seen && !_stop) {
+                pthread_cond_wait(&_start_cond, &_mtx);
+            }
+            const bool stop = _stop;
+            pthread_mutex_unlock(&_mtx);
+            if (stop) {
+                return;
+            }
+        }
+        seen = gen;
+
+        _fn(lane);
+
+        if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pthread_mutex_lock(&_mtx);
+            pthread_cond_signal(&_done_cond);
+            pthread_mutex_unlock(&_mtx);
+        }
+    }
+}
+
+void NavEKF_core_workers::run(lane_fn fn)
+{
+    if (_num_threads == 0) {
+        for (uint8_t lane=0; lane<_num_lanes; lane++) {
+            fn(lane);
+        }
+        return;
+    }
+
+    _fn = fn;
+    _pending.store(_num_threads, std::memory_order_relaxed);
+    pthread_mutex_lock(&_mtx);
+    _generation.fetch_add(1, std::memory_order_release);
+    pthread_cond_broadcast(&_start_cond);
+    pthread_mutex_unlock(&_mtx);
+
+    fn(0);
+
+    for (uint16_t i=0; _pending.load(std::memory_order_acquire) != 0 && i<NAVEKF_WORKER_SPIN_COUNT; i++) {
+        cpu_relax();
+    }
+    if (_pending.load(std::memory_order_acquire) != 0) {
+        pthread_mutex_lock(&_mtx);
+        while (_pending.load(std::memory_order_acquire) != 0) {
+            pthread_cond_wait(&_done_cond, &_mtx);
+        }
+        pthread_mutex_unlock(&_mtx);
+    }
+}
+
+#endif // HAL_NAVEKF_CORE_THREADS_ENABLED
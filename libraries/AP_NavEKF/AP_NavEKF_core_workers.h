@@ -0,0 +1,98 @@
+/*
+  NavEKF_core_workers runs the per-IMU cores of EKF2 and EKF3 in
+  parallel on boards with more than one CPU
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_HAL/AP_HAL_Boards.h>
+#include <AP_HAL/utility/functor.h>
+#include <stdint.h>
+
+#ifndef HAL_NAVEKF_CORE_THREADS_ENABLED
+#define HAL_NAVEKF_CORE_THREADS_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+
+#include <atomic>
+#include <pthread.h>
+
+/*
+  a set of worker threads, one per EKF lane above the first, each
+  pinned to its own CPU. run() hands every lane to its thread, runs
+  lane 0 on the calling thread and returns once all lanes are done, so
+  the caller sees the same state as if the lanes had run one after the
+  other. Lanes must not share mutable state while running
+
+  What the EKF2/EKF3 cores touch outside themselves while running:
+  - AP::ins(), AP::gps(), AP::baro(), AP::rangefinder(),
+    AP::beacon(), AP::ahrs() and the compass and airspeed objects
+    are only read. Their frontends are updated on the main thread,
+    which is busy in run() until every lane is done
+  - messages for the GCS are held by the core and sent by the EKF
+    frontend after run() returns, see NavEKF_core_common::send_text()
+  - a newly set origin is passed to the other cores by the EKF
+    frontend after run() returns
+  - the frontend logging flags are separate bools, only ever set to
+    true by the cores and cleared by the frontend on the main thread
+  - the GPS health check may set EKx_GPS_TYPE to 1. That is a single
+    byte store of a constant that any core may make; the other cores
+    see the old or the new value, as they would sequentially
+  - hal.util perf counters are per core; the Linux HAL's shared
+    update count is atomic
+  - AP::baro().update_calibration() is only reached from
+    resetHeightDatum(), which the frontend calls on the main thread
+    outside UpdateFilter()
+ */
+class NavEKF_core_workers {
+public:
+    FUNCTOR_TYPEDEF(lane_fn, void, uint8_t);
+
+    ~NavEKF_core_workers();
+
+    // start threads for num_lanes lanes. Returns false if the board
+    // has a single CPU or the threads could not be created, in which
+    // case run() calls the lanes in turn
+    bool init(uint8_t num_lanes);
+
+    // call fn for each lane and wait for all to complete
+    void run(lane_fn fn);
+
+    static const uint8_t max_lanes = 7;
+
+private:
+    uint8_t _num_lanes = 1;
+    uint8_t _num_threads = 0;
+    pthread_t _threads[max_lanes];
+    struct lane_arg {
+        NavEKF_core_workers *workers;
+        uint8_t lane;
+    } _args[max_lanes];
+
+    lane_fn _fn;
+    std::atomic<uint32_t> _generation {0};
+    std::atomic<uint8_t> _pending {0};
+    bool _stop = false;
+    pthread_mutex_t _mtx = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t _start_cond = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t _done_cond = PTHREAD_COND_INITIALIZER;
+
+    static void *thread_main(void *arg);
+    void worker(uint8_t lane);
+    void stop_threads();
+};
+
+#endif // HAL_NAVEKF_CORE_THREADS_ENABLED
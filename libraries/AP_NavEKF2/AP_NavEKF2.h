@@ -26,6 +26,7 @@
 #include <AP_Param/AP_Param.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_NavEKF/AP_Nav_Common.h>
+#include <AP_NavEKF/AP_NavEKF_core_workers.h>
 #include <AP_Airspeed/AP_Airspeed.h>
 #include <AP_Compass/AP_Compass.h>
 #include <AP_Logger/LogStructure.h>
@@ -417,6 +418,9 @@ private:
     AP_Int8 _flowUse;               // Controls if the optical flow data is fused into the main navigation estimator and/or the terrain estimator.
     AP_Int16 _mag_ef_limit;         // limit on difference between WMM tables and learned earth field.
     AP_Float _hrt_filt_freq;        // frequency of output observer height rate complementary filter in Hz
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+    AP_Int8 _coreThreads;           // Set to 1 to update cores in parallel on separate threads
+#endif
 
 // Possible values for _flowUse
 #define FLOW_USE_NONE    0
@@ -454,11 +458,30 @@ private:
     struct Location common_EKF_origin;
     bool common_origin_valid;
 
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+    // threads used to update the cores in parallel, nullptr if disabled
+    NavEKF_core_workers *workers;
+
+    // true while the cores are being updated in parallel
+    bool parallelUpdate;
+
+    // copy any origin set by a core during a parallel update to the
+    // other cores
+    void shareCoreOrigins(void);
+#endif
+
+    // true if core i should run its prediction step on this frame
+    bool predictionEnabled(uint8_t i) const;
+
+    // update core i; called for each core from UpdateFilter()
+    void UpdateCoreFilter(uint8_t i);
+
+    // not bitfields as cores may set these from their own threads
     struct {
-        bool enabled:1;
-        bool log_compass:1;
-        bool log_baro:1;
-        bool log_imu:1;
+        bool enabled;
+        bool log_compass;
+        bool log_baro;
+        bool log_imu;
     } logging;
 
     // time at start of current filter update
@@ -486,6 +509,7 @@ private:
     } pos_down_reset_data;
 
     bool runCoreSelection; // true when the primary core has stabilised and the core selection logic can be started
+    bool statePredictEnabled[7]; // true when the prediction step for this core is enabled on this time step
 
     bool inhibitGpsVertVelUse;  // true when GPS vertical velocity use is prohibited
 
@@ -100,7 +100,7 @@ void NavEKF2_core::calcGpsGoodToAlign(void)
         // capable of giving a vertical velocity
         if (gps.status() >= AP_GPS::GPS_OK_FIX_3D) {
             frontend->_fusionModeGPS.set(1);
-            gcs().send_text(MAV_SEVERITY_WARNING, "EK2: Changed EK2_GPS_TYPE to 1");
+            send_text(MAV_SEVERITY_WARNING, "EK2: Changed EK2_GPS_TYPE to 1");
         }
     } else {
         gpsVertVelFail = false;
@@ -199,6 +199,7 @@ void NavEKF2_core::InitialiseVariables()
     inhibitWindStates = true;
     gndOffsetValid =  false;
     validOrigin = false;
+    newOrigin = false;
     takeoffExpectedSet_ms = 0;
     expectGndEffectTakeoff = false;
     touchdownExpectedSet_ms = 0;
@@ -623,7 +624,7 @@ void NavEKF2_core::UpdateFilter(bool predict)
         AP_HAL::millis() - last_filter_ok_ms > 5000 &&
         !hal.util->get_soft_armed()) {
         // we've been unhealthy for 5 seconds after being healthy, reset the filter
-        gcs().send_text(MAV_SEVERITY_WARNING, "EKF2 IMU%u forced reset",(unsigned)imu_index);
+        send_text(MAV_SEVERITY_WARNING, "EKF2 IMU%u forced reset",(unsigned)imu_index);
         last_filter_ok_ms = 0;
         statesInitialised = false;
         InitialiseFilterBootstrap();
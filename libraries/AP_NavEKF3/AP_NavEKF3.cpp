@@ -604,6 +604,16 @@ const AP_Param::GroupInfo NavEKF3::var_info[] = {
     // @Units: mGauss
     AP_GROUPINFO("MAG_EF_LIM", 56, NavEKF3, _mag_ef_limit, 50),
 
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+    // @Param: THREADS
+    // @DisplayName: Parallel core updates
+    // @Description: When enabled, each EKF core after the first is updated on its own thread pinned to a separate CPU, in parallel with the first core. The prediction step of every core is enabled or skipped at the start of the update rather than as each core runs, and a core adopts an origin set by another core on the following update, so results can differ slightly from updating the cores one after the other. Has no effect on boards with a single CPU.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("THREADS", 57, NavEKF3, _coreThreads, 0),
+#endif
+
     AP_GROUPEND
 };
 
@@ -702,6 +712,20 @@ bool NavEKF3::InitialiseFilter(void)
         for (uint8_t i = 0; i < num_cores; i++) {
             new (&core[i]) NavEKF3_core(this);
         }
+
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+        // start threads to update the cores in parallel
+        if (_coreThreads != 0 && num_cores > 1 && workers == nullptr) {
+            workers = new NavEKF_core_workers();
+            if (workers != nullptr && !workers->init(num_cores)) {
+                delete workers;
+                workers = nullptr;
+            }
+            if (workers != nullptr) {
+                gcs().send_text(MAV_SEVERITY_INFO, "NavEKF3: %u cores in parallel", (unsigned)num_cores);
+            }
+        }
+#endif
     }
 
     // Set up any cores that have been created
@@ -743,6 +767,43 @@ bool NavEKF3::InitialiseFilter(void)
     return ret;
 }
 
+/*
+  return true if core i should run its prediction step on this frame.
+  If we have not overrun by more than 3 IMU frames, and we have
+  already used more than 1/3 of the CPU budget for this loop then
+  suppress the prediction step. This allows multiple EKF instances to
+  cooperate on scheduling
+ */
+bool NavEKF3::predictionEnabled(uint8_t i) const
+{
+    const AP_InertialSensor &ins = AP::ins();
+    return !(core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
+             (AP_HAL::micros() - ins.get_last_update_usec()) > _frameTimeUsec/3);
+}
+
+void NavEKF3::UpdateCoreFilter(uint8_t i)
+{
+    core[i].UpdateFilter(statePredictEnabled[i]);
+}
+
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+/*
+  copy any origin set by a core during a parallel update to the
+  frontend, in core order, so the other cores pick it up on their next
+  update
+ */
+void NavEKF3::shareCoreOrigins(void)
+{
+    for (uint8_t i=0; i<num_cores; i++) {
+        Location loc;
+        if (core[i].getNewOrigin(loc)) {
+            common_EKF_origin = loc;
+            common_origin_valid = true;
+        }
+    }
+}
+#endif
+
 // Update Filter States - this should be called whenever new IMU data is available
 void NavEKF3::UpdateFilter(void)
 {
@@ -752,21 +813,31 @@ void NavEKF3::UpdateFilter(void)
 
     imuSampleTime_us = AP_HAL::micros64();
 
-    const AP_InertialSensor &ins = AP::ins();
+#if HAL_NAVEKF_CORE_THREADS_ENABLED
+    if (workers != nullptr) {
+        // decide on prediction for all cores up front, as they will
+        // all be running at once
+        for (uint8_t i=0; i<num_cores; i++) {
+            statePredictEnabled[i] = predictionEnabled(i);
+            core[i].defer_text();
+        }
+        parallelUpdate = true;
+        workers->run(FUNCTOR_BIND_MEMBER(&NavEKF3::UpdateCoreFilter, void, uint8_t));
+        parallelUpdate = false;
 
-    bool statePredictEnabled[num_cores];
-    for (uint8_t i=0; i<num_cores; i++) {
-        // if we have not overrun by more than 3 IMU frames, and we
-        // have already used more than 1/3 of the CPU budget for this
-        // loop then suppress the prediction step. This allows
-        // multiple EKF instances to cooperate on scheduling
-        if (core[i].getFramesSincePredict() < (_framesPerPrediction+3) &&
-            (AP_HAL::micros() - ins.get_last_update_usec()) > _frameTimeUsec/3) {
-            statePredictEnabled[i] = false;
-        } else {
-            statePredictEnabled[i] = true;
+        // back on the main thread, pass on what the cores couldn't
+        // while running
+        shareCoreOrigins();
+        for (uint8_t i=0; i<num_cores; i++) {
+            core[i].flush_text();
+        }
+    } else
+#endif
+    {
+        for (uint8_t i=0; i<num_cores; i++) {
+            statePredictEnabled[i] = predictionEnabled(i);
+            UpdateCoreFilter(i);
         }
-        core[i].UpdateFilter(statePredictEnabled[i]);
     }
 
     // If the current core selected has a bad error score or is unhealthy, switch to a healthy core with the lowest fault score
@@ -168,7 +168,7 @@ void NavEKF3_core::FuseAirspeed()
                 }
             }
             for (unsigned j = 0; j<=stateIndexLim; j++) {
-                for (unsigned i = 0; i<=stateIndexLim; i++) {
+                for (unsigned i = 0; i<=j; i++) {
                     ftype res = 0;
                     res += KH[i][4] * P[4][j];
                     res += KH[i][5] * P[5][j];
@@ -179,15 +179,14 @@ void NavEKF3_core::FuseAirspeed()
                 }
             }
             for (unsigned i = 0; i<=stateIndexLim; i++) {
-                for (unsigned j = 0; j<=stateIndexLim; j++) {
+                for (unsigned j = i; j<=stateIndexLim; j++) {
                     P[i][j] = P[i][j] - KHP[i][j];
                 }
             }
         }
     }
 
-    // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-    ForceSymmetry();
+    // limit the variances to prevent ill-conditioning
     ConstrainVariances();
 
     // stop performance timer
@@ -433,7 +432,7 @@ void NavEKF3_core::FuseSideslip()
             }
         }
         for (unsigned j = 0; j<=stateIndexLim; j++) {
-            for (unsigned i = 0; i<=stateIndexLim; i++) {
+            for (unsigned i = 0; i<=j; i++) {
                 ftype res = 0;
                 res += KH[i][0] * P[0][j];
                 res += KH[i][1] * P[1][j];
@@ -448,14 +447,13 @@ void NavEKF3_core::FuseSideslip()
             }
         }
         for (unsigned i = 0; i<=stateIndexLim; i++) {
-            for (unsigned j = 0; j<=stateIndexLim; j++) {
+            for (unsigned j = i; j<=stateIndexLim; j++) {
                 P[i][j] = P[i][j] - KHP[i][j];
             }
         }
     }
 
-    // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-    ForceSymmetry();
+    // limit the variances to prevent ill-conditioning
     ConstrainVariances();
 
     // stop the performance timer
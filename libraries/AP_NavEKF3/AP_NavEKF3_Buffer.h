@@ -3,6 +3,11 @@
 // this buffer model is to be used for observation buffers,
 // the data is pushed into buffer like any standard ring buffer
 // return is based on the sample time provided
+//
+// The storage is rounded up to a power of two so indices wrap with a
+// mask. While the unread samples are in time order, which is the
+// normal case, recall() finds the sample with a binary search rather
+// than scanning every unread sample
 template <typename element_type>
 class obs_ring_buffer_t
 {
@@ -14,16 +19,24 @@ public:
     // initialise buffer, returns false when allocation has failed
     bool init(uint32_t size)
     {
-        buffer = new element_t[size];
+        if (size == 0 || size > 256) {
+            return false;
+        }
+        uint16_t capacity = 1;
+        while (capacity < size) {
+            capacity <<= 1;
+        }
+        buffer = new element_t[capacity];
         if(buffer == nullptr)
         {
             return false;
         }
-        memset((void *)buffer,0,size*sizeof(element_t));
-        _size = size;
+        memset((void *)buffer,0,capacity*sizeof(element_t));
+        _mask = capacity - 1;
         _head = 0;
         _tail = 0;
         _new_data = false;
+        _ordered = true;
         return true;
     }
 
@@ -51,6 +64,28 @@ public:
                     _new_data = false;
                 }
             }
+        } else if (_ordered) {
+            // samples from tail to head are in time order, so the
+            // newest one not after sample_time is the last one before
+            // the first sample that is after it. Zeroed samples can
+            // only be at the start and are never used
+            uint8_t lo = 0, hi = (_head - tail) & _mask;
+            while (lo < hi) {
+                const uint8_t mid = (lo + hi) >> 1;
+                if (buffer[(tail + mid) & _mask].element.time_ms <= sample_time) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            if (lo > 0) {
+                const uint8_t index = (tail + lo - 1) & _mask;
+                if (buffer[index].element.time_ms != 0 &&
+                    (sample_time - buffer[index].element.time_ms) < 100) {
+                    bestIndex = index;
+                    success = true;
+                }
+            }
         } else {
             while(_head != tail) {
                 // find a measurement older than the fusion time horizon that we haven't checked before
@@ -63,13 +98,21 @@ public:
                 } else if(buffer[tail].element.time_ms > sample_time){
                     break;
                 }
-                tail = (tail+1)%_size;
+                tail = (tail+1) & _mask;
             }
         }
 
         if (success) {
             element = buffer[bestIndex].element;
-            _tail = (bestIndex+1)%_size;
+            if (bestIndex == _head) {
+                // every sample is now older than tail, order is only
+                // known again once head wraps onto it
+                _ordered = false;
+            } else if (((bestIndex+1) & _mask) == _head) {
+                // only the head sample is left
+                _ordered = true;
+            }
+            _tail = (bestIndex+1) & _mask;
             //make time zero to stop using it again,
             //resolves corner case of reusing the element when head == tail
             buffer[bestIndex].element.time_ms = 0;
@@ -86,16 +129,25 @@ public:
     inline void push(element_type element)
     {
         // Advance head to next available index
-        _head = (_head+1)%_size;
+        const uint8_t head = (_head+1) & _mask;
+        if (head == _tail) {
+            // the oldest unread sample is overwritten, leaving this
+            // one as the only sample from tail to head
+            _ordered = true;
+        } else if (element.time_ms < buffer[_head].element.time_ms) {
+            _ordered = false;
+        }
+        _head = head;
         // New data is written at the head
         buffer[_head].element = element;
         _new_data = true;
     }
     // writes the same data to all elements in the ring buffer
     inline void reset_history(element_type element, uint32_t sample_time) {
-        for (uint8_t index=0; index<_size; index++) {
+        for (uint16_t index=0; index<=_mask; index++) {
             buffer[index].element = element;
         }
+        _ordered = true;
     }
 
     // zeroes all data in the ring buffer
@@ -103,11 +155,14 @@ public:
         _head = 0;
         _tail = 0;
         _new_data = false;
-        memset((void *)buffer,0,_size*sizeof(element_t));
+        _ordered = true;
+        memset((void *)buffer,0,(_mask+1)*sizeof(element_t));
     }
 
 private:
-    uint8_t _size,_head,_tail,_new_data;
+    uint8_t _mask,_head,_tail,_new_data;
+    // true when the samples from _tail to _head are in time order
+    bool _ordered;
 };
 
 
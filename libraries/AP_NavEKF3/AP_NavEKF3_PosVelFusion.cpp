@@ -698,7 +698,7 @@ void NavEKF3_core::FuseVelPosNED()
                 // update the covariance - take advantage of direct observation of a single state at index = stateIndex to reduce computations
                 // this is a numerically optimised implementation of standard equation P = (I - K*H)*P;
                 for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                    for (uint8_t j= 0; j<=stateIndexLim; j++)
+                    for (uint8_t j= i; j<=stateIndexLim; j++)
                     {
                         KHP[i][j] = Kfusion[i] * P[stateIndex][j];
                     }
@@ -713,13 +713,12 @@ void NavEKF3_core::FuseVelPosNED()
                 if (healthyFusion) {
                     // update the covariance matrix
                     for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                        for (uint8_t j= 0; j<=stateIndexLim; j++) {
+                        for (uint8_t j= i; j<=stateIndexLim; j++) {
                             P[i][j] = P[i][j] - KHP[i][j];
                         }
                     }
 
-                    // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-                    ForceSymmetry();
+                    // limit the variances to prevent ill-conditioning
                     ConstrainVariances();
 
                     // update states and renormalise the quaternions
@@ -1510,7 +1509,7 @@ void NavEKF3_core::FuseBodyVel()
             // notify first time only
             if (!bodyVelFusionActive) {
                 bodyVelFusionActive = true;
-                gcs().send_text(MAV_SEVERITY_INFO, "EKF3 IMU%u fusing odometry",(unsigned)imu_index);
+                send_text(MAV_SEVERITY_INFO, "EKF3 IMU%u fusing odometry",(unsigned)imu_index);
             }
             // correct the covariance P = (I - K*H)*P
             // take advantage of the empty columns in KH to reduce the
@@ -1524,7 +1523,7 @@ void NavEKF3_core::FuseBodyVel()
                 }
             }
             for (unsigned j = 0; j<=stateIndexLim; j++) {
-                for (unsigned i = 0; i<=stateIndexLim; i++) {
+                for (unsigned i = 0; i<=j; i++) {
                     ftype res = 0;
                     res += KH[i][0] * P[0][j];
                     res += KH[i][1] * P[1][j];
@@ -1548,13 +1547,12 @@ void NavEKF3_core::FuseBodyVel()
             if (healthyFusion) {
                 // update the covariance matrix
                 for (uint8_t i= 0; i<=stateIndexLim; i++) {
-                    for (uint8_t j= 0; j<=stateIndexLim; j++) {
+                    for (uint8_t j= i; j<=stateIndexLim; j++) {
                         P[i][j] = P[i][j] - KHP[i][j];
                     }
                 }
 
-                // force the covariance matrix to be symmetrical and limit the variances to prevent ill-conditioning.
-                ForceSymmetry();
+                // limit the variances to prevent ill-conditioning
                 ConstrainVariances();
 
                 // correct the state vector
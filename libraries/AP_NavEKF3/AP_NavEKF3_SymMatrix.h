@@ -0,0 +1,116 @@
+/*
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+  symmetric NxN matrix stored as its packed upper triangle, N*(N+1)/2
+  elements instead of N*N. Row i holds columns i..N-1 contiguously, so
+  updates that walk a row of the upper triangle are unit stride and
+  vectorise. Element (i,j) and (j,i) are the same storage, so the
+  matrix is symmetric by construction.
+
+  m[i][j] works as for a two dimensional array; with constant indices
+  the packed offset is resolved at compile time. The accessors are
+  forced inline as at -Os the compiler otherwise makes index() a
+  call, which costs more than the halved loops save.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <AP_Math/AP_Math.h>
+
+template <typename T, uint8_t N>
+class SymMatrixPacked {
+public:
+    static const uint16_t num_elements = uint16_t(N) * (N + 1) / 2;
+
+    // offset of element (i,j) with i <= j
+    __attribute__((always_inline)) static constexpr uint16_t upper_index(uint8_t i, uint8_t j) {
+        return uint16_t(i) * (2 * N - i - 1) / 2 + j;
+    }
+
+    // offset of element (i,j) for any i, j
+    __attribute__((always_inline)) static constexpr uint16_t index(uint8_t i, uint8_t j) {
+        return i <= j ? upper_index(i, j) : upper_index(j, i);
+    }
+
+    class Row {
+    public:
+        Row(T *d, uint8_t r) : _d(d), _r(r) {}
+        __attribute__((always_inline)) T &operator[](uint8_t c) const {
+#if MATH_CHECK_INDEXES
+            assert(c < N);
+#endif
+            return _d[index(_r, c)];
+        }
+    private:
+        T *_d;
+        uint8_t _r;
+    };
+
+    class ConstRow {
+    public:
+        ConstRow(const T *d, uint8_t r) : _d(d), _r(r) {}
+        __attribute__((always_inline)) const T &operator[](uint8_t c) const {
+#if MATH_CHECK_INDEXES
+            assert(c < N);
+#endif
+            return _d[index(_r, c)];
+        }
+    private:
+        const T *_d;
+        uint8_t _r;
+    };
+
+    __attribute__((always_inline)) Row operator[](uint8_t r) {
+#if MATH_CHECK_INDEXES
+        assert(r < N);
+#endif
+        return Row(_v, r);
+    }
+    __attribute__((always_inline)) ConstRow operator[](uint8_t r) const {
+#if MATH_CHECK_INDEXES
+        assert(r < N);
+#endif
+        return ConstRow(_v, r);
+    }
+
+    // pointer to element (i,i); the row continues to (i,N-1)
+    T *upper_row(uint8_t i) { return &_v[upper_index(i, i)]; }
+    const T *upper_row(uint8_t i) const { return &_v[upper_index(i, i)]; }
+
+    void zero() { memset(_v, 0, sizeof(_v)); }
+
+    // zero rows and columns first to last inclusive
+    void zero_rows_cols(uint8_t first, uint8_t last) {
+        for (uint8_t i=0; i<first; i++) {
+            memset(&upper_row(i)[first-i], 0, sizeof(T)*(1+last-first));
+        }
+        for (uint8_t i=first; i<=last; i++) {
+            memset(upper_row(i), 0, sizeof(T)*(N-i));
+        }
+    }
+
+    // set from the upper triangle of a full NxN matrix
+    template <typename M>
+    void set_from_upper(const M &m, uint8_t last = N-1) {
+        for (uint8_t i=0; i<=last; i++) {
+            memcpy(upper_row(i), &m[i][i], sizeof(T)*(last+1-i));
+        }
+    }
+
+private:
+    alignas(16) T _v[num_elements];
+};
@@ -75,11 +75,11 @@ bool NavEKF3_core::setup_core(uint8_t _imu_index, uint8_t _core_index)
                 lastInitFailReport_ms = AP_HAL::millis();
                 // provide an escalating series of messages
                 if (AP_HAL::millis() > 30000) {
-                    gcs().send_text(MAV_SEVERITY_ERROR, "EKF3 waiting for GPS config data");
+                    send_text(MAV_SEVERITY_ERROR, "EKF3 waiting for GPS config data");
                 } else if (AP_HAL::millis() > 15000) {
-                    gcs().send_text(MAV_SEVERITY_WARNING, "EKF3 waiting for GPS config data");
+                    send_text(MAV_SEVERITY_WARNING, "EKF3 waiting for GPS config data");
                 } else  {
-                    gcs().send_text(MAV_SEVERITY_INFO, "EKF3 waiting for GPS config data");
+                    send_text(MAV_SEVERITY_INFO, "EKF3 waiting for GPS config data");
                 }
             }
             return false;
@@ -146,7 +146,7 @@ bool NavEKF3_core::setup_core(uint8_t _imu_index, uint8_t _core_index)
     if(!storedOutput.init(imu_buffer_length)) {
         return false;
     }
-    gcs().send_text(MAV_SEVERITY_INFO, "EKF3 IMU%u buffers IMU=%u OBS=%u OF=%u, dt=%.4f",
+    send_text(MAV_SEVERITY_INFO, "EKF3 IMU%u buffers IMU=%u OBS=%u OF=%u, dt=%.4f",
                     (unsigned)imu_index,
                     (unsigned)imu_buffer_length,
                     (unsigned)obs_buffer_length,
@@ -210,7 +210,7 @@ void NavEKF3_core::InitialiseVariables()
     velDotNEDfilt.zero();
     lastKnownPositionNE.zero();
     prevTnb.zero();
-    memset(&P[0][0], 0, sizeof(P));
+    P.zero();
     memset(&KH[0][0], 0, sizeof(KH));
     memset(&KHP[0][0], 0, sizeof(KHP));
     memset(&nextP[0][0], 0, sizeof(nextP));
@@ -240,6 +240,7 @@ void NavEKF3_core::InitialiseVariables()
     inhibitDelAngBiasStates = true;
     gndOffsetValid =  false;
     validOrigin = false;
+    newOrigin = false;
     takeoffExpectedSet_ms = 0;
     expectGndEffectTakeoff = false;
     touchdownExpectedSet_ms = 0;
@@ -513,7 +514,7 @@ bool NavEKF3_core::InitialiseFilterBootstrap(void)
         inactiveBias[i].accel_bias.zero();
     }
 
-    gcs().send_text(MAV_SEVERITY_INFO, "EKF3 IMU%u initialised",(unsigned)imu_index);
+    send_text(MAV_SEVERITY_INFO, "EKF3 IMU%u initialised",(unsigned)imu_index);
 
     // we initially return false to wait for the IMU buffer to fill
     return false;
@@ -523,7 +524,7 @@ bool NavEKF3_core::InitialiseFilterBootstrap(void)
 void NavEKF3_core::CovarianceInit()
 {
     // zero the matrix
-    memset(&P[0][0], 0, sizeof(P));
+    P.zero();
 
     // define the initial angle uncertainty as variances for a rotation vector
     Vector3f rot_vec_var;
@@ -984,6 +985,9 @@ void NavEKF3_core::CovariancePrediction()
 
     // calculate the predicted covariance due to inertial sensor error propagation
     // we calculate the lower diagonal and copy to take advantage of symmetry
+    // this is generated code that only evaluates the non-zero terms of F*P*F'. It is
+    // deliberately kept scalar, a vectorised dense product is far slower (see
+    // BM_CovariancePredictDense in benchmarks/benchmark_covariance.cpp)
 
     // intermediate calculations
     Vector21 SF;
@@ -1381,16 +1385,9 @@ void NavEKF3_core::CovariancePrediction()
         }
     }
 
-    // covariance matrix is symmetrical, so copy diagonals and copy lower half in nextP
-    // to lower and upper half in P
-    for (uint8_t row = 0; row <= stateIndexLim; row++) {
-        // copy diagonals
-        P[row][row] = nextP[row][row];
-        // copy off diagonals
-        for (uint8_t column = 0 ; column < row; column++) {
-            P[row][column] = P[column][row] = nextP[column][row];
-        }
-    }
+    // covariance matrix is symmetrical, so copy the upper half of
+    // nextP into P, one contiguous row at a time
+    P.set_from_upper(nextP, stateIndexLim);
 
     // constrain values to prevent ill-conditioning
     ConstrainVariances();
@@ -1398,24 +1395,18 @@ void NavEKF3_core::CovariancePrediction()
     hal.util->perf_end(_perf_CovariancePrediction);
 }
 
-// zero specified range of rows in the state covariance matrix
-void NavEKF3_core::zeroRows(Matrix24 &covMat, uint8_t first, uint8_t last)
+// zero specified range of rows in the state covariance matrix. As the
+// matrix is stored packed this also zeroes the matching columns
+void NavEKF3_core::zeroRows(PackedMatrix24 &covMat, uint8_t first, uint8_t last)
 {
-    uint8_t row;
-    for (row=first; row<=last; row++)
-    {
-        memset(&covMat[row][0], 0, sizeof(covMat[0][0])*24);
-    }
+    covMat.zero_rows_cols(first, last);
 }
 
-// zero specified range of columns in the state covariance matrix
-void NavEKF3_core::zeroCols(Matrix24 &covMat, uint8_t first, uint8_t last)
+// zero specified range of columns in the state covariance matrix. As
+// the matrix is stored packed this also zeroes the matching rows
+void NavEKF3_core::zeroCols(PackedMatrix24 &covMat, uint8_t first, uint8_t last)
 {
-    uint8_t row;
-    for (row=0; row<=23; row++)
-    {
-        memset(&covMat[row][first], 0, sizeof(covMat[0][0])*(1+last-first));
-    }
+    covMat.zero_rows_cols(first, last);
 }
 
 // reset the output data to the current EKF state
@@ -1463,20 +1454,6 @@ void NavEKF3_core::quat2Tbn(Matrix3f &Tbn, const Quaternion &quat) const
     quat.rotation_matrix(Tbn);
 }
 
-// force symmetry on the covariance matrix to prevent ill-conditioning
-void NavEKF3_core::ForceSymmetry()
-{
-    for (uint8_t i=1; i<=stateIndexLim; i++)
-    {
-        for (uint8_t j=0; j<=i-1; j++)
-        {
-            float temp = 0.5f*(P[i][j] + P[j][i]);
-            P[i][j] = temp;
-            P[j][i] = temp;
-        }
-    }
-}
-
 // constrain variances (diagonal terms) in the state covariance matrix to  prevent ill-conditioning
 // if states are inactive, zero the corresponding off-diagonals
 void NavEKF3_core::ConstrainVariances()
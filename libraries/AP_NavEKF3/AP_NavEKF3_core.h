@@ -29,6 +29,7 @@
 #include <AP_Math/vectorN.h>
 #include <AP_NavEKF/AP_NavEKF_core_common.h>
 #include <AP_NavEKF3/AP_NavEKF3_Buffer.h>
+#include <AP_NavEKF3/AP_NavEKF3_SymMatrix.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
 
 // GPS pre-flight check bit locations
@@ -171,6 +172,10 @@ public:
     // Returns false if the filter has rejected the attempt to set the origin
     bool setOriginLLH(const Location &loc);
 
+    // return the origin if it has been set since the last call, so
+    // the frontend can share it with the other cores
+    bool getNewOrigin(Location &loc);
+
     // return estimated height above ground level
     // return false if ground height is not being estimated.
     bool getHAGL(float &HAGL) const;
@@ -427,6 +432,9 @@ private:
     typedef uint32_t Vector_u32_50[50];
 #endif
 
+    // symmetric 24x24 matrix holding only the upper triangle
+    typedef SymMatrixPacked<ftype,24> PackedMatrix24;
+
     const AP_AHRS *_ahrs;
 
     // the states are available in two forms, either as a Vector24, or
@@ -548,9 +556,6 @@ private:
     // calculate the predicted state covariance matrix
     void CovariancePrediction();
 
-    // force symmetry on the state covariance matrix
-    void ForceSymmetry();
-
     // constrain variances (diagonal terms) in the state covariance matrix
     void ConstrainVariances();
 
@@ -585,10 +590,10 @@ private:
     void FuseSideslip();
 
     // zero specified range of rows in the state covariance matrix
-    void zeroRows(Matrix24 &covMat, uint8_t first, uint8_t last);
+    void zeroRows(PackedMatrix24 &covMat, uint8_t first, uint8_t last);
 
     // zero specified range of columns in the state covariance matrix
-    void zeroCols(Matrix24 &covMat, uint8_t first, uint8_t last);
+    void zeroCols(PackedMatrix24 &covMat, uint8_t first, uint8_t last);
 
     // Reset the stored output history to current data
     void StoreOutputReset(void);
@@ -860,7 +865,7 @@ private:
     bool badIMUdata;                // boolean true if the bad IMU data is detected
 
     float gpsNoiseScaler;           // Used to scale the  GPS measurement noise and consistency gates to compensate for operation with small satellite counts
-    Matrix24 P;                     // covariance matrix
+    PackedMatrix24 P;               // covariance matrix, symmetric so only the upper triangle is stored
     imu_ring_buffer_t<imu_elements> storedIMU;      // IMU data buffer
     obs_ring_buffer_t<gps_elements> storedGPS;      // GPS data buffer
     obs_ring_buffer_t<mag_elements> storedMag;      // Magnetometer data buffer
@@ -927,6 +932,7 @@ private:
     bool gpsNotAvailable;           // bool true when valid GPS data is not available
     struct Location EKF_origin;     // LLH origin of the NED axis system
     bool validOrigin;               // true when the EKF origin is valid
+    bool newOrigin;                 // true when the EKF origin has been set and not yet shared with the other cores
     float gpsSpdAccuracy;           // estimated speed accuracy in m/s returned by the GPS receiver
     float gpsPosAccuracy;           // estimated position accuracy in m returned by the GPS receiver
     float gpsHgtAccuracy;           // estimated height accuracy in m returned by the GPS receiver
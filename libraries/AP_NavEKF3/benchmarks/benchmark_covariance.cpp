@@ -0,0 +1,168 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/matrix_kernels.h>
+#include <AP_NavEKF3/AP_NavEKF3_SymMatrix.h>
+
+/*
+  compare the covariance bookkeeping done for each EKF3 prediction and
+  fusion step with P held as a full 24x24 matrix (as before) and as a
+  packed upper triangle. The work modelled is the copy of the
+  predicted covariance into P, one magnetometer style update
+  P -= K*H*P using 10 non-zero columns of KH, and (for the full
+  matrix) the ForceSymmetry() pass
+ */
+
+typedef float Matrix24[24][24];
+typedef SymMatrixPacked<float,24> PackedMatrix24;
+
+static const uint8_t stateIndexLim = 23;
+
+static Matrix24 nextP;
+static Matrix24 KH;
+static Matrix24 KHP;
+static Matrix24 P_full;
+static PackedMatrix24 P_packed;
+
+static void setup_inputs(void)
+{
+    for (uint8_t i=0; i<24; i++) {
+        for (uint8_t j=0; j<24; j++) {
+            nextP[i][j] = nextP[j][i] = (i == j) ? 1.0f : 1.0e-3f * (i + j);
+            KH[i][j] = 1.0e-4f * (i + 1);
+        }
+    }
+}
+
+template <typename M>
+static void calc_KHP(const M &P, bool upper_only)
+{
+    for (unsigned j = 0; j<=stateIndexLim; j++) {
+        const unsigned last = upper_only ? j : stateIndexLim;
+        for (unsigned i = 0; i<=last; i++) {
+            float res = 0;
+            res += KH[i][0] * P[0][j];
+            res += KH[i][1] * P[1][j];
+            res += KH[i][2] * P[2][j];
+            res += KH[i][3] * P[3][j];
+            res += KH[i][16] * P[16][j];
+            res += KH[i][17] * P[17][j];
+            res += KH[i][18] * P[18][j];
+            res += KH[i][19] * P[19][j];
+            res += KH[i][20] * P[20][j];
+            res += KH[i][21] * P[21][j];
+            KHP[i][j] = res;
+        }
+    }
+}
+
+// the updates are not inlined and are passed P through an escaped
+// pointer so that, as for the member P in the EKF, the compiler cannot
+// assume it does not alias KHP
+static NOINLINE void update_full(Matrix24 &P)
+{
+    // copy predicted covariance
+    for (uint8_t row = 0; row <= stateIndexLim; row++) {
+        P[row][row] = nextP[row][row];
+        for (uint8_t column = 0 ; column < row; column++) {
+            P[row][column] = P[column][row] = nextP[column][row];
+        }
+    }
+
+    // fusion update
+    calc_KHP(P, false);
+    for (uint8_t i = 0; i<=stateIndexLim; i++) {
+        for (uint8_t j = 0; j<=stateIndexLim; j++) {
+            P[i][j] = P[i][j] - KHP[i][j];
+        }
+    }
+
+    // force symmetry
+    for (uint8_t i=1; i<=stateIndexLim; i++) {
+        for (uint8_t j=0; j<=i-1; j++) {
+            float temp = 0.5f*(P[i][j] + P[j][i]);
+            P[i][j] = temp;
+            P[j][i] = temp;
+        }
+    }
+}
+
+static NOINLINE void update_packed(PackedMatrix24 &P)
+{
+    // copy predicted covariance
+    P.set_from_upper(nextP, stateIndexLim);
+
+    // fusion update, upper triangle only
+    calc_KHP(P, true);
+    for (uint8_t i = 0; i<=stateIndexLim; i++) {
+        for (uint8_t j = i; j<=stateIndexLim; j++) {
+            P[i][j] = P[i][j] - KHP[i][j];
+        }
+    }
+}
+
+static void BM_CovarianceFull(benchmark::State& state)
+{
+    Matrix24 *P = &P_full;
+    setup_inputs();
+    gbenchmark_escape(&P);
+
+    while (state.KeepRunning()) {
+        update_full(*P);
+        gbenchmark_escape(P);
+    }
+}
+
+static void BM_CovariancePacked(benchmark::State& state)
+{
+    PackedMatrix24 *P = &P_packed;
+    setup_inputs();
+    gbenchmark_escape(&P);
+
+    while (state.KeepRunning()) {
+        update_packed(*P);
+        gbenchmark_escape(P);
+    }
+}
+
+/*
+  the covariance prediction written as the dense product F*P*F', which
+  is unit stride and vectorises. This is the form a SIMD prediction
+  would take; the generated code in CovariancePrediction() only
+  evaluates the non-zero terms of F, around 2500 multiplies for the
+  upper triangle against 2*24^3 here, and is much faster even when
+  this is vectorised
+ */
+static Matrix24 F;
+static Matrix24 FT;
+static Matrix24 FP;
+
+static NOINLINE void predict_dense(Matrix24 &P)
+{
+    mat_mul(F, P, FP);
+    mat_mul(FP, FT, nextP);
+}
+
+static void BM_CovariancePredictDense(benchmark::State& state)
+{
+    Matrix24 *P = &P_full;
+    setup_inputs();
+    for (uint8_t i=0; i<24; i++) {
+        for (uint8_t j=0; j<24; j++) {
+            F[i][j] = FT[j][i] = (i == j) ? 1.0f : 1.0e-2f * ((i + j) % 3 == 0);
+            P_full[i][j] = nextP[i][j];
+        }
+    }
+    gbenchmark_escape(&P);
+
+    while (state.KeepRunning()) {
+        predict_dense(*P);
+        gbenchmark_escape(&nextP);
+    }
+}
+
+BENCHMARK(BM_CovarianceFull);
+BENCHMARK(BM_CovariancePacked);
+BENCHMARK(BM_CovariancePredictDense);
+
+BENCHMARK_MAIN()
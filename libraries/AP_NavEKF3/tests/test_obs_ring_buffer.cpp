@@ -0,0 +1,234 @@
+#include <AP_gtest.h>
+#include <AP_Common/AP_Common.h>
+
+#include <AP_NavEKF3/AP_NavEKF3_Buffer.h>
+
+/*
+  check that obs_ring_buffer_t returns exactly what the original linear
+  scan buffer returned for the same pushes and recalls
+ */
+
+struct test_elements {
+    float value;
+    uint32_t time_ms;
+};
+
+// the observation buffer as it was before recall() used a binary
+// search, kept as the reference
+template <typename element_type>
+class ref_obs_ring_buffer_t
+{
+public:
+    struct element_t{
+        element_type element;
+    } *buffer;
+
+    bool init(uint32_t size)
+    {
+        buffer = new element_t[size];
+        memset((void *)buffer,0,size*sizeof(element_t));
+        _size = size;
+        _head = 0;
+        _tail = 0;
+        _new_data = false;
+        return true;
+    }
+
+    bool recall(element_type &element,uint32_t sample_time)
+    {
+        if(!_new_data) {
+            return false;
+        }
+        bool success = false;
+        uint8_t tail = _tail, bestIndex;
+
+        if(_head == tail) {
+            if (buffer[tail].element.time_ms != 0 && buffer[tail].element.time_ms <= sample_time) {
+                if (((sample_time - buffer[tail].element.time_ms) < 100)) {
+                    bestIndex = tail;
+                    success = true;
+                    _new_data = false;
+                }
+            }
+        } else {
+            while(_head != tail) {
+                if (buffer[tail].element.time_ms != 0 && buffer[tail].element.time_ms <= sample_time) {
+                    if (((sample_time - buffer[tail].element.time_ms) < 100)) {
+                        bestIndex = tail;
+                        success = true;
+                    }
+                } else if(buffer[tail].element.time_ms > sample_time){
+                    break;
+                }
+                tail = (tail+1)%_size;
+            }
+        }
+
+        if (success) {
+            element = buffer[bestIndex].element;
+            _tail = (bestIndex+1)%_size;
+            buffer[bestIndex].element.time_ms = 0;
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    void push(element_type element)
+    {
+        _head = (_head+1)%_size;
+        buffer[_head].element = element;
+        _new_data = true;
+    }
+
+    void reset_history(element_type element, uint32_t sample_time) {
+        for (uint8_t index=0; index<_size; index++) {
+            buffer[index].element = element;
+        }
+    }
+
+    void reset() {
+        _head = 0;
+        _tail = 0;
+        _new_data = false;
+        memset((void *)buffer,0,_size*sizeof(element_t));
+    }
+
+private:
+    uint8_t _size,_head,_tail,_new_data;
+};
+
+static uint32_t rand_state;
+
+static uint32_t next_rand(uint32_t max)
+{
+    rand_state = rand_state * 1664525U + 1013904223U;
+    return (rand_state >> 8) % max;
+}
+
+struct sequence {
+    uint8_t buffer_size;
+    uint16_t interval_ms;   // time between samples
+    uint16_t jitter_ms;     // random extra delay on each sample
+    uint16_t delay_ms;      // fusion time horizon delay
+    uint8_t burst;          // if non-zero, push this many samples at once every so often
+    bool resets;            // reset the buffers occasionally
+};
+
+/*
+  sequences shaped like the sensors fed to the EKF. A buffer size that
+  is not a power of two is rounded up, so those sequences must never
+  overflow the reference buffer; power of two sizes are also run with
+  bursts that wrap the buffer
+ */
+static const sequence sequences[] = {
+    { 23, 200, 0, 220, 0, false },     // 5Hz GPS
+    { 23, 200, 40, 220, 0, false },    // 5Hz GPS with lag jitter
+    { 23, 100, 0, 60, 0, false },      // 10Hz baro
+    { 23, 20, 0, 100, 0, false },      // 50Hz external nav
+    { 23, 20, 15, 100, 0, false },     // 50Hz external nav, samples out of order
+    { 16, 20, 30, 120, 0, true },
+    { 8, 20, 0, 100, 12, false },      // bursts that wrap the buffer
+    { 8, 20, 25, 100, 10, true },
+    { 16, 5, 8, 60, 20, false },
+    { 4, 20, 0, 50, 6, true },
+    { 1, 50, 5, 30, 0, false },
+};
+
+static void run_sequence(const sequence &seq, uint32_t seed)
+{
+    rand_state = seed;
+
+    obs_ring_buffer_t<test_elements> buf;
+    ref_obs_ring_buffer_t<test_elements> ref;
+    ASSERT_TRUE(buf.init(seq.buffer_size));
+    ASSERT_TRUE(ref.init(seq.buffer_size));
+
+    uint32_t next_sample_ms = 1000;
+    uint32_t recalls = 0;
+    for (uint32_t now_ms = 1000; now_ms < 61000; now_ms += 10) {
+        if (now_ms >= next_sample_ms) {
+            next_sample_ms += seq.interval_ms;
+            uint8_t count = 1;
+            if (seq.burst != 0 && next_rand(50) == 0) {
+                count = seq.burst;
+            }
+            for (uint8_t i=0; i<count; i++) {
+                test_elements e;
+                e.time_ms = now_ms - (seq.jitter_ms ? next_rand(seq.jitter_ms) : 0);
+                e.value = next_rand(100000) * 0.01f;
+                buf.push(e);
+                ref.push(e);
+            }
+        }
+
+        if (seq.resets && next_rand(2000) == 0) {
+            if (next_rand(2) == 0) {
+                buf.reset();
+                ref.reset();
+            } else {
+                test_elements e;
+                e.time_ms = now_ms;
+                e.value = 0;
+                buf.reset_history(e, now_ms);
+                ref.reset_history(e, now_ms);
+            }
+        }
+
+        const uint32_t sample_time_ms = now_ms - seq.delay_ms;
+        test_elements got {}, expected {};
+        const bool ok = buf.recall(got, sample_time_ms);
+        const bool ok_ref = ref.recall(expected, sample_time_ms);
+        ASSERT_EQ(ok_ref, ok) << "at " << now_ms;
+        if (ok) {
+            recalls++;
+            ASSERT_EQ(0, memcmp(&expected, &got, sizeof(got))) << "at " << now_ms;
+        }
+    }
+    EXPECT_GT(recalls, 0U);
+}
+
+TEST(ObsRingBuffer, MatchesLinearScan)
+{
+    for (const sequence &seq : sequences) {
+        for (uint32_t seed=1; seed<=20; seed++) {
+            SCOPED_TRACE(testing::Message() << "sequence " << (&seq - sequences) << " seed " << seed);
+            run_sequence(seq, seed);
+        }
+    }
+}
+
+TEST(ObsRingBuffer, RecallNewestInWindow)
+{
+    obs_ring_buffer_t<test_elements> buf;
+    ASSERT_TRUE(buf.init(10));
+
+    test_elements e {};
+    EXPECT_FALSE(buf.recall(e, 1000));
+
+    for (uint32_t t=100; t<=1000; t+=100) {
+        e.time_ms = t;
+        e.value = t;
+        buf.push(e);
+    }
+
+    // newest sample not after the fusion time
+    EXPECT_TRUE(buf.recall(e, 650));
+    EXPECT_EQ(600U, e.time_ms);
+
+    // samples older than the one returned are discarded
+    EXPECT_FALSE(buf.recall(e, 650));
+
+    EXPECT_TRUE(buf.recall(e, 950));
+    EXPECT_EQ(900U, e.time_ms);
+
+    // too old to use
+    EXPECT_FALSE(buf.recall(e, 1150));
+    EXPECT_TRUE(buf.recall(e, 1050));
+    EXPECT_EQ(1000U, e.time_ms);
+
+    // each sample is only returned once
+    EXPECT_FALSE(buf.recall(e, 1050));
+}
+
+AP_GTEST_MAIN()
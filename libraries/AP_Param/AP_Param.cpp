@@ -80,6 +80,28 @@ uint16_t AP_Param::num_read_only = 0;
 
 ObjectBuffer<AP_Param::param_save> AP_Param::save_queue{30};
 bool AP_Param::registered_save_handler;
+struct AP_Param::save_stats AP_Param::_save_stats;
+
+AP_Param::batch_save *AP_Param::_save_batch;
+uint16_t AP_Param::_save_batch_count;
+uint32_t AP_Param::_save_batch_start_ms;
+bool AP_Param::_save_batch_committed;
+bool AP_Param::_save_batch_writing;
+HAL_Semaphore AP_Param::_save_batch_sem;
+
+#if AP_PARAM_STORAGE_MAP
+AP_Param::storage_map_entry *AP_Param::_storage_map;
+uint16_t AP_Param::_storage_map_count;
+uint16_t AP_Param::_storage_map_size;
+bool AP_Param::_storage_map_failed;
+HAL_Semaphore AP_Param::_storage_map_sem;
+#endif
+
+#if AP_PARAM_LOOKUP_INDEX
+AP_Param::lookup_index *AP_Param::_lookup_index;
+uint16_t AP_Param::_lookup_generation;
+HAL_Semaphore AP_Param::_lookup_sem;
+#endif
 
 // we need a dummy object for the parameter save callback
 static AP_Param save_dummy;
@@ -138,6 +160,12 @@ void AP_Param::erase_all(void)
 
     // add a sentinal directly after the header
     write_sentinal(sizeof(struct EEPROM_header));
+
+#if AP_PARAM_STORAGE_MAP
+    WITH_SEMAPHORE(_storage_map_sem);
+    _storage_map_count = 0;
+    _storage_map_failed = false;
+#endif
 }
 
 /* the 'group_id' of a element of a group is the 18 bit identifier
@@ -685,6 +713,18 @@ bool AP_Param::is_sentinal(const Param_header &phdr)
 // if the sentinal isn't found either, the offset is set to 0xFFFF
 bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
 {
+#if AP_PARAM_STORAGE_MAP
+    {
+        WITH_SEMAPHORE(_storage_map_sem);
+        if (_storage_map != nullptr || storage_map_build()) {
+            if (storage_map_find(*target, *pofs)) {
+                return true;
+            }
+            *pofs = sentinal_offset;
+            return false;
+        }
+    }
+#endif
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
     while (ofs < _storage.size()) {
@@ -709,6 +749,156 @@ bool AP_Param::scan(const AP_Param::Param_header *target, uint16_t *pofs)
     return false;
 }
 
+#if AP_PARAM_STORAGE_MAP
+/*
+  return a Param_header as the value used to key the storage map
+ */
+uint32_t AP_Param::storage_map_header(const Param_header &phdr)
+{
+    uint32_t v;
+    memcpy(&v, &phdr, sizeof(v));
+    return v;
+}
+
+int AP_Param::storage_map_cmp(const void *a, const void *b)
+{
+    const storage_map_entry *e1 = (const storage_map_entry *)a;
+    const storage_map_entry *e2 = (const storage_map_entry *)b;
+    if (e1->header != e2->header) {
+        return e1->header < e2->header ? -1 : 1;
+    }
+    // keep the first copy in storage first, as scan() would find it
+    return int(e1->ofs) - int(e2->ofs);
+}
+
+void AP_Param::storage_map_free(void)
+{
+    delete[] _storage_map;
+    _storage_map = nullptr;
+    _storage_map_count = 0;
+    _storage_map_size = 0;
+}
+
+/*
+  walk storage once to build the map. Must be called with
+  _storage_map_sem held. Returns false if the map can't be used
+ */
+bool AP_Param::storage_map_build(void)
+{
+    if (_storage_map_failed) {
+        return false;
+    }
+
+    // count the variables so we only allocate once
+    struct Param_header phdr;
+    uint16_t count = 0;
+    uint16_t ofs = sizeof(AP_Param::EEPROM_header);
+    while (true) {
+        if (ofs >= _storage.size()) {
+            // no sentinal, leave it to scan() to report
+            _storage_map_failed = true;
+            return false;
+        }
+        _storage.read_block(&phdr, ofs, sizeof(phdr));
+        if (is_sentinal(phdr)) {
+            break;
+        }
+        count++;
+        ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
+    }
+
+    // allow some room to add variables before we need to grow
+    const uint16_t size = count + 32;
+    _storage_map = new storage_map_entry[size];
+    if (_storage_map == nullptr) {
+        _storage_map_failed = true;
+        return false;
+    }
+    _storage_map_size = size;
+
+    ofs = sizeof(AP_Param::EEPROM_header);
+    for (uint16_t i=0; i<count; i++) {
+        _storage.read_block(&phdr, ofs, sizeof(phdr));
+        _storage_map[i].header = storage_map_header(phdr);
+        _storage_map[i].ofs = ofs;
+        ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
+    }
+    sentinal_offset = ofs;
+
+    qsort(_storage_map, count, sizeof(storage_map_entry), storage_map_cmp);
+
+    // drop any duplicates, keeping the first one in storage
+    uint16_t n = 0;
+    for (uint16_t i=0; i<count; i++) {
+        if (n > 0 && _storage_map[n-1].header == _storage_map[i].header) {
+            continue;
+        }
+        _storage_map[n++] = _storage_map[i];
+    }
+    _storage_map_count = n;
+    return true;
+}
+
+/*
+  binary search the map for a header. Must be called with
+  _storage_map_sem held
+ */
+bool AP_Param::storage_map_find(const Param_header &phdr, uint16_t &ofs)
+{
+    const uint32_t header = storage_map_header(phdr);
+    uint16_t lo = 0;
+    uint16_t hi = _storage_map_count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (_storage_map[mid].header < header) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == _storage_map_count || _storage_map[lo].header != header) {
+        return false;
+    }
+    ofs = _storage_map[lo].ofs;
+    return true;
+}
+
+/*
+  record a variable that has just been added to storage
+ */
+void AP_Param::storage_map_add(const Param_header &phdr, uint16_t ofs)
+{
+    WITH_SEMAPHORE(_storage_map_sem);
+    if (_storage_map == nullptr) {
+        return;
+    }
+    if (_storage_map_count == _storage_map_size) {
+        const uint16_t new_size = _storage_map_size + 32;
+        storage_map_entry *new_map = new storage_map_entry[new_size];
+        if (new_map == nullptr) {
+            // fall back to walking storage
+            storage_map_free();
+            _storage_map_failed = true;
+            return;
+        }
+        memcpy(new_map, _storage_map, _storage_map_count * sizeof(storage_map_entry));
+        delete[] _storage_map;
+        _storage_map = new_map;
+        _storage_map_size = new_size;
+    }
+
+    const uint32_t header = storage_map_header(phdr);
+    uint16_t i = _storage_map_count;
+    while (i > 0 && _storage_map[i-1].header > header) {
+        _storage_map[i] = _storage_map[i-1];
+        i--;
+    }
+    _storage_map[i].header = header;
+    _storage_map[i].ofs = ofs;
+    _storage_map_count++;
+}
+#endif // AP_PARAM_STORAGE_MAP
+
 /**
  * add a _X, _Y, _Z suffix to the name of a Vector3f element
  * @param buffer
@@ -840,6 +1030,12 @@ AP_Param::find_group(const char *name, uint16_t vindex, ptrdiff_t group_offset,
 AP_Param *
 AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
 {
+#if AP_PARAM_LOOKUP_INDEX
+    AP_Param *ap_indexed = find_indexed(name, ptype, flags);
+    if (ap_indexed != nullptr) {
+        return ap_indexed;
+    }
+#endif
     for (uint16_t i=0; i<_num_vars; i++) {
         uint8_t type = _var_info[i].type;
         if (type == AP_PARAM_GROUP) {
@@ -880,11 +1076,26 @@ AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
     return nullptr;
 }
 
-// Find a variable by index. Note that this is quite slow.
+// Find a variable by index. Note that this is quite slow unless the
+// lookup index has been built by count_parameters()
 //
 AP_Param *
 AP_Param::find_by_index(uint16_t idx, enum ap_var_type *ptype, ParamToken *token)
 {
+#if AP_PARAM_LOOKUP_INDEX
+    {
+        WITH_SEMAPHORE(_lookup_sem);
+        if (_lookup_index != nullptr) {
+            if (idx >= _lookup_index->num_scalars) {
+                return nullptr;
+            }
+            const lookup_scalar &s = _lookup_index->scalars[idx];
+            *token = s.token;
+            *ptype = (enum ap_var_type)s.type;
+            return s.ap;
+        }
+    }
+#endif
     AP_Param *ap;
     uint16_t count=0;
     for (ap=AP_Param::first(token, ptype);
@@ -968,6 +1179,27 @@ bool AP_Param::find_key_by_pointer(const void *ptr, uint16_t &key)
 AP_Param *
 AP_Param::find_object(const char *name)
 {
+#if AP_PARAM_LOOKUP_INDEX
+    {
+        WITH_SEMAPHORE(_lookup_sem);
+        if (_lookup_index != nullptr) {
+            const uint32_t hash = lookup_hash(name, true);
+            const lookup_name *n = lookup_first(_lookup_index->objects, _num_vars, hash);
+            const lookup_name *end = &_lookup_index->objects[_num_vars];
+            for (; n != nullptr && n < end && n->hash == hash; n++) {
+                const uint16_t i = n->index;
+                if (strcasecmp(name, _var_info[i].name) == 0) {
+                    ptrdiff_t base;
+                    if (!get_base(_var_info[i], base)) {
+                        return nullptr;
+                    }
+                    return (AP_Param *)base;
+                }
+            }
+            return nullptr;
+        }
+    }
+#endif
     for (uint16_t i=0; i<_num_vars; i++) {
         if (strcasecmp(name, _var_info[i].name) == 0) {
             ptrdiff_t base;
@@ -1010,7 +1242,7 @@ void AP_Param::notify() const {
 /*
   Save the variable to HAL storage, synchronous version
 */
-void AP_Param::save_sync(bool force_save)
+void AP_Param::save_sync(bool force_save, bool send_to_gcs)
 {
     uint32_t group_element = 0;
     const struct GroupInfo *ginfo;
@@ -1046,7 +1278,7 @@ void AP_Param::save_sync(bool force_save)
 
     if (phdr.type == AP_PARAM_INT8 && ginfo != nullptr && (ginfo->flags & AP_PARAM_FLAG_ENABLE)) {
         // clear cached parameter count
-        _parameter_count = 0;
+        invalidate_count();
     }
     
     char name[AP_MAX_NAME_SIZE+1];
@@ -1057,7 +1289,9 @@ void AP_Param::save_sync(bool force_save)
     if (scan(&phdr, &ofs)) {
         // found an existing copy of the variable
         eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
-        send_parameter(name, (enum ap_var_type)phdr.type, idx);
+        if (send_to_gcs) {
+            send_parameter(name, (enum ap_var_type)phdr.type, idx);
+        }
         return;
     }
     if (ofs == (uint16_t) ~0) {
@@ -1074,7 +1308,9 @@ void AP_Param::save_sync(bool force_save)
             v2 = get_default_value(this, &info->def_value);
         }
         if (is_equal(v1,v2) && !force_save) {
-            GCS_SEND_PARAM(name, (enum ap_var_type)info->type, v2);
+            if (send_to_gcs) {
+                GCS_SEND_PARAM(name, (enum ap_var_type)info->type, v2);
+            }
             return;
         }
         if (!force_save &&
@@ -1082,7 +1318,9 @@ void AP_Param::save_sync(bool force_save)
              (fabsf(v1-v2) < 0.0001f*fabsf(v1)))) {
             // for other than 32 bit integers, we accept values within
             // 0.01 percent of the current value as being the same
-            GCS_SEND_PARAM(name, (enum ap_var_type)info->type, v2);
+            if (send_to_gcs) {
+                GCS_SEND_PARAM(name, (enum ap_var_type)info->type, v2);
+            }
             return;
         }
     }
@@ -1097,8 +1335,13 @@ void AP_Param::save_sync(bool force_save)
     write_sentinal(ofs + sizeof(phdr) + type_size((enum ap_var_type)phdr.type));
     eeprom_write_check(ap, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
     eeprom_write_check(&phdr, ofs, sizeof(phdr));
+#if AP_PARAM_STORAGE_MAP
+    storage_map_add(phdr, ofs);
+#endif
 
-    send_parameter(name, (enum ap_var_type)phdr.type, idx);
+    if (send_to_gcs) {
+        send_parameter(name, (enum ap_var_type)phdr.type, idx);
+    }
 }
 
 /*
@@ -1109,20 +1352,146 @@ void AP_Param::save(bool force_save)
     struct param_save p;
     p.param = this;
     p.force_save = force_save;
+    uint32_t stall_start_us = 0;
     while (!save_queue.push(p)) {
         // if we can't save to the queue
         if (hal.util->get_soft_armed()) {
             // if we are armed then don't sleep, instead we lose the
             // parameter save
+            WITH_SEMAPHORE(_save_batch_sem);
+            _save_stats.dropped++;
             return;
         }
         // when we are disarmed then loop waiting for a slot to become
         // available. This guarantees completion for large parameter
         // set loads
+        if (stall_start_us == 0) {
+            stall_start_us = AP_HAL::micros();
+        }
         hal.scheduler->expect_delay_ms(1);
         hal.scheduler->delay_microseconds(500);
         hal.scheduler->expect_delay_ms(0);
     }
+    const uint16_t queued = save_queue.available();
+
+    WITH_SEMAPHORE(_save_batch_sem);
+    if (stall_start_us != 0) {
+        _save_stats.stall_count++;
+        _save_stats.stall_us += AP_HAL::micros() - stall_start_us;
+    }
+    if (queued > _save_stats.queue_high_water) {
+        _save_stats.queue_high_water = queued;
+    }
+}
+
+/*
+  add variable to the current save batch
+*/
+void AP_Param::save_batched(bool force_save)
+{
+    if (!batch_add(this, force_save)) {
+        // the last batch has not been picked up by the IO thread
+        // yet. The queued save also sends the value to the GCS,
+        // which is a harmless repeat
+        save(force_save);
+    }
+}
+
+/*
+  add a save to the current batch. Returns false if there is no room
+  for it, in which case the caller uses the save queue
+ */
+bool AP_Param::batch_add(AP_Param *param, bool force_save)
+{
+    WITH_SEMAPHORE(_save_batch_sem);
+    if (_save_batch_committed) {
+        return false;
+    }
+    if (_save_batch == nullptr) {
+        _save_batch = new batch_save[AP_PARAM_SAVE_BATCH_MAX];
+        if (_save_batch == nullptr) {
+            return false;
+        }
+    }
+    if (_save_batch_count == 0) {
+        _save_batch_start_ms = AP_HAL::millis();
+    }
+    struct batch_save &b = _save_batch[_save_batch_count++];
+    b.param = param;
+    b.ofs = 0;
+    b.force_save = force_save;
+    if (_save_batch_count > _save_stats.batch_high_water) {
+        _save_stats.batch_high_water = _save_batch_count;
+    }
+    if (_save_batch_count == AP_PARAM_SAVE_BATCH_MAX) {
+        _save_batch_committed = true;
+    }
+    return true;
+}
+
+int AP_Param::batch_cmp_param(const void *a, const void *b)
+{
+    const struct batch_save *b1 = (const struct batch_save *)a;
+    const struct batch_save *b2 = (const struct batch_save *)b;
+    if (b1->param != b2->param) {
+        return b1->param < b2->param ? -1 : 1;
+    }
+    return 0;
+}
+
+int AP_Param::batch_cmp_ofs(const void *a, const void *b)
+{
+    const struct batch_save *b1 = (const struct batch_save *)a;
+    const struct batch_save *b2 = (const struct batch_save *)b;
+    return int(b1->ofs) - int(b2->ofs);
+}
+
+/*
+  merge saves of the same parameter, returning the new count and
+  adding the number of merged saves to coalesced. A merged save is
+  forced if any of the saves it replaces was
+ */
+uint16_t AP_Param::batch_coalesce(struct batch_save *batch, uint16_t count, uint32_t &coalesced)
+{
+    if (count < 2) {
+        return count;
+    }
+    qsort(batch, count, sizeof(batch_save), batch_cmp_param);
+    uint16_t n = 1;
+    for (uint16_t i=1; i<count; i++) {
+        if (batch[i].param == batch[n-1].param) {
+            batch[n-1].force_save |= batch[i].force_save;
+            coalesced++;
+            continue;
+        }
+        batch[n++] = batch[i];
+    }
+    return n;
+}
+
+/*
+  write a committed batch in storage order, so existing values are
+  updated in one pass and new values are appended after them
+ */
+void AP_Param::batch_write(struct batch_save *batch, uint16_t count)
+{
+    uint32_t coalesced = 0;
+    count = batch_coalesce(batch, count, coalesced);
+    if (coalesced != 0) {
+        WITH_SEMAPHORE(_save_batch_sem);
+        _save_stats.coalesced += coalesced;
+    }
+    for (uint16_t i=0; i<count; i++) {
+        if (!batch[i].param->storage_offset(batch[i].ofs)) {
+            batch[i].ofs = 0xFFFF;
+        }
+    }
+    // qsort isn't stable, but new values have no order to keep
+    qsort(batch, count, sizeof(batch_save), batch_cmp_ofs);
+    for (uint16_t i=0; i<count; i++) {
+        // the caller of save_batched() has already sent the value
+        batch[i].param->save_sync(batch[i].force_save, false);
+    }
 }
 
 /*
@@ -1134,6 +1503,54 @@ void AP_Param::save_io_handler(void)
     while (save_queue.pop(p)) {
         p.param->save_sync(p.force_save);
     }
+
+    struct batch_save *batch = nullptr;
+    uint16_t count = 0;
+    {
+        WITH_SEMAPHORE(_save_batch_sem);
+        if (_save_batch_count > 0 &&
+            AP_HAL::millis() - _save_batch_start_ms >= AP_PARAM_SAVE_BATCH_MS) {
+            _save_batch_committed = true;
+        }
+        if (_save_batch_committed) {
+            batch = _save_batch;
+            count = _save_batch_count;
+            _save_batch = nullptr;
+            _save_batch_count = 0;
+            _save_batch_committed = false;
+            // flush() waits for the write, not just the handover
+            _save_batch_writing = true;
+        }
+    }
+    if (batch != nullptr) {
+        batch_write(batch, count);
+        delete[] batch;
+        WITH_SEMAPHORE(_save_batch_sem);
+        _save_batch_writing = false;
+    }
+}
+
+/*
+  true if a batch has not been completely written. A batch that is
+  still being collected is handed to the IO thread as it is, so that
+  flush() covers it too
+ */
+bool AP_Param::batch_pending(void)
+{
+    WITH_SEMAPHORE(_save_batch_sem);
+    if (_save_batch_count > 0) {
+        _save_batch_committed = true;
+    }
+    return _save_batch_committed || _save_batch_writing;
+}
+
+/*
+  get a consistent copy of the save statistics
+ */
+void AP_Param::get_save_stats(struct save_stats &stats)
+{
+    WITH_SEMAPHORE(_save_batch_sem);
+    stats = _save_stats;
 }
 
 /*
@@ -1142,7 +1559,7 @@ void AP_Param::save_io_handler(void)
 void AP_Param::flush(void)
 {
     uint16_t counter = 200; // 2 seconds max
-    while (counter-- && save_queue.available()) {
+    while (counter-- && (save_queue.available() || batch_pending())) {
         hal.scheduler->expect_delay_ms(10);
         hal.scheduler->delay(10);
         hal.scheduler->expect_delay_ms(0);
@@ -1244,6 +1661,33 @@ bool AP_Param::configured_in_storage(void) const
     return scan(&phdr, &ofs) && (phdr.type == AP_PARAM_VECTOR3F || idx == 0);
 }
 
+/*
+  find the offset in storage of the variable. Returns false if it is
+  not in storage
+ */
+bool AP_Param::storage_offset(uint16_t &ofs) const
+{
+    uint32_t group_element = 0;
+    const struct GroupInfo *ginfo;
+    struct GroupNesting group_nesting {};
+    uint8_t idx;
+    const struct AP_Param::Info *info = find_var_info(&group_element, ginfo, group_nesting, &idx);
+    if (info == nullptr) {
+        return false;
+    }
+
+    struct Param_header phdr;
+    if (ginfo != nullptr) {
+        phdr.type = ginfo->type;
+    } else {
+        phdr.type = info->type;
+    }
+    set_key(phdr, info->key);
+    phdr.group_element = group_element;
+
+    return scan(&phdr, &ofs);
+}
+
 bool AP_Param::configured_in_defaults_file(bool &read_only) const
 {
     if (num_param_overrides == 0) {
@@ -1448,7 +1892,7 @@ void AP_Param::load_object_from_eeprom(const void *object_pointer, const struct
     uint16_t key;
 
     // reset cached param counter as we may be loading a dynamic var_info
-    _parameter_count = 0;
+    invalidate_count();
     
     if (!find_key_by_pointer(object_pointer, key)) {
         hal.console->printf("ERROR: Unable to find param pointer\n");
@@ -2250,9 +2694,217 @@ uint16_t AP_Param::count_parameters(void)
         }
         _parameter_count = ret;
     }
+#if AP_PARAM_LOOKUP_INDEX
+    if (_lookup_index == nullptr) {
+        build_lookup_index();
+    }
+#endif
     return ret;
 }
 
+/*
+  forget the cached parameter count and lookup index
+ */
+void AP_Param::invalidate_count(void)
+{
+    _parameter_count = 0;
+#if AP_PARAM_LOOKUP_INDEX
+    WITH_SEMAPHORE(_lookup_sem);
+    _lookup_generation++;
+    free_lookup_index(_lookup_index);
+    _lookup_index = nullptr;
+#endif
+}
+
+#if AP_PARAM_LOOKUP_INDEX
+/*
+  FNV-1a hash of a parameter name, optionally case insensitive
+ */
+uint32_t AP_Param::lookup_hash(const char *name, bool ignore_case)
+{
+    uint32_t hash = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i]; i++) {
+        uint8_t c = name[i];
+        if (ignore_case && c >= 'a' && c <= 'z') {
+            c -= 'a' - 'A';
+        }
+        hash ^= c;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/*
+  sort by hash, then by index so that equal names keep the order a
+  linear search would see them in
+ */
+int AP_Param::lookup_name_cmp(const void *a, const void *b)
+{
+    const lookup_name *n1 = (const lookup_name *)a;
+    const lookup_name *n2 = (const lookup_name *)b;
+    if (n1->hash != n2->hash) {
+        return n1->hash < n2->hash ? -1 : 1;
+    }
+    return int(n1->index) - int(n2->index);
+}
+
+/*
+  return the first entry in a sorted table with the given hash, or
+  nullptr if there is none
+ */
+const AP_Param::lookup_name *AP_Param::lookup_first(const lookup_name *table, uint16_t count, uint32_t hash)
+{
+    uint16_t lo = 0;
+    uint16_t hi = count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (table[mid].hash < hash) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == count || table[lo].hash != hash) {
+        return nullptr;
+    }
+    return &table[lo];
+}
+
+void AP_Param::free_lookup_index(lookup_index *index)
+{
+    if (index == nullptr) {
+        return;
+    }
+    delete[] index->entries;
+    delete[] index->names;
+    delete[] index->objects;
+    delete[] index->scalars;
+    delete index;
+}
+
+/*
+  build the lookup index. The tree walk is done without holding the
+  lookup semaphore, and the result is discarded if the tree was
+  invalidated while we were walking it
+ */
+void AP_Param::build_lookup_index(void)
+{
+    uint16_t generation;
+    {
+        WITH_SEMAPHORE(_lookup_sem);
+        generation = _lookup_generation;
+    }
+
+    ParamToken token;
+    enum ap_var_type type;
+    AP_Param *ap;
+    uint16_t num_entries = 0;
+    uint16_t num_scalars = 0;
+    for (ap = first(&token, &type); ap != nullptr; ap = next(&token, &type)) {
+        num_entries++;
+    }
+    for (ap = first(&token, &type); ap != nullptr; ap = next_scalar(&token, &type)) {
+        num_scalars++;
+    }
+
+    lookup_index *index = new lookup_index {};
+    if (index == nullptr) {
+        return;
+    }
+    index->entries = new lookup_entry[num_entries];
+    index->names = new lookup_name[num_entries];
+    index->objects = new lookup_name[_num_vars];
+    index->scalars = new lookup_scalar[num_scalars];
+    if (index->entries == nullptr || index->names == nullptr ||
+        index->objects == nullptr || index->scalars == nullptr) {
+        // not enough memory, lookups stay on the slow path
+        free_lookup_index(index);
+        return;
+    }
+
+    uint16_t n = 0;
+    for (ap = first(&token, &type); ap != nullptr && n < num_entries; ap = next(&token, &type), n++) {
+        lookup_entry &e = index->entries[n];
+        e.ap = ap;
+        e.type = type;
+        ap->copy_name_token(token, e.name, sizeof(e.name), type != AP_PARAM_VECTOR3F);
+        e.name[AP_MAX_NAME_SIZE] = 0;
+
+        uint32_t group_element;
+        const struct GroupInfo *ginfo;
+        struct GroupNesting group_nesting {};
+        uint8_t idx;
+        const struct Info *info = ap->find_var_info_token(token, &group_element, ginfo, group_nesting, &idx);
+        e.in_group = (ginfo != nullptr);
+        e.flags = e.in_group ? ginfo->flags : 0;
+
+        if (info == nullptr || (!e.in_group && token.idx != 0)) {
+            // find() can't see elements of top level vectors
+            continue;
+        }
+        lookup_name &ln = index->names[index->num_names++];
+        ln.hash = lookup_hash(e.name, false);
+        ln.index = n;
+    }
+    index->num_entries = n;
+
+    n = 0;
+    for (ap = first(&token, &type); ap != nullptr && n < num_scalars; ap = next_scalar(&token, &type), n++) {
+        lookup_scalar &sc = index->scalars[n];
+        sc.ap = ap;
+        sc.token = token;
+        sc.type = type;
+    }
+    index->num_scalars = n;
+
+    for (uint16_t i=0; i<_num_vars; i++) {
+        index->objects[i].hash = lookup_hash(_var_info[i].name, true);
+        index->objects[i].index = i;
+    }
+
+    qsort(index->names, index->num_names, sizeof(lookup_name), lookup_name_cmp);
+    qsort(index->objects, _num_vars, sizeof(lookup_name), lookup_name_cmp);
+
+    WITH_SEMAPHORE(_lookup_sem);
+    if (generation != _lookup_generation || _lookup_index != nullptr) {
+        // tree changed under us, or another thread beat us to it
+        free_lookup_index(index);
+        return;
+    }
+    _lookup_index = index;
+}
+
+/*
+  find a variable by exact name using the lookup index. Returns
+  nullptr if the index is not built or the name is not in it
+ */
+AP_Param *AP_Param::find_indexed(const char *name, enum ap_var_type *ptype, uint16_t *flags)
+{
+    WITH_SEMAPHORE(_lookup_sem);
+    if (_lookup_index == nullptr) {
+        return nullptr;
+    }
+    const uint32_t hash = lookup_hash(name, false);
+    const lookup_name *n = lookup_first(_lookup_index->names, _lookup_index->num_names, hash);
+    if (n == nullptr) {
+        return nullptr;
+    }
+    const lookup_name *end = &_lookup_index->names[_lookup_index->num_names];
+    for (; n < end && n->hash == hash; n++) {
+        const lookup_entry &e = _lookup_index->entries[n->index];
+        if (strncmp(name, e.name, AP_MAX_NAME_SIZE) != 0) {
+            continue;
+        }
+        *ptype = (enum ap_var_type)e.type;
+        if (flags != nullptr && e.in_group) {
+            *flags = e.flags;
+        }
+        return e.ap;
+    }
+    return nullptr;
+}
+#endif // AP_PARAM_LOOKUP_INDEX
+
 /*
   set a default value by name
  */
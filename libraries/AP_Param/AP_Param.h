@@ -42,6 +42,35 @@
 #define AP_PARAM_MAX_EMBEDDED_PARAM 8192
 #endif
 
+/*
+  enable a RAM lookup index for find(), find_by_index() and
+  find_object(). This costs roughly 40 bytes per parameter so is only
+  enabled by default on boards with plenty of memory
+ */
+#ifndef AP_PARAM_LOOKUP_INDEX
+#define AP_PARAM_LOOKUP_INDEX (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+/*
+  keep a RAM map from Param_header to storage offset so scan() does
+  not need to walk storage. This costs 8 bytes per stored parameter
+ */
+#ifndef AP_PARAM_STORAGE_MAP
+#define AP_PARAM_STORAGE_MAP (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+/*
+  limits on a save_batched() batch. The age is measured from the
+  first save in the batch, so a steady stream of saves can't hold the
+  batch back
+ */
+#ifndef AP_PARAM_SAVE_BATCH_MS
+#define AP_PARAM_SAVE_BATCH_MS 200
+#endif
+#ifndef AP_PARAM_SAVE_BATCH_MAX
+#define AP_PARAM_SAVE_BATCH_MAX 64
+#endif
+
 /*
   flags for variables in var_info and group tables
  */
@@ -318,10 +347,11 @@ public:
     /// Save the current value of the variable to storage, synchronous API
     ///
     /// @param  force_save     If true then force save even if default
+    /// @param  send_to_gcs    If true then send the saved value to the GCS
     ///
     /// @return                True if the variable was saved successfully.
     ///
-    void save_sync(bool force_save=false);
+    void save_sync(bool force_save=false, bool send_to_gcs=true);
 
     /// flush all pending parameter saves
     /// used on reboot
@@ -333,6 +363,30 @@ public:
     ///
     void save(bool force_save=false);
 
+    /// Save the current value of the variable to storage as part of a
+    /// batch, for callers such as a GCS uploading a parameter file
+    /// that save many parameters in a short time. Repeated saves of
+    /// the same parameter are coalesced and the batch is written in
+    /// storage order by the IO thread once its first save is
+    /// AP_PARAM_SAVE_BATCH_MS old or it holds AP_PARAM_SAVE_BATCH_MAX
+    /// saves. Unlike save(), nothing is sent to the GCS when the batch
+    /// is written, so the caller must send the new value itself.
+    ///
+    /// @param  force_save     If true then force save even if default
+    ///
+    void save_batched(bool force_save=false);
+
+    // statistics on the background save path
+    struct save_stats {
+        uint32_t stall_us;          // total time save() spent waiting for queue space
+        uint32_t stall_count;       // number of save() calls that had to wait
+        uint32_t dropped;           // saves lost as the queue was full while armed
+        uint32_t coalesced;         // batched saves merged with an earlier save
+        uint16_t queue_high_water;  // most entries seen in the save queue
+        uint16_t batch_high_water;  // most entries seen in a save batch
+    };
+    static void get_save_stats(struct save_stats &stats);
+
     /// Load the variable from EEPROM.
     ///
     /// @return                True if the variable was loaded successfully.
@@ -440,11 +494,19 @@ public:
     // count of parameters in tree
     static uint16_t count_parameters(void);
 
-    static void set_hide_disabled_groups(bool value) { _hide_disabled_groups = value; }
+    // forget the cached parameter count and lookup index. Needed
+    // whenever the set of visible parameters may have changed
+    static void invalidate_count(void);
+
+    static void set_hide_disabled_groups(bool value) {
+        _hide_disabled_groups = value;
+        invalidate_count();
+    }
 
     // set frame type flags. Used to unhide frame specific parameters
     static void set_frame_type_flags(uint16_t flags_to_set) {
         _frame_type_flags |= flags_to_set;
+        invalidate_count();
     }
 
     // check if a given frame type should be included
@@ -656,9 +718,103 @@ private:
     };
     static ObjectBuffer<struct param_save> save_queue;
     static bool registered_save_handler;
+    static struct save_stats _save_stats;
 
     // background function for saving parameters
     void save_io_handler(void);
+
+    // support for batched saves. Saves from save_batched() are
+    // collected in _save_batch and written by the IO thread once
+    // committed. _save_batch_sem also protects _save_stats
+    struct batch_save {
+        AP_Param *param;
+        uint16_t ofs;   // storage offset, filled in when written
+        bool force_save;
+    };
+    static struct batch_save *_save_batch;
+    static uint16_t _save_batch_count;
+    static uint32_t _save_batch_start_ms;
+    static bool _save_batch_committed;
+    static bool _save_batch_writing;
+    static HAL_Semaphore _save_batch_sem;
+
+    static bool batch_add(AP_Param *param, bool force_save);
+    static bool batch_pending(void);
+    static uint16_t batch_coalesce(struct batch_save *batch, uint16_t count, uint32_t &coalesced);
+    static void batch_write(struct batch_save *batch, uint16_t count);
+    static int batch_cmp_param(const void *a, const void *b);
+    static int batch_cmp_ofs(const void *a, const void *b);
+    bool storage_offset(uint16_t &ofs) const;
+
+#if AP_PARAM_STORAGE_MAP
+    /*
+      map of stored Param_header values to their offset in storage,
+      sorted by header. It is built on the first scan() and kept in
+      step as variables are added to storage. If we run out of memory
+      the map is dropped and scan() walks storage as before
+     */
+    struct storage_map_entry {
+        uint32_t header;
+        uint16_t ofs;
+    };
+    static storage_map_entry *_storage_map;
+    static uint16_t _storage_map_count;
+    static uint16_t _storage_map_size;
+    static bool _storage_map_failed;
+    static HAL_Semaphore _storage_map_sem;
+
+    static uint32_t storage_map_header(const Param_header &phdr);
+    static int storage_map_cmp(const void *a, const void *b);
+    static bool storage_map_build(void);
+    static void storage_map_free(void);
+    static bool storage_map_find(const Param_header &phdr, uint16_t &ofs);
+    static void storage_map_add(const Param_header &phdr, uint16_t ofs);
+#endif // AP_PARAM_STORAGE_MAP
+
+#if AP_PARAM_LOOKUP_INDEX
+    /*
+      lookup index built lazily by count_parameters() on the IO
+      thread. It caches the results of walking the var_info tree so
+      that lookups by name or index don't need to. Names not in the
+      index fall back to the tree walk, so the index only needs to
+      cover the exact-case names seen by next()
+     */
+    struct lookup_name {
+        uint32_t hash;
+        uint16_t index;     // index into entries[] or _var_info[]
+    };
+    struct lookup_entry {
+        AP_Param *ap;
+        uint16_t flags;     // group flags, valid if in_group is set
+        uint8_t type;       // ap_var_type as returned by next()
+        bool in_group;
+        char name[AP_MAX_NAME_SIZE+1];
+    };
+    struct lookup_scalar {
+        AP_Param *ap;
+        ParamToken token;   // token as returned by next_scalar()
+        uint8_t type;
+    };
+    struct lookup_index {
+        uint16_t num_entries;
+        uint16_t num_names;
+        uint16_t num_scalars;
+        lookup_entry *entries;  // variables in next() order
+        lookup_name *names;     // hashes of entries[] names, sorted
+        lookup_name *objects;   // hashes of _var_info[] names, sorted
+        lookup_scalar *scalars; // variables in next_scalar() order
+    };
+    static lookup_index *_lookup_index;
+    static uint16_t _lookup_generation;
+    static HAL_Semaphore _lookup_sem;
+
+    static void build_lookup_index(void);
+    static void free_lookup_index(lookup_index *index);
+    static uint32_t lookup_hash(const char *name, bool ignore_case);
+    static int lookup_name_cmp(const void *a, const void *b);
+    static const lookup_name *lookup_first(const lookup_name *table, uint16_t count, uint32_t hash);
+    static AP_Param *find_indexed(const char *name, enum ap_var_type *ptype, uint16_t *flags);
+#endif // AP_PARAM_LOOKUP_INDEX
 };
 
 /// Template class for scalar variables.
@@ -0,0 +1,123 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  a synthetic parameter tree of 16 objects with 48 parameters each,
+  similar in size to a vehicle parameter table
+ */
+class BenchGroup {
+public:
+    BenchGroup() {
+        AP_Param::setup_object_defaults(this, var_info);
+    }
+    static const struct AP_Param::GroupInfo var_info[];
+
+    AP_Float f[40];
+    AP_Int16 i[7];
+    AP_Vector3f v;
+};
+
+#define BENCH_FLOAT(n) AP_GROUPINFO("F" #n, n, BenchGroup, f[n], 0)
+#define BENCH_INT(n)   AP_GROUPINFO("I" #n, 40+n, BenchGroup, i[n], 0)
+
+const AP_Param::GroupInfo BenchGroup::var_info[] = {
+    BENCH_FLOAT(0),  BENCH_FLOAT(1),  BENCH_FLOAT(2),  BENCH_FLOAT(3),
+    BENCH_FLOAT(4),  BENCH_FLOAT(5),  BENCH_FLOAT(6),  BENCH_FLOAT(7),
+    BENCH_FLOAT(8),  BENCH_FLOAT(9),  BENCH_FLOAT(10), BENCH_FLOAT(11),
+    BENCH_FLOAT(12), BENCH_FLOAT(13), BENCH_FLOAT(14), BENCH_FLOAT(15),
+    BENCH_FLOAT(16), BENCH_FLOAT(17), BENCH_FLOAT(18), BENCH_FLOAT(19),
+    BENCH_FLOAT(20), BENCH_FLOAT(21), BENCH_FLOAT(22), BENCH_FLOAT(23),
+    BENCH_FLOAT(24), BENCH_FLOAT(25), BENCH_FLOAT(26), BENCH_FLOAT(27),
+    BENCH_FLOAT(28), BENCH_FLOAT(29), BENCH_FLOAT(30), BENCH_FLOAT(31),
+    BENCH_FLOAT(32), BENCH_FLOAT(33), BENCH_FLOAT(34), BENCH_FLOAT(35),
+    BENCH_FLOAT(36), BENCH_FLOAT(37), BENCH_FLOAT(38), BENCH_FLOAT(39),
+    BENCH_INT(0), BENCH_INT(1), BENCH_INT(2), BENCH_INT(3),
+    BENCH_INT(4), BENCH_INT(5), BENCH_INT(6),
+    AP_GROUPINFO("VEC", 47, BenchGroup, v, 0),
+    AP_GROUPEND
+};
+
+static AP_Int8 format_version;
+static BenchGroup objects[16];
+
+#define BENCH_OBJECT(n, name) { AP_PARAM_GROUP, name, n+1, (const void *)&objects[n], {group_info : BenchGroup::var_info} }
+
+static const AP_Param::Info var_info[] = {
+    { format_version.vtype, "FORMAT_VERSION", 0, &format_version, {def_value : 0} },
+    BENCH_OBJECT(0, "AA_"),  BENCH_OBJECT(1, "AB_"),  BENCH_OBJECT(2, "AC_"),  BENCH_OBJECT(3, "AD_"),
+    BENCH_OBJECT(4, "AE_"),  BENCH_OBJECT(5, "AF_"),  BENCH_OBJECT(6, "AG_"),  BENCH_OBJECT(7, "AH_"),
+    BENCH_OBJECT(8, "AI_"),  BENCH_OBJECT(9, "AJ_"),  BENCH_OBJECT(10, "AK_"), BENCH_OBJECT(11, "AL_"),
+    BENCH_OBJECT(12, "AM_"), BENCH_OBJECT(13, "AN_"), BENCH_OBJECT(14, "AO_"), BENCH_OBJECT(15, "AP_"),
+    AP_VAREND
+};
+
+static AP_Param param_loader{var_info};
+
+// names spread over the whole tree, so the linear walk is exercised
+static const char *lookup_names[] = {
+    "FORMAT_VERSION", "AA_F0", "AD_I3", "AH_F20", "AK_VEC_Y", "AP_F39", "AP_I6",
+};
+
+static void BM_ParamFindLinear(benchmark::State& state)
+{
+    AP_Param::invalidate_count();
+    uint8_t n = 0;
+    while (state.KeepRunning()) {
+        enum ap_var_type ptype;
+        AP_Param *ap = AP_Param::find(lookup_names[n], &ptype);
+        gbenchmark_escape(ap);
+        n = (n + 1) % ARRAY_SIZE(lookup_names);
+    }
+}
+
+static void BM_ParamFindIndexed(benchmark::State& state)
+{
+    AP_Param::count_parameters();
+    uint8_t n = 0;
+    while (state.KeepRunning()) {
+        enum ap_var_type ptype;
+        AP_Param *ap = AP_Param::find(lookup_names[n], &ptype);
+        gbenchmark_escape(ap);
+        n = (n + 1) % ARRAY_SIZE(lookup_names);
+    }
+}
+
+static void BM_ParamFindByIndexLinear(benchmark::State& state)
+{
+    AP_Param::invalidate_count();
+    const uint16_t count = AP_Param::count_parameters();
+    AP_Param::invalidate_count();
+    uint16_t idx = 0;
+    while (state.KeepRunning()) {
+        enum ap_var_type ptype;
+        AP_Param::ParamToken token;
+        AP_Param *ap = AP_Param::find_by_index(idx, &ptype, &token);
+        gbenchmark_escape(ap);
+        idx = (idx + 97) % count;
+    }
+}
+
+static void BM_ParamFindByIndexIndexed(benchmark::State& state)
+{
+    const uint16_t count = AP_Param::count_parameters();
+    uint16_t idx = 0;
+    while (state.KeepRunning()) {
+        enum ap_var_type ptype;
+        AP_Param::ParamToken token;
+        AP_Param *ap = AP_Param::find_by_index(idx, &ptype, &token);
+        gbenchmark_escape(ap);
+        idx = (idx + 97) % count;
+    }
+}
+
+BENCHMARK(BM_ParamFindLinear);
+BENCHMARK(BM_ParamFindIndexed);
+BENCHMARK(BM_ParamFindByIndexLinear);
+BENCHMARK(BM_ParamFindByIndexIndexed);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,126 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#include <AP_HAL_SITL/Storage.h>
+
+/*
+  a parameter tree of 8 objects with 32 floats each
+ */
+class StorageTestGroup {
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+    AP_Float f[32];
+};
+
+#define TEST_FLOAT(n) AP_GROUPINFO("F" #n, n, StorageTestGroup, f[n], 0)
+
+const AP_Param::GroupInfo StorageTestGroup::var_info[] = {
+    TEST_FLOAT(0),  TEST_FLOAT(1),  TEST_FLOAT(2),  TEST_FLOAT(3),
+    TEST_FLOAT(4),  TEST_FLOAT(5),  TEST_FLOAT(6),  TEST_FLOAT(7),
+    TEST_FLOAT(8),  TEST_FLOAT(9),  TEST_FLOAT(10), TEST_FLOAT(11),
+    TEST_FLOAT(12), TEST_FLOAT(13), TEST_FLOAT(14), TEST_FLOAT(15),
+    TEST_FLOAT(16), TEST_FLOAT(17), TEST_FLOAT(18), TEST_FLOAT(19),
+    TEST_FLOAT(20), TEST_FLOAT(21), TEST_FLOAT(22), TEST_FLOAT(23),
+    TEST_FLOAT(24), TEST_FLOAT(25), TEST_FLOAT(26), TEST_FLOAT(27),
+    TEST_FLOAT(28), TEST_FLOAT(29), TEST_FLOAT(30), TEST_FLOAT(31),
+    AP_GROUPEND
+};
+
+static const uint8_t num_objects = 8;
+static const uint16_t num_params = num_objects * 32;
+
+static AP_Int8 format_version;
+static StorageTestGroup objects[num_objects];
+
+#define TEST_OBJECT(n, name) { AP_PARAM_GROUP, name, n+1, (const void *)&objects[n], {group_info : StorageTestGroup::var_info} }
+
+static const AP_Param::Info var_info[] = {
+    { format_version.vtype, "FORMAT_VERSION", 0, &format_version, {def_value : 0} },
+    TEST_OBJECT(0, "TA_"), TEST_OBJECT(1, "TB_"), TEST_OBJECT(2, "TC_"), TEST_OBJECT(3, "TD_"),
+    TEST_OBJECT(4, "TE_"), TEST_OBJECT(5, "TF_"), TEST_OBJECT(6, "TG_"), TEST_OBJECT(7, "TH_"),
+    AP_VAREND
+};
+
+static AP_Param param_loader{var_info};
+static GCS_Dummy _gcs;
+
+static uint32_t storage_reads(void)
+{
+    return static_cast<HALSITL::Storage *>(hal.storage)->get_read_count();
+}
+
+static float test_value(uint8_t obj, uint8_t i)
+{
+    return obj * 100 + i + 0.5f;
+}
+
+/*
+  saving and loading a full parameter set should take a bounded number
+  of storage reads per parameter, not a walk of storage per parameter
+ */
+TEST(AP_Param, StorageReadCount)
+{
+    AP_Param::setup();
+    AP_Param::erase_all();
+
+    for (uint8_t o=0; o<num_objects; o++) {
+        for (uint8_t i=0; i<32; i++) {
+            objects[o].f[i].set(test_value(o, i));
+        }
+    }
+
+    uint32_t reads = storage_reads();
+    for (uint8_t o=0; o<num_objects; o++) {
+        for (uint8_t i=0; i<32; i++) {
+            objects[o].f[i].save_sync(true);
+        }
+    }
+    const uint32_t save_reads = storage_reads() - reads;
+
+    for (uint8_t o=0; o<num_objects; o++) {
+        for (uint8_t i=0; i<32; i++) {
+            objects[o].f[i].set(0);
+        }
+    }
+
+    reads = storage_reads();
+    for (uint8_t o=0; o<num_objects; o++) {
+        for (uint8_t i=0; i<32; i++) {
+            EXPECT_TRUE(objects[o].f[i].load());
+        }
+    }
+    const uint32_t load_reads = storage_reads() - reads;
+
+    for (uint8_t o=0; o<num_objects; o++) {
+        for (uint8_t i=0; i<32; i++) {
+            EXPECT_FLOAT_EQ(test_value(o, i), objects[o].f[i].get());
+        }
+    }
+
+#if AP_PARAM_STORAGE_MAP
+    // one read of the value per load, plus building the map once
+    EXPECT_LE(save_reads, 4U);
+    EXPECT_LE(load_reads, unsigned(num_params));
+#endif
+
+    // overwriting an existing value must be seen by the next load
+    objects[2].f[7].set(42);
+    objects[2].f[7].save_sync(true);
+    objects[2].f[7].set(0);
+    EXPECT_TRUE(objects[2].f[7].load());
+    EXPECT_FLOAT_EQ(42, objects[2].f[7].get());
+
+    // and erasing storage must empty the map
+    AP_Param::erase_all();
+    EXPECT_FALSE(objects[2].f[7].load());
+}
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_SITL
+
+AP_GTEST_MAIN()
@@ -65,6 +65,13 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
 
     AP_GROUPINFO("DEBUG_LVL", 4, AP_Scripting, _debug_level, 1),
 
+    // @Param: OPTIONS
+    // @DisplayName: Scripting Options
+    // @Description: Options for scripting. Compiled scripts are normally cached in the scripts directory as .luac files and reloaded while the script is unchanged. Script statistics (runs, run time and memory allocated) are logged once a second, and can also be sent to the GCS
+    // @Bitmask: 0:Disable bytecode cache,1:Send script statistics to GCS
+    // @User: Advanced
+    AP_GROUPINFO("OPTIONS", 5, AP_Scripting, _options, 0),
+
     AP_GROUPEND
 };
 
@@ -93,7 +100,7 @@ void AP_Scripting::init(void) {
 }
 
 void AP_Scripting::thread(void) {
-    lua_scripts *lua = new lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_level);
+    lua_scripts *lua = new lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_level, _options);
     if (lua == nullptr || !lua->heap_allocated()) {
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Unable to allocate scripting memory");
         _init_failed = true;
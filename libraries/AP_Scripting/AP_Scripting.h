@@ -46,6 +46,7 @@ private:
     AP_Int32 _script_vm_exec_count;
     AP_Int32 _script_heap_size;
     AP_Int8 _debug_level;
+    AP_Int16 _options;
 
     bool _init_failed;  // true if memory allocation failed
 
@@ -0,0 +1,47 @@
+--[[
+Benchmark of vector and location maths written with the operators, which
+allocate a new userdata for every result. Run it alongside
+benchmark_vector_inplace.lua, which does the same sums without allocating.
+
+Set bit 1 of SCR_OPTIONS to have the run time, bytes allocated and garbage
+collection time of each script sent to the GCS once a second. The same
+numbers are logged in the SCR message.
+--]]
+
+local iterations = 100 -- per update, keep below the SCR_VM_I_COUNT budget
+
+local pos = Vector3f()
+local vel = Vector3f()
+local accel = Vector3f()
+accel:x(0.1)
+accel:y(-0.2)
+accel:z(0.05)
+local drag = Vector3f()
+
+local origin = Location()
+origin:lat(-353632620)
+origin:lng(1491652370)
+
+local count = 0
+
+function update()
+  for i = 1, iterations do
+    drag = vel - accel
+    vel = vel + accel
+    vel = vel - drag
+    pos = pos + vel
+
+    local loc = Location()
+    loc:lat(origin:lat())
+    loc:lng(origin:lng())
+    loc:offset(pos:x(), pos:y())
+  end
+
+  count = count + 1
+  if count % 100 == 0 then
+    gcs:send_text(6, string.format("alloc: %d updates pos %.1f %.1f %.1f", count, pos:x(), pos:y(), pos:z()))
+  end
+  return update, 10
+end
+
+return update()
@@ -0,0 +1,59 @@
+--[[
+Heap soak test. Keeps a set of strings, tables and vectors of mixed sizes
+alive for random lengths of time, replacing a few of them on every update,
+so the scripting heap sees the sort of churn a long running script causes.
+
+Set bit 1 of SCR_OPTIONS to have the heap usage, largest free block,
+fragmentation and allocation rate sent to the GCS once a second. The same
+numbers are logged in the SCRH message.
+--]]
+
+local slots = 100        -- objects kept alive at once
+local churn = 10         -- objects replaced per update
+local report_updates = 6000 -- about once a minute
+
+local live = {}
+local updates = 0
+
+local function new_object()
+  local r = math.random(100)
+  if r <= 40 then
+    -- short string, made unique so lua doesn't share it
+    return string.rep("s", math.random(1, 32)) .. updates .. r
+  elseif r <= 60 then
+    -- table with an array part
+    local t = {}
+    for i = 1, math.random(1, 16) do
+      t[i] = i
+    end
+    return t
+  elseif r <= 75 then
+    -- table with a hash part
+    local t = {}
+    for i = 1, math.random(1, 8) do
+      t["k" .. i] = i
+    end
+    return t
+  elseif r <= 90 then
+    local v = Vector3f()
+    v:x(r)
+    return v
+  else
+    -- large string
+    return string.rep("l", math.random(100, 1200))
+  end
+end
+
+function update()
+  for i = 1, churn do
+    live[math.random(slots)] = new_object()
+  end
+
+  updates = updates + 1
+  if updates % report_updates == 0 then
+    gcs:send_text(6, string.format("heap soak: %d updates", updates))
+  end
+  return update, 10
+end
+
+return update()
@@ -13,6 +13,7 @@ char keyword_depends[]   = "depends";
 char keyword_enum[]      = "enum";
 char keyword_field[]     = "field";
 char keyword_include[]   = "include";
+char keyword_inplace[]   = "inplace";
 char keyword_method[]    = "method";
 char keyword_operator[]  = "operator";
 char keyword_read[]      = "read";
@@ -280,6 +281,7 @@ struct method {
   struct type return_type;
   struct argument * arguments;
   uint32_t flags; // filled out with TYPE_FLAGS
+  char *assignment; // assignment operator applied by an inplace method, NULL for normal methods
 };
 
 struct userdata_field {
@@ -663,6 +665,64 @@ void handle_operator(struct userdata *data) {
   }
 }
 
+void handle_inplace(struct userdata *data) {
+  trace(TRACE_USERDATA, "Adding an inplace method");
+
+  char * name = next_token();
+  if (name == NULL) {
+    error(ERROR_USERDATA, "Missing inplace method name for %s", data->name);
+  }
+
+  struct method * method = data->methods;
+  while (method != NULL && strcmp(method->name, name)) {
+    method = method-> next;
+  }
+  if (method != NULL) {
+    error(ERROR_USERDATA, "Method %s already exsists for %s (declared on %d)", name, data->name, method->line);
+  }
+
+  char *operator = next_token();
+  if (operator == NULL) {
+    error(ERROR_USERDATA, "Needed a symbol for the inplace method %s", name);
+  }
+
+  char *assignment;
+  if (strcmp(operator, "+") == 0) {
+    assignment = "+=";
+  } else if (strcmp(operator, "-") == 0) {
+    assignment = "-=";
+  } else if (strcmp(operator, "*") == 0) {
+    assignment = "*=";
+  } else if (strcmp(operator, "/") == 0) {
+    assignment = "/=";
+  } else if (strcmp(operator, "=") == 0) {
+    assignment = "=";
+  } else {
+    error(ERROR_USERDATA, "Unknown inplace operation type: %s", operator);
+  }
+
+  trace(TRACE_USERDATA, "Adding inplace method %s", name);
+  method = allocate(sizeof(struct method));
+  method->next = data->methods;
+  data->methods = method;
+  string_copy(&(method->name), name);
+  string_copy(&(method->assignment), assignment);
+  method->line = state.line_num;
+
+  // the modified object is returned, so that calls can be chained
+  method->return_type.type = TYPE_USERDATA;
+  string_copy(&(method->return_type.data.userdata_name), data->name);
+
+  struct argument * arg = allocate(sizeof(struct argument));
+  parse_type(&(arg->type), TYPE_RESTRICTION_NOT_NULLABLE, RANGE_CHECK_MANDATORY);
+  if ((arg->type.type == TYPE_NONE) || (arg->type.type == TYPE_LITERAL)) {
+    error(ERROR_USERDATA, "Inplace method %s needs an argument", name);
+  }
+  arg->line_num = state.line_num;
+  arg->token_num = state.token_num;
+  method->arguments = arg;
+}
+
 void handle_userdata(void) {
   trace(TRACE_USERDATA, "Adding a userdata");
 
@@ -700,6 +760,8 @@ void handle_userdata(void) {
     handle_operator(node);
   } else if (strcmp(type, keyword_method) == 0) {
     handle_method(node->name, &(node->methods));
+  } else if (strcmp(type, keyword_inplace) == 0) {
+    handle_inplace(node);
   } else if (strcmp(type, keyword_enum) == 0) {
     handle_userdata_enum(node);
   } else {
@@ -1378,6 +1440,20 @@ void emit_userdata_method(const struct userdata *data, const struct method *meth
   fprintf(source, "}\n\n");
 }
 
+// inplace methods modify the userdata they are called on, rather than
+// allocating a new userdata for the result
+void emit_userdata_inplace_method(const struct userdata *data, const struct method *method) {
+  fprintf(source, "static int %s_%s(lua_State *L) {\n", data->name, method->name);
+  fprintf(source, "    binding_argcheck(L, 2);\n");
+  fprintf(source, "    %s * ud = check_%s(L, 1);\n", data->name, data->name);
+  emit_checker(method->arguments->type, 2, 0, "    ", "argument");
+  fprintf(source, "    *ud %s data_2;\n", method->assignment);
+  // return the userdata we were called on
+  fprintf(source, "    lua_settop(L, 1);\n");
+  fprintf(source, "    return 1;\n");
+  fprintf(source, "}\n\n");
+}
+
 const char * get_name_for_operation(enum operator_type op) {
   switch (op) {
     case OP_ADD:
@@ -1446,7 +1522,11 @@ void emit_userdata_methods(struct userdata *node) {
     // methods
     struct method *method = node->methods;
     while(method) {
-      emit_userdata_method(node, method);
+      if (method->assignment != NULL) {
+        emit_userdata_inplace_method(node, method);
+      } else {
+        emit_userdata_method(node, method);
+      }
       method = method->next;
     }
 
@@ -268,6 +268,44 @@ static int Location_lat(lua_State *L) {
     }
 }
 
+static int Vector2f_scale(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector2f * ud = check_Vector2f(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(-FLT_MAX, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    *ud *= data_2;
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int Vector2f_sub(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector2f * ud = check_Vector2f(L, 1);
+    Vector2f & data_2 = *check_Vector2f(L, 2);
+    *ud -= data_2;
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int Vector2f_add(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector2f * ud = check_Vector2f(L, 1);
+    Vector2f & data_2 = *check_Vector2f(L, 2);
+    *ud += data_2;
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int Vector2f_copy(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector2f * ud = check_Vector2f(L, 1);
+    Vector2f & data_2 = *check_Vector2f(L, 2);
+    *ud = data_2;
+    lua_settop(L, 1);
+    return 1;
+}
+
 static int Vector2f_is_zero(lua_State *L) {
     binding_argcheck(L, 1);
     Vector2f * ud = check_Vector2f(L, 1);
@@ -330,6 +368,44 @@ static int Vector2f___sub(lua_State *L) {
     return 1;
 }
 
+static int Vector3f_scale(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector3f * ud = check_Vector3f(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(-FLT_MAX, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    *ud *= data_2;
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int Vector3f_sub(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector3f * ud = check_Vector3f(L, 1);
+    Vector3f & data_2 = *check_Vector3f(L, 2);
+    *ud -= data_2;
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int Vector3f_add(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector3f * ud = check_Vector3f(L, 1);
+    Vector3f & data_2 = *check_Vector3f(L, 2);
+    *ud += data_2;
+    lua_settop(L, 1);
+    return 1;
+}
+
+static int Vector3f_copy(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector3f * ud = check_Vector3f(L, 1);
+    Vector3f & data_2 = *check_Vector3f(L, 2);
+    *ud = data_2;
+    lua_settop(L, 1);
+    return 1;
+}
+
 static int Vector3f_is_zero(lua_State *L) {
     binding_argcheck(L, 1);
     Vector3f * ud = check_Vector3f(L, 1);
@@ -392,6 +468,15 @@ static int Vector3f___sub(lua_State *L) {
     return 1;
 }
 
+static int Location_copy(lua_State *L) {
+    binding_argcheck(L, 2);
+    Location * ud = check_Location(L, 1);
+    Location & data_2 = *check_Location(L, 2);
+    *ud = data_2;
+    lua_settop(L, 1);
+    return 1;
+}
+
 static int Location_get_distance_NE(lua_State *L) {
     binding_argcheck(L, 2);
     Location * ud = check_Location(L, 1);
@@ -473,6 +558,10 @@ static int Location_get_distance(lua_State *L) {
 const luaL_Reg Vector2f_meta[] = {
     {"y", Vector2f_y},
     {"x", Vector2f_x},
+    {"scale", Vector2f_scale},
+    {"sub", Vector2f_sub},
+    {"add", Vector2f_add},
+    {"copy", Vector2f_copy},
     {"is_zero", Vector2f_is_zero},
     {"is_inf", Vector2f_is_inf},
     {"is_nan", Vector2f_is_nan},
@@ -487,6 +576,10 @@ const luaL_Reg Vector3f_meta[] = {
     {"z", Vector3f_z},
     {"y", Vector3f_y},
     {"x", Vector3f_x},
+    {"scale", Vector3f_scale},
+    {"sub", Vector3f_sub},
+    {"add", Vector3f_add},
+    {"copy", Vector3f_copy},
     {"is_zero", Vector3f_is_zero},
     {"is_inf", Vector3f_is_inf},
     {"is_nan", Vector3f_is_nan},
@@ -504,6 +597,7 @@ const luaL_Reg Location_meta[] = {
     {"relative_alt", Location_relative_alt},
     {"lng", Location_lng},
     {"lat", Location_lat},
+    {"copy", Location_copy},
     {"get_distance_NE", Location_get_distance_NE},
     {"get_distance_NED", Location_get_distance_NED},
     {"get_bearing", Location_get_bearing},
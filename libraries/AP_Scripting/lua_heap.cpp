@@ -0,0 +1,296 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lua_heap.h"
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+#include <string.h>
+
+extern const AP_HAL::HAL& hal;
+
+// index of the highest and lowest set bits, x must not be zero
+static inline uint8_t fls32(uint32_t x) { return 31 - __builtin_clz(x); }
+static inline uint8_t ffs32(uint32_t x) { return __builtin_ctz(x); }
+
+bool lua_heap::init(uint32_t size) {
+    size = MIN(size, (1U << fl_max) - 1) & ~7U;
+    if (_memory != nullptr || size < 2 * header_size + min_block_size) {
+        return false;
+    }
+    _memory = (uint8_t *)hal.util->malloc_type(size, AP_HAL::Util::MEM_FAST);
+    if (_memory == nullptr) {
+        return false;
+    }
+    _size = size;
+
+    // one free block covering the heap, followed by an empty block
+    // that is never free so nothing merges past the end
+    block_header *first = (block_header *)_memory;
+    first->prev_phys = nullptr;
+    first->size = size - 2 * header_size;
+    block_header *sentinel = next_phys(first);
+    sentinel->size = 0;
+    set_free(first);
+    insert_free(first);
+
+    return true;
+}
+
+void lua_heap::set_free(block_header *b) {
+    b->size |= flag_free;
+    block_header *next = next_phys(b);
+    next->prev_phys = b;
+    next->size |= flag_prev_free;
+}
+
+void lua_heap::set_used(block_header *b) {
+    b->size &= ~flag_free;
+    next_phys(b)->size &= ~flag_prev_free;
+}
+
+/*
+  list a block of size bytes belongs on
+ */
+void lua_heap::mapping_insert(uint32_t size, uint8_t &fl, uint8_t &sl) {
+    if (size < small_block_size) {
+        fl = 0;
+        sl = size / (small_block_size / sl_count);
+    } else {
+        const uint8_t f = fls32(size);
+        sl = (size >> (f - sl_count_log2)) ^ sl_count;
+        fl = f - (fl_shift - 1);
+    }
+}
+
+/*
+  first list whose blocks are all at least size bytes
+ */
+void lua_heap::mapping_search(uint32_t size, uint8_t &fl, uint8_t &sl) {
+    if (size >= small_block_size) {
+        size += (1U << (fls32(size) - sl_count_log2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+void lua_heap::insert_free(block_header *b) {
+    uint8_t fl, sl;
+    mapping_insert(block_size(b), fl, sl);
+    block_header *head = _free_lists[fl][sl];
+    b->prev_free = nullptr;
+    b->next_free = head;
+    if (head != nullptr) {
+        head->prev_free = b;
+    }
+    _free_lists[fl][sl] = b;
+    _fl_bitmap |= 1U << fl;
+    _sl_bitmap[fl] |= 1U << sl;
+    _free_bytes += block_size(b);
+}
+
+void lua_heap::remove_free(block_header *b) {
+    uint8_t fl, sl;
+    mapping_insert(block_size(b), fl, sl);
+    if (b->prev_free != nullptr) {
+        b->prev_free->next_free = b->next_free;
+    } else {
+        _free_lists[fl][sl] = b->next_free;
+    }
+    if (b->next_free != nullptr) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    if (_free_lists[fl][sl] == nullptr) {
+        _sl_bitmap[fl] &= ~(1U << sl);
+        if (_sl_bitmap[fl] == 0) {
+            _fl_bitmap &= ~(1U << fl);
+        }
+    }
+    _free_bytes -= block_size(b);
+}
+
+lua_heap::block_header *lua_heap::find_free(uint8_t fl, uint8_t sl) const {
+    if (fl >= fl_count) {
+        return nullptr;
+    }
+    uint32_t sl_map = _sl_bitmap[fl] & (~0U << sl);
+    if (sl_map == 0) {
+        // nothing big enough at this level, take the smallest list of a larger one
+        const uint32_t fl_map = _fl_bitmap & (~0U << (fl + 1));
+        if (fl_map == 0) {
+            return nullptr;
+        }
+        fl = ffs32(fl_map);
+        sl_map = _sl_bitmap[fl];
+    }
+    return _free_lists[fl][ffs32(sl_map)];
+}
+
+/*
+  search the list size maps to for a block that is large enough. This
+  is not constant time, so is only used when find_free() fails
+ */
+lua_heap::block_header *lua_heap::find_fit(uint32_t size) const {
+    uint8_t fl, sl;
+    mapping_insert(size, fl, sl);
+    if (fl >= fl_count) {
+        return nullptr;
+    }
+    for (block_header *b = _free_lists[fl][sl]; b != nullptr; b = b->next_free) {
+        if (block_size(b) >= size) {
+            return b;
+        }
+    }
+    return nullptr;
+}
+
+/*
+  trim a block that isn't on a free list down to size bytes, freeing the rest
+ */
+void lua_heap::split(block_header *b, uint32_t size) {
+    const uint32_t bsize = block_size(b);
+    if (bsize < size + header_size + min_block_size) {
+        return;
+    }
+    block_header *rest = (block_header *)((uint8_t *)block_data(b) + size);
+    rest->size = bsize - size - header_size;
+    set_block_size(b, size);
+    rest = merge_next(rest);
+    set_free(rest);
+    insert_free(rest);
+}
+
+/*
+  absorb the following block if it is free. The caller must mark the
+  block free or used afterwards to fix up the block after it
+ */
+lua_heap::block_header *lua_heap::merge_next(block_header *b) {
+    block_header *next = next_phys(b);
+    if (next->size & flag_free) {
+        remove_free(next);
+        set_block_size(b, block_size(b) + header_size + block_size(next));
+    }
+    return b;
+}
+
+void *lua_heap::allocate(size_t size) {
+    if (size == 0) {
+        return nullptr;
+    }
+    if (size > _size) {
+        _fail_count++;
+        return nullptr;
+    }
+    const uint32_t adjusted = MAX(uint32_t((size + 7) & ~7U), uint32_t(min_block_size));
+    uint8_t fl, sl;
+    mapping_search(adjusted, fl, sl);
+    block_header *b = find_free(fl, sl);
+    if (b == nullptr) {
+        // the search only looks at lists where every block is big
+        // enough. Before failing, check the list this size falls in
+        b = find_fit(adjusted);
+        if (b == nullptr) {
+            _fail_count++;
+            return nullptr;
+        }
+    }
+    remove_free(b);
+    split(b, adjusted);
+    set_used(b);
+
+    _used += header_size + block_size(b);
+    _high_water = MAX(_high_water, _used);
+    _alloc_count++;
+    return block_data(b);
+}
+
+void lua_heap::free(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    block_header *b = data_block(ptr);
+    _used -= header_size + block_size(b);
+
+    if (b->size & flag_prev_free) {
+        block_header *prev = b->prev_phys;
+        remove_free(prev);
+        set_block_size(prev, block_size(prev) + header_size + block_size(b));
+        b = prev;
+    }
+    b = merge_next(b);
+    set_free(b);
+    insert_free(b);
+}
+
+void *lua_heap::reallocate(void *ptr, size_t size) {
+    if (ptr == nullptr) {
+        return allocate(size);
+    }
+    if (size == 0) {
+        free(ptr);
+        return nullptr;
+    }
+    if (size > _size) {
+        _fail_count++;
+        return nullptr;
+    }
+
+    block_header *b = data_block(ptr);
+    const uint32_t current = block_size(b);
+    const uint32_t adjusted = MAX(uint32_t((size + 7) & ~7U), uint32_t(min_block_size));
+
+    if (adjusted > current) {
+        block_header *next = next_phys(b);
+        if (!(next->size & flag_free) ||
+            current + header_size + block_size(next) < adjusted) {
+            // no room to grow in place, so move it
+            void *new_ptr = allocate(size);
+            if (new_ptr == nullptr) {
+                return nullptr;
+            }
+            memcpy(new_ptr, ptr, current);
+            free(ptr);
+            return new_ptr;
+        }
+        merge_next(b);
+        set_used(b);
+    }
+
+    // trim any excess
+    split(b, adjusted);
+    _used += block_size(b) - current;
+    _high_water = MAX(_high_water, _used);
+    return ptr;
+}
+
+uint32_t lua_heap::get_largest_free(void) const {
+    if (_fl_bitmap == 0) {
+        return 0;
+    }
+    // the blocks on the highest list are the largest, but not sorted
+    const uint8_t fl = fls32(_fl_bitmap);
+    const uint8_t sl = fls32(_sl_bitmap[fl]);
+    uint32_t largest = 0;
+    for (const block_header *b = _free_lists[fl][sl]; b != nullptr; b = b->next_free) {
+        largest = MAX(largest, block_size(b));
+    }
+    return largest;
+}
+
+uint8_t lua_heap::get_fragmentation(void) const {
+    if (_free_bytes == 0) {
+        return 0;
+    }
+    return 100 - (uint8_t)((uint64_t)get_largest_free() * 100 / _free_bytes);
+}
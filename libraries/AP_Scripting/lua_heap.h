@@ -0,0 +1,116 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <stddef.h>
+
+/*
+  Two level segregated fit (TLSF) heap for the scripting VM.
+
+  Free blocks are kept on lists by size class, the first level being
+  the power of two of the size and the second level splitting that
+  range into 16. Bitmaps of the non-empty lists let allocate() find a
+  big enough block with a couple of bit scans, and free() merges a
+  block with its free neighbours straight away, so both are O(1)
+  whatever the state of the heap. Rounding requests up to the next
+  size class means any block found is large enough, which keeps
+  fragmentation bounded for long running scripts.
+
+  The heap is a single block of memory from the HAL, so it behaves
+  the same on every board.
+ */
+class lua_heap
+{
+public:
+    // allocate size bytes of memory for the heap, returns false on failure
+    bool init(uint32_t size);
+    bool initialised(void) const { return _memory != nullptr; }
+
+    void *allocate(size_t size);
+    void free(void *ptr);
+    // resize a block in place where possible, otherwise move it.
+    // Returns nullptr, leaving the block alone, if there is no space
+    void *reallocate(void *ptr, size_t size);
+
+    // bytes handed out, including the block headers
+    uint32_t get_used(void) const { return _used; }
+    uint32_t get_high_water(void) const { return _high_water; }
+    uint32_t get_size(void) const { return _size; }
+    // largest single allocation that would currently succeed
+    uint32_t get_largest_free(void) const;
+    // percentage of the free memory that is not in the largest free block
+    uint8_t get_fragmentation(void) const;
+    // allocations and failed allocations since boot
+    uint32_t get_alloc_count(void) const { return _alloc_count; }
+    uint32_t get_fail_count(void) const { return _fail_count; }
+
+private:
+    static const uint8_t align_shift = 3;
+    static const uint8_t sl_count_log2 = 4;
+    static const uint8_t sl_count = 1U << sl_count_log2;
+    static const uint8_t fl_shift = sl_count_log2 + align_shift;
+    static const uint32_t small_block_size = 1U << fl_shift;
+    static const uint8_t fl_max = 24; // up to 16MB
+    static const uint8_t fl_count = fl_max - fl_shift + 1;
+
+    struct block_header {
+        block_header *prev_phys; // previous block in memory, valid when it is free
+        uint32_t size;           // bytes after the header, and the flags below
+        // these overlap the data when the block is free
+        block_header *next_free;
+        block_header *prev_free;
+    };
+
+    static const uint32_t flag_free = 1U << 0;
+    static const uint32_t flag_prev_free = 1U << 1;
+    static const uint32_t flag_mask = flag_free | flag_prev_free;
+
+    // data starts on an 8 byte boundary after the prev_phys and size fields
+    static const uint32_t header_size = (offsetof(block_header, size) + sizeof(uint32_t) + 7) & ~7U;
+    // a free block needs room for its list pointers
+    static const uint32_t min_block_size = ((sizeof(block_header) - header_size) + 7) & ~7U;
+
+    static uint32_t block_size(const block_header *b) { return b->size & ~flag_mask; }
+    static void set_block_size(block_header *b, uint32_t size) { b->size = size | (b->size & flag_mask); }
+    static void *block_data(block_header *b) { return (uint8_t *)b + header_size; }
+    static block_header *data_block(void *ptr) { return (block_header *)((uint8_t *)ptr - header_size); }
+    static block_header *next_phys(block_header *b) { return (block_header *)((uint8_t *)block_data(b) + block_size(b)); }
+
+    void set_free(block_header *b);
+    void set_used(block_header *b);
+
+    static void mapping_insert(uint32_t size, uint8_t &fl, uint8_t &sl);
+    static void mapping_search(uint32_t size, uint8_t &fl, uint8_t &sl);
+
+    void insert_free(block_header *b);
+    void remove_free(block_header *b);
+    block_header *find_free(uint8_t fl, uint8_t sl) const;
+    block_header *find_fit(uint32_t size) const;
+    void split(block_header *b, uint32_t size);
+    block_header *merge_next(block_header *b);
+
+    uint8_t *_memory;
+    uint32_t _size;
+    uint32_t _used;
+    uint32_t _high_water;
+    uint32_t _free_bytes;
+    uint32_t _alloc_count;
+    uint32_t _fail_count;
+
+    uint32_t _fl_bitmap;
+    uint16_t _sl_bitmap[fl_count];
+    block_header *_free_lists[fl_count][sl_count];
+};
@@ -0,0 +1,186 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lua_pool.h"
+
+#include <string.h>
+
+void *lua_pool::allocate(lua_heap &heap, size_t size) {
+    const uint8_t c = size_class(size);
+    const size_t block_size = (c + 1) * granularity;
+
+    if (free_list[c] == nullptr) {
+        // carve a new slab into blocks, falling back to a single
+        // block when the heap is too full for a whole slab
+        uint8_t count = blocks_per_slab;
+        slab *s = (slab *)heap.allocate(slab_header_size + block_size * count);
+        if (s == nullptr) {
+            count = 1;
+            s = (slab *)heap.allocate(slab_header_size + block_size);
+            if (s == nullptr) {
+                return nullptr;
+            }
+        }
+        if (!index_insert(heap, s)) {
+            heap.free(s);
+            return nullptr;
+        }
+        s->count = count;
+        s->size_class = c;
+        s->next = slabs[c];
+        slabs[c] = s;
+        uint8_t *data = (uint8_t *)s + slab_header_size;
+        for (uint8_t i = 0; i < count; i++) {
+            block *b = (block *)&data[i * block_size];
+            b->next = free_list[c];
+            free_list[c] = b;
+        }
+        pool_bytes += block_size * count;
+        free_bytes += block_size * count;
+    }
+
+    block *b = free_list[c];
+    free_list[c] = b->next;
+    free_bytes -= block_size;
+    return b;
+}
+
+bool lua_pool::owns(const void *ptr, size_t &block_size) const {
+    uint16_t pos;
+    const slab *s = find_slab(ptr, pos);
+    if (s == nullptr) {
+        return false;
+    }
+    block_size = (s->size_class + 1) * granularity;
+    return true;
+}
+
+void lua_pool::free(void *ptr) {
+    uint16_t pos;
+    const uint8_t c = find_slab(ptr, pos)->size_class;
+    block *b = (block *)ptr;
+    b->next = free_list[c];
+    free_list[c] = b;
+    free_bytes += (c + 1) * granularity;
+}
+
+/*
+  this walks the free list once per slab, so is only for when the
+  heap has run out
+ */
+uint32_t lua_pool::release(lua_heap &heap) {
+    uint32_t released = 0;
+    for (uint8_t c = 0; c < num_classes; c++) {
+        const size_t block_size = (c + 1) * granularity;
+        slab **sp = &slabs[c];
+        while (*sp != nullptr) {
+            slab *s = *sp;
+            const uint8_t *start = (const uint8_t *)s + slab_header_size;
+            const uint8_t *end = start + s->count * block_size;
+
+            uint8_t free_count = 0;
+            for (const block *b = free_list[c]; b != nullptr; b = b->next) {
+                if ((const uint8_t *)b >= start && (const uint8_t *)b < end) {
+                    free_count++;
+                }
+            }
+            if (free_count < s->count) {
+                sp = &s->next;
+                continue;
+            }
+
+            // every block is free, take them off the free list and free the slab
+            block **bp = &free_list[c];
+            while (*bp != nullptr) {
+                if ((const uint8_t *)*bp >= start && (const uint8_t *)*bp < end) {
+                    *bp = (*bp)->next;
+                } else {
+                    bp = &(*bp)->next;
+                }
+            }
+            const uint32_t bytes = s->count * block_size;
+            pool_bytes -= bytes;
+            free_bytes -= bytes;
+            released += bytes;
+            *sp = s->next;
+            index_remove(s);
+            heap.free(s);
+        }
+    }
+    if (index_count == 0 && index != nullptr) {
+        heap.free(index);
+        index = nullptr;
+        index_size = 0;
+    }
+    return released;
+}
+
+/*
+  binary search of the index for the last slab starting at or before ptr
+ */
+lua_pool::slab *lua_pool::find_slab(const void *ptr, uint16_t &pos) const {
+    uint16_t lo = 0;
+    uint16_t hi = index_count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if ((const void *)index[mid] <= ptr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    pos = lo;
+    if (lo == 0) {
+        return nullptr;
+    }
+    slab *s = index[lo - 1];
+    const uint8_t *start = (const uint8_t *)s + slab_header_size;
+    const uint8_t *end = start + s->count * (s->size_class + 1) * granularity;
+    if ((const uint8_t *)ptr < start || (const uint8_t *)ptr >= end) {
+        return nullptr;
+    }
+    return s;
+}
+
+bool lua_pool::index_insert(lua_heap &heap, slab *s) {
+    if (index_count == index_size) {
+        // grow by doubling, the index is only freed by release() once the pools are empty
+        const uint16_t new_size = index_size == 0 ? 16 : index_size * 2;
+        if (new_size <= index_size) {
+            return false;
+        }
+        slab **new_index = (slab **)heap.reallocate(index, new_size * sizeof(slab *));
+        if (new_index == nullptr) {
+            return false;
+        }
+        index = new_index;
+        index_size = new_size;
+    }
+    uint16_t pos;
+    find_slab(s, pos);
+    memmove(&index[pos + 1], &index[pos], (index_count - pos) * sizeof(slab *));
+    index[pos] = s;
+    index_count++;
+    return true;
+}
+
+void lua_pool::index_remove(slab *s) {
+    uint16_t pos;
+    find_slab(s, pos);
+    // pos is just past s, as s is the last slab starting at or before itself
+    pos--;
+    memmove(&index[pos], &index[pos + 1], (index_count - pos - 1) * sizeof(slab *));
+    index_count--;
+}
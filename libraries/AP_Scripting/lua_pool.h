@@ -0,0 +1,97 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include "lua_heap.h"
+
+/*
+  pools of fixed size blocks for the small objects lua creates and
+  frees at a high rate, such as Vector3f and Location userdata, small
+  strings and closures.
+
+  Blocks are carved out of the scripting heap a slab at a time and
+  are kept on a free list for their size class once freed, so the
+  heap doesn't fragment and small allocations don't search the heap.
+  Slabs stay with their pool until release() is called, which returns
+  any slab whose blocks are all free to the heap.
+
+  A sorted index of the slabs lets owns() tell a pool block from a
+  heap block by its address. The caller can't go by size, as a heap
+  block may be shrunk in place below max_size when the pools are out
+  of memory.
+ */
+class lua_pool
+{
+public:
+    // largest allocation served from the pools
+    static const uint8_t max_size = 64;
+
+    static bool handles(size_t size) { return size > 0 && size <= max_size; }
+
+    // true if both sizes are served by the same block size
+    static bool same_class(size_t size1, size_t size2) { return size_class(size1) == size_class(size2); }
+
+    // allocate a block for size bytes from the heap, returns nullptr if the heap is exhausted
+    void *allocate(lua_heap &heap, size_t size);
+
+    // true if ptr is a block from the pools, and the largest size it can hold
+    bool owns(const void *ptr, size_t &block_size) const;
+
+    // return a block to its pool, ptr must be owned by the pools
+    void free(void *ptr);
+
+    // give slabs with no blocks in use back to the heap, for when the
+    // heap is too full for an allocation. Returns the bytes released
+    uint32_t release(lua_heap &heap);
+
+    // bytes of heap held by the pools, and how many of those are free
+    uint32_t get_pool_bytes(void) const { return pool_bytes; }
+    uint32_t get_free_bytes(void) const { return free_bytes; }
+
+private:
+    static const uint8_t granularity = 8;
+    static const uint8_t num_classes = max_size / granularity;
+    static const uint8_t blocks_per_slab = 16;
+
+    static uint8_t size_class(size_t size) { return (size - 1) / granularity; }
+
+    struct block {
+        block *next;
+    };
+    block *free_list[num_classes];
+
+    // each slab starts with a header, blocks follow on a granularity boundary
+    struct slab {
+        slab *next;
+        uint8_t count;
+        uint8_t size_class;
+    };
+    static const uint8_t slab_header_size = (sizeof(slab) + granularity - 1) & ~(granularity - 1);
+    slab *slabs[num_classes];
+
+    // every slab sorted by address, allocated from the heap
+    slab **index;
+    uint16_t index_count;
+    uint16_t index_size;
+
+    // the slab that may hold ptr, or nullptr. pos is set to where ptr would be inserted
+    slab *find_slab(const void *ptr, uint16_t &pos) const;
+    bool index_insert(lua_heap &heap, slab *s);
+    void index_remove(slab *s);
+
+    uint32_t pool_bytes;
+    uint32_t free_bytes;
+};
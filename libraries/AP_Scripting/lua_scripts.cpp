@@ -18,6 +18,8 @@
 #include <GCS_MAVLink/GCS.h>
 #include "AP_Scripting.h"
 #include <AP_ROMFS/AP_ROMFS.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Math/crc.h>
 
 #include "lua_generated_bindings.h"
 
@@ -29,15 +31,29 @@
   #endif //HAL_OS_FATFS_IO
 #endif // SCRIPTING_DIRECTORY
 
+// compiled scripts are cached alongside the source as <name>.luac
+#define SCRIPTING_CACHE_SUFFIX "c"
+
+// the cache starts with a comment line holding the CRC of the source
+// the chunk was compiled from and the CRC of the chunk, which lua
+// skips when loading the chunk
+#define SCRIPTING_CACHE_HEADER_LEN 19 // "#xxxxxxxx xxxxxxxx\n"
+
+// interval between script statistics reports
+#define SCRIPTING_STATS_INTERVAL_MS 1000
+
 extern const AP_HAL::HAL& hal;
 
 bool lua_scripts::overtime;
 jmp_buf lua_scripts::panic_jmp;
+uint32_t lua_scripts::_alloc_bytes;
+lua_pool lua_scripts::_pool;
 
-lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level)
+lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level, const AP_Int16 &options)
     : _vm_steps(vm_steps),
-      _debug_level(debug_level) {
-    _heap = hal.util->allocate_heap_memory(heap_size);
+      _debug_level(debug_level),
+      _options(options) {
+    _heap.init(heap_size);
 }
 
 void lua_scripts::hook(lua_State *L, lua_Debug *ar) {
@@ -57,31 +73,158 @@ int lua_scripts::atpanic(lua_State *L) {
     return 0;
 }
 
+/*
+  CRC the rest of an open file, returns false on a read error
+ */
+static bool crc_file(int fd, uint32_t &crc) {
+    uint8_t buf[128];
+    crc = 0;
+    while (true) {
+        const ssize_t n = AP::FS().read(fd, buf, sizeof(buf));
+        if (n < 0) {
+            return false;
+        }
+        if (n == 0) {
+            return true;
+        }
+        crc = crc_crc32(crc, buf, n);
+    }
+}
+
+static bool parse_hex32(const char *s, uint32_t &value) {
+    value = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        const char c = s[i];
+        uint8_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else {
+            return false;
+        }
+        value = (value << 4) | digit;
+    }
+    return true;
+}
+
+bool lua_scripts::load_cached_script(lua_State *L, const char *filename, const char *cachename, uint32_t source_crc) {
+    const int fd = AP::FS().open(cachename, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    // only trust a chunk that was compiled from this source and has
+    // been written out in full, lua does not verify bytecode
+    char header[SCRIPTING_CACHE_HEADER_LEN];
+    uint32_t cached_source_crc, chunk_crc, crc;
+    const bool valid = AP::FS().read(fd, header, sizeof(header)) == sizeof(header) &&
+                       header[0] == '#' && header[9] == ' ' && header[18] == '\n' &&
+                       parse_hex32(&header[1], cached_source_crc) &&
+                       parse_hex32(&header[10], chunk_crc) &&
+                       cached_source_crc == source_crc &&
+                       crc_file(fd, crc) && crc == chunk_crc;
+    AP::FS().close(fd);
+    if (!valid) {
+        return false;
+    }
+
+    if (luaL_loadfilex(L, cachename, "b") != LUA_OK) {
+        if (_debug_level > 0) {
+            gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: Ignoring cache for %s: %s", filename, lua_tostring(L, -1));
+        }
+        lua_pop(L, 1);
+        return false;
+    }
+    return true;
+}
+
+static int cache_crc_writer(lua_State *L, const void *p, size_t sz, void *ud) {
+    uint32_t *crc = (uint32_t *)ud;
+    *crc = crc_crc32(*crc, (const uint8_t *)p, sz);
+    return 0;
+}
+
+static int cache_file_writer(lua_State *L, const void *p, size_t sz, void *ud) {
+    const int fd = *(int *)ud;
+    return AP::FS().write(fd, p, sz) == (ssize_t)sz ? 0 : 1;
+}
+
+void lua_scripts::write_script_cache(lua_State *L, const char *cachename, uint32_t source_crc) {
+    // dump once to CRC the chunk, so the header can be written first
+    uint32_t chunk_crc = 0;
+    lua_dump(L, cache_crc_writer, &chunk_crc, 0);
+
+    int fd = AP::FS().open(cachename, O_WRONLY|O_CREAT|O_TRUNC);
+    if (fd == -1) {
+        return;
+    }
+    char header[SCRIPTING_CACHE_HEADER_LEN+1];
+    snprintf(header, sizeof(header), "#%08x %08x\n", (unsigned)source_crc, (unsigned)chunk_crc);
+    const bool ok = AP::FS().write(fd, header, SCRIPTING_CACHE_HEADER_LEN) == SCRIPTING_CACHE_HEADER_LEN &&
+                    lua_dump(L, cache_file_writer, &fd, 0) == 0;
+    AP::FS().close(fd);
+    if (!ok) {
+        // a partial file would fail its CRC check, but don't leave it around
+        AP::FS().unlink(cachename);
+    }
+}
+
 lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename) {
-    if (int error = luaL_loadfile(L, filename)) {
-        switch (error) {
-            case LUA_ERRSYNTAX:
-                gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Syntax error in %s", filename);
-                gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Error: %s", lua_tostring(L, -1));
-                lua_pop(L, lua_gettop(L));
-                return nullptr;
-            case LUA_ERRMEM:
-                gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Insufficent memory loading %s", filename);
-                lua_pop(L, lua_gettop(L));
-                return nullptr;
-            case LUA_ERRFILE:
-                gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Unable to load the file: %s", lua_tostring(L, -1));
-                hal.console->printf("Lua: File error: %s\n", lua_tostring(L, -1));
-                lua_pop(L, lua_gettop(L));
-                return nullptr;
-            default:
-                gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Unknown error (%d) loading %s", error, filename);
-                lua_pop(L, lua_gettop(L));
-                return nullptr;
+    // work out if there is an up to date compiled copy of the script
+    const bool use_cache = !option_is_set(Option::DISABLE_BYTECODE_CACHE);
+    uint32_t source_crc = 0;
+    char *cachename = nullptr;
+    if (use_cache) {
+        const int fd = AP::FS().open(filename, O_RDONLY);
+        if (fd != -1) {
+            if (crc_file(fd, source_crc)) {
+                const size_t size = strlen(filename) + sizeof(SCRIPTING_CACHE_SUFFIX);
+                cachename = (char *)_heap.allocate(size);
+                if (cachename != nullptr) {
+                    snprintf(cachename, size, "%s" SCRIPTING_CACHE_SUFFIX, filename);
+                }
+            }
+            AP::FS().close(fd);
         }
     }
 
-    script_info *new_script = (script_info *)hal.util->heap_realloc(_heap, nullptr, sizeof(script_info));
+    bool loaded = false;
+    if (cachename != nullptr) {
+        loaded = load_cached_script(L, filename, cachename, source_crc);
+    }
+
+    if (!loaded) {
+        if (int error = luaL_loadfile(L, filename)) {
+            _heap.free(cachename);
+            switch (error) {
+                case LUA_ERRSYNTAX:
+                    gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Syntax error in %s", filename);
+                    gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Error: %s", lua_tostring(L, -1));
+                    lua_pop(L, lua_gettop(L));
+                    return nullptr;
+                case LUA_ERRMEM:
+                    gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Insufficent memory loading %s", filename);
+                    lua_pop(L, lua_gettop(L));
+                    return nullptr;
+                case LUA_ERRFILE:
+                    gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Unable to load the file: %s", lua_tostring(L, -1));
+                    hal.console->printf("Lua: File error: %s\n", lua_tostring(L, -1));
+                    lua_pop(L, lua_gettop(L));
+                    return nullptr;
+                default:
+                    gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Unknown error (%d) loading %s", error, filename);
+                    lua_pop(L, lua_gettop(L));
+                    return nullptr;
+            }
+        }
+        if (cachename != nullptr) {
+            write_script_cache(L, cachename, source_crc);
+        }
+    }
+    _heap.free(cachename);
+
+    script_info *new_script = (script_info *)_heap.allocate(sizeof(script_info));
     if (new_script == nullptr) {
         // No memory, shouldn't happen, we even attempted to do a GC
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Insufficent memory loading %s", filename);
@@ -90,8 +233,11 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
     }
 
     new_script->name = filename;
-    new_script->next = nullptr;
-
+    new_script->run_count = 0;
+    new_script->run_time_us = 0;
+    new_script->max_time_us = 0;
+    new_script->alloc_bytes = 0;
+    new_script->gc_time_us = 0;
 
     // find and create a sandbox for the new chunk
     lua_getglobal(L, "get_sandbox_env");
@@ -135,7 +281,7 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
 
         // FIXME: because chunk name fetching is not working we are allocating and storing an extra string we shouldn't need to
         size_t size = strlen(dirname) + strlen(de->d_name) + 2;
-        char * filename = (char *) hal.util->heap_realloc(_heap, nullptr, size);
+        char * filename = (char *) _heap.allocate(size);
         if (filename == nullptr) {
             continue;
         }
@@ -144,7 +290,7 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
         // we have something that looks like a lua file, attempt to load it
         script_info * script = load_script(L, filename);
         if (script == nullptr) {
-            hal.util->heap_realloc(_heap, filename, 0);
+            _heap.free(filename);
             continue;
         }
         reschedule_script(script);
@@ -154,7 +300,7 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
 }
 
 void lua_scripts::run_next_script(lua_State *L) {
-    if (scripts == nullptr) {
+    if (_run_queue_len == 0) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
         AP_HAL::panic("Lua: Attempted to run a script without any scripts queued");
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
@@ -164,9 +310,8 @@ void lua_scripts::run_next_script(lua_State *L) {
     // reset the current script tracking information
     overtime = false;
 
-    // strip the selected script out of the list
-    script_info *script = scripts;
-    scripts = script->next;
+    // strip the selected script out of the queue
+    script_info *script = queue_pop();
 
     // reset the hook to clear the counter
     const int32_t vm_steps = MAX(_vm_steps, 1000);
@@ -178,7 +323,23 @@ void lua_scripts::run_next_script(lua_State *L) {
     // pop the function to the top of the stack
     lua_rawgeti(L, LUA_REGISTRYINDEX, script->lua_ref);
 
-    if(lua_pcall(L, 0, LUA_MULTRET, 0)) {
+    const uint32_t alloc_start = _alloc_bytes;
+    const uint32_t run_start_us = AP_HAL::micros();
+
+    const int error = lua_pcall(L, 0, LUA_MULTRET, 0);
+
+    const uint32_t run_time_us = AP_HAL::micros() - run_start_us;
+    script->run_count++;
+    script->run_time_us += run_time_us;
+    script->max_time_us = MAX(script->max_time_us, run_time_us);
+    script->alloc_bytes += _alloc_bytes - alloc_start;
+
+    // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
+    const uint32_t gc_start_us = AP_HAL::micros();
+    lua_gc(L, LUA_GCCOLLECT, 0);
+    script->gc_time_us += AP_HAL::micros() - gc_start_us;
+
+    if (error) {
         if (overtime) {
             // script has consumed an excessive amount of CPU time
             gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: %s exceeded time limit (%d)", script->name,  (int)vm_steps);
@@ -239,17 +400,16 @@ void lua_scripts::remove_script(lua_State *L, script_info *script) {
         return;
     }
 
-    // ensure that the script isn't in the loaded list for any reason
-    if (scripts == nullptr) {
-        // nothing to do, already not in the list
-    } else if (scripts == script) {
-        scripts = script->next;
-    } else {
-        for(script_info * current = scripts; current->next != nullptr; current = current->next) {
-            if (current->next == script) {
-                current->next = script->next;
-                break;
+    // ensure that the script isn't in the run queue for any reason
+    for (uint16_t i = 0; i < _run_queue_len; i++) {
+        if (_run_queue[i] == script) {
+            _run_queue_len--;
+            if (i < _run_queue_len) {
+                _run_queue[i] = _run_queue[_run_queue_len];
+                queue_sift_up(i);
+                queue_sift_down(i);
             }
+            break;
         }
     }
 
@@ -257,8 +417,8 @@ void lua_scripts::remove_script(lua_State *L, script_info *script) {
         // state could be null if we are force killing all scripts
         luaL_unref(L, LUA_REGISTRYINDEX, script->lua_ref);
     }
-    hal.util->heap_realloc(_heap, script->name, 0);
-    hal.util->heap_realloc(_heap, script, 0);
+    _heap.free(script->name);
+    _heap.free(script);
 }
 
 void lua_scripts::reschedule_script(script_info *script) {
@@ -269,44 +429,232 @@ void lua_scripts::reschedule_script(script_info *script) {
        return;
     }
 
-    script->next = nullptr;
-    if (scripts == nullptr) {
-        scripts = script;
-        return;
+    if (_run_queue_len == _run_queue_size) {
+        const uint16_t new_size = MAX(_run_queue_size * 2, 8);
+        script_info **new_queue = (script_info **)_heap.reallocate(_run_queue, new_size * sizeof(script_info *));
+        if (new_queue == nullptr) {
+            gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Insufficent memory to schedule %s", script->name);
+            remove_script(lua_state, script);
+            return;
+        }
+        _run_queue = new_queue;
+        _run_queue_size = new_size;
     }
 
-    uint64_t next_run_ms = script->next_run_ms;
+    script->sequence = _sequence++;
+    _run_queue[_run_queue_len] = script;
+    queue_sift_up(_run_queue_len);
+    _run_queue_len++;
+}
 
-    if (scripts->next_run_ms > next_run_ms) {
-        script->next = scripts;
-        scripts = script;
+bool lua_scripts::run_before(const script_info *a, const script_info *b) {
+    if (a->next_run_ms != b->next_run_ms) {
+        return a->next_run_ms < b->next_run_ms;
+    }
+    // scripts due at the same time run in the order they were queued
+    return (int32_t)(a->sequence - b->sequence) < 0;
+}
+
+lua_scripts::script_info *lua_scripts::queue_pop(void) {
+    script_info *script = _run_queue[0];
+    _run_queue_len--;
+    if (_run_queue_len > 0) {
+        _run_queue[0] = _run_queue[_run_queue_len];
+        queue_sift_down(0);
+    }
+    return script;
+}
+
+void lua_scripts::queue_sift_up(uint16_t i) {
+    script_info *script = _run_queue[i];
+    while (i > 0) {
+        const uint16_t parent = (i - 1) / 2;
+        if (!run_before(script, _run_queue[parent])) {
+            break;
+        }
+        _run_queue[i] = _run_queue[parent];
+        i = parent;
+    }
+    _run_queue[i] = script;
+}
+
+void lua_scripts::queue_sift_down(uint16_t i) {
+    script_info *script = _run_queue[i];
+    while (true) {
+        uint16_t child = 2 * i + 1;
+        if (child >= _run_queue_len) {
+            break;
+        }
+        if (child + 1 < _run_queue_len && run_before(_run_queue[child + 1], _run_queue[child])) {
+            child++;
+        }
+        if (!run_before(_run_queue[child], script)) {
+            break;
+        }
+        _run_queue[i] = _run_queue[child];
+        i = child;
+    }
+    _run_queue[i] = script;
+}
+
+/*
+  log the statistics for the heap and each script, and optionally send them to the GCS
+ */
+void lua_scripts::update_stats(void) {
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = now_ms - _last_stats_ms;
+    if (dt_ms < SCRIPTING_STATS_INTERVAL_MS) {
         return;
     }
+    _last_stats_ms = now_ms;
+
+    const int32_t total_mem = lua_gc(lua_state, LUA_GCCOUNT, 0) * 1024 + lua_gc(lua_state, LUA_GCCOUNTB, 0);
+    const uint64_t now_us = AP_HAL::micros64();
+    AP_Logger *logger = AP_Logger::get_singleton();
+    const bool send_stats = option_is_set(Option::SEND_STATS);
+
+    for (uint16_t i = 0; i < _run_queue_len; i++) {
+        script_info *script = _run_queue[i];
+        const char *name = strrchr(script->name, '/');
+        name = (name == nullptr) ? script->name : name + 1;
+
+        if (logger != nullptr) {
+            struct log_Scripting pkt {
+                LOG_PACKET_HEADER_INIT(LOG_SCRIPTING_MSG),
+                time_us     : now_us,
+                name        : {},
+                runs        : script->run_count,
+                run_time    : script->run_time_us,
+                max_time    : script->max_time_us,
+                alloc_bytes : script->alloc_bytes,
+                gc_time     : script->gc_time_us,
+                total_mem   : total_mem,
+            };
+            strncpy(pkt.name, name, sizeof(pkt.name));
+            logger->WriteBlock(&pkt, sizeof(pkt));
+        }
 
-    script_info *previous = scripts;
-    while (previous->next != nullptr) {
-        if (previous->next->next_run_ms > next_run_ms) {
-            script->next = previous->next;
-            previous->next = script;
-            return;
+        if (send_stats) {
+            gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: %s runs:%u time:%uus max:%uus alloc:%u gc:%uus",
+                            name,
+                            (unsigned)script->run_count,
+                            (unsigned)script->run_time_us,
+                            (unsigned)script->max_time_us,
+                            (unsigned)script->alloc_bytes,
+                            (unsigned)script->gc_time_us);
         }
-        previous = previous->next;
+
+        script->run_count = 0;
+        script->run_time_us = 0;
+        script->max_time_us = 0;
+        script->alloc_bytes = 0;
+        script->gc_time_us = 0;
+    }
+
+    const uint32_t alloc_rate = (uint64_t)(_alloc_bytes - _last_alloc_bytes) * 1000 / dt_ms;
+    _last_alloc_bytes = _alloc_bytes;
+    const uint32_t largest_free = _heap.get_largest_free();
+    const uint8_t fragmentation = _heap.get_fragmentation();
+
+    if (logger != nullptr) {
+        const struct log_Scripting_Heap pkt {
+            LOG_PACKET_HEADER_INIT(LOG_SCRIPTING_HEAP_MSG),
+            time_us       : now_us,
+            size          : _heap.get_size(),
+            used          : _heap.get_used(),
+            high_water    : _heap.get_high_water(),
+            largest_free  : largest_free,
+            fragmentation : fragmentation,
+            alloc_rate    : alloc_rate,
+            fail_count    : _heap.get_fail_count(),
+            pool_bytes    : _pool.get_pool_bytes(),
+            pool_free     : _pool.get_free_bytes(),
+        };
+        logger->WriteBlock(&pkt, sizeof(pkt));
     }
 
-    previous->next = script;
+    if (send_stats) {
+        gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: heap used:%u hwm:%u maxfree:%u frag:%u%% rate:%uB/s",
+                        (unsigned)_heap.get_used(),
+                        (unsigned)_heap.get_high_water(),
+                        (unsigned)largest_free,
+                        (unsigned)fragmentation,
+                        (unsigned)alloc_rate);
+    }
 }
 
-void *lua_scripts::_heap;
+lua_heap lua_scripts::_heap;
+
+void *lua_scripts::allocate(size_t size, bool pooled) {
+    if (pooled) {
+        return _pool.allocate(_heap, size);
+    }
+    return _heap.allocate(size);
+}
 
 void *lua_scripts::alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
-    (void)ud; (void)osize;  /* not used */
-    return hal.util->heap_realloc(_heap, ptr, nsize);
+    (void)ud;  /* not used */
+    // osize is the type of object being created when ptr is null
+    if (ptr == nullptr) {
+        osize = 0;
+    }
+
+    // count the bytes handed out, so the cost of each script can be reported
+    if (nsize > osize) {
+        _alloc_bytes += nsize - osize;
+    }
+
+    // small blocks come from the pools, everything else from the heap.
+    // Which one ptr came from is found by its address, as a shrink
+    // that couldn't move a block to the pools leaves it on the heap
+    size_t block_size = 0;
+    const bool old_pooled = ptr != nullptr && _pool.owns(ptr, block_size);
+    const bool new_pooled = lua_pool::handles(nsize);
+    if (old_pooled && new_pooled && lua_pool::same_class(block_size, nsize)) {
+        return ptr;
+    }
+    if (ptr != nullptr && !old_pooled && !new_pooled) {
+        void *new_ptr = _heap.reallocate(ptr, nsize);
+        if (nsize > 0 && new_ptr == nullptr && _pool.release(_heap) > 0) {
+            // the pools were holding on to free memory, try again
+            new_ptr = _heap.reallocate(ptr, nsize);
+        }
+        return new_ptr;
+    }
+
+    void *new_ptr = nullptr;
+    if (nsize > 0) {
+        new_ptr = allocate(nsize, new_pooled);
+        if (new_ptr == nullptr && _pool.release(_heap) > 0) {
+            new_ptr = allocate(nsize, new_pooled);
+        }
+        if (new_ptr == nullptr) {
+            // lua assumes a shrink can't fail, so keep the block where it is
+            if (ptr != nullptr && nsize <= osize) {
+                return old_pooled ? ptr : _heap.reallocate(ptr, nsize);
+            }
+            // lua keeps the old block when an allocation fails
+            return nullptr;
+        }
+    }
+
+    if (ptr != nullptr) {
+        if (new_ptr != nullptr) {
+            memcpy(new_ptr, ptr, MIN(osize, nsize));
+        }
+        if (old_pooled) {
+            _pool.free(ptr);
+        } else {
+            _heap.free(ptr);
+        }
+    }
+    return new_ptr;
 }
 
 void lua_scripts::run(void) {
     bool succeeded_initial_load = false;
 
-    if (_heap == nullptr) {
+    if (!_heap.initialised()) {
         gcs().send_text(MAV_SEVERITY_INFO, "Lua: Unable to allocate a heap");
         return;
     }
@@ -320,10 +668,9 @@ void lua_scripts::run(void) {
             lua_close(lua_state); // shutdown the old state
         }
         // remove all the old scheduled scripts
-        for (script_info *script = scripts; script != nullptr; script = scripts) {
-            remove_script(nullptr, script);
+        while (_run_queue_len > 0) {
+            remove_script(nullptr, _run_queue[_run_queue_len - 1]);
         }
-        scripts = nullptr;
         overtime = false;
     }
 
@@ -363,26 +710,26 @@ void lua_scripts::run(void) {
         }
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
 
-        if (scripts != nullptr) {
+        if (_run_queue_len > 0) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
-              // Sanity check that the scripts list is ordered correctly
-              script_info *sanity = scripts;
-              while (sanity->next != nullptr) {
-                  if (sanity->next_run_ms > sanity->next->next_run_ms) {
+              // Sanity check that the run queue is ordered correctly
+              for (uint16_t i = 1; i < _run_queue_len; i++) {
+                  if (run_before(_run_queue[i], _run_queue[(i - 1) / 2])) {
                       AP_HAL::panic("Lua: Script tasking order has been violated");
                   }
-                  sanity = sanity->next;
               }
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
 
+            script_info *next = _run_queue[0];
+
             // compute delay time
             uint64_t now_ms = AP_HAL::millis64();
-            if (now_ms < scripts->next_run_ms) {
-                hal.scheduler->delay(scripts->next_run_ms - now_ms);
+            if (now_ms < next->next_run_ms) {
+                hal.scheduler->delay(next->next_run_ms - now_ms);
             }
 
             if (_debug_level > 1) {
-                gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: Running %s", scripts->name);
+                gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: Running %s", next->name);
             }
 
             const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
@@ -399,8 +746,7 @@ void lua_scripts::run(void) {
                                                     (int)(endMem - startMem));
             }
 
-            // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
-            lua_gc(L, LUA_GCCOLLECT, 0);
+            update_stats();
 
         } else {
             gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: No scripts to run");
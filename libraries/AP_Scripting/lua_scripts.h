@@ -20,44 +20,80 @@
 
 #include <AP_Filesystem/posix_compat.h>
 #include "lua_bindings.h"
+#include "lua_heap.h"
+#include "lua_pool.h"
 
 class lua_scripts
 {
 public:
-    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level);
+    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level, const AP_Int16 &options);
 
     /* Do not allow copies */
     lua_scripts(const lua_scripts &other) = delete;
     lua_scripts &operator=(const lua_scripts&) = delete;
 
     // return true if initialisation failed
-    bool heap_allocated() const { return _heap != nullptr; }
+    bool heap_allocated() const { return _heap.initialised(); }
 
     // run scripts, does not return unless an error occured
     void run(void);
 
     static bool overtime; // script exceeded it's execution slot, and we are bailing out
+
+    // bits for SCR_OPTIONS
+    enum class Option : uint16_t {
+        DISABLE_BYTECODE_CACHE = (1U<<0),
+        SEND_STATS             = (1U<<1),
+    };
+
 private:
 
     typedef struct script_info {
        int lua_ref;          // reference to the loaded script object
        uint64_t next_run_ms; // time (in milliseconds) the script should next be run at
        char *name;           // filename for the script // FIXME: This information should be available from Lua
-       script_info *next;
+       uint32_t sequence;    // order the script was queued in, breaks ties in next_run_ms
+       // statistics since they were last reported
+       uint32_t run_count;   // number of times run
+       uint32_t run_time_us; // total time spent running
+       uint32_t max_time_us; // longest single run
+       uint32_t alloc_bytes; // bytes allocated while running
+       uint32_t gc_time_us;  // time spent collecting garbage after running
     } script_info;
 
     script_info *load_script(lua_State *L, char *filename);
 
+    // load a script from its bytecode cache, returns false if there is no up to date cache
+    bool load_cached_script(lua_State *L, const char *filename, const char *cachename, uint32_t source_hash);
+
+    // write the compiled chunk on the top of the stack to the bytecode cache
+    void write_script_cache(lua_State *L, const char *cachename, uint32_t source_hash);
+
     void load_all_scripts_in_dir(lua_State *L, const char *dirname);
 
     void run_next_script(lua_State *L);
 
     void remove_script(lua_State *L, script_info *script);
 
-    // reschedule the script for execution. It is assumed the script is not in the list already
+    // reschedule the script for execution. It is assumed the script is not in the queue already
     void reschedule_script(script_info *script);
 
-    script_info *scripts; // linked list of scripts to be run, sorted by next run time (soonest first)
+    // run queue of scripts, a binary min-heap ordered by next run time
+    script_info **_run_queue;
+    uint16_t _run_queue_len;
+    uint16_t _run_queue_size;
+    uint32_t _sequence;
+
+    // true if script a should be run before script b
+    static bool run_before(const script_info *a, const script_info *b);
+    script_info *queue_pop(void);
+    void queue_sift_up(uint16_t i);
+    void queue_sift_down(uint16_t i);
+
+    // log and report the heap and per-script statistics
+    void update_stats(void);
+    uint32_t _last_stats_ms;
+    uint32_t _last_alloc_bytes;
 
     // hook will be run when CPU time for a script is exceeded
     // it must be static to be passed to the C API
@@ -71,8 +107,19 @@ private:
 
     const AP_Int32 & _vm_steps;
     const AP_Int8 & _debug_level;
+    const AP_Int16 & _options;
+
+    bool option_is_set(Option option) const {
+        return (uint16_t(_options.get()) & uint16_t(option)) != 0;
+    }
 
     static void *alloc(void *ud, void *ptr, size_t osize, size_t nsize);
+    // allocate a new block from the pools or the heap
+    static void *allocate(size_t size, bool pooled);
+
+    static uint32_t _alloc_bytes; // running count of bytes allocated by lua
+
+    static lua_pool _pool; // small allocations
 
-    static void *_heap;
+    static lua_heap _heap;
 };
@@ -40,14 +40,14 @@ void Variometer::update(const float polar_K, const float polar_B, const float po
         _prev_update_time = AP_HAL::micros64();
         new_data = true;
 
-        AP::logger().Write("VAR", "TimeUS,aspd_raw,aspd_filt,alt,roll,raw,filt", "Qffffff",
-                                               AP_HAL::micros64(),
-                                               (double)aspd,
-                                               (double)_aspd_filt,
-                                               (double)alt,
-                                               (double)roll,
-                                               (double)reading,
-                                               (double)filtered_reading);
+        AP_LOGGER_WRITE_PACKED("VAR", "TimeUS,aspd_raw,aspd_filt,alt,roll,raw,filt", nullptr, nullptr, "Qffffff",
+                               AP_HAL::micros64(),
+                               aspd,
+                               _aspd_filt,
+                               alt,
+                               roll,
+                               reading,
+                               filtered_reading);
     }
 }
 
@@ -41,12 +41,30 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
 
     // @Param: SPACING
     // @DisplayName: Terrain grid spacing
-    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the worldwide SRTM database then a resolution of 100 meters is appropriate. Some parts of the world may have higher resolution data available, such as 30 meter data available in the SRTM database in the USA. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be demand loaded as needed.
+    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the worldwide SRTM database then a resolution of 100 meters is appropriate. Some parts of the world may have higher resolution data available, such as 30 meter data available in the SRTM database in the USA. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in each grid square held in memory (see TERRAIN_CACHE_SZ) having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be demand loaded as needed.
     // @Units: m
     // @Increment: 1
     // @User: Advanced
     AP_GROUPINFO("SPACING",   1, AP_Terrain, grid_spacing, 100),
 
+    // @Param: CACHE_SZ
+    // @DisplayName: Terrain memory cache size
+    // @Description: Number of terrain grid blocks kept in memory. Each block uses about 2 kilobytes and covers 28x32 grid points. A larger cache lets more of the flight path be loaded ahead of the vehicle.
+    // @Range: 4 128
+    // @Increment: 1
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("CACHE_SZ",  2, AP_Terrain, config_cache_size, TERRAIN_GRID_BLOCK_CACHE_SIZE),
+
+    // @Param: PREFETCH
+    // @DisplayName: Terrain prefetch time
+    // @Description: Terrain along the vehicle's velocity vector and the next legs of the mission is loaded into memory for this many seconds of flight ahead. Blocks not already on the SD card are requested from the ground station. Zero disables prefetching.
+    // @Units: s
+    // @Range: 0 600
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("PREFETCH",  3, AP_Terrain, prefetch_time, 60),
+
     AP_GROUPEND
 };
 
@@ -114,8 +132,10 @@ bool AP_Terrain::height_amsl(const Location &loc, float &height, bool corrected)
         !check_bitmap(grid, info.idx_x,   info.idx_y+1) ||
         !check_bitmap(grid, info.idx_x+1, info.idx_y) ||
         !check_bitmap(grid, info.idx_x+1, info.idx_y+1)) {
+        cache_stats.misses++;
         return false;
     }
+    cache_stats.hits++;
 
     // hXY are the heights of the 4 surrounding grid points
     int16_t h00, h01, h10, h11;
@@ -320,6 +340,9 @@ void AP_Terrain::update(void)
     // check for pending rally data
     update_rally_data();
 
+    // load terrain ahead of the vehicle
+    update_prefetch();
+
     // update capabilities and status
     if (allocate()) {
         if (!pos_valid) {
@@ -368,6 +391,17 @@ void AP_Terrain::log_terrain_data()
         loaded         : loaded
     };
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
+
+    struct log_TERRAIN_CACHE pkt2 = {
+        LOG_PACKET_HEADER_INIT(LOG_TERRAIN_CACHE_MSG),
+        time_us        : pkt.time_us,
+        cache_size     : cache_size,
+        hits           : cache_stats.hits,
+        misses         : cache_stats.misses,
+        map_loads      : cache_stats.map_loads,
+        prefetched     : cache_stats.prefetched
+    };
+    AP::logger().WriteBlock(&pkt2, sizeof(pkt2));
 }
 
 /*
@@ -382,13 +416,16 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
+    const uint8_t size = constrain_int16(config_cache_size,
+                                         TERRAIN_GRID_BLOCK_CACHE_SIZE_MIN,
+                                         TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX);
+    cache = (struct grid_cache *)calloc(size, sizeof(cache[0]));
     if (cache == nullptr) {
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
         memory_alloc_failed = true;
         return false;
     }
-    cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    cache_size = size;
     return true;
 }
 
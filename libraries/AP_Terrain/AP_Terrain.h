@@ -51,8 +51,27 @@
 #define TERRAIN_GRID_BLOCK_SIZE_X (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_X)
 #define TERRAIN_GRID_BLOCK_SIZE_Y (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_Y)
 
-// number of grid_blocks in the LRU memory cache
+// default number of grid_blocks in the LRU memory cache
+#ifndef TERRAIN_GRID_BLOCK_CACHE_SIZE
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE 32
+#else
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
+#endif
+#endif
+
+// limits on the TERRAIN_CACHE_SZ parameter
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_MIN 4
+#define TERRAIN_GRID_BLOCK_CACHE_SIZE_MAX 128
+
+// have the IO thread load grid_blocks that are already on disk from a
+// memory mapped view of the terrain file rather than seeking and reading
+#ifndef AP_TERRAIN_MMAP_ENABLED
+#define AP_TERRAIN_MMAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
+// number of upcoming mission legs to prefetch terrain along
+#define TERRAIN_PREFETCH_MISSION_LEGS 3
 
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
@@ -319,10 +338,12 @@ private:
       disk IO functions
      */
     int16_t find_io_idx(enum GridCacheState state);
-    uint16_t get_block_crc(struct grid_block &block);
+    uint16_t get_block_crc(const struct grid_block &block) const;
     void check_disk_read(void);
     void check_disk_write(void);
     void io_timer(void);
+    void format_file_name(char *p, int8_t lat_degrees, int16_t lon_degrees) const;
+    uint32_t block_file_offset(const struct grid_block &block) const;
     void open_file(void);
     void seek_offset(void);
     void write_block(void);
@@ -338,10 +359,33 @@ private:
      */
     void update_rally_data(void);
 
+    /*
+      load blocks along the vehicle's path into the cache
+     */
+    struct prefetch_state {
+        uint8_t budget;     // blocks still to be visited this pass
+        int32_t last_lat;   // last block visited
+        int32_t last_lon;
+    };
+    void update_prefetch(void);
+    void prefetch_line(const Location &from, const Location &to, struct prefetch_state &state);
+    void prefetch_block(const Location &loc, struct prefetch_state &state);
+
+#if AP_TERRAIN_MMAP_ENABLED
+    /*
+      memory mapped view of the terrain file, used by the IO thread
+     */
+    bool map_file(int8_t lat_degrees, int16_t lon_degrees, uint32_t min_size);
+    void unmap_file(void);
+    bool read_block_from_map(void);
+#endif
+
 
     // parameters
     AP_Int8  enable;
     AP_Int16 grid_spacing; // meters between grid points
+    AP_Int16 config_cache_size; // number of grid blocks kept in memory
+    AP_Int16 prefetch_time; // seconds of flight ahead to load terrain for
 
     // reference to AP_Mission, so we can ask preload terrain data for 
     // all waypoints
@@ -416,6 +460,33 @@ private:
 
     char *file_path = nullptr;
 
+#if AP_TERRAIN_MMAP_ENABLED
+    // read-only map of one terrain file, owned by the IO thread. The
+    // file is only ever extended, so blocks within the mapped size
+    // stay readable
+    struct {
+        uint8_t *base;
+        size_t size;    // whole blocks mapped
+        int8_t lat_degrees;
+        int16_t lon_degrees;
+        uint32_t last_attempt_ms;
+    } file_map {};
+
+    // set by the IO thread when disk_block came from the map
+    bool disk_block_from_map = false;
+#endif
+
+    // last time blocks ahead of the vehicle were prefetched
+    uint32_t last_prefetch_ms = 0;
+
+    // cache statistics for the TERC log message
+    struct {
+        uint32_t hits;          // height_amsl() lookups with data in memory
+        uint32_t misses;        // height_amsl() lookups without data
+        uint32_t map_loads;     // disk reads served from the mapped file
+        uint32_t prefetched;    // blocks loaded ahead of the vehicle
+    } cache_stats {};
+
     // status
     enum TerrainStatus system_status = TerrainStatusDisabled;
 
@@ -93,7 +93,15 @@ void AP_Terrain::schedule_disk_io(void)
             cache[cache_idx].state = GRID_CACHE_VALID;
             cache[cache_idx].last_access_ms = AP_HAL::millis();
         }
+#if AP_TERRAIN_MMAP_ENABLED
+        if (disk_block_from_map) {
+            cache_stats.map_loads++;
+        }
+#endif
         disk_io_state = DiskIoIdle;
+        // hand over the next read straight away, so a run of misses
+        // doesn't take a main loop per block
+        check_disk_read();
         break;
     }
 
@@ -132,6 +140,19 @@ All file operations are done by the IO thread.
 *********************************************************/
 
 
+/*
+  write the name of a degree file, starting with the path separator,
+  to p. p must have room for 13 bytes
+ */
+void AP_Terrain::format_file_name(char *p, int8_t lat_degrees, int16_t lon_degrees) const
+{
+    snprintf(p, 13, "/%c%02u%c%03u.DAT",
+             lat_degrees<0?'S':'N',
+             (unsigned)MIN(abs((int32_t)lat_degrees), 99),
+             lon_degrees<0?'W':'E',
+             (unsigned)MIN(abs((int32_t)lon_degrees), 999));
+}
+
 /*
   open the current degree file
  */
@@ -164,11 +185,7 @@ void AP_Terrain::open_file(void)
         io_failure = true;
         return;        
     }
-    snprintf(p, 13, "/%c%02u%c%03u.DAT",
-             block.lat_degrees<0?'S':'N',
-             (unsigned)MIN(abs((int32_t)block.lat_degrees), 99),
-             block.lon_degrees<0?'W':'E',
-             (unsigned)MIN(abs((int32_t)block.lon_degrees), 999));
+    format_file_name(p, block.lat_degrees, block.lon_degrees);
 
     // create directory if need be
     if (!directory_created) {
@@ -206,11 +223,10 @@ void AP_Terrain::open_file(void)
 }
 
 /*
-  seek to the right offset for disk_block
+  offset of a block within its degree file
  */
-void AP_Terrain::seek_offset(void)
+uint32_t AP_Terrain::block_file_offset(const struct grid_block &block) const
 {
-    struct grid_block &block = disk_block.block;
     // work out how many longitude blocks there are at this latitude
     Location loc1, loc2;
     loc1.lat = block.lat_degrees*10*1000*1000L;
@@ -223,8 +239,16 @@ void AP_Terrain::seek_offset(void)
     const Vector2f offset = loc1.get_distance_NE(loc2);
     uint16_t east_blocks = offset.y / (grid_spacing*TERRAIN_GRID_BLOCK_SIZE_Y);
 
-    uint32_t file_offset = (east_blocks * block.grid_idx_x + 
-                            block.grid_idx_y) * sizeof(union grid_io_block);
+    return (east_blocks * block.grid_idx_x +
+            block.grid_idx_y) * sizeof(union grid_io_block);
+}
+
+/*
+  seek to the position of disk_block in the current file
+ */
+void AP_Terrain::seek_offset(void)
+{
+    const uint32_t file_offset = block_file_offset(disk_block.block);
     if (AP::FS().lseek(fd, file_offset, SEEK_SET) != (off_t)file_offset) {
 #if TERRAIN_DEBUG
         hal.console->printf("Seek %lu failed - %s\n",
@@ -341,6 +365,14 @@ void AP_Terrain::io_timer(void)
         break;
 
     case DiskIoWaitRead:
+#if AP_TERRAIN_MMAP_ENABLED
+        // blocks already in the file are copied from the map
+        disk_block_from_map = read_block_from_map();
+        if (disk_block_from_map) {
+            disk_io_state = DiskIoDoneRead;
+            break;
+        }
+#endif
         // need to read in the block
         open_file();
         if (fd == -1) {
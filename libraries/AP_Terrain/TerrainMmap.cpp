@@ -0,0 +1,137 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  second tier of the terrain cache: a read-only memory map of the
+  current degree file, so the IO thread can load blocks already on
+  disk with a copy rather than a seek and read. Everything here runs
+  in the IO timer context, like the rest of the file IO
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include "AP_Terrain.h"
+
+#if AP_TERRAIN_AVAILABLE && AP_TERRAIN_MMAP_ENABLED
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+extern const AP_HAL::HAL& hal;
+
+/*
+  map the file for the given degree square, making sure at least
+  min_size bytes are mapped. The file is remapped at most once a
+  second as it grows
+ */
+bool AP_Terrain::map_file(int8_t lat_degrees, int16_t lon_degrees, uint32_t min_size)
+{
+    if (file_map.base != nullptr &&
+        file_map.lat_degrees == lat_degrees &&
+        file_map.lon_degrees == lon_degrees &&
+        file_map.size >= min_size) {
+        return true;
+    }
+
+    const uint32_t now = AP_HAL::millis();
+    if (file_map.last_attempt_ms != 0 && now - file_map.last_attempt_ms < 1000) {
+        return false;
+    }
+    file_map.last_attempt_ms = now;
+
+    unmap_file();
+
+    const char* terrain_dir = hal.util->get_custom_terrain_directory();
+    if (terrain_dir == nullptr) {
+        terrain_dir = HAL_BOARD_TERRAIN_DIRECTORY;
+    }
+    char *path = nullptr;
+    if (asprintf(&path, "%s/NxxExxx.DAT", terrain_dir) <= 0) {
+        return false;
+    }
+    format_file_name(&path[strlen(path)-12], lat_degrees, lon_degrees);
+    int map_fd = ::open(path, O_RDONLY|O_CLOEXEC);
+    free(path);
+    if (map_fd == -1) {
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(map_fd, &st) != 0) {
+        ::close(map_fd);
+        return false;
+    }
+    // only whole blocks are mapped
+    const size_t size = st.st_size - (st.st_size % sizeof(union grid_io_block));
+    if (size == 0 || size < min_size) {
+        ::close(map_fd);
+        return false;
+    }
+
+    void *base = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, map_fd, 0);
+    // the mapping holds its own reference to the file
+    ::close(map_fd);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+    // start reading the file in now rather than page by page
+    ::madvise(base, size, MADV_WILLNEED);
+
+    file_map.base = (uint8_t *)base;
+    file_map.size = size;
+    file_map.lat_degrees = lat_degrees;
+    file_map.lon_degrees = lon_degrees;
+    return true;
+}
+
+void AP_Terrain::unmap_file(void)
+{
+    if (file_map.base != nullptr) {
+        ::munmap(file_map.base, file_map.size);
+        file_map.base = nullptr;
+        file_map.size = 0;
+    }
+}
+
+/*
+  fill disk_block from the mapped file. Returns false if the block
+  is not in the file, in which case the normal disk read is used
+ */
+bool AP_Terrain::read_block_from_map(void)
+{
+    const struct grid_block &block = disk_block.block;
+    const uint32_t offset = block_file_offset(block);
+    if (!map_file(block.lat_degrees, block.lon_degrees, offset + sizeof(union grid_io_block))) {
+        return false;
+    }
+
+    const struct grid_block &mapped = *(const struct grid_block *)&file_map.base[offset];
+    if (mapped.lat != block.lat ||
+        mapped.lon != block.lon ||
+        mapped.bitmap == 0 ||
+        mapped.spacing != grid_spacing ||
+        mapped.version != TERRAIN_GRID_FORMAT_VERSION ||
+        mapped.crc != get_block_crc(mapped)) {
+        return false;
+    }
+
+    memcpy(&disk_block, &file_map.base[offset], sizeof(disk_block));
+    return true;
+}
+
+#endif // AP_TERRAIN_AVAILABLE && AP_TERRAIN_MMAP_ENABLED
@@ -0,0 +1,140 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  load terrain blocks along the vehicle's path into the cache before
+  they are needed
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_AHRS/AP_AHRS.h>
+#include "AP_Terrain.h"
+
+#if AP_TERRAIN_AVAILABLE
+
+extern const AP_HAL::HAL& hal;
+
+/*
+  once a second, walk the path the vehicle is expected to fly over
+  the next TERRAIN_PREFETCH seconds and the next few mission legs,
+  bringing each block into the cache. Blocks not in memory are read
+  from disk (or the mapped file), and blocks not on disk are then
+  requested from the GCS by send_request()
+ */
+void AP_Terrain::update_prefetch(void)
+{
+    if (prefetch_time <= 0 || grid_spacing <= 0 || !allocate()) {
+        return;
+    }
+    const uint32_t now = AP_HAL::millis();
+    if (now - last_prefetch_ms < 1000) {
+        return;
+    }
+    last_prefetch_ms = now;
+
+    AP_AHRS &ahrs = AP::ahrs();
+    Location loc;
+    if (!ahrs.get_position(loc)) {
+        return;
+    }
+
+    // only visit half of the cache each pass, so the blocks around
+    // the vehicle are never pushed out by blocks further ahead
+    struct prefetch_state state {};
+    state.budget = cache_size / 2;
+
+    // along the velocity vector
+    const Vector2f ground_vel = ahrs.groundspeed_vector() * prefetch_time;
+    if (ground_vel.length() > grid_spacing) {
+        Location end = loc;
+        end.offset(ground_vel.x, ground_vel.y);
+        prefetch_line(loc, end, state);
+    }
+
+    // along the next legs of the mission
+    if (mission.state() != AP_Mission::MISSION_RUNNING) {
+        return;
+    }
+    Location from = loc;
+    uint8_t legs = 0;
+    for (uint16_t i=mission.get_current_nav_index();
+         i < mission.num_commands() && legs < TERRAIN_PREFETCH_MISSION_LEGS && state.budget > 0;
+         i++) {
+        AP_Mission::Mission_Command cmd;
+        if (!mission.read_cmd_from_storage(i, cmd) ||
+            !AP_Mission::is_nav_cmd(cmd) ||
+            (cmd.content.location.lat == 0 && cmd.content.location.lng == 0)) {
+            continue;
+        }
+        prefetch_line(from, cmd.content.location, state);
+        from = cmd.content.location;
+        legs++;
+    }
+}
+
+/*
+  bring the blocks along a line into the cache, stepping half a block
+  at a time so that no block on the line is missed
+ */
+void AP_Terrain::prefetch_line(const Location &from, const Location &to, struct prefetch_state &state)
+{
+    const float distance = from.get_distance(to);
+    const float bearing = from.get_bearing_to(to) * 0.01f;
+    const float step = 0.5f * grid_spacing * MIN(TERRAIN_GRID_BLOCK_SPACING_X, TERRAIN_GRID_BLOCK_SPACING_Y);
+    for (float d=0; d < distance && state.budget > 0; d += step) {
+        Location loc = from;
+        loc.offset_bearing(bearing, d);
+        prefetch_block(loc, state);
+    }
+    prefetch_block(to, state);
+}
+
+/*
+  bring the block holding loc into the cache
+ */
+void AP_Terrain::prefetch_block(const Location &loc, struct prefetch_state &state)
+{
+    if (state.budget == 0) {
+        return;
+    }
+    struct grid_info info;
+    calculate_grid_info(loc, info);
+    if (info.grid_lat == state.last_lat && info.grid_lon == state.last_lon) {
+        return;
+    }
+    state.last_lat = info.grid_lat;
+    state.last_lon = info.grid_lon;
+    state.budget--;
+
+    bool cached = false;
+    for (uint16_t i=0; i<cache_size; i++) {
+        if (cache[i].grid.lat == info.grid_lat &&
+            cache[i].grid.lon == info.grid_lon &&
+            cache[i].grid.spacing == grid_spacing) {
+            cached = true;
+            break;
+        }
+    }
+    if (!cached) {
+        cache_stats.prefetched++;
+    }
+
+    // also refreshes the access time of a cached block, so blocks
+    // ahead of the vehicle are kept
+    find_grid_cache(info);
+}
+
+#endif // AP_TERRAIN_AVAILABLE
@@ -171,13 +171,16 @@ int16_t AP_Terrain::find_io_idx(enum GridCacheState state)
 /*
   get CRC for a block
  */
-uint16_t AP_Terrain::get_block_crc(struct grid_block &block)
+uint16_t AP_Terrain::get_block_crc(const struct grid_block &block) const
 {
-    uint16_t saved_crc = block.crc;
-    block.crc = 0;
-    uint16_t ret = crc16_ccitt((const uint8_t *)&block, sizeof(block), 0);
-    block.crc = saved_crc;
-    return ret;
+    // taken as if crc were zero, without writing to the block, so a
+    // block in the read-only file map can be checked in place
+    const uint8_t *p = (const uint8_t *)&block;
+    const uint8_t zero[sizeof(block.crc)] {};
+    const uint32_t crc_end = offsetof(struct grid_block, crc) + sizeof(block.crc);
+    uint16_t ret = crc16_ccitt(p, offsetof(struct grid_block, crc), 0);
+    ret = crc16_ccitt(zero, sizeof(zero), ret);
+    return crc16_ccitt(&p[crc_end], sizeof(block) - crc_end, ret);
 }
 
 #endif // AP_TERRAIN_AVAILABLE
@@ -0,0 +1,203 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BiquadBank.h"
+#include "NotchFilter.h"
+#include "LowPassFilter2p.h"
+
+#include <string.h>
+
+/*
+  vector operations on BIQUADBANK_VECTOR_LANES lanes. Only separate
+  multiplies and adds are used, never fused multiply-add, so each lane
+  rounds exactly as the scalar filters do
+ */
+#if defined(__SSE__)
+#include <xmmintrin.h>
+typedef __m128 bq_vec;
+static inline bq_vec bq_load(const float *p) { return _mm_loadu_ps(p); }
+static inline void bq_store(float *p, bq_vec v) { _mm_storeu_ps(p, v); }
+static inline bq_vec bq_splat(float f) { return _mm_set1_ps(f); }
+static inline bq_vec bq_add(bq_vec a, bq_vec b) { return _mm_add_ps(a, b); }
+static inline bq_vec bq_sub(bq_vec a, bq_vec b) { return _mm_sub_ps(a, b); }
+static inline bq_vec bq_mul(bq_vec a, bq_vec b) { return _mm_mul_ps(a, b); }
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+typedef float32x4_t bq_vec;
+static inline bq_vec bq_load(const float *p) { return vld1q_f32(p); }
+static inline void bq_store(float *p, bq_vec v) { vst1q_f32(p, v); }
+static inline bq_vec bq_splat(float f) { return vdupq_n_f32(f); }
+static inline bq_vec bq_add(bq_vec a, bq_vec b) { return vaddq_f32(a, b); }
+static inline bq_vec bq_sub(bq_vec a, bq_vec b) { return vsubq_f32(a, b); }
+static inline bq_vec bq_mul(bq_vec a, bq_vec b) { return vmulq_f32(a, b); }
+#else
+// one lane at a time, so a Vector3f is three iterations rather than a
+// padded four on microcontrollers without a vector unit
+typedef float bq_vec;
+static inline bq_vec bq_load(const float *p) { return *p; }
+static inline void bq_store(float *p, bq_vec v) { *p = v; }
+static inline bq_vec bq_splat(float f) { return f; }
+static inline bq_vec bq_add(bq_vec a, bq_vec b) { return a + b; }
+static inline bq_vec bq_sub(bq_vec a, bq_vec b) { return a - b; }
+static inline bq_vec bq_mul(bq_vec a, bq_vec b) { return a * b; }
+#endif
+
+template <class T>
+BiquadBank<T>::~BiquadBank()
+{
+    delete[] _stages;
+}
+
+template <class T>
+bool BiquadBank<T>::allocate(uint8_t num_stages)
+{
+    delete[] _stages;
+    _num_stages = 0;
+    _num_active = 0;
+    if (num_stages == 0) {
+        _stages = nullptr;
+        return true;
+    }
+    // new zeroes the stages, so they start as PASS_THROUGH with no state
+    _stages = new Stage[num_stages];
+    if (_stages == nullptr) {
+        return false;
+    }
+    _num_stages = num_stages;
+    return true;
+}
+
+template <class T>
+void BiquadBank<T>::set_notch(uint8_t stage, float sample_freq_hz, float center_freq_hz, float A, float Q)
+{
+    if (stage >= _num_stages) {
+        return;
+    }
+    Stage &s = _stages[stage];
+    NotchFilter<float> notch;
+    notch.init_with_A_and_Q(sample_freq_hz, center_freq_hz, A, Q);
+    s.form = Form::DIRECT_1;
+    if (!notch.initialised) {
+        // NotchFilter passes the sample through but keeps its history,
+        // which these coefficients do too
+        s.b0 = 1;
+        s.b1 = s.b2 = s.a1 = s.a2 = 0;
+        s.a0_inv = 1;
+        return;
+    }
+    s.b0 = notch.b0;
+    s.b1 = notch.b1;
+    s.b2 = notch.b2;
+    s.a1 = notch.a1;
+    s.a2 = notch.a2;
+    s.a0_inv = notch.a0_inv;
+}
+
+template <class T>
+void BiquadBank<T>::set_low_pass(uint8_t stage, float sample_freq_hz, float cutoff_freq_hz)
+{
+    if (stage >= _num_stages) {
+        return;
+    }
+    Stage &s = _stages[stage];
+    struct DigitalBiquadFilter<float>::biquad_params params {};
+    DigitalBiquadFilter<float>::compute_params(sample_freq_hz, cutoff_freq_hz, params);
+    if (is_zero(params.cutoff_freq) || is_zero(params.sample_freq)) {
+        // DigitalBiquadFilter leaves its state alone in this case
+        s.form = Form::PASS_THROUGH;
+        return;
+    }
+    s.form = Form::DIRECT_2;
+    s.b0 = params.b0;
+    s.b1 = params.b1;
+    s.b2 = params.b2;
+    s.a1 = params.a1;
+    s.a2 = params.a2;
+    s.a0_inv = 1;
+}
+
+/*
+  apply a sample to each active stage, all components at once. The
+  order of operations matches NotchFilter::apply() and
+  DigitalBiquadFilter::apply() so results are bit-identical to them
+ */
+template <class T>
+T BiquadBank<T>::apply(const T &sample)
+{
+    float v[lanes] {};
+    memcpy(v, &sample, sizeof(T));
+
+    for (uint8_t i = 0; i < _num_active; i++) {
+        Stage &s = _stages[i];
+        if (s.form == Form::PASS_THROUGH) {
+            continue;
+        }
+        const bq_vec b0 = bq_splat(s.b0);
+        const bq_vec b1 = bq_splat(s.b1);
+        const bq_vec b2 = bq_splat(s.b2);
+        const bq_vec a1 = bq_splat(s.a1);
+        const bq_vec a2 = bq_splat(s.a2);
+        if (s.form == Form::DIRECT_1) {
+            const bq_vec a0_inv = bq_splat(s.a0_inv);
+            for (uint8_t l = 0; l < lanes; l += BIQUADBANK_VECTOR_LANES) {
+                const bq_vec x0 = bq_load(&v[l]);
+                const bq_vec x1 = bq_load(&s.state[0][l]);
+                const bq_vec x2 = bq_load(&s.state[1][l]);
+                const bq_vec y1 = bq_load(&s.state[2][l]);
+                const bq_vec y2 = bq_load(&s.state[3][l]);
+                bq_vec y0 = bq_add(bq_mul(x0, b0), bq_mul(x1, b1));
+                y0 = bq_add(y0, bq_mul(x2, b2));
+                y0 = bq_sub(y0, bq_mul(y1, a1));
+                y0 = bq_sub(y0, bq_mul(y2, a2));
+                y0 = bq_mul(y0, a0_inv);
+                bq_store(&s.state[1][l], x1);
+                bq_store(&s.state[0][l], x0);
+                bq_store(&s.state[3][l], y1);
+                bq_store(&s.state[2][l], y0);
+                bq_store(&v[l], y0);
+            }
+        } else {
+            for (uint8_t l = 0; l < lanes; l += BIQUADBANK_VECTOR_LANES) {
+                const bq_vec x0 = bq_load(&v[l]);
+                const bq_vec w1 = bq_load(&s.state[0][l]);
+                const bq_vec w2 = bq_load(&s.state[1][l]);
+                const bq_vec w0 = bq_sub(bq_sub(x0, bq_mul(w1, a1)), bq_mul(w2, a2));
+                bq_vec y0 = bq_add(bq_mul(w0, b0), bq_mul(w1, b1));
+                y0 = bq_add(y0, bq_mul(w2, b2));
+                bq_store(&s.state[1][l], w1);
+                bq_store(&s.state[0][l], w0);
+                bq_store(&v[l], y0);
+            }
+        }
+    }
+
+    T output;
+    memcpy(&output, v, sizeof(T));
+    return output;
+}
+
+template <class T>
+void BiquadBank<T>::reset(void)
+{
+    for (uint8_t i = 0; i < _num_stages; i++) {
+        memset(_stages[i].state, 0, sizeof(_stages[i].state));
+    }
+}
+
+/*
+   instantiate template classes
+ */
+template class BiquadBank<float>;
+template class BiquadBank<Vector3f>;
@@ -0,0 +1,87 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <AP_Math/AP_Math.h>
+#include <inttypes.h>
+
+// lanes evaluated at once
+#if defined(__SSE__) || defined(__ARM_NEON)
+#define BIQUADBANK_VECTOR_LANES 4
+#else
+#define BIQUADBANK_VECTOR_LANES 1
+#endif
+
+/*
+  a cascade of biquad filters applied to each component of a sample
+  in one pass.
+
+  The filter state is held as structure of arrays, one lane per
+  component of T, so that each stage is evaluated for all components
+  at once with SSE on x86 and NEON on ARM application processors,
+  where the lanes are padded to a multiple of four. Elsewhere there is
+  no padding and each lane is a scalar loop iteration.
+  Each stage gives the same output as the filter it replaces:
+  NotchFilter (direct form I) or LowPassFilter2p (direct form II)
+ */
+template <class T>
+class BiquadBank {
+public:
+    ~BiquadBank();
+
+    // allocate num_stages stages, all passing samples through.
+    // Returns false on allocation failure
+    bool allocate(uint8_t num_stages);
+    uint8_t num_stages(void) const { return _num_stages; }
+
+    // set a stage to a notch filter, as NotchFilter::init_with_A_and_Q()
+    void set_notch(uint8_t stage, float sample_freq_hz, float center_freq_hz, float A, float Q);
+
+    // set a stage to a second order low pass filter, as LowPassFilter2p
+    void set_low_pass(uint8_t stage, float sample_freq_hz, float cutoff_freq_hz);
+
+    // apply only the first num_active stages
+    void set_num_active(uint8_t num_active) { _num_active = MIN(num_active, _num_stages); }
+
+    // apply a sample to each active stage in turn
+    T apply(const T &sample);
+
+    // zero the state of all stages
+    void reset(void);
+
+private:
+    // lanes for the components of T, rounded up to whole vectors
+    static constexpr uint8_t lanes = ((sizeof(T) / sizeof(float)) + BIQUADBANK_VECTOR_LANES - 1) /
+        BIQUADBANK_VECTOR_LANES * BIQUADBANK_VECTOR_LANES;
+
+    enum class Form : uint8_t {
+        PASS_THROUGH,
+        DIRECT_1,           // state is x[n-1], x[n-2], y[n-1], y[n-2]
+        DIRECT_2,           // state is w[n-1], w[n-2]
+    };
+
+    struct Stage {
+        float b0, b1, b2, a1, a2, a0_inv;
+        Form form;
+        float state[4][lanes];
+    };
+
+    Stage *_stages = nullptr;
+    uint8_t _num_stages = 0;
+    uint8_t _num_active = 0;
+};
+
+typedef BiquadBank<float> BiquadBankFloat;
+typedef BiquadBank<Vector3f> BiquadBankVector3f;
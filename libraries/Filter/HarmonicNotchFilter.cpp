@@ -63,7 +63,7 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
 
     // @Param: REF
     // @DisplayName: Harmonic Notch Filter reference value
-    // @Description: A reference value of zero disables dynamic updates on the Harmonic Notch Filter and a positive value enables dynamic updates on the Harmonic Notch Filter.  For throttle-based scaling, this parameter is the reference value associated with the specified frequency to facilitate frequency scaling of the Harmonic Notch Filter. For RPM and ESC telemetry based tracking, this parameter is set to 1 to enable the Harmonic Notch Filter using the RPM sensor or ESC telemetry set to measure rotor speed.  The sensor data is converted to Hz automatically for use in the Harmonic Notch Filter.  This reference value may also be used to scale the sensor data, if required.  For example, rpm sensor data is required to measure heli motor RPM. Therefore the reference value can be used to scale the RPM sensor to the rotor RPM.
+    // @Description: A reference value of zero disables dynamic updates on the Harmonic Notch Filter and a positive value enables dynamic updates on the Harmonic Notch Filter.  For throttle-based scaling, this parameter is the reference value associated with the specified frequency to facilitate frequency scaling of the Harmonic Notch Filter. For RPM, ESC telemetry and gyro FFT based tracking, this parameter is set to 1 to enable the Harmonic Notch Filter using the RPM sensor or ESC telemetry set to measure rotor speed.  The sensor data is converted to Hz automatically for use in the Harmonic Notch Filter.  This reference value may also be used to scale the sensor data, if required.  For example, rpm sensor data is required to measure heli motor RPM. Therefore the reference value can be used to scale the RPM sensor to the rotor RPM.
     // @User: Advanced
     // @Range: 0.0 1.0
     // @RebootRequired: True
@@ -71,9 +71,9 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
 
     // @Param: MODE
     // @DisplayName: Harmonic Notch Filter dynamic frequency tracking mode
-    // @Description: Harmonic Notch Filter dynamic frequency tracking mode. Dynamic updates can be throttle, RPM sensor or ESC telemetry based. Throttle-based updates should only be used with multicopters.
-    // @Range: 0 3
-    // @Values: 0:Disabled,1:Throttle,2:RPM Sensor,3:ESC Telemetry
+    // @Description: Harmonic Notch Filter dynamic frequency tracking mode. Dynamic updates can be throttle, RPM sensor, ESC telemetry or gyro FFT based. Throttle-based updates should only be used with multicopters. FFT-based updates need INS_FFT_ENABLE set.
+    // @Range: 0 4
+    // @Values: 0:Disabled,1:Throttle,2:RPM Sensor,3:ESC Telemetry,4:In-Flight FFT
     // @User: Advanced
     AP_GROUPINFO("MODE", 7, HarmonicNotchFilterParams, _tracking_mode, 1),
 
@@ -85,7 +85,6 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
  */
 template <class T>
 HarmonicNotchFilter<T>::~HarmonicNotchFilter() {
-    delete[] _filters;
     _num_filters = 0;
     _num_enabled_filters = 0;
 }
@@ -98,7 +97,7 @@ template <class T>
 void HarmonicNotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, float bandwidth_hz, float attenuation_dB)
 {
     // sanity check the input
-    if (_filters == nullptr || is_zero(sample_freq_hz) || isnan(sample_freq_hz)) {
+    if (_filters.num_stages() == 0 || is_zero(sample_freq_hz) || isnan(sample_freq_hz)) {
         return;
     }
 
@@ -118,12 +117,13 @@ void HarmonicNotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, fl
         if ((1U<<i) & _harmonics) {
             // only enable the filter if its center frequency is below the nyquist frequency
             if (notch_center < nyquist_limit) {
-                _filters[filt].init_with_A_and_Q(sample_freq_hz, notch_center, _A, _Q);
+                _filters.set_notch(filt, sample_freq_hz, notch_center, _A, _Q);
                 _num_enabled_filters++;
             }
             filt++;
         }
     }
+    _filters.set_num_active(_num_enabled_filters);
     _initialised = true;
 }
 
@@ -139,9 +139,8 @@ void HarmonicNotchFilter<T>::allocate_filters(uint8_t harmonics)
         }
     }
     if (_num_filters > 0) {
-        _filters = new NotchFilter<T>[_num_filters];
-        if (_filters == nullptr) {
-            gcs().send_text(MAV_SEVERITY_WARNING, "Failed to allocate %u bytes for HarmonicNotchFilter", (unsigned int)(_num_filters * sizeof(NotchFilter<T>)));
+        if (!_filters.allocate(_num_filters)) {
+            gcs().send_text(MAV_SEVERITY_WARNING, "Failed to allocate %u notch filters for HarmonicNotchFilter", (unsigned int)_num_filters);
             _num_filters = 0;
         }
 
@@ -171,12 +170,13 @@ void HarmonicNotchFilter<T>::update(float center_freq_hz)
         if ((1U<<i) & _harmonics) {
             // only enable the filter if its center frequency is below the nyquist frequency
             if (notch_center < nyquist_limit) {
-                _filters[filt].init_with_A_and_Q(_sample_freq_hz, notch_center, _A, _Q);
+                _filters.set_notch(filt, _sample_freq_hz, notch_center, _A, _Q);
                 _num_enabled_filters++;
             }
             filt++;
         }
     }
+    _filters.set_num_active(_num_enabled_filters);
 }
 
 /*
@@ -189,11 +189,7 @@ T HarmonicNotchFilter<T>::apply(const T &sample)
         return sample;
     }
 
-    T output = sample;
-    for (uint8_t i = 0; i < _num_enabled_filters; i++) {
-        output = _filters[i].apply(output);
-    }
-    return output;
+    return _filters.apply(sample);
 }
 
 /*
@@ -206,9 +202,7 @@ void HarmonicNotchFilter<T>::reset()
         return;
     }
 
-    for (uint8_t i = 0; i < _num_filters; i++) {
-        _filters[i].reset();
-    }
+    _filters.reset();
 }
 
 /*
@@ -18,6 +18,7 @@
 #include <cmath>
 #include <AP_Param/AP_Param.h>
 #include "NotchFilter.h"
+#include "BiquadBank.h"
 
 /*
   a filter that manages a set of notch filters targetted at a fundamental center frequency
@@ -39,8 +40,8 @@ public:
     void reset();
 
 private:
-    // underlying bank of notch filters
-    NotchFilter<T>*  _filters;
+    // underlying bank of notch filters, one stage per harmonic
+    BiquadBank<T> _filters;
     // sample frequency for each filter
     float _sample_freq_hz;
     // attenuation for each filter
@@ -62,6 +63,7 @@ enum class HarmonicNotchDynamicMode {
     UpdateThrottle  = 1,
     UpdateRPM       = 2,
     UpdateBLHeli    = 3,
+    UpdateFFT       = 4,
 };
 
 /*
@@ -39,6 +39,8 @@ public:
     static void calculate_A_and_Q(float center_freq_hz, float bandwidth_hz, float attenuation_dB, float& A, float& Q); 
 
 private:
+    // BiquadBank takes its notch coefficients from here
+    template <class U> friend class BiquadBank;
 
     bool initialised;
     float b0, b1, b2, a1, a2, a0_inv;
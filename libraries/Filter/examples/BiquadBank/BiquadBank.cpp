@@ -0,0 +1,102 @@
+/*
+ *       Example sketch to time BiquadBank against the filters it replaces,
+ *       on a gyro filter chain of a low pass filter and three harmonic
+ *       notches for each of three IMUs
+ */
+
+#include <AP_HAL/AP_HAL.h>
+#include <Filter/BiquadBank.h>
+#include <Filter/NotchFilter.h>
+#include <Filter/LowPassFilter2p.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define SAMPLE_FREQ     1000.0f
+#define LPF_FREQ        80.0f
+#define NOTCH_FREQ      90.0f
+#define NUM_IMUS        3
+#define NUM_NOTCHES     3
+#define NUM_SAMPLES     20000
+
+static LowPassFilter2pVector3f lpf[NUM_IMUS];
+static NotchFilterVector3f notch[NUM_IMUS][NUM_NOTCHES];
+static BiquadBankVector3f bank[NUM_IMUS];
+
+static Vector3f samples[NUM_SAMPLES];
+static Vector3f filters_out[NUM_SAMPLES];
+static Vector3f bank_out[NUM_SAMPLES];
+
+void setup()
+{
+    hal.console->printf("BiquadBank timing test\n\n");
+
+    float A, Q;
+    NotchFilterVector3f::calculate_A_and_Q(NOTCH_FREQ, 40, 40, A, Q);
+    for (uint8_t imu = 0; imu < NUM_IMUS; imu++) {
+        lpf[imu].set_cutoff_frequency(SAMPLE_FREQ, LPF_FREQ);
+        if (!bank[imu].allocate(NUM_NOTCHES+1)) {
+            AP_HAL::panic("Failed to allocate BiquadBank");
+        }
+        bank[imu].set_low_pass(0, SAMPLE_FREQ, LPF_FREQ);
+        for (uint8_t i = 0; i < NUM_NOTCHES; i++) {
+            notch[imu][i].init_with_A_and_Q(SAMPLE_FREQ, NOTCH_FREQ * (i+1), A, Q);
+            bank[imu].set_notch(i+1, SAMPLE_FREQ, NOTCH_FREQ * (i+1), A, Q);
+        }
+        bank[imu].set_num_active(NUM_NOTCHES+1);
+    }
+
+    // motor noise at the notch frequencies on top of a slow rotation
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        const float t = i / SAMPLE_FREQ;
+        const float noise = sinf(M_2PI * NOTCH_FREQ * t) + 0.5f * sinf(M_2PI * 2 * NOTCH_FREQ * t);
+        samples[i] = Vector3f(0.3f + noise, -0.2f + 0.7f * noise, 0.1f - noise);
+    }
+}
+
+void loop()
+{
+    for (uint8_t imu = 0; imu < NUM_IMUS; imu++) {
+        lpf[imu].reset();
+        for (uint8_t i = 0; i < NUM_NOTCHES; i++) {
+            notch[imu][i].reset();
+        }
+        bank[imu].reset();
+    }
+
+    uint32_t start_us = AP_HAL::micros();
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        for (uint8_t imu = 0; imu < NUM_IMUS; imu++) {
+            Vector3f v = lpf[imu].apply(samples[i]);
+            for (uint8_t n = 0; n < NUM_NOTCHES; n++) {
+                v = notch[imu][n].apply(v);
+            }
+            filters_out[i] = v;
+        }
+    }
+    const uint32_t filters_us = AP_HAL::micros() - start_us;
+
+    start_us = AP_HAL::micros();
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        for (uint8_t imu = 0; imu < NUM_IMUS; imu++) {
+            bank_out[i] = bank[imu].apply(samples[i]);
+        }
+    }
+    const uint32_t bank_us = AP_HAL::micros() - start_us;
+
+    float max_error = 0;
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+        max_error = MAX(max_error, (filters_out[i] - bank_out[i]).length());
+    }
+
+    hal.console->printf("filters %.1fns bank %.1fns per sample, max error %g\n",
+                        (double)(filters_us * 1000.0f / (NUM_SAMPLES * NUM_IMUS)),
+                        (double)(bank_us * 1000.0f / (NUM_SAMPLES * NUM_IMUS)),
+                        (double)max_error);
+
+    hal.scheduler->delay(1000);
+}
+
+AP_HAL_MAIN();
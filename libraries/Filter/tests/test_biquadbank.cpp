@@ -0,0 +1,94 @@
+#include <AP_gtest.h>
+
+#include <Filter/BiquadBank.h>
+#include <Filter/NotchFilter.h>
+#include <Filter/LowPassFilter2p.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define SAMPLE_FREQ 1000.0f
+#define NUM_NOTCHES 3
+
+static uint32_t rand_state;
+
+static float rand_float(float min, float max)
+{
+    rand_state = rand_state * 1664525U + 1013904223U;
+    return min + (max - min) * ((rand_state >> 8) * (1.0f / (1U<<24)));
+}
+
+static Vector3f rand_sample()
+{
+    return Vector3f(rand_float(-5, 5), rand_float(-1, 1), rand_float(-50, 50));
+}
+
+static void set_notches(NotchFilter<Vector3f> *notch, BiquadBank<Vector3f> &bank, float center_freq_hz)
+{
+    float A, Q;
+    NotchFilter<Vector3f>::calculate_A_and_Q(center_freq_hz, 40, 40, A, Q);
+    for (uint8_t i = 0; i < NUM_NOTCHES; i++) {
+        notch[i].init_with_A_and_Q(SAMPLE_FREQ, center_freq_hz * (i+1), A, Q);
+        bank.set_notch(i+1, SAMPLE_FREQ, center_freq_hz * (i+1), A, Q);
+    }
+}
+
+// the bank must give exactly the output of the filters it replaces
+TEST(BiquadBank, MatchesFilters)
+{
+    LowPassFilter2p<Vector3f> lpf(SAMPLE_FREQ, 80);
+    NotchFilter<Vector3f> notch[NUM_NOTCHES] {};
+    BiquadBank<Vector3f> bank;
+    ASSERT_TRUE(bank.allocate(NUM_NOTCHES+1));
+    bank.set_low_pass(0, SAMPLE_FREQ, 80);
+    bank.set_num_active(NUM_NOTCHES+1);
+
+    rand_state = 1;
+    // the third harmonic of 180Hz is above nyquist, so passes through
+    const float center_freq_hz[] = { 80, 120, 180 };
+    for (const float freq : center_freq_hz) {
+        set_notches(notch, bank, freq);
+        for (uint16_t i = 0; i < 5000; i++) {
+            const Vector3f sample = rand_sample();
+            Vector3f expected = lpf.apply(sample);
+            for (uint8_t n = 0; n < NUM_NOTCHES; n++) {
+                expected = notch[n].apply(expected);
+            }
+            const Vector3f output = bank.apply(sample);
+            EXPECT_EQ(expected.x, output.x);
+            EXPECT_EQ(expected.y, output.y);
+            EXPECT_EQ(expected.z, output.z);
+        }
+    }
+}
+
+TEST(BiquadBank, PassThrough)
+{
+    BiquadBank<float> bank;
+    ASSERT_TRUE(bank.allocate(2));
+    bank.set_num_active(2);
+    // unset stages and a zero cutoff low pass leave samples alone
+    bank.set_low_pass(1, SAMPLE_FREQ, 0);
+    EXPECT_EQ(1.5f, bank.apply(1.5f));
+
+    // only active stages are applied
+    bank.set_low_pass(1, SAMPLE_FREQ, 10);
+    bank.set_num_active(1);
+    EXPECT_EQ(2.5f, bank.apply(2.5f));
+}
+
+TEST(BiquadBank, Reset)
+{
+    BiquadBank<Vector3f> bank;
+    ASSERT_TRUE(bank.allocate(1));
+    bank.set_low_pass(0, SAMPLE_FREQ, 20);
+    bank.set_num_active(1);
+    const Vector3f first = bank.apply(Vector3f(1, 2, 3));
+    bank.apply(Vector3f(4, 5, 6));
+    bank.reset();
+    const Vector3f output = bank.apply(Vector3f(1, 2, 3));
+    EXPECT_EQ(first.x, output.x);
+    EXPECT_EQ(first.y, output.y);
+    EXPECT_EQ(first.z, output.z);
+}
+
+AP_GTEST_MAIN()
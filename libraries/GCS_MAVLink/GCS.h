@@ -249,6 +249,9 @@ public:
     // don't get broadcast packets or forwarded packets
     static void set_channel_private(mavlink_channel_t chan);
 
+    // return a bitmap of private channels
+    static uint8_t private_channel_mask(void) { return mavlink_private; }
+
     // return true if channel is private
     static bool is_private(mavlink_channel_t _chan) {
         return (mavlink_private & (1U<<(unsigned)_chan)) != 0;
@@ -634,6 +637,12 @@ private:
     // have we registered the IO timer callback?
     static bool param_timer_registered;
 
+    // save statistics are logged after a burst of PARAM_SETs, once no
+    // PARAM_SET has arrived for a while. This is the time of the last
+    // one in the current burst, or zero if there isn't one
+    static uint32_t param_set_burst_ms;
+    static void update_param_set_burst(void);
+
     // IO timer callback for parameters
     void param_io_timer(void);
 
@@ -771,6 +780,10 @@ private:
         bool active;
     } alternative;
 
+    // handle received bytes
+    bool receive_byte(uint8_t c, uint32_t now_ms, mavlink_message_t &msg, mavlink_status_t &status);
+    uint32_t receive_block(const uint8_t *buf, uint32_t len, uint32_t now_ms, mavlink_message_t &msg, mavlink_status_t &status);
+
     JitterCorrection lag_correction;
     
     // we cache the current location and send it even if the AHRS has
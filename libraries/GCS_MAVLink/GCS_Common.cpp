@@ -1306,6 +1306,82 @@ void GCS_MAVLINK::packetReceived(const mavlink_status_t &status,
     handleMessage(msg);
 }
 
+/*
+  handle one received byte. Returns true if it completed a MAVLink
+  packet
+ */
+bool GCS_MAVLINK::receive_byte(uint8_t c, uint32_t now_ms, mavlink_message_t &msg, mavlink_status_t &status)
+{
+    const uint32_t protocol_timeout = 4000;
+
+    if (alternative.handler &&
+        now_ms - alternative.last_mavlink_ms > protocol_timeout) {
+        /*
+          we have an alternative protocol handler installed and we
+          haven't parsed a MAVLink packet for 4 seconds. Try
+          parsing using alternative handler
+         */
+        if (alternative.handler(c, mavlink_comm_port[chan])) {
+            alternative.last_alternate_ms = now_ms;
+            gcs_alternative_active[chan] = true;
+        }
+
+        /*
+          we may also try parsing as MAVLink if we haven't had a
+          successful parse on the alternative protocol for 4s
+         */
+        if (now_ms - alternative.last_alternate_ms <= protocol_timeout) {
+            return false;
+        }
+    }
+
+    // Try to get a new message
+    if (!mavlink_parse_char(chan, c, &msg, &status)) {
+        return false;
+    }
+
+    hal.util->persistent_data.last_mavlink_msgid = msg.msgid;
+    hal.util->perf_begin(_perf_packet);
+    packetReceived(status, msg);
+    hal.util->perf_end(_perf_packet);
+    gcs_alternative_active[chan] = false;
+    alternative.last_mavlink_ms = now_ms;
+    hal.util->persistent_data.last_mavlink_msgid = 0;
+    return true;
+}
+
+/*
+  handle a block of received bytes, returning the number used. This
+  stops after the first complete packet, as handling it may change
+  the port's receive buffer.
+
+  Between packets the MAVLink parser ignores everything except a start
+  byte, so when no alternative protocol handler needs to see the bytes
+  the block is scanned for the next start byte rather than fed through
+  the parser byte by byte. Frames themselves still go through
+  mavlink_parse_char(), which does the length, CRC, signing and
+  per-channel stats checks; they are not validated here
+ */
+uint32_t GCS_MAVLINK::receive_block(const uint8_t *buf, uint32_t len, uint32_t now_ms, mavlink_message_t &msg, mavlink_status_t &status)
+{
+    const mavlink_status_t *chan_status = mavlink_get_channel_status(chan);
+    uint32_t i = 0;
+    while (i < len) {
+        if (!alternative.handler && chan_status->parse_state <= MAVLINK_PARSE_STATE_IDLE) {
+            while (i < len && buf[i] != MAVLINK_STX && buf[i] != MAVLINK_STX_MAVLINK1) {
+                i++;
+            }
+            if (i == len) {
+                break;
+            }
+        }
+        if (receive_byte(buf[i++], now_ms, msg, status)) {
+            break;
+        }
+    }
+    return i;
+}
+
 void
 GCS_MAVLINK::update_receive(uint32_t max_time_us)
 {
@@ -1324,47 +1400,39 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
 
     status.packet_rx_drop_count = 0;
 
-    const uint16_t nbytes = _port->available();
-    for (uint16_t i=0; i<nbytes; i++)
-    {
-        const uint8_t c = (uint8_t)_port->read();
-        const uint32_t protocol_timeout = 4000;
-        
-        if (alternative.handler &&
-            now_ms - alternative.last_mavlink_ms > protocol_timeout) {
-            /*
-              we have an alternative protocol handler installed and we
-              haven't parsed a MAVLink packet for 4 seconds. Try
-              parsing using alternative handler
-             */
-            if (alternative.handler(c, mavlink_comm_port[chan])) {
-                alternative.last_alternate_ms = now_ms;
-                gcs_alternative_active[chan] = true;
-            }
-            
-            /*
-              we may also try parsing as MAVLink if we haven't had a
-              successful parse on the alternative protocol for 4s
-             */
-            if (now_ms - alternative.last_alternate_ms <= protocol_timeout) {
-                continue;
-            }
+    uint32_t nbytes = _port->available();
+
+    // parse straight out of the port's receive buffer where the
+    // driver allows it
+    while (nbytes > 0) {
+        uint32_t n;
+        const uint8_t *buf = _port->read_ptr(n);
+        if (buf == nullptr) {
+            break;
+        }
+        // limit the block size so the time check below is made at
+        // least every 100 bytes
+        n = MIN(MIN(n, nbytes), 100U);
+        const uint32_t used = receive_block(buf, n, now_ms, msg, status);
+        _port->read_advance(used);
+        nbytes -= used;
+
+        // make sure we don't spend too much time parsing mavlink messages
+        if (AP_HAL::micros() - tstart_us > max_time_us) {
+            nbytes = 0;
         }
+    }
 
-        bool parsed_packet = false;
-
-        // Try to get a new message
-        if (mavlink_parse_char(chan, c, &msg, &status)) {
-            hal.util->persistent_data.last_mavlink_msgid = msg.msgid;
-            hal.util->perf_begin(_perf_packet);
-            packetReceived(status, msg);
-            hal.util->perf_end(_perf_packet);
-            parsed_packet = true;
-            gcs_alternative_active[chan] = false;
-            alternative.last_mavlink_ms = now_ms;
-            hal.util->persistent_data.last_mavlink_msgid = 0;
+    // otherwise a byte at a time
+    for (uint32_t i=0; i<nbytes; i++)
+    {
+        const int16_t c = _port->read();
+        if (c < 0) {
+            break;
         }
 
+        const bool parsed_packet = receive_byte((uint8_t)c, now_ms, msg, status);
+
         if (parsed_packet || i % 100 == 0) {
             // make sure we don't spend too much time parsing mavlink messages
             if (AP_HAL::micros() - tstart_us > max_time_us) {
@@ -1388,6 +1456,7 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
     if (is_active() || is_streaming()) {
         if (tnow - last_mavlink_stats_logged > 1000) {
             log_mavlink_stats();
+            routing.log_stats();
             last_mavlink_stats_logged = tnow;
         }
     }
@@ -1906,6 +1975,7 @@ void GCS::update_receive(void)
     for (uint8_t i=0; i<num_gcs(); i++) {
         chan(i)->update_receive();
     }
+    GCS_MAVLINK::update_param_set_burst();
     // also update UART pass-thru, if enabled
     update_passthru();
 }
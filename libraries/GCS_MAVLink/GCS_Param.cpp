@@ -26,6 +26,10 @@ ObjectBuffer<GCS_MAVLINK::pending_param_request> GCS_MAVLINK::param_requests(20)
 ObjectBuffer<GCS_MAVLINK::pending_param_reply> GCS_MAVLINK::param_replies(5);
 
 bool GCS_MAVLINK::param_timer_registered;
+uint32_t GCS_MAVLINK::param_set_burst_ms;
+
+// a PARAM_SET burst is over once it has been quiet for this long
+#define PARAM_SET_BURST_MS 1000
 
 /**
  * @brief Send the next pending parameter, called from deferred message
@@ -296,8 +300,12 @@ void GCS_MAVLINK::handle_param_set(const mavlink_message_t &msg)
      */
     bool force_save = !is_equal(packet.param_value, old_value);
 
-    // save the change
-    vp->save(force_save);
+    // save the change as part of a batch, so a GCS writing many
+    // parameters doesn't fill the save queue. The batch doesn't send
+    // the value when it is written, so acknowledge it now
+    vp->save_batched(force_save);
+    gcs().send_parameter_value(key, var_type, vp->cast_to_float(var_type));
+    param_set_burst_ms = MAX(AP_HAL::millis(), 1U);
 
     AP_Logger *logger = AP_Logger::get_singleton();
     if (logger != nullptr) {
@@ -305,6 +313,32 @@ void GCS_MAVLINK::handle_param_set(const mavlink_message_t &msg)
     }
 }
 
+/*
+  log how the save path coped with a burst of PARAM_SETs once it has
+  gone quiet
+ */
+void GCS_MAVLINK::update_param_set_burst(void)
+{
+    if (param_set_burst_ms == 0 ||
+        AP_HAL::millis() - param_set_burst_ms < PARAM_SET_BURST_MS) {
+        return;
+    }
+    param_set_burst_ms = 0;
+
+    struct AP_Param::save_stats stats;
+    AP_Param::get_save_stats(stats);
+    AP::logger().Write("PSAV",
+                       "TimeUS,StallUS,Stalls,Drop,Coal,QHW,BHW",
+                       "QIIIIHH",
+                       AP_HAL::micros64(),
+                       stats.stall_us,
+                       stats.stall_count,
+                       stats.dropped,
+                       stats.coalesced,
+                       stats.queue_high_water,
+                       stats.batch_high_water);
+}
+
 void GCS_MAVLINK::send_parameter_value(const char *param_name, ap_var_type param_type, float param_value)
 {
     if (!HAVE_PAYLOAD_SPACE(chan, PARAM_VALUE)) {
@@ -21,6 +21,7 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS.h"
 #include "MAVLink_routing.h"
+#include <AP_Logger/AP_Logger.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -98,7 +99,7 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
     }
 
     // learn new routes
-    learn_route(in_channel, msg);
+    struct route *source = learn_route(in_channel, msg);
 
     if (msg.msgid == MAVLINK_MSG_ID_RADIO ||
         msg.msgid == MAVLINK_MSG_ID_RADIO_STATUS) {
@@ -108,7 +109,7 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
     
     if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
         // heartbeat needs special handling
-        handle_heartbeat(in_channel, msg);
+        handle_heartbeat(in_channel, msg, source);
         return true;
     }
 
@@ -134,42 +135,35 @@ bool MAVLink_routing::check_and_forward(mavlink_channel_t in_channel, const mavl
         return true;
     }
 
-    // forward on any channels matching the targets
-    bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-    
-        // Skip if channel is private and the target system or component IDs do not match
-        if ((GCS_MAVLINK::is_private(routes[i].channel)) &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
-            continue;
-        }
+    // forward on any channels where the targets have been seen
+    uint8_t mask;
+    if (broadcast_system) {
+        mask = all_channels_mask;
+    } else if (broadcast_component || !match_system) {
+        mask = system_channels(target_system);
+    } else {
+        mask = route_channels(target_system, target_component);
+    }
 
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
+    // private channels only get messages targeted at exactly a
+    // sysid/compid seen on them
+    const uint8_t private_mask = GCS_MAVLINK::private_channel_mask();
+    mask &= ~private_mask;
+    if (!broadcast_system && target_component != -1) {
+        mask |= route_channels(target_system, target_component) & private_mask;
+    }
 
-            if (in_channel != routes[i].channel && !sent_to_chan[routes[i].channel]) {
-                
-                if (comm_get_txspace(routes[i].channel) >= ((uint16_t)msg.len) +
-                    GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+    mask &= ~(1U<<(in_channel-MAVLINK_COMM_0));
+    const bool forwarded = (mask != 0);
+    if (forwarded) {
 #if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_channel,
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
+        ::printf("fwd msg %u from chan %u sysid=%d compid=%d\n",
+                 msg.msgid,
+                 (unsigned)in_channel,
+                 (int)target_system,
+                 (int)target_component);
 #endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
-            }
-        }
+        resend_on_channels(mask, msg, source);
     }
 
     if (!forwarded && match_system) {
@@ -195,29 +189,22 @@ void MAVLink_routing::send_to_components(uint32_t msgid, const char *pkt, uint8_
 
 void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entry_t *entry, const uint8_t pkt_len)
 {
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
-
-    // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid != mavlink_system.sysid) {
-            // our system ID hasn't been seen on this link
-            continue;
-        }
-        if (sent_to_chan[routes[i].channel]) {
-            // we've already send it on this link
+    // send on each channel where our system id has been seen
+    const uint8_t mask = system_channels(mavlink_system.sysid);
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (!(mask & (1U<<i))) {
             continue;
         }
-        if (comm_get_txspace(routes[i].channel) <
-            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) <
+            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(channel)) {
             // it doesn't fit on this channel
             continue;
         }
 #if ROUTING_DEBUG
-        ::printf("send msg %u on chan %u sysid=%u compid=%u\n",
+        ::printf("send msg %u on chan %u\n",
                  entry->msgid,
-                 (unsigned)routes[i].channel,
-                 (unsigned)routes[i].sysid,
-                 (unsigned)routes[i].compid);
+                 (unsigned)channel);
 #endif
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         if (entry->max_msg_len > pkt_len) {
@@ -225,13 +212,12 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
                           entry->max_msg_len, pkt_len);
         }
 #endif
-        _mav_finalize_message_chan_send(routes[i].channel,
+        _mav_finalize_message_chan_send(channel,
                                         entry->msgid,
                                         pkt,
                                         entry->min_msg_len,
                                         MIN(entry->max_msg_len, pkt_len),
                                         entry->crc_extra);
-        sent_to_chan[routes[i].channel] = true;
     }
 }
 
@@ -255,35 +241,74 @@ bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &
     return false;
 }
 
+/*
+  find the route for a sysid/compid pair, or nullptr if it hasn't
+  been seen
+*/
+MAVLink_routing::route *MAVLink_routing::find_route(uint8_t sysid, uint8_t compid)
+{
+    for (uint8_t slot = hash_slot((uint16_t(sysid)<<8) | compid);
+         route_hash[slot] != 0;
+         slot = (slot + 1) & (MAVLINK_ROUTE_HASH_SIZE-1)) {
+        struct route &r = routes[route_hash[slot]-1];
+        if (r.sysid == sysid && r.compid == compid) {
+            return &r;
+        }
+    }
+    return nullptr;
+}
+
+MAVLink_routing::system *MAVLink_routing::find_system(uint8_t sysid)
+{
+    for (uint8_t slot = hash_slot(sysid);
+         system_hash[slot] != 0;
+         slot = (slot + 1) & (MAVLINK_ROUTE_HASH_SIZE-1)) {
+        struct system &sys = systems[system_hash[slot]-1];
+        if (sys.sysid == sysid) {
+            return &sys;
+        }
+    }
+    return nullptr;
+}
+
+uint8_t MAVLink_routing::route_channels(uint8_t sysid, uint8_t compid)
+{
+    const struct route *r = find_route(sysid, compid);
+    return r != nullptr ? r->channel_mask : 0;
+}
+
+uint8_t MAVLink_routing::system_channels(uint8_t sysid)
+{
+    const struct system *sys = find_system(sysid);
+    return sys != nullptr ? sys->channel_mask : 0;
+}
+
 /*
   see if the message is for a new route and learn it
 */
-void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_message_t &msg)
+MAVLink_routing::route *MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0 ||
         (msg.sysid == mavlink_system.sysid &&
          msg.compid == mavlink_system.compid)) {
-        return;
+        return nullptr;
     }
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
-            }
-            break;
+
+    struct route *r = find_route(msg.sysid, msg.compid);
+    if (r == nullptr) {
+        if (num_routes >= MAVLINK_MAX_ROUTES) {
+            return nullptr;
         }
-    }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+        r = &routes[num_routes];
+        memset(r, 0, sizeof(*r));
+        r->sysid = msg.sysid;
+        r->compid = msg.compid;
+        r->channel = in_channel;
+        uint8_t slot = hash_slot((uint16_t(msg.sysid)<<8) | msg.compid);
+        while (route_hash[slot] != 0) {
+            slot = (slot + 1) & (MAVLINK_ROUTE_HASH_SIZE-1);
         }
-        num_routes++;
+        route_hash[slot] = ++num_routes;
 #if ROUTING_DEBUG
         ::printf("learned route %u %u via %u\n",
                  (unsigned)msg.sysid,
@@ -291,6 +316,83 @@ void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_me
                  (unsigned)in_channel);
 #endif
     }
+
+    if (r->mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+        r->mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    }
+
+    const uint8_t chan_bit = 1U<<(in_channel-MAVLINK_COMM_0);
+    if ((r->channel_mask & chan_bit) == 0) {
+        // first time seen on this channel
+        r->channel_mask |= chan_bit;
+        all_channels_mask |= chan_bit;
+        struct system *sys = find_system(msg.sysid);
+        if (sys == nullptr) {
+            // there are never more systems than routes, so this fits
+            sys = &systems[num_systems];
+            sys->sysid = msg.sysid;
+            sys->channel_mask = 0;
+            uint8_t slot = hash_slot(msg.sysid);
+            while (system_hash[slot] != 0) {
+                slot = (slot + 1) & (MAVLINK_ROUTE_HASH_SIZE-1);
+            }
+            system_hash[slot] = ++num_systems;
+        }
+        sys->channel_mask |= chan_bit;
+    }
+
+    return r;
+}
+
+/*
+  send a message on the channels in mask which have space for it
+*/
+void MAVLink_routing::resend_on_channels(uint8_t mask, const mavlink_message_t &msg, struct route *source)
+{
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if (!(mask & (1U<<i))) {
+            continue;
+        }
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) < ((uint16_t)msg.len) +
+            GCS_MAVLINK::packet_overhead_chan(channel)) {
+            continue;
+        }
+        _mavlink_resend_uart(channel, &msg);
+        if (source != nullptr) {
+            source->fwd_packets++;
+            // whole frame: header, payload, CRC and any signature
+            source->fwd_bytes += mavlink_msg_get_send_buffer_length(&msg);
+        }
+    }
+}
+
+/*
+  log the forwarding statistics for each route
+*/
+void MAVLink_routing::log_stats(void)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - last_log_ms < 10000) {
+        return;
+    }
+    last_log_ms = now_ms;
+
+    const uint64_t now_us = AP_HAL::micros64();
+    for (uint8_t i=0; i<num_routes; i++) {
+        const struct route &r = routes[i];
+        const struct log_MAVLink_route pkt {
+            LOG_PACKET_HEADER_INIT(LOG_MAVLINK_ROUTE_MSG),
+            time_us      : now_us,
+            sysid        : r.sysid,
+            compid       : r.compid,
+            mavtype      : r.mavtype,
+            channel_mask : r.channel_mask,
+            packets      : r.fwd_packets,
+            bytes        : r.fwd_bytes
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
 }
 
 
@@ -299,7 +401,7 @@ void MAVLink_routing::learn_route(mavlink_channel_t in_channel, const mavlink_me
   propagation heartbeat messages need to be forwarded on all channels
   except channels where the sysid/compid of the heartbeat could come from
 */
-void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavlink_message_t &msg)
+void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavlink_message_t &msg, struct route *source)
 {
     uint16_t mask = GCS_MAVLINK::active_channel_mask();
     
@@ -311,10 +413,8 @@ void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavli
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
-            mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
-        }
+    if (source != nullptr) {
+        mask &= ~source->channel_mask;
     }
 
     if (mask == 0) {
@@ -322,23 +422,15 @@ void MAVLink_routing::handle_heartbeat(mavlink_channel_t in_channel, const mavli
         return;
     }
 
-    // send on the remaining channels
-    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
-        if (mask & (1U<<i)) {
-            mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
-            if (comm_get_txspace(channel) >= ((uint16_t)msg.len) +
-                GCS_MAVLINK::packet_overhead_chan(channel)) {
 #if ROUTING_DEBUG
-                ::printf("fwd HB from chan %u on chan %u from sysid=%u compid=%u\n",
-                         (unsigned)in_channel,
-                         (unsigned)channel,
-                         (unsigned)msg.sysid,
-                         (unsigned)msg.compid);
+    ::printf("fwd HB from chan %u from sysid=%u compid=%u\n",
+             (unsigned)in_channel,
+             (unsigned)msg.sysid,
+             (unsigned)msg.compid);
 #endif
-                _mavlink_resend_uart(channel, &msg);
-            }
-        }
-    }
+
+    // send on the remaining channels
+    resend_on_channels(mask, msg, source);
 }
 
 
@@ -6,9 +6,22 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+// maximum number of sysid/compid pairs learned. A pair seen on several
+// channels uses one route
+#ifndef MAVLINK_MAX_ROUTES
 #define MAVLINK_MAX_ROUTES 20
+#endif
+
+// the hash tables indexing the routes have 2^MAVLINK_ROUTE_HASH_BITS
+// slots, which must be at least twice MAVLINK_MAX_ROUTES
+#ifndef MAVLINK_ROUTE_HASH_BITS
+#define MAVLINK_ROUTE_HASH_BITS 6
+#endif
+#define MAVLINK_ROUTE_HASH_SIZE (1U<<MAVLINK_ROUTE_HASH_BITS)
+
+static_assert(MAVLINK_ROUTE_HASH_SIZE >= 2*MAVLINK_MAX_ROUTES, "MAVLINK_ROUTE_HASH_BITS too small");
+static_assert(MAVLINK_MAX_ROUTES < 255, "too many routes");
+static_assert(MAVLINK_COMM_NUM_BUFFERS <= 8, "channel masks are 8 bits");
 
 /*
   object to handle MAVLink packet routing
@@ -44,28 +57,69 @@ public:
      */
     bool find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel);
 
+    /*
+      log the forwarding statistics for each route, at most once
+      every 10 seconds
+     */
+    void log_stats(void);
+
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
+    // one route per sysid/compid pair, in the order they were first
+    // seen, with a mask of the channels they have been seen on
     uint8_t num_routes;
     struct route {
         uint8_t sysid;
         uint8_t compid;
-        mavlink_channel_t channel;
         uint8_t mavtype;
+        uint8_t channel_mask;
+        mavlink_channel_t channel;  // first channel the route was seen on
+        uint32_t fwd_packets;       // packets from this route forwarded, per channel sent on
+        uint32_t fwd_bytes;         // bytes on the wire of the packets counted in fwd_packets
     } routes[MAVLINK_MAX_ROUTES];
-    
+
+    // mask of the channels each system id has been seen on
+    uint8_t num_systems;
+    struct system {
+        uint8_t sysid;
+        uint8_t channel_mask;
+    } systems[MAVLINK_MAX_ROUTES];
+
+    // channels any route has been seen on
+    uint8_t all_channels_mask;
+
+    // open addressing hash tables of route and system indexes plus
+    // one, zero for an empty slot. Entries are never removed
+    uint8_t route_hash[MAVLINK_ROUTE_HASH_SIZE];
+    uint8_t system_hash[MAVLINK_ROUTE_HASH_SIZE];
+
+    uint32_t last_log_ms;
+
     // a channel mask to block routing as required
     uint8_t no_route_mask;
-    
-    // learn new routes
-    void learn_route(mavlink_channel_t in_channel, const mavlink_message_t &msg);
+
+    static uint8_t hash_slot(uint16_t key) {
+        // Fibonacci hashing
+        return uint16_t(key * 40503U) >> (16 - MAVLINK_ROUTE_HASH_BITS);
+    }
+    struct route *find_route(uint8_t sysid, uint8_t compid);
+    struct system *find_system(uint8_t sysid);
+
+    // channels on which sysid/compid, or any component of sysid, has been seen
+    uint8_t route_channels(uint8_t sysid, uint8_t compid);
+    uint8_t system_channels(uint8_t sysid);
+
+    // send msg on each channel in mask with room for it, counting it
+    // against the source route
+    void resend_on_channels(uint8_t mask, const mavlink_message_t &msg, struct route *source);
+
+    // learn new routes, returning the sender's route if there is one
+    struct route *learn_route(mavlink_channel_t in_channel, const mavlink_message_t &msg);
 
     // extract target sysid and compid from a message
     void get_targets(const mavlink_message_t &msg, int16_t &sysid, int16_t &compid);
 
     // special handling for heartbeat messages
-    void handle_heartbeat(mavlink_channel_t in_channel, const mavlink_message_t &msg);
+    void handle_heartbeat(mavlink_channel_t in_channel, const mavlink_message_t &msg, struct route *source);
 
     void send_to_components(const char *pkt, const mavlink_msg_entry_t *entry, uint8_t pkt_len);
 };
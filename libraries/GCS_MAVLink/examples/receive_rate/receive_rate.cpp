@@ -0,0 +1,156 @@
+//
+// Measure how fast GCS_MAVLINK::update_receive() parses packets from
+// a port, with the port read a byte at a time and with bulk reads.
+// Both paths parse frames with mavlink_parse_char(); bulk reads save
+// the per byte read() call and skip to start bytes between frames
+//
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+#include <GCS_MAVLink/GCS.h>
+#include <GCS_MAVLink/GCS_MAVLink.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+#include <AP_SerialManager/AP_SerialManager.h>
+
+void setup();
+void loop();
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+AP_SerialManager _serialmanager;
+GCS_Dummy _gcs;
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+#define RX_BUFFER_SIZE 16384
+#define ITERATIONS 200
+
+/*
+  a port with data written straight into its receive buffer. Bulk
+  reads can be turned off to measure the byte at a time path
+ */
+class TestUART : public AP_HAL::UARTDriver {
+public:
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+    uint32_t txspace() override { return 0; }
+    size_t write(uint8_t c) override { return 0; }
+    size_t write(const uint8_t *buffer, size_t size) override { return 0; }
+
+    uint32_t available() override { return rxbuf.available(); }
+    int16_t read() override {
+        uint8_t c;
+        if (!rxbuf.read_byte(&c)) {
+            return -1;
+        }
+        return c;
+    }
+    const uint8_t *read_ptr(uint32_t &n) override {
+        if (!bulk) {
+            n = 0;
+            return nullptr;
+        }
+        return rxbuf.readptr(n);
+    }
+    bool read_advance(uint32_t n) override { return rxbuf.advance(n); }
+
+    ByteBuffer rxbuf{RX_BUFFER_SIZE};
+    bool bulk;
+};
+
+static TestUART uart;
+static GCS_MAVLINK_Parameters link_params;
+static GCS_MAVLINK_Dummy mavlink_link(link_params, uart);
+
+// a burst of companion computer style traffic
+static uint8_t stream[RX_BUFFER_SIZE/2];
+static uint16_t stream_len;
+static uint16_t stream_packets;
+
+static void add_packet(const mavlink_message_t &msg)
+{
+    uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+    const uint16_t len = mavlink_msg_to_send_buffer(buf, &msg);
+    memcpy(&stream[stream_len], buf, len);
+    stream_len += len;
+    stream_packets++;
+}
+
+static void build_stream(void)
+{
+    mavlink_message_t msg;
+    while (stream_len + 3*MAVLINK_MAX_PACKET_LEN + 8 < sizeof(stream)) {
+        mavlink_attitude_t attitude {};
+        attitude.time_boot_ms = stream_packets;
+        mavlink_msg_attitude_encode_chan(2, 1, MAVLINK_COMM_1, &msg, &attitude);
+        add_packet(msg);
+
+        mavlink_global_position_int_t pos {};
+        pos.time_boot_ms = stream_packets;
+        mavlink_msg_global_position_int_encode_chan(2, 1, MAVLINK_COMM_1, &msg, &pos);
+        add_packet(msg);
+
+        if (stream_packets % 30 == 0) {
+            mavlink_heartbeat_t heartbeat {};
+            mavlink_msg_heartbeat_encode_chan(2, 1, MAVLINK_COMM_1, &msg, &heartbeat);
+            add_packet(msg);
+
+            // some line noise, without start bytes
+            for (uint8_t i=0; i<8; i++) {
+                stream[stream_len++] = 0x55;
+            }
+        }
+    }
+}
+
+static void run(bool bulk)
+{
+    uart.bulk = bulk;
+    const mavlink_status_t *status = mavlink_get_channel_status(MAVLINK_COMM_0);
+    const uint32_t count0 = status->packet_rx_success_count;
+
+    const uint64_t tstart_us = AP_HAL::micros64();
+    for (uint16_t i=0; i<ITERATIONS; i++) {
+        uart.rxbuf.write(stream, stream_len);
+        while (uart.available() > 0) {
+            mavlink_link.update_receive(UINT32_MAX);
+        }
+    }
+    uint64_t dt_us = AP_HAL::micros64() - tstart_us;
+    if (dt_us == 0) {
+        dt_us = 1;
+    }
+
+    const uint32_t packets = status->packet_rx_success_count - count0;
+    hal.console->printf("%-10s %6lu packets %s, %8lu packets/s, %6.2f MB/s\n",
+                        bulk ? "bulk" : "byte",
+                        (unsigned long)packets,
+                        packets == uint32_t(ITERATIONS) * stream_packets ? "OK" : "MISSING",
+                        (unsigned long)(packets * 1.0e6 / dt_us),
+                        (double)(ITERATIONS * stream_len / (double)dt_us));
+}
+
+void setup(void)
+{
+    hal.console->printf("MAVLink receive rate test\n");
+    mavlink_comm_port[MAVLINK_COMM_0] = &uart;
+    build_stream();
+    hal.console->printf("%u packets in %u bytes per burst\n",
+                        (unsigned)stream_packets, (unsigned)stream_len);
+}
+
+void loop(void)
+{
+    run(false);
+    run(true);
+    hal.scheduler->delay(1000);
+}
+
+AP_HAL_MAIN();
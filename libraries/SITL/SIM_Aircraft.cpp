@@ -74,10 +74,13 @@ Aircraft::Aircraft(const char *frame_str) :
     enum ap_var_type ptype;
     ahrs_orientation = (AP_Int8 *)AP_Param::find("AHRS_ORIENTATION", &ptype);
 
-    enum Rotation imu_rotation = (enum Rotation)ahrs_orientation->get();
-    ahrs_rotation_inv.from_rotation(imu_rotation);
-    ahrs_rotation_inv.transpose();
-    last_imu_rotation = imu_rotation;
+    // there is no AHRS when models are run outside a vehicle
+    if (ahrs_orientation != nullptr) {
+        enum Rotation imu_rotation = (enum Rotation)ahrs_orientation->get();
+        ahrs_rotation_inv.from_rotation(imu_rotation);
+        ahrs_rotation_inv.transpose();
+        last_imu_rotation = imu_rotation;
+    }
 
     terrain = reinterpret_cast<AP_Terrain *>(AP_Param::find_object("TERRAIN_"));
 }
@@ -278,6 +281,10 @@ void Aircraft::add_noise(float throttle)
                            rand_normal(0, 1)) * accel_noise * fabsf(throttle);
 }
 
+thread_local unsigned Aircraft::rand_seed = 1;
+thread_local double Aircraft::rand_n2;
+thread_local bool Aircraft::rand_n2_cached;
+
 /*
   normal distribution random numbers
   See
@@ -285,25 +292,23 @@ void Aircraft::add_noise(float throttle)
 */
 double Aircraft::rand_normal(double mean, double stddev)
 {
-    static double n2 = 0.0;
-    static int n2_cached = 0;
-    if (!n2_cached) {
+    if (!rand_n2_cached) {
         double x, y, r;
         do
         {
-            x = 2.0 * rand()/RAND_MAX - 1;
-            y = 2.0 * rand()/RAND_MAX - 1;
+            x = 2.0 * rand_r(&rand_seed)/RAND_MAX - 1;
+            y = 2.0 * rand_r(&rand_seed)/RAND_MAX - 1;
             r = x*x + y*y;
         } while (is_zero(r) || r > 1.0);
         const double d = sqrt(-2.0 * log(r)/r);
         const double n1 = x * d;
-        n2 = y * d;
+        rand_n2 = y * d;
         const double result = n1 * stddev + mean;
-        n2_cached = 1;
+        rand_n2_cached = true;
         return result;
     } else {
-        n2_cached = 0;
-        return n2 * stddev + mean;
+        rand_n2_cached = false;
+        return rand_n2 * stddev + mean;
     }
 }
 
@@ -582,7 +587,7 @@ void Aircraft::update_wind(const struct sitl_input &input)
 
     if (wind_turb > 0 && !on_ground()) {
 
-        turbulence_azimuth = turbulence_azimuth + (2 * rand());
+        turbulence_azimuth = turbulence_azimuth + (2 * rand_r(&rand_seed));
 
         turbulence_horizontal_speed =
                 static_cast<float>(turbulence_horizontal_speed * iir_coef+wind_turb * rand_normal(0, 1) * (1 - iir_coef));
@@ -48,6 +48,14 @@ public:
      */
     void set_speedup(float speedup);
 
+    /*
+      enable or disable sleeping to keep simulation time in step
+      with the wall clock
+     */
+    void set_time_sync(bool enable) {
+        use_time_sync = enable;
+    }
+
     /*
       set instance number
      */
@@ -81,6 +89,9 @@ public:
     /* return normal distribution random numbers */
     static double rand_normal(double mean, double stddev);
 
+    /* seed the random numbers for the calling thread */
+    static void seed_random(unsigned seed) { rand_seed = seed; }
+
     // get frame rate of model in Hz
     float get_rate_hz(void) const { return rate_hz; }
 
@@ -283,6 +294,12 @@ private:
     Gripper_EPM *gripper_epm;
     Parachute *parachute;
     SIM_Precland *precland;
+
+    // random number state. Swarm models are stepped on several
+    // threads, so each thread has its own
+    static thread_local unsigned rand_seed;
+    static thread_local double rand_n2;
+    static thread_local bool rand_n2_cached;
 };
 
 } // namespace SITL
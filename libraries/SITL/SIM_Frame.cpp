@@ -20,6 +20,7 @@
 #include <AP_Motors/AP_Motors.h>
 
 #include <stdio.h>
+#include <new>
 
 using namespace SITL;
 
@@ -234,6 +235,22 @@ Frame *Frame::find_frame(const char *name)
     return nullptr;
 }
 
+/*
+  copy a frame and its motors. The frames and motors in the table
+  above are shared by every vehicle of that type, but they hold
+  per vehicle state, so each vehicle works on its own copy
+ */
+Frame *Frame::create_copy(void) const
+{
+    Frame *frame = new Frame(*this);
+    Motor *motors_copy = (Motor *)::operator new(sizeof(Motor) * num_motors);
+    for (uint8_t i=0; i<num_motors; i++) {
+        new (&motors_copy[i]) Motor(motors[i]);
+    }
+    frame->motors = motors_copy;
+    return frame;
+}
+
 // calculate rotational and linear accelerations
 void Frame::calculate_forces(const Aircraft &aircraft,
                              const struct sitl_input &input,
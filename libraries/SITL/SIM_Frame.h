@@ -42,6 +42,10 @@ public:
 
     // find a frame by name
     static Frame *find_frame(const char *name);
+
+    // a copy of the frame with its own motors, for a vehicle to
+    // keep its servo and scaling state in
+    Frame *create_copy(void) const;
     
     // initialise frame
     void init(float mass, float hover_throttle, float terminal_velocity, float terminal_rotation_rate);
@@ -41,7 +41,6 @@ public:
     /*  Create and set in/out socket for Gazebo simulator */
     void set_interface_ports(const char* address, const int port_in, const int port_out) override;
 
-private:
     /*
       packet sent to Gazebo
      */
@@ -62,6 +61,7 @@ private:
       double position_xyz[3];
     };
 
+private:
     void recv_fdm(const struct sitl_input &input);
     void send_servos(const struct sitl_input &input);
     void drain_sockets();
@@ -29,11 +29,12 @@ MultiCopter::MultiCopter(const char *frame_str) :
 {
     mass = 1.5f;
 
-    frame = Frame::find_frame(frame_str);
-    if (frame == nullptr) {
+    const Frame *frame_type = Frame::find_frame(frame_str);
+    if (frame_type == nullptr) {
         printf("Frame '%s' not found", frame_str);
         exit(1);
     }
+    frame = frame_type->create_copy();
     // initial mass is passed through to Frame for it to calculate a
     // hover thrust requirement.
     if (strstr(frame_str, "-fast")) {
@@ -68,11 +68,12 @@ QuadPlane::QuadPlane(const char *frame_str) :
         // fwd motor gives zero thrust
         thrust_scale = 0;
     }
-    frame = Frame::find_frame(frame_type);
-    if (frame == nullptr) {
+    const Frame *frame_def = Frame::find_frame(frame_type);
+    if (frame_def == nullptr) {
         printf("Failed to find frame '%s'\n", frame_type);
         exit(1);
     }
+    frame = frame_def->create_copy();
     num_motors = 1 + frame->num_motors;
 
     if (strstr(frame_str, "cl84")) {
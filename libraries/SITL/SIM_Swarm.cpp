@@ -0,0 +1,205 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  batch physics for swarm tests
+*/
+
+#include "SIM_Swarm.h"
+
+#include "SIM_Multicopter.h"
+#include "SIM_Plane.h"
+#include "SIM_QuadPlane.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+
+namespace SITL {
+
+static const struct {
+    const char *name;
+    Aircraft *(*constructor)(const char *frame_str);
+} swarm_models[] = {
+    { "quadplane",          QuadPlane::create },
+    { "plane",              Plane::create },
+};
+
+bool Swarm::init(const char *model_str, uint16_t count, uint16_t base_port)
+{
+    if (vehicles != nullptr || count == 0) {
+        return false;
+    }
+    vehicles = new Vehicle[count]();
+    if (vehicles == nullptr) {
+        return false;
+    }
+
+    // anything that isn't a plane is a multicopter frame name
+    Aircraft *(*constructor)(const char *frame_str) = MultiCopter::create;
+    for (uint8_t i=0; i < ARRAY_SIZE(swarm_models); i++) {
+        if (strncasecmp(swarm_models[i].name, model_str, strlen(swarm_models[i].name)) == 0) {
+            constructor = swarm_models[i].constructor;
+            break;
+        }
+    }
+
+    for (uint16_t i=0; i<count; i++) {
+        Vehicle &v = vehicles[i];
+        v.model = constructor(model_str);
+        v.sock = new SocketAPM(true);
+        if (v.model == nullptr || v.sock == nullptr) {
+            return false;
+        }
+        // the firmware keeps time with us, so never sleep
+        v.model->set_time_sync(false);
+
+        const uint16_t port = base_port + 10 * i;
+        v.sock->reuseaddress();
+        if (!v.sock->bind("0.0.0.0", port)) {
+            ::fprintf(stderr, "Swarm: bind failed on port %u - %s\n", port, strerror(errno));
+            return false;
+        }
+        v.sock->set_blocking(false);
+        v.reply_port = port + 1;
+        num_vehicles++;
+    }
+    ::printf("Swarm: %u %s models on ports %u to %u\n",
+             num_vehicles, model_str, base_port, base_port + 10 * (num_vehicles - 1));
+    return true;
+}
+
+bool Swarm::start(uint8_t num_threads)
+{
+    if (num_vehicles == 0 || workers != nullptr) {
+        return false;
+    }
+    num_threads = constrain_int16(num_threads, 1, MIN(num_vehicles, 255));
+    workers = new Worker[num_threads];
+    if (workers == nullptr) {
+        return false;
+    }
+    num_workers = num_threads;
+    for (uint8_t i=0; i<num_workers; i++) {
+        workers[i].swarm = this;
+        workers[i].index = i;
+        if (pthread_create(&workers[i].thread, nullptr, worker_trampoline, &workers[i]) != 0) {
+            return false;
+        }
+    }
+    ::printf("Swarm: stepping on %u threads\n", num_workers);
+    return true;
+}
+
+uint64_t Swarm::total_steps() const
+{
+    uint64_t total = 0;
+    for (uint16_t i=0; i<num_vehicles; i++) {
+        total += vehicles[i].steps.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void *Swarm::worker_trampoline(void *arg)
+{
+    Worker *w = (Worker *)arg;
+    w->swarm->run_worker(w->index);
+    return nullptr;
+}
+
+/*
+  step this worker's models, index, index+num_workers and so on, each
+  time their firmware sends servo outputs
+ */
+void Swarm::run_worker(uint8_t index)
+{
+    // each thread has its own noise sequence
+    Aircraft::seed_random(index + 1);
+
+    const uint16_t n = (num_vehicles - index + num_workers - 1) / num_workers;
+    struct pollfd *fds = new struct pollfd[n];
+    Vehicle **mine = new Vehicle*[n];
+    if (fds == nullptr || mine == nullptr) {
+        ::fprintf(stderr, "Swarm: out of memory in worker %u\n", index);
+        return;
+    }
+    for (uint16_t i=0; i<n; i++) {
+        mine[i] = &vehicles[index + i * num_workers];
+        fds[i].fd = mine[i]->sock->get_read_fd();
+        fds[i].events = POLLIN;
+    }
+
+    while (true) {
+        if (poll(fds, n, 1000) <= 0) {
+            continue;
+        }
+        for (uint16_t i=0; i<n; i++) {
+            if (!(fds[i].revents & POLLIN)) {
+                continue;
+            }
+            // one physics step per servo packet, as the firmware
+            // waits for our reply before sending the next
+            Gazebo::servo_packet pkt;
+            while (mine[i]->sock->recv(&pkt, sizeof(pkt), 0) == sizeof(pkt)) {
+                step(*mine[i], pkt);
+            }
+        }
+    }
+}
+
+/*
+  step one model and send its state back to its firmware
+ */
+void Swarm::step(Vehicle &v, const Gazebo::servo_packet &pkt)
+{
+    struct sitl_input input {};
+    for (uint8_t i=0; i<ARRAY_SIZE(input.servos); i++) {
+        input.servos[i] = constrain_float(1000 + pkt.motor_speed[i] * 1000, 0, 2500);
+    }
+    const SITL *sitl = AP::sitl();
+    if (sitl != nullptr) {
+        input.wind.speed = sitl->wind_speed;
+        input.wind.direction = sitl->wind_direction;
+        input.wind.turbulence = sitl->wind_turbulance;
+        input.wind.dir_z = sitl->wind_dir_z;
+    }
+
+    v.model->update_model(input);
+    v.model->fill_fdm(v.fdm);
+    v.steps.fetch_add(1, std::memory_order_relaxed);
+
+    Gazebo::fdm_packet reply;
+    reply.timestamp = v.fdm.timestamp_us * 1.0e-6;
+    reply.imu_angular_velocity_rpy[0] = radians(v.fdm.rollRate);
+    reply.imu_angular_velocity_rpy[1] = radians(v.fdm.pitchRate);
+    reply.imu_angular_velocity_rpy[2] = radians(v.fdm.yawRate);
+    reply.imu_linear_acceleration_xyz[0] = v.fdm.xAccel;
+    reply.imu_linear_acceleration_xyz[1] = v.fdm.yAccel;
+    reply.imu_linear_acceleration_xyz[2] = v.fdm.zAccel;
+    reply.imu_orientation_quat[0] = v.fdm.quaternion.q1;
+    reply.imu_orientation_quat[1] = v.fdm.quaternion.q2;
+    reply.imu_orientation_quat[2] = v.fdm.quaternion.q3;
+    reply.imu_orientation_quat[3] = v.fdm.quaternion.q4;
+    reply.velocity_xyz[0] = v.fdm.speedN;
+    reply.velocity_xyz[1] = v.fdm.speedE;
+    reply.velocity_xyz[2] = v.fdm.speedD;
+    const Vector3f &pos = v.model->get_position();
+    reply.position_xyz[0] = pos.x;
+    reply.position_xyz[1] = pos.y;
+    reply.position_xyz[2] = pos.z;
+
+    v.sock->sendto(&reply, sizeof(reply), "127.0.0.1", v.reply_port);
+}
+
+}  // namespace SITL
@@ -0,0 +1,86 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  batch physics for swarm tests: many Aircraft models in one process,
+  stepped on a pool of threads
+*/
+
+#pragma once
+
+#include "SIM_Gazebo.h"
+#include <AP_HAL/utility/Socket.h>
+#include <pthread.h>
+#include <atomic>
+
+namespace SITL {
+
+/*
+  Each model serves one firmware instance over the Gazebo packet
+  protocol, so the firmware keeps its own process and is started as
+  usual with "-M gazebo -I N". Model N listens for servo packets on
+  base_port+10*N and replies on the port after it, which matches the
+  simulator ports used by instance N.
+
+  The models are shared out between the threads, so each model is
+  only ever stepped by one thread. Models keep their own copy of their
+  frame and motors, and the noise random numbers are per thread, so
+  nothing a model changes while stepping is shared with another
+  thread.
+ */
+class Swarm {
+public:
+    Swarm() {}
+
+    /* do not allow copies */
+    Swarm(const Swarm &other) = delete;
+    Swarm &operator=(const Swarm&) = delete;
+
+    // create count models of the given type, e.g. "quad" or "plane"
+    bool init(const char *model_str, uint16_t count, uint16_t base_port);
+
+    // start num_threads threads stepping the models
+    bool start(uint8_t num_threads);
+
+    uint16_t count() const { return num_vehicles; }
+
+    // total number of physics steps run by all models
+    uint64_t total_steps() const;
+
+private:
+    struct Vehicle {
+        Aircraft *model;
+        SocketAPM *sock;
+        uint16_t reply_port;
+        struct sitl_fdm fdm;
+        // read by total_steps() from other threads
+        std::atomic<uint32_t> steps;
+    };
+    Vehicle *vehicles = nullptr;
+    uint16_t num_vehicles = 0;
+
+    struct Worker {
+        Swarm *swarm;
+        uint8_t index;
+        pthread_t thread;
+    };
+    Worker *workers = nullptr;
+    uint8_t num_workers = 0;
+
+    static void *worker_trampoline(void *arg);
+    void run_worker(uint8_t index);
+    void step(Vehicle &v, const Gazebo::servo_packet &pkt);
+};
+
+}  // namespace SITL